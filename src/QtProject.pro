@@ -13,13 +13,59 @@ SOURCES += \
     main.cpp \
     mainwindow.cpp \
     crypto_utils.cpp \
-    settingsdialog.cpp
+    settingsdialog.cpp \
+    chunkeduploader.cpp \
+    transferstats.cpp \
+    hashservice.cpp \
+    deltauploader.cpp \
+    fleetuploader.cpp \
+    fleetuploaddialog.cpp \
+    sharedchunksource.cpp \
+    sshsession.cpp \
+    sshprocess.cpp \
+    sshutils.cpp \
+    streamextractor.cpp \
+    streamcompressor.cpp \
+    multistreamuploader.cpp \
+    ratelimiter.cpp \
+    transferwatchdog.cpp \
+    retrypolicy.cpp \
+    rollingchecksum.cpp \
+    batchuploader.cpp \
+    digestmanifest.cpp \
+    filedigest.cpp \
+    upgradepipeline.cpp \
+    upgradetelemetry.cpp \
+    upgradetimelinedialog.cpp
 
 # 头文件
 HEADERS += \
     mainwindow.h \
     crypto_utils.h \
-    settingsdialog.h
+    settingsdialog.h \
+    chunkeduploader.h \
+    transferstats.h \
+    hashservice.h \
+    deltauploader.h \
+    fleetuploader.h \
+    fleetuploaddialog.h \
+    sharedchunksource.h \
+    sshsession.h \
+    sshprocess.h \
+    sshutils.h \
+    streamextractor.h \
+    streamcompressor.h \
+    multistreamuploader.h \
+    ratelimiter.h \
+    transferwatchdog.h \
+    retrypolicy.h \
+    rollingchecksum.h \
+    batchuploader.h \
+    digestmanifest.h \
+    filedigest.h \
+    upgradepipeline.h \
+    upgradetelemetry.h \
+    upgradetimelinedialog.h
 
 # 资源文件
 RESOURCES += \
@@ -0,0 +1,729 @@
+/**
+ * @File Name: batchuploader.cpp
+ * @brief  多文件/目录上传实现，小文件在本地编码为 ustar 流送入远程 tar -x，大文件交给分块上传引擎，最后按清单一次校验
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "batchuploader.h"
+#include "chunkeduploader.h"
+#include "ratelimiter.h"
+#include "sshprocess.h"
+#include "sshutils.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QSet>
+#include <algorithm>
+#include <cstring>
+
+// tar 块大小，以及 ustar 头部中文件名和前缀字段的长度
+static const int TAR_BLOCK_SIZE = 512;
+static const int USTAR_NAME_LENGTH = 100;
+static const int USTAR_PREFIX_LENGTH = 155;
+
+// 校验失败时日志中最多列出的文件数
+static const int MAX_REPORTED_FAILURES = 10;
+
+// 按 ustar 规则拆分路径：不超过100字节直接放入 name，否则在某个 / 处拆成 prefix 和 name
+static bool splitUstarPath(const QByteArray &path, QByteArray *name, QByteArray *prefix)
+{
+    if (path.size() <= USTAR_NAME_LENGTH) {
+        *name = path;
+        prefix->clear();
+        return true;
+    }
+
+    for (int i = path.size() - 1; i > 0; --i) {
+        if (path.at(i) != '/') {
+            continue;
+        }
+        if (i <= USTAR_PREFIX_LENGTH && path.size() - i - 1 <= USTAR_NAME_LENGTH && path.size() - i - 1 > 0) {
+            *prefix = path.left(i);
+            *name = path.mid(i + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void writeOctal(QByteArray &header, int offset, int width, qint64 value)
+{
+    QByteArray digits = QByteArray::number(value, 8).rightJustified(width - 1, '0');
+    memcpy(header.data() + offset, digits.constData(), width - 1);
+}
+
+// 小文件打包发送；路径超出 ustar 限制的文件改走分块上传
+static bool fitsTarBatch(const BatchUploader::Entry &entry)
+{
+    QByteArray name;
+    QByteArray prefix;
+    return entry.size <= ChunkedUploader::DEFAULT_CHUNK_SIZE
+           && splitUstarPath(entry.relativePath.toUtf8(), &name, &prefix);
+}
+
+static QString remoteJoin(const QString &dir, const QString &relativePath)
+{
+    QString base = dir;
+    while (base.length() > 1 && base.endsWith('/')) {
+        base.chop(1);
+    }
+    return base.endsWith('/') ? base + relativePath : base + "/" + relativePath;
+}
+
+BatchUploader::BatchUploader(QObject *parent)
+    : QObject(parent), port(22), sshEnvironment(QProcessEnvironment::systemEnvironment()),
+      deltaEnabled(false), compressionEnabled(false), running(false), cancelRequested(false),
+      errorClass(RetryPolicy::ErrorNone), tarPosition(-1), tarProcess(nullptr), tarHash(QCryptographicHash::Md5),
+      tarFileRemaining(0), tarPayloadWritten(0), tarTrailerQueued(false), deviceLimiter(nullptr),
+      limiterConsumer(-1), largePosition(0), largeUploader(nullptr), largeBytesSent(0), verifyProcess(nullptr)
+{
+    deviceLimiter = new RateLimiter(this);
+    connect(deviceLimiter, &RateLimiter::tokensAvailable, this, &BatchUploader::feedTar);
+
+    largeUploader = new ChunkedUploader(this);
+    connect(largeUploader, &ChunkedUploader::logMessage, this, &BatchUploader::logMessage);
+    connect(largeUploader, &ChunkedUploader::progressChanged, this, &BatchUploader::onLargeFileProgress);
+    connect(largeUploader, &ChunkedUploader::finished, this, &BatchUploader::onLargeFileFinished);
+    connect(largeUploader, &ChunkedUploader::preparing, this, &BatchUploader::preparing);
+    connect(largeUploader, &ChunkedUploader::cancelled, this, [this]() {
+        if (running && cancelRequested) {
+            finishWithError("多文件上传已取消");
+        }
+    });
+}
+
+BatchUploader::~BatchUploader()
+{
+    cleanup();
+}
+
+QList<BatchUploader::Entry> BatchUploader::collectEntries(const QStringList &paths, QString *errorMessage)
+{
+    QList<Entry> entries;
+    QSet<QString> seen;
+
+    auto addFile = [&entries, &seen](const QFileInfo &info, const QString &relativePath) {
+        if (seen.contains(relativePath)) {
+            return;
+        }
+        seen.insert(relativePath);
+
+        Entry entry;
+        entry.localPath = info.absoluteFilePath();
+        entry.relativePath = relativePath;
+        entry.size = info.size();
+        entry.executable = info.isExecutable();
+        entry.sent = false;
+        entry.verified = false;
+        entries.append(entry);
+    };
+
+    for (const QString &path : paths) {
+        QFileInfo info(path);
+        if (!info.exists()) {
+            if (errorMessage) {
+                *errorMessage = QString("路径不存在: %1").arg(path);
+            }
+            return QList<Entry>();
+        }
+
+        if (info.isFile()) {
+            addFile(info, info.fileName());
+            continue;
+        }
+
+        // 目录保留自身名称作为远程路径的第一级，空目录不上传
+        QDir dir(info.absoluteFilePath());
+        QString base = info.fileName();
+        QDirIterator it(dir.absolutePath(), QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            QString relative = dir.relativeFilePath(it.filePath());
+            addFile(it.fileInfo(), base.isEmpty() ? relative : base + "/" + relative);
+        }
+    }
+
+    if (entries.isEmpty()) {
+        if (errorMessage) {
+            *errorMessage = "所选路径中没有可上传的文件";
+        }
+        return entries;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.relativePath < b.relativePath;
+    });
+    return entries;
+}
+
+QByteArray BatchUploader::ustarHeader(const Entry &entry, qint64 mtime)
+{
+    QByteArray header(TAR_BLOCK_SIZE, '\0');
+    QByteArray name;
+    QByteArray prefix;
+    splitUstarPath(entry.relativePath.toUtf8(), &name, &prefix);
+
+    memcpy(header.data(), name.constData(), name.size());
+    writeOctal(header, 100, 8, entry.executable ? 0755 : 0644);
+    writeOctal(header, 108, 8, 0);
+    writeOctal(header, 116, 8, 0);
+    writeOctal(header, 124, 12, entry.size);
+    writeOctal(header, 136, 12, qMax<qint64>(0, mtime));
+    header[156] = '0';
+    memcpy(header.data() + 257, "ustar", 6);
+    memcpy(header.data() + 263, "00", 2);
+    memcpy(header.data() + 345, prefix.constData(), prefix.size());
+
+    // 校验和按校验和字段为8个空格计算，写成6位八进制加 NUL 和空格
+    memset(header.data() + 148, ' ', 8);
+    unsigned int checksum = 0;
+    for (int i = 0; i < TAR_BLOCK_SIZE; ++i) {
+        checksum += static_cast<unsigned char>(header.at(i));
+    }
+    QByteArray digits = QByteArray::number(checksum, 8).rightJustified(6, '0');
+    memcpy(header.data() + 148, digits.constData(), 6);
+    header[154] = '\0';
+    header[155] = ' ';
+    return header;
+}
+
+void BatchUploader::setEntries(const QList<Entry> &entries)
+{
+    fileEntries = entries;
+}
+
+void BatchUploader::setRemoteTarget(const QString &host, int port, const QString &username, const QString &remoteDir)
+{
+    this->host = host;
+    this->port = port;
+    this->username = username;
+    remoteDirectory = remoteDir;
+}
+
+void BatchUploader::setSshOptions(const QStringList &options)
+{
+    sshOptions = options;
+}
+
+void BatchUploader::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+void BatchUploader::setStateDirectory(const QString &dirPath)
+{
+    stateDirectory = dirPath;
+}
+
+void BatchUploader::setDeltaEnabled(bool enabled)
+{
+    deltaEnabled = enabled;
+}
+
+void BatchUploader::setCompressionEnabled(bool enabled)
+{
+    compressionEnabled = enabled;
+}
+
+void BatchUploader::setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond)
+{
+    // tar 通道和大文件通道共用一个设备级限速器，整台设备的总速率不超过设定值
+    deviceLimiter->setUpstream(sharedLimiter);
+    deviceLimiter->setRate(deviceBytesPerSecond);
+}
+
+const QList<BatchUploader::Entry> &BatchUploader::entries() const
+{
+    return fileEntries;
+}
+
+qint64 BatchUploader::totalSize() const
+{
+    qint64 total = 0;
+    for (const Entry &entry : fileEntries) {
+        total += entry.size;
+    }
+    return total;
+}
+
+bool BatchUploader::isRunning() const
+{
+    // 出错后分块上传可能还在退出，等它结束再重新开始
+    return running || largeUploader->isRunning();
+}
+
+RetryPolicy::ErrorClass BatchUploader::lastErrorClass() const
+{
+    return errorClass;
+}
+
+void BatchUploader::start()
+{
+    if (isRunning()) {
+        return;
+    }
+
+    cancelRequested = false;
+    errorClass = RetryPolicy::ErrorNone;
+    tarQueue.clear();
+    largeQueue.clear();
+    largePosition = 0;
+    largeBytesSent = 0;
+
+    if (fileEntries.isEmpty()) {
+        errorClass = RetryPolicy::ErrorLocal;
+        emit finished(false, "没有要上传的文件");
+        return;
+    }
+
+    // 已发送完成的文件不再发送，重试时只补发剩余部分
+    int alreadySent = 0;
+    qint64 tarBytes = 0;
+    for (int i = 0; i < fileEntries.size(); ++i) {
+        const Entry &entry = fileEntries.at(i);
+        if (entry.sent) {
+            ++alreadySent;
+        } else if (fitsTarBatch(entry)) {
+            tarQueue.append(i);
+            tarBytes += entry.size;
+        } else {
+            largeQueue.append(i);
+        }
+    }
+
+    running = true;
+    emit logMessage(QString("[多文件上传] 共 %1 个文件 (%2 字节) 上传到 %3@%4:%5")
+                   .arg(fileEntries.size()).arg(totalSize()).arg(username).arg(host).arg(remoteDirectory));
+    if (alreadySent > 0) {
+        emit logMessage(QString("[多文件上传] %1 个文件已在上次尝试中发送，本次跳过").arg(alreadySent));
+    }
+    if (!tarQueue.isEmpty()) {
+        emit logMessage(QString("[多文件上传] %1 个小文件 (%2 字节) 打包为一个 tar 流发送")
+                       .arg(tarQueue.size()).arg(tarBytes));
+    }
+    if (!largeQueue.isEmpty()) {
+        emit logMessage(QString("[多文件上传] %1 个大文件逐个分块上传").arg(largeQueue.size()));
+    }
+    emitProgress();
+
+    // 两条流水线同时开始，都结束后再统一校验
+    startTarBatch();
+    startNextLargeFile();
+    maybeVerify();
+}
+
+void BatchUploader::cancel()
+{
+    if (!running) {
+        return;
+    }
+
+    cancelRequested = true;
+    if (tarProcess) {
+        tarProcess->kill();
+    }
+    if (verifyProcess) {
+        verifyProcess->kill();
+    }
+    if (largeUploader->isRunning()) {
+        largeUploader->cancel();
+    }
+}
+
+QStringList BatchUploader::buildSshArguments(const QString &remoteCommand) const
+{
+    QStringList arguments = SshUtils::commonArguments();
+    arguments << sshOptions;
+    arguments << "-p" << QString::number(port)
+              << QString("%1@%2").arg(username).arg(host)
+              << remoteCommand;
+    return arguments;
+}
+
+void BatchUploader::startTarBatch()
+{
+    if (!running || tarQueue.isEmpty()) {
+        return;
+    }
+
+    tarPosition = -1;
+    tarPending.clear();
+    tarFileRemaining = 0;
+    tarPayloadWritten = 0;
+    tarTrailerQueued = false;
+
+    limiterConsumer = deviceLimiter->attach();
+    tarProcess = new SshProcess(sshEnvironment, this);
+    connect(tarProcess, &SshProcess::readyWrite, this, &BatchUploader::onTarWritable);
+    connect(tarProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &BatchUploader::onTarFinished);
+    connect(tarProcess, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+
+    // tar 读到结束块后可能不再读取，随后用 cat 读尽剩余数据，避免本地写入时通道被提前关闭
+    QString remoteCommand = QString("d=%1; mkdir -p \"$d\" || exit 1; "
+                                    "tar -xf - -C \"$d\"; rc=$?; cat > /dev/null; exit $rc")
+                            .arg(SshUtils::shellQuote(remoteDirectory));
+    tarProcess->startSsh(buildSshArguments(remoteCommand));
+}
+
+void BatchUploader::onTarWritable()
+{
+    emitProgress();
+    feedTar();
+}
+
+bool BatchUploader::openNextTarEntry()
+{
+    ++tarPosition;
+    if (tarPosition >= tarQueue.size()) {
+        // 两个全零块表示归档结束
+        tarPending.append(QByteArray(2 * TAR_BLOCK_SIZE, '\0'));
+        tarTrailerQueued = true;
+        return true;
+    }
+
+    const Entry &entry = fileEntries.at(tarQueue.at(tarPosition));
+    tarFile.setFileName(entry.localPath);
+    if (!tarFile.open(QIODevice::ReadOnly)) {
+        finishWithError(QString("无法打开本地文件 %1: %2").arg(entry.localPath).arg(tarFile.errorString()));
+        return false;
+    }
+
+    tarHash.reset();
+    tarFileRemaining = entry.size;
+    qint64 mtime = QFileInfo(entry.localPath).lastModified().toMSecsSinceEpoch() / 1000;
+    tarPending.append(ustarHeader(entry, mtime));
+    return true;
+}
+
+void BatchUploader::finishTarEntry()
+{
+    Entry &entry = fileEntries[tarQueue.at(tarPosition)];
+    entry.md5 = QString(tarHash.result().toHex());
+    tarFile.close();
+
+    // 文件数据补齐到整块
+    int padding = static_cast<int>((TAR_BLOCK_SIZE - entry.size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE);
+    tarPending.append(QByteArray(padding, '\0'));
+}
+
+void BatchUploader::feedTar()
+{
+    if (!tarProcess) {
+        return;
+    }
+
+    // 头部和填充随文件数据一起写入，只有文件数据需要令牌
+    while (tarProcess->canWrite()) {
+        if (!tarPending.isEmpty()) {
+            tarProcess->write(tarPending);
+            tarPending.clear();
+            continue;
+        }
+
+        if (tarFile.isOpen()) {
+            if (tarFileRemaining > 0) {
+                qint64 sliceBytes = deviceLimiter->acquire(limiterConsumer, tarProcess->nextSlice(tarFileRemaining));
+                if (sliceBytes <= 0) {
+                    return;
+                }
+
+                QByteArray data = tarFile.read(sliceBytes);
+                if (data.isEmpty()) {
+                    finishWithError(QString("读取本地文件失败 %1: %2").arg(tarFile.fileName()).arg(tarFile.errorString()));
+                    return;
+                }
+
+                // 同一份读缓冲既发送又计入MD5，文件只读取一次
+                tarHash.addData(data);
+                tarProcess->write(data);
+                tarFileRemaining -= data.size();
+                tarPayloadWritten += data.size();
+                continue;
+            }
+
+            finishTarEntry();
+            continue;
+        }
+
+        if (tarTrailerQueued) {
+            break;
+        }
+        if (!openNextTarEntry()) {
+            return;
+        }
+    }
+
+    if (tarTrailerQueued && tarPending.isEmpty()) {
+        // 归档全部交给SSH后关闭写通道，让远程 tar 收到EOF
+        tarProcess->closeWriteChannelWhenDrained();
+    }
+}
+
+void BatchUploader::onTarFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelRequested) {
+        finishWithError("多文件上传已取消");
+        return;
+    }
+
+    QString error = QString::fromUtf8(tarProcess->readAllStandardError()).trimmed();
+    if (!tarTrailerQueued || !tarPending.isEmpty() || exitStatus != QProcess::NormalExit || exitCode != 0) {
+        // 归档未完整送达时整个批次下次重发，小文件重发的代价很小
+        RetryPolicy::ErrorClass failure = RetryPolicy::classify(exitCode, exitStatus, error);
+        if (failure == RetryPolicy::ErrorNone) {
+            failure = RetryPolicy::ErrorRemote;
+        }
+        finishWithError(error.isEmpty() ? QString("远程 tar 解包失败 (退出码: %1)").arg(exitCode) : error, failure);
+        return;
+    }
+
+    for (int index : tarQueue) {
+        fileEntries[index].sent = true;
+    }
+    emit logMessage(QString("[多文件上传] %1 个小文件已发送并解包").arg(tarQueue.size()));
+
+    if (limiterConsumer >= 0) {
+        deviceLimiter->detach(limiterConsumer);
+        limiterConsumer = -1;
+    }
+    tarProcess->disconnect(this);
+    tarProcess->deleteLater();
+    tarProcess = nullptr;
+    tarPayloadWritten = 0;
+
+    emitProgress();
+    maybeVerify();
+}
+
+void BatchUploader::startNextLargeFile()
+{
+    if (!running || largePosition >= largeQueue.size()) {
+        return;
+    }
+
+    const Entry &entry = fileEntries.at(largeQueue.at(largePosition));
+    largeBytesSent = 0;
+
+    // 设备级速率由本对象的限速器控制，分块上传自身不再单独限速
+    largeUploader->setLocalFile(entry.localPath);
+    largeUploader->setRemoteTarget(host, port, username, remoteJoin(remoteDirectory, entry.relativePath));
+    largeUploader->setSshOptions(sshOptions);
+    largeUploader->setSshEnvironment(sshEnvironment);
+    largeUploader->setStateDirectory(stateDirectory);
+    largeUploader->setExpectedMd5(entry.md5);
+    largeUploader->setDeltaEnabled(deltaEnabled);
+    largeUploader->setCompressionEnabled(compressionEnabled);
+    largeUploader->setRateLimit(deviceLimiter, 0);
+
+    emit logMessage(QString("[多文件上传] 大文件 %1/%2: %3")
+                   .arg(largePosition + 1).arg(largeQueue.size()).arg(entry.relativePath));
+    largeUploader->start();
+}
+
+void BatchUploader::onLargeFileProgress(qint64 bytesSent, qint64 totalBytes)
+{
+    Q_UNUSED(totalBytes);
+
+    largeBytesSent = bytesSent;
+    emitProgress();
+}
+
+void BatchUploader::onLargeFileFinished(bool success, const QString &errorMessage)
+{
+    if (!running) {
+        return;
+    }
+
+    if (!success) {
+        finishWithError(errorMessage, largeUploader->lastErrorClass());
+        return;
+    }
+
+    completeLargeFile();
+}
+
+void BatchUploader::completeLargeFile()
+{
+    // 跳过传输或多通道拼接后已在远程校验过的文件不必再进入清单
+    Entry &entry = fileEntries[largeQueue.at(largePosition)];
+    entry.sent = true;
+    entry.md5 = largeUploader->fileMd5();
+    entry.verified = largeUploader->skippedIdentical() || largeUploader->verifiedRemotely();
+
+    largeBytesSent = 0;
+    ++largePosition;
+    emitProgress();
+
+    startNextLargeFile();
+    maybeVerify();
+}
+
+void BatchUploader::maybeVerify()
+{
+    if (!running || tarProcess || verifyProcess || largeUploader->isRunning() || largePosition < largeQueue.size()) {
+        return;
+    }
+
+    verifyManifest.clear();
+    verifyManifest.setBaseDirectory(remoteDirectory);
+    verifyIndexes.clear();
+    for (int i = 0; i < fileEntries.size(); ++i) {
+        const Entry &entry = fileEntries.at(i);
+        if (entry.verified) {
+            continue;
+        }
+        verifyManifest.addFile(entry.relativePath, entry.md5);
+        verifyIndexes.append(i);
+    }
+
+    if (verifyManifest.isEmpty()) {
+        running = false;
+        emit progressChanged(totalSize(), totalSize());
+        emit logMessage(QString("[多文件上传] %1 个文件远程内容均已确认一致").arg(fileEntries.size()));
+        emit finished(true, QString());
+        return;
+    }
+
+    emit logMessage(QString("[多文件上传] 正在按清单校验 %1 个文件的MD5...").arg(verifyManifest.size()));
+    emit verificationStarted(verifyManifest.size());
+
+    // 文件很多时清单可能超出远程命令长度限制，改为从标准输入写入
+    verifyProcess = new SshProcess(sshEnvironment, this);
+    connect(verifyProcess, &QProcess::started, this, [this]() {
+        verifyProcess->write(verifyManifest.pathList());
+        verifyProcess->closeWriteChannel();
+    });
+    connect(verifyProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &BatchUploader::onVerifyFinished);
+    connect(verifyProcess, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+
+    verifyProcess->startSsh(buildSshArguments(verifyManifest.streamingCommand()));
+}
+
+void BatchUploader::onVerifyFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelRequested) {
+        finishWithError("多文件上传已取消");
+        return;
+    }
+
+    bool complete = verifyManifest.parseOutput(verifyProcess->readAllStandardOutput());
+    QString error = QString::fromUtf8(verifyProcess->readAllStandardError()).trimmed();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0 || !complete) {
+        RetryPolicy::ErrorClass failure = RetryPolicy::classify(exitCode, exitStatus, error);
+        if (failure == RetryPolicy::ErrorNone) {
+            failure = RetryPolicy::ErrorRemote;
+        }
+        finishWithError(error.isEmpty() ? QString("清单校验失败 (退出码: %1)").arg(exitCode) : error, failure);
+        return;
+    }
+
+    const QList<DigestManifest::Item> &items = verifyManifest.items();
+    int failedCount = 0;
+    for (int i = 0; i < items.size(); ++i) {
+        const DigestManifest::Item &item = items.at(i);
+        if (item.status == DigestManifest::StatusMatched) {
+            continue;
+        }
+
+        // 校验失败的文件标记为未发送，重试时重新上传
+        fileEntries[verifyIndexes.at(i)].sent = false;
+        if (++failedCount <= MAX_REPORTED_FAILURES) {
+            emit logMessage(item.status == DigestManifest::StatusMissing
+                            ? QString("[多文件上传] 远程文件不存在: %1").arg(item.path)
+                            : QString("[多文件上传] MD5校验失败: %1 (本地 %2，远程 %3)")
+                              .arg(item.path).arg(item.expected).arg(item.actual));
+        }
+    }
+    if (failedCount > 0) {
+        finishWithError(QString("%1 个文件MD5校验失败").arg(failedCount), RetryPolicy::ErrorRemote);
+        return;
+    }
+
+    for (Entry &entry : fileEntries) {
+        entry.verified = true;
+    }
+
+    verifyProcess->disconnect(this);
+    verifyProcess->deleteLater();
+    verifyProcess = nullptr;
+    running = false;
+
+    emit progressChanged(totalSize(), totalSize());
+    emit logMessage(QString("[多文件上传] %1 个文件全部上传并校验通过").arg(fileEntries.size()));
+    emit finished(true, QString());
+}
+
+void BatchUploader::emitProgress()
+{
+    qint64 sent = 0;
+    for (const Entry &entry : fileEntries) {
+        if (entry.sent) {
+            sent += entry.size;
+        }
+    }
+    if (tarProcess) {
+        sent += tarPayloadWritten;
+    }
+    sent += largeBytesSent;
+    emit progressChanged(sent, totalSize());
+}
+
+void BatchUploader::finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass)
+{
+    this->errorClass = errorClass;
+    running = false;
+    cleanup();
+
+    // 用户主动取消时界面已自行处理，这里只通知一次取消完成
+    if (cancelRequested) {
+        emit cancelled();
+        return;
+    }
+    emit finished(false, errorMessage);
+}
+
+void BatchUploader::cleanup()
+{
+    if (tarFile.isOpen()) {
+        tarFile.close();
+    }
+    if (limiterConsumer >= 0) {
+        deviceLimiter->detach(limiterConsumer);
+        limiterConsumer = -1;
+    }
+    if (tarProcess) {
+        tarProcess->disconnect(this);
+        if (tarProcess->state() != QProcess::NotRunning) {
+            tarProcess->kill();
+            tarProcess->waitForFinished(1000);
+        }
+        tarProcess->deleteLater();
+        tarProcess = nullptr;
+    }
+    if (verifyProcess) {
+        verifyProcess->disconnect(this);
+        if (verifyProcess->state() != QProcess::NotRunning) {
+            verifyProcess->kill();
+            verifyProcess->waitForFinished(1000);
+        }
+        verifyProcess->deleteLater();
+        verifyProcess = nullptr;
+    }
+    if (largeUploader->isRunning()) {
+        largeUploader->cancel();
+    }
+    largeBytesSent = 0;
+    tarPayloadWritten = 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * @File Name: batchuploader.h
+ * @brief  多文件/目录上传头文件，小文件打包成一个 tar 流发送，大文件逐个分块上传，最后按合并清单一次校验MD5
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef BATCHUPLOADER_H
+#define BATCHUPLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QCryptographicHash>
+#include "retrypolicy.h"
+#include "digestmanifest.h"
+
+class ChunkedUploader;
+class RateLimiter;
+class SshProcess;
+
+/**
+ * 一次上传多个文件（或整个目录）到同一个远程目录，所有SSH通道复用同一条主连接：
+ * - 小文件（不超过一个分块）依次编码为 ustar 条目，经一个SSH通道送入远程 tar -x，
+ *   不再为每个文件单独建立通道、探测和校验；发送时顺带计算每个文件的MD5
+ * - 大文件（以及路径超出 ustar 长度限制的文件）逐个交给 ChunkedUploader，支持断点续传和增量上传
+ * - 两条流水线同时进行，全部完成后用一个 DigestManifest 清单在一次远程调用中取回所有文件的MD5并逐个比对
+ * 失败后再次 start() 只重发未完成的部分：已完成的 tar 批次和大文件不再发送，大文件从远程已落盘的分块续传。
+ * 选择目录时保留目录名，远程路径为 <远程目录>/<目录名>/<相对路径>。
+ */
+class BatchUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Entry {
+        QString localPath;
+        QString relativePath;   // 相对远程目录的路径，以 / 分隔
+        qint64 size;
+        bool executable;
+        QString md5;
+        bool sent;              // 已发送完成
+        bool verified;          // 上传时已确认远程内容一致（跳过传输或多通道拼接后已校验），不再进入清单
+    };
+
+    explicit BatchUploader(QObject *parent = nullptr);
+    ~BatchUploader();
+
+    // 展开选择的文件和目录（递归），重名的相对路径只保留第一个
+    static QList<Entry> collectEntries(const QStringList &paths, QString *errorMessage);
+
+    // 生成一个普通文件的 ustar 头部（512字节）
+    static QByteArray ustarHeader(const Entry &entry, qint64 mtime);
+
+    void setEntries(const QList<Entry> &entries);
+    void setRemoteTarget(const QString &host, int port, const QString &username, const QString &remoteDir);
+    void setSshOptions(const QStringList &options);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setStateDirectory(const QString &dirPath);
+    void setDeltaEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+    void setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond);
+
+    const QList<Entry> &entries() const;
+    qint64 totalSize() const;
+    bool isRunning() const;
+    RetryPolicy::ErrorClass lastErrorClass() const;
+
+    void start();
+    void cancel();
+
+signals:
+    void logMessage(const QString &message);
+    void progressChanged(qint64 bytesSent, qint64 totalBytes);
+    void verificationStarted(int fileCount);   // 传输已结束，开始远程校验（不再有进度）
+    void preparing();                          // 大文件开始探测或计算增量，暂时没有进度
+    void finished(bool success, const QString &errorMessage);
+    void cancelled();
+
+private slots:
+    void onTarWritable();
+    void onTarFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void feedTar();
+    void onLargeFileFinished(bool success, const QString &errorMessage);
+    void onLargeFileProgress(qint64 bytesSent, qint64 totalBytes);
+    void onVerifyFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    QStringList buildSshArguments(const QString &remoteCommand) const;
+    bool openNextTarEntry();
+    void finishTarEntry();
+    void startTarBatch();
+    void startNextLargeFile();
+    void completeLargeFile();
+    void maybeVerify();
+    void emitProgress();
+    void finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass = RetryPolicy::ErrorLocal);
+    void cleanup();
+
+    // 参数
+    QList<Entry> fileEntries;
+    QString host;
+    int port;
+    QString username;
+    QString remoteDirectory;
+    QStringList sshOptions;
+    QProcessEnvironment sshEnvironment;
+    QString stateDirectory;
+    bool deltaEnabled;
+    bool compressionEnabled;
+
+    // 运行状态
+    bool running;
+    bool cancelRequested;
+    RetryPolicy::ErrorClass errorClass;
+
+    // tar 批次：小文件依次写入同一个通道
+    QList<int> tarQueue;
+    int tarPosition;            // tarQueue 中正在发送的条目
+    SshProcess *tarProcess;
+    QFile tarFile;
+    QCryptographicHash tarHash;
+    QByteArray tarPending;      // 已生成但还没写入通道的头部/填充数据
+    qint64 tarFileRemaining;
+    qint64 tarPayloadWritten;   // 已写入通道的文件数据（不含头部和填充）
+    bool tarTrailerQueued;
+    RateLimiter *deviceLimiter;
+    int limiterConsumer;
+
+    // 大文件：逐个分块上传
+    QList<int> largeQueue;
+    int largePosition;
+    ChunkedUploader *largeUploader;
+    qint64 largeBytesSent;
+
+    // 合并清单校验
+    SshProcess *verifyProcess;
+    DigestManifest verifyManifest;
+    QList<int> verifyIndexes;   // 清单条目对应的 fileEntries 下标
+};
+
+#endif // BATCHUPLOADER_H
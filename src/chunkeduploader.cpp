@@ -0,0 +1,949 @@
+/**
+ * @File Name: chunkeduploader.cpp
+ * @brief  分块断点续传上传引擎实现，通过SSH通道把文件分块写入远程dd，链路中断后从第一个缺失分块续传
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "chunkeduploader.h"
+#include "deltauploader.h"
+#include "multistreamuploader.h"
+#include "ratelimiter.h"
+#include "sharedchunksource.h"
+#include "sshprocess.h"
+#include "sshutils.h"
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QProcessEnvironment>
+#include <QTimer>
+
+const qint64 ChunkedUploader::DEFAULT_CHUNK_SIZE;
+
+// 续传前计算已落盘前缀MD5时每次事件循环读取的数据量
+static const qint64 HASH_SLICE_SIZE = 4 * 1024 * 1024;
+
+// 远程探测输出中各段之间的分隔标记：清单 / .part大小 / 目标文件大小及MD5 / 并行上传的分段文件
+static const char *PROBE_SIZE_MARKER = "@@PART_SIZE";
+static const char *PROBE_FINAL_MARKER = "@@FINAL";
+static const char *PROBE_RANGES_MARKER = "@@RANGES";
+static const char *PROBE_GZIP_MARKER = "@@GZIP";
+
+ChunkedUploader::ChunkedUploader(QObject *parent)
+    : QObject(parent), port(22), sshEnvironment(QProcessEnvironment::systemEnvironment()), chunkBytes(DEFAULT_CHUNK_SIZE), deltaEnabled(false),
+      compressionEnabled(false), streamCount(1), stage(StageIdle), process(nullptr),
+      totalBytes(0), lastModifiedMs(0), startOffset(0), writtenOffset(0), startChunk(0), cancelRequested(false),
+      md5Hash(QCryptographicHash::Md5), identicalSkipped(false), deltaUsed(false), remoteVerified(false), errorClass(RetryPolicy::ErrorNone),
+      deltaUploader(nullptr), multiStreamUploader(nullptr), deviceLimiter(nullptr), limiterConsumer(-1),
+      chunkSource(nullptr), sourceConsumer(-1), hashingLocally(true), remoteHasGzip(false), streamCompressed(false),
+      streamBytesQueued(0), acknowledgedOffset(0)
+{
+    deltaUploader = new DeltaUploader(this);
+    connect(deltaUploader, &DeltaUploader::logMessage, this, &ChunkedUploader::logMessage);
+    connect(deltaUploader, &DeltaUploader::progressChanged, this, &ChunkedUploader::progressChanged);
+    connect(deltaUploader, &DeltaUploader::finished, this, &ChunkedUploader::onDeltaFinished);
+    connect(deltaUploader, &DeltaUploader::notApplicable, this, &ChunkedUploader::onDeltaNotApplicable);
+
+    multiStreamUploader = new MultiStreamUploader(this);
+    connect(multiStreamUploader, &MultiStreamUploader::logMessage, this, &ChunkedUploader::logMessage);
+    connect(multiStreamUploader, &MultiStreamUploader::progressChanged, this, &ChunkedUploader::progressChanged);
+    connect(multiStreamUploader, &MultiStreamUploader::finished, this, &ChunkedUploader::onParallelFinished);
+
+    deviceLimiter = new RateLimiter(this);
+    connect(deviceLimiter, &RateLimiter::tokensAvailable, this, &ChunkedUploader::feedStream);
+}
+
+ChunkedUploader::~ChunkedUploader()
+{
+    releaseChunkSource();
+    cleanupProcess();
+}
+
+void ChunkedUploader::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+}
+
+void ChunkedUploader::setRemoteTarget(const QString &host, int port, const QString &username, const QString &remoteFilePath)
+{
+    this->host = host;
+    this->port = port;
+    this->username = username;
+    this->remoteFilePath = remoteFilePath;
+}
+
+void ChunkedUploader::setSshOptions(const QStringList &options)
+{
+    sshOptions = options;
+}
+
+void ChunkedUploader::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+void ChunkedUploader::setCompressionEnabled(bool enabled)
+{
+    compressionEnabled = enabled;
+}
+
+void ChunkedUploader::setStreamCount(int count)
+{
+    streamCount = qMax(1, count);
+}
+
+void ChunkedUploader::setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond)
+{
+    deviceLimiter->setUpstream(sharedLimiter);
+    deviceLimiter->setRate(deviceBytesPerSecond);
+}
+
+void ChunkedUploader::setChunkSize(qint64 bytes)
+{
+    if (bytes > 0) {
+        chunkBytes = bytes;
+    }
+}
+
+void ChunkedUploader::setStateDirectory(const QString &dirPath)
+{
+    stateDirectory = dirPath;
+}
+
+void ChunkedUploader::setExpectedMd5(const QString &md5)
+{
+    expectedMd5 = md5.trimmed().toLower();
+}
+
+void ChunkedUploader::setDeltaEnabled(bool enabled)
+{
+    deltaEnabled = enabled;
+}
+
+void ChunkedUploader::setChunkSource(SharedChunkSource *source)
+{
+    if (stage == StageIdle) {
+        chunkSource = source;
+    }
+}
+
+QString ChunkedUploader::localFile() const
+{
+    return localFilePath;
+}
+
+QString ChunkedUploader::remoteFile() const
+{
+    return remoteFilePath;
+}
+
+qint64 ChunkedUploader::chunkSize() const
+{
+    return chunkBytes;
+}
+
+qint64 ChunkedUploader::fileSize() const
+{
+    return totalBytes;
+}
+
+int ChunkedUploader::chunkCount() const
+{
+    if (totalBytes <= 0) {
+        return 0;
+    }
+    return static_cast<int>((totalBytes + chunkBytes - 1) / chunkBytes);
+}
+
+int ChunkedUploader::resumedChunks() const
+{
+    return startChunk;
+}
+
+bool ChunkedUploader::isRunning() const
+{
+    return stage != StageIdle;
+}
+
+QString ChunkedUploader::fileMd5() const
+{
+    return md5Hex;
+}
+
+bool ChunkedUploader::skippedIdentical() const
+{
+    return identicalSkipped;
+}
+
+bool ChunkedUploader::usedDelta() const
+{
+    return deltaUsed;
+}
+
+bool ChunkedUploader::verifiedRemotely() const
+{
+    return remoteVerified;
+}
+
+RetryPolicy::ErrorClass ChunkedUploader::lastErrorClass() const
+{
+    return errorClass;
+}
+
+void ChunkedUploader::start()
+{
+    if (stage != StageIdle) {
+        return;
+    }
+
+    QFileInfo fileInfo(localFilePath);
+    if (!fileInfo.exists() || !fileInfo.isFile()) {
+        errorClass = RetryPolicy::ErrorLocal;
+        emit finished(false, QString("本地文件不存在: %1").arg(localFilePath));
+        return;
+    }
+
+    totalBytes = fileInfo.size();
+    lastModifiedMs = fileInfo.lastModified().toMSecsSinceEpoch();
+    startChunk = 0;
+    startOffset = 0;
+    writtenOffset = 0;
+    cancelRequested = false;
+    md5Hash.reset();
+    md5Hex.clear();
+    identicalSkipped = false;
+    deltaUsed = false;
+    remoteVerified = false;
+    errorClass = RetryPolicy::ErrorNone;
+    remoteHasGzip = false;
+    remoteRanges.clear();
+
+    emit logMessage(QString("[分块上传] 文件大小 %1 字节，分块大小 %2 KB，共 %3 块")
+                   .arg(totalBytes).arg(chunkBytes / 1024).arg(chunkCount()));
+
+    // 第一步：探测远程已落盘的分块
+    stage = StageProbing;
+    emit preparing();
+    process = new SshProcess(sshEnvironment, this);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ChunkedUploader::onProbeFinished);
+    connect(process, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+
+    QString probeCommand = QString("cat %1 2>/dev/null; echo '%2'; wc -c < %3 2>/dev/null || echo 0")
+                          .arg(SshUtils::shellQuote(remoteManifestFile()))
+                          .arg(PROBE_SIZE_MARKER)
+                          .arg(SshUtils::shellQuote(remotePartFile()));
+
+    // 顺带读取目标文件大小（增量上传的基准）；已知本地MD5且大小一致时计算远程MD5
+    QString finalFile = SshUtils::shellQuote(remoteFilePath);
+    probeCommand += QString("; echo '%1'; s=$(wc -c < %2 2>/dev/null); echo \"${s:-0}\"")
+                   .arg(PROBE_FINAL_MARKER)
+                   .arg(finalFile);
+    if (!expectedMd5.isEmpty()) {
+        probeCommand += QString("; if [ \"${s:-0}\" -eq %1 ] 2>/dev/null; then md5sum %2 2>/dev/null; fi")
+                       .arg(totalBytes)
+                       .arg(finalFile);
+    }
+    // 并行上传中断后残留的分段文件：每个输出 "<起始分块>-<结束分块> <大小>"
+    probeCommand += QString("; echo '%1'; for f in %2.r*; do [ -f \"$f\" ] && echo \"${f##*.r} $(wc -c < \"$f\")\"; done; true")
+                   .arg(PROBE_RANGES_MARKER)
+                   .arg(SshUtils::shellQuote(remotePartFile()));
+    if (compressionEnabled) {
+        // 用 if 包裹：设备没有 gzip 时整条探测命令的退出码仍为 0，不会被当作探测失败
+        probeCommand += QString("; if command -v gzip >/dev/null 2>&1; then echo '%1'; fi").arg(PROBE_GZIP_MARKER);
+    }
+
+    emit logMessage("[分块上传] 正在检查远程已上传的分块...");
+    process->startSsh(buildSshArguments(probeCommand));
+}
+
+void ChunkedUploader::cancel()
+{
+    if (stage == StageIdle) {
+        return;
+    }
+
+    cancelRequested = true;
+    if (stage == StageDelta) {
+        deltaUploader->cancel();
+    } else if (stage == StageParallel) {
+        multiStreamUploader->cancel();
+    } else if (process) {
+        process->kill();
+    }
+}
+
+void ChunkedUploader::onProbeFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    int landedChunks = 0;
+    qint64 remoteFinalSize = 0;
+
+    ProbeResult probe = parseProbeOutput(QString::fromUtf8(process->readAllStandardOutput()));
+    if (exitStatus != QProcess::NormalExit || exitCode != 0 || !probe.hasPart) {
+        // 探测失败时不知道远程已落盘多少，不能当作没有进度从头覆盖；保留本地清单，由调用方按类别决定是否重试
+        QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        RetryPolicy::ErrorClass failure = RetryPolicy::classify(exitCode, exitStatus, error, process->error());
+        if (failure == RetryPolicy::ErrorNone) {
+            failure = RetryPolicy::ErrorRemote;
+        }
+        finishWithError(QString("无法读取远程分块清单: %1")
+                        .arg(error.isEmpty() ? QString("退出码 %1").arg(exitCode) : error),
+                        failure);
+        return;
+    }
+
+    remoteHasGzip = probe.hasGzip;
+
+    if (probe.hasFinal) {
+        if (isRemoteIdentical(probe, totalBytes, expectedMd5)) {
+            process->deleteLater();
+            process = nullptr;
+            finishIdentical();
+            return;
+        }
+        remoteFinalSize = probe.finalSize;
+    }
+
+    if (probe.hasPart) {
+        const QString &remoteIdentity = probe.identity;
+        if (remoteIdentity == sourceIdentity()) {
+            // 分段文件只有与清单属于同一源文件时才可复用
+            remoteRanges = MultiStreamUploader::parseRemoteRanges(probe.rangesSection, totalBytes, chunkBytes);
+        }
+
+        if (remoteIdentity == sourceIdentity() && probe.partSize > 0) {
+            // 远程清单与当前源文件一致，按 .part 大小计算完整落盘的分块数
+            int remoteChunks = static_cast<int>(qMin(probe.partSize, totalBytes) / chunkBytes);
+            int localChunks = loadLocalManifest();
+
+            landedChunks = remoteChunks;
+            if (localChunks >= 0 && localChunks != remoteChunks) {
+                emit logMessage(QString("[分块上传] 本地清单记录 %1 块，远程实际落盘 %2 块，以远程为准")
+                               .arg(localChunks).arg(remoteChunks));
+            }
+        } else if (!remoteIdentity.isEmpty()) {
+            emit logMessage("[分块上传] 远程残留的分块属于其他版本的文件，将重新上传");
+        }
+    }
+
+    process->deleteLater();
+    process = nullptr;
+
+    if (!remoteRanges.isEmpty()) {
+        // 第0段（.part）不会超出第1段的起点
+        landedChunks = static_cast<int>(qMin(static_cast<qint64>(landedChunks) * chunkBytes,
+                                             remoteRanges.first().begin) / chunkBytes);
+        emit logMessage(QString("[分块上传] 检测到上次并行上传的 %1 个分段，按原分段继续上传")
+                       .arg(remoteRanges.size() + 1));
+    } else if (landedChunks > 0) {
+        emit logMessage(QString("[分块上传] 检测到已上传 %1/%2 块，从第 %3 块继续上传")
+                       .arg(landedChunks).arg(chunkCount()).arg(landedChunks + 1));
+    } else if (deltaEnabled && remoteFinalSize > 0) {
+        // 没有可续传的分块，但远程已有旧版本：尝试只发送差异块
+        stage = StageDelta;
+        emit preparing();
+        deltaUploader->setLocalFile(localFilePath);
+        deltaUploader->setRemoteFile(remoteFilePath);
+        deltaUploader->setSshConnectionArguments(sshConnectionArguments());
+        deltaUploader->setSshEnvironment(sshEnvironment);
+        deltaUploader->start(remoteFinalSize);
+        return;
+    }
+
+    saveLocalManifest(landedChunks);
+    startStream(landedChunks);
+}
+
+ChunkedUploader::ProbeResult ChunkedUploader::parseProbeOutput(const QString &text)
+{
+    // 格式："[清单]@@PART_SIZE\n大小\n@@FINAL\n大小\n[MD5  文件名]\n@@RANGES\n[分段列表]\n[@@GZIP]"
+    ProbeResult probe;
+    probe.hasPart = false;
+    probe.partSize = 0;
+    probe.hasFinal = false;
+    probe.finalSize = 0;
+    probe.hasGzip = false;
+
+    QString output = text;
+    int gzipIndex = output.indexOf(PROBE_GZIP_MARKER);
+    if (gzipIndex >= 0) {
+        probe.hasGzip = true;
+        output = output.left(gzipIndex);
+    }
+    int rangesIndex = output.indexOf(PROBE_RANGES_MARKER);
+    if (rangesIndex >= 0) {
+        probe.rangesSection = output.mid(rangesIndex + QString(PROBE_RANGES_MARKER).length());
+        output = output.left(rangesIndex);
+    }
+    int markerIndex = output.indexOf(PROBE_SIZE_MARKER);
+    int finalIndex = output.indexOf(PROBE_FINAL_MARKER);
+
+    if (finalIndex >= 0) {
+        probe.hasFinal = true;
+        QStringList lines = output.mid(finalIndex + QString(PROBE_FINAL_MARKER).length())
+                                  .trimmed().split('\n', QString::SkipEmptyParts);
+        if (!lines.isEmpty()) {
+            probe.finalSize = lines[0].trimmed().toLongLong();
+        }
+        if (lines.size() >= 2) {
+            QStringList parts = lines[1].trimmed().split(' ', QString::SkipEmptyParts);
+            if (!parts.isEmpty()) {
+                probe.finalMd5 = parts[0].toLower();
+            }
+        }
+    }
+
+    if (markerIndex >= 0) {
+        probe.hasPart = true;
+        probe.identity = output.left(markerIndex).trimmed();
+        int sizeLength = (finalIndex > markerIndex ? finalIndex : output.length()) - markerIndex
+                         - QString(PROBE_SIZE_MARKER).length();
+        probe.partSize = output.mid(markerIndex + QString(PROBE_SIZE_MARKER).length(), sizeLength).trimmed().toLongLong();
+    }
+    return probe;
+}
+
+bool ChunkedUploader::isRemoteIdentical(const ProbeResult &probe, qint64 size, const QString &md5)
+{
+    return probe.hasFinal && !md5.isEmpty() && !probe.finalMd5.isEmpty()
+           && probe.finalSize == size && probe.finalMd5 == md5.toLower();
+}
+
+void ChunkedUploader::finishIdentical()
+{
+    emit logMessage(QString("[分块上传] 远程已存在相同文件 (大小 %1 字节，MD5 %2)，跳过传输")
+                   .arg(totalBytes).arg(expectedMd5));
+
+    md5Hex = expectedMd5;
+    identicalSkipped = true;
+    stage = StageIdle;
+    removeLocalManifest();
+
+    emit progressChanged(totalBytes, totalBytes);
+    emit finished(true, QString());
+}
+
+void ChunkedUploader::onDeltaFinished(bool success, const QString &errorMessage)
+{
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    if (success) {
+        md5Hex = deltaUploader->fileMd5();
+        deltaUsed = true;
+        removeLocalManifest();
+        stage = StageIdle;
+        emit finished(true, QString());
+        return;
+    }
+
+    // 增量上传失败时旧文件保持不变，改为完整上传
+    emit logMessage(QString("[增量上传] 失败: %1，改为完整上传").arg(errorMessage));
+    saveLocalManifest(0);
+    startStream(0);
+}
+
+void ChunkedUploader::onDeltaNotApplicable(const QString &reason)
+{
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    emit logMessage(QString("[增量上传] %1，改为完整上传").arg(reason));
+    saveLocalManifest(0);
+    startStream(0);
+}
+
+void ChunkedUploader::startStream(int firstChunk)
+{
+    startChunk = firstChunk;
+    startOffset = qMin(static_cast<qint64>(firstChunk) * chunkBytes, totalBytes);
+    writtenOffset = startOffset;
+    hashingLocally = true;
+
+    // 批量上传时各设备已经并行，共享数据源只按顺序读取，不再拆分通道；上次的分段未完成时沿用原分段
+    if (!chunkSource && (!remoteRanges.isEmpty()
+                         || MultiStreamUploader::usableStreams(totalBytes - startOffset, chunkBytes, streamCount) > 1)) {
+        startParallel();
+        return;
+    }
+
+    if (chunkSource) {
+        sourceConsumer = chunkSource->attach(startOffset);
+        if (sourceConsumer >= 0) {
+            // 数据和MD5都来自共享数据源，不再单独读盘计算前缀
+            hashingLocally = false;
+            connect(chunkSource, &SharedChunkSource::dataAvailable, this, &ChunkedUploader::feedStream);
+            launchStream();
+            return;
+        }
+    }
+
+    sourceFile.setFileName(localFilePath);
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        finishWithError(QString("无法打开本地文件: %1").arg(sourceFile.errorString()));
+        return;
+    }
+
+    if (startOffset > 0) {
+        // 已落盘的前缀不再发送，但仍需计入MD5，分段读取以保持界面响应
+        stage = StageHashingPrefix;
+        emit preparing();
+        emit logMessage(QString("[分块上传] 正在计算已上传部分的MD5 (%1 字节)...").arg(startOffset));
+        QTimer::singleShot(0, this, &ChunkedUploader::hashPrefixSlice);
+        return;
+    }
+
+    launchStream();
+}
+
+void ChunkedUploader::startParallel()
+{
+    stage = StageParallel;
+    multiStreamUploader->setLocalFile(localFilePath);
+    multiStreamUploader->setRemoteFile(remoteFilePath);
+    multiStreamUploader->setSshConnectionArguments(sshConnectionArguments());
+    multiStreamUploader->setSshEnvironment(sshEnvironment);
+    multiStreamUploader->setChunkSize(chunkBytes);
+    multiStreamUploader->setCompressed(compressionEnabled && remoteHasGzip);
+    multiStreamUploader->setRateLimiter(deviceLimiter);
+    multiStreamUploader->setExpectedMd5(expectedMd5);
+
+    QList<MultiStreamUploader::Range> ranges;
+    if (remoteRanges.isEmpty()) {
+        ranges = MultiStreamUploader::splitRanges(startOffset, totalBytes, chunkBytes, streamCount);
+    } else {
+        MultiStreamUploader::Range first = { 0, remoteRanges.first().begin, startOffset };
+        ranges << first << remoteRanges;
+    }
+    saveLocalManifest(startChunk, ranges);
+    multiStreamUploader->start(ranges, sourceIdentity());
+}
+
+void ChunkedUploader::onParallelFinished(bool success, const QString &errorMessage)
+{
+    if (cancelRequested) {
+        saveLocalManifest(static_cast<int>(multiStreamUploader->resumableOffset() / chunkBytes),
+                          multiStreamUploader->resumableRanges());
+        finishWithError("上传已取消");
+        return;
+    }
+
+    if (success) {
+        md5Hex = multiStreamUploader->fileMd5();
+        remoteVerified = true;
+        removeLocalManifest();
+        stage = StageIdle;
+        emit finished(true, QString());
+        return;
+    }
+
+    // 各段都留在远程，下次探测到分段文件后按原分段续传
+    saveLocalManifest(static_cast<int>(multiStreamUploader->resumableOffset() / chunkBytes),
+                      multiStreamUploader->resumableRanges());
+    finishWithError(errorMessage, multiStreamUploader->lastErrorClass());
+}
+
+void ChunkedUploader::hashPrefixSlice()
+{
+    if (stage != StageHashingPrefix) {
+        return;
+    }
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    qint64 remaining = startOffset - sourceFile.pos();
+    if (remaining > 0) {
+        QByteArray data = sourceFile.read(qMin(HASH_SLICE_SIZE, remaining));
+        if (data.isEmpty()) {
+            finishWithError(QString("读取本地文件失败: %1").arg(sourceFile.errorString()));
+            return;
+        }
+        md5Hash.addData(data);
+        QTimer::singleShot(0, this, &ChunkedUploader::hashPrefixSlice);
+        return;
+    }
+
+    // 文件位置正好停在续传起点，接着发送剩余数据
+    launchStream();
+}
+
+void ChunkedUploader::launchStream()
+{
+    // 只有探测到远程 gzip 时才压缩传输
+    streamCompressed = compressionEnabled && remoteHasGzip;
+    compressor.reset();
+    streamBytesQueued = 0;
+    pendingMembers.clear();
+    acknowledgedOffset = writtenOffset;
+    limiterConsumer = deviceLimiter->attach();
+
+    QString remoteDir = QFileInfo(remoteFilePath).path();
+    QString part = SshUtils::shellQuote(remotePartFile());
+
+    // 从头上传时先清除残留的 .part，续传时 seek 到第一个缺失分块覆盖写入
+    QString remoteCommand = QString("mkdir -p %1 && ").arg(SshUtils::shellQuote(remoteDir));
+    if (startChunk == 0) {
+        remoteCommand += QString("rm -f %1 && ").arg(part);
+    }
+    remoteCommand += QString("printf '%s\\n' %1 > %2 && %8"
+                             "dd of=%3 bs=%4 seek=%5 conv=notrunc 2>/dev/null && "
+                             "[ $(wc -c < %3) -eq %6 ] && "
+                             "mv -f %3 %7 && rm -f %2 %3.r*")
+                    .arg(SshUtils::shellQuote(sourceIdentity()))
+                    .arg(SshUtils::shellQuote(remoteManifestFile()))
+                    .arg(part)
+                    .arg(chunkBytes)
+                    .arg(startChunk)
+                    .arg(totalBytes)
+                    .arg(SshUtils::shellQuote(remoteFilePath))
+                    .arg(streamCompressed ? "gzip -dc | " : "");
+
+    stage = StageStreaming;
+    process = new SshProcess(sshEnvironment, this);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ChunkedUploader::onStreamFinished);
+    connect(process, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+    connect(process, &SshProcess::readyWrite, this, &ChunkedUploader::onStreamWritable);
+
+    emit logMessage(QString("[分块上传] 开始传输，剩余 %1 字节").arg(totalBytes - startOffset));
+    if (deviceLimiter->isLimiting()) {
+        emit logMessage("[分块上传] 当前处于限速时段，按设定速率发送");
+    }
+    if (streamCompressed) {
+        emit logMessage("[分块上传] 启用传输压缩，压缩级别随链路速度自动调整");
+    } else if (compressionEnabled) {
+        emit logMessage("[分块上传] 远程没有 gzip，不压缩传输");
+    }
+    emit progressChanged(startOffset, totalBytes);
+
+    process->startSsh(buildSshArguments(remoteCommand));
+}
+
+void ChunkedUploader::onStreamWritable()
+{
+    if (!process) {
+        return;
+    }
+
+    emit progressChanged(updateSentOffset(), totalBytes);
+    feedStream();
+}
+
+void ChunkedUploader::feedStream()
+{
+    if (!process || stage != StageStreaming || process->state() != QProcess::Running) {
+        return;
+    }
+
+    // 保持通道缓冲区中只有少量待发送数据，避免整块文件读入内存
+    qint64 sliceBytes;
+    while ((sliceBytes = process->nextSlice(totalBytes - writtenOffset)) > 0) {
+        // 先取得限速令牌，令牌不足时等限速器通知后继续
+        sliceBytes = deviceLimiter->acquire(limiterConsumer, sliceBytes);
+        if (sliceBytes <= 0) {
+            return;
+        }
+
+        QByteArray data;
+        if (sourceConsumer >= 0) {
+            SharedChunkSource::ReadStatus status;
+            data = chunkSource->read(sourceConsumer, writtenOffset, sliceBytes, &status);
+            if (status != SharedChunkSource::ReadOk) {
+                deviceLimiter->release(sliceBytes);
+            }
+            if (status == SharedChunkSource::ReadWait) {
+                // 其他设备占满了共享窗口，等数据源通知后继续
+                return;
+            }
+            if (status == SharedChunkSource::ReadFallback) {
+                if (!switchToPrivateRead()) {
+                    process->kill();
+                    return;
+                }
+                continue;
+            }
+        } else {
+            data = sourceFile.read(sliceBytes);
+        }
+
+        if (data.isEmpty()) {
+            emit logMessage(QString("[错误] 读取本地文件失败: %1").arg(sourceFile.errorString()));
+            process->kill();
+            return;
+        }
+
+        // 同一份读缓冲既发送又计入MD5，文件只读取一次
+        if (hashingLocally) {
+            md5Hash.addData(data);
+        }
+        writtenOffset += data.size();
+        if (streamCompressed) {
+            QByteArray member = compressor.compress(data);
+            process->write(member);
+            deviceLimiter->release(data.size() - member.size());  // 限速按实际发送的压缩数据计算
+            streamBytesQueued += member.size();
+            pendingMembers.append(qMakePair(streamBytesQueued, writtenOffset));
+        } else {
+            process->write(data);
+        }
+    }
+
+    if (writtenOffset >= totalBytes) {
+        // 所有数据交给SSH后关闭写通道，让远程dd收到EOF
+        process->closeWriteChannelWhenDrained();
+    }
+}
+
+qint64 ChunkedUploader::updateSentOffset()
+{
+    if (!process) {
+        return acknowledgedOffset;
+    }
+    if (!streamCompressed) {
+        return writtenOffset - process->bytesToWrite();
+    }
+
+    // 压缩数据按成员换算：通道已取走整个成员时，对应的原始数据才算已发送
+    qint64 drained = streamBytesQueued - process->bytesToWrite();
+    while (!pendingMembers.isEmpty() && pendingMembers.first().first <= drained) {
+        acknowledgedOffset = pendingMembers.takeFirst().second;
+    }
+    return acknowledgedOffset;
+}
+
+bool ChunkedUploader::switchToPrivateRead()
+{
+    releaseChunkSource();
+
+    sourceFile.setFileName(localFilePath);
+    if (!sourceFile.open(QIODevice::ReadOnly) || !sourceFile.seek(writtenOffset)) {
+        emit logMessage(QString("[错误] 无法打开本地文件: %1").arg(sourceFile.errorString()));
+        return false;
+    }
+
+    emit logMessage(QString("[分块上传] 从 %1 字节处改为单独读取本地文件").arg(writtenOffset));
+    return true;
+}
+
+void ChunkedUploader::releaseChunkSource()
+{
+    if (chunkSource && sourceConsumer >= 0) {
+        disconnect(chunkSource, &SharedChunkSource::dataAvailable, this, &ChunkedUploader::feedStream);
+        chunkSource->detach(sourceConsumer);
+    }
+    sourceConsumer = -1;
+}
+
+void ChunkedUploader::onStreamFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    sourceFile.close();
+    releaseChunkSource();
+
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        if (hashingLocally) {
+            md5Hex = QString(md5Hash.result().toHex());
+        } else if (chunkSource) {
+            // 共享数据源的MD5可能还在计算，由调用方等待 SharedChunkSource::md5Ready
+            md5Hex = chunkSource->fileMd5();
+        }
+        emit progressChanged(totalBytes, totalBytes);
+        emit logMessage(QString("[分块上传] 全部 %1 块已写入远程文件").arg(chunkCount()));
+        if (streamCompressed && compressor.inputBytes() > 0) {
+            emit logMessage(QString("[分块上传] 传输压缩: 原始 %1 字节，实际发送 %2 字节 (%3%)，最终压缩级别 %4")
+                           .arg(compressor.inputBytes())
+                           .arg(compressor.outputBytes())
+                           .arg(compressor.ratio() * 100, 0, 'f', 1)
+                           .arg(compressor.level()));
+        }
+        removeLocalManifest();
+
+        cleanupProcess();
+        stage = StageIdle;
+        emit finished(true, QString());
+        return;
+    }
+
+    QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+    RetryPolicy::ErrorClass failure = RetryPolicy::classify(exitCode, exitStatus, error);
+
+    // 记录本次至少已交给SSH的完整分块数，远程实际落盘情况在下次续传时重新探测
+    qint64 sentBytes = updateSentOffset();
+    saveLocalManifest(static_cast<int>(sentBytes / chunkBytes));
+
+    if (error.isEmpty()) {
+        error = QString("SSH传输通道异常退出 (退出码: %1)").arg(exitCode);
+    }
+    finishWithError(error, failure);
+}
+
+void ChunkedUploader::finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass)
+{
+    this->errorClass = errorClass;
+    if (sourceFile.isOpen()) {
+        sourceFile.close();
+    }
+    releaseChunkSource();
+    cleanupProcess();
+    stage = StageIdle;
+
+    // 用户主动取消时界面已自行处理，这里只通知一次取消完成
+    if (cancelRequested) {
+        emit cancelled();
+        return;
+    }
+    emit finished(false, errorMessage);
+}
+
+void ChunkedUploader::cleanupProcess()
+{
+    if (limiterConsumer >= 0) {
+        deviceLimiter->detach(limiterConsumer);
+        limiterConsumer = -1;
+    }
+    if (process) {
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+        process->deleteLater();
+        process = nullptr;
+    }
+}
+
+QStringList ChunkedUploader::buildSshArguments(const QString &remoteCommand) const
+{
+    QStringList arguments = sshConnectionArguments();
+    arguments << remoteCommand;
+    return arguments;
+}
+
+QStringList ChunkedUploader::sshConnectionArguments() const
+{
+    // 保活探测及时发现断开的链路，便于尽快续传
+    QStringList arguments = SshUtils::commonArguments();
+    arguments << sshOptions;
+    arguments << "-p" << QString::number(port)
+              << QString("%1@%2").arg(username).arg(host);
+    return arguments;
+}
+
+QString ChunkedUploader::remotePartFile() const
+{
+    return remoteFilePath + ".part";
+}
+
+QString ChunkedUploader::remoteManifestFile() const
+{
+    return remoteFilePath + ".part.manifest";
+}
+
+QString ChunkedUploader::sourceIdentity() const
+{
+    // 文件名、大小、修改时间和分块大小共同决定分块能否复用
+    return QString("%1:%2:%3:%4")
+           .arg(QFileInfo(localFilePath).fileName())
+           .arg(totalBytes)
+           .arg(lastModifiedMs)
+           .arg(chunkBytes);
+}
+
+QString ChunkedUploader::localManifestPath() const
+{
+    QString key = QString("%1@%2:%3:%4").arg(username).arg(host).arg(port).arg(remoteFilePath);
+    QString hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex();
+    return QDir(stateDirectory).absoluteFilePath(hash + ".json");
+}
+
+int ChunkedUploader::loadLocalManifest() const
+{
+    if (stateDirectory.isEmpty()) {
+        return -1;
+    }
+
+    QFile file(localManifestPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+
+    QJsonObject manifest = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    if (manifest.value("identity").toString() != sourceIdentity()) {
+        return -1;
+    }
+    return manifest.value("completedChunks").toInt(-1);
+}
+
+void ChunkedUploader::saveLocalManifest(int completedChunks, const QList<MultiStreamUploader::Range> &ranges)
+{
+    if (stateDirectory.isEmpty()) {
+        return;
+    }
+
+    QDir dir(stateDirectory);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+
+    QJsonObject manifest;
+    manifest["identity"] = sourceIdentity();
+    manifest["localFile"] = localFilePath;
+    manifest["remoteFile"] = QString("%1@%2:%3").arg(username).arg(host).arg(remoteFilePath);
+    manifest["fileSize"] = QString::number(totalBytes);
+    manifest["chunkSize"] = QString::number(chunkBytes);
+    manifest["chunkCount"] = chunkCount();
+    manifest["completedChunks"] = completedChunks;
+    if (!ranges.isEmpty()) {
+        // 并行上传的各段位置，与远程 .part.r* 分段文件一一对应
+        QJsonArray rangeArray;
+        for (const MultiStreamUploader::Range &range : ranges) {
+            QJsonObject item;
+            item["begin"] = QString::number(range.begin);
+            item["end"] = QString::number(range.end);
+            item["landed"] = QString::number(range.landed);
+            rangeArray.append(item);
+        }
+        manifest["ranges"] = rangeArray;
+    }
+    manifest["updateTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    QFile file(localManifestPath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(manifest).toJson());
+        file.close();
+    }
+}
+
+void ChunkedUploader::removeLocalManifest()
+{
+    if (!stateDirectory.isEmpty()) {
+        QFile::remove(localManifestPath());
+    }
+}
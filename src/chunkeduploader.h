@@ -0,0 +1,212 @@
+/**
+ * @File Name: chunkeduploader.h
+ * @brief  分块断点续传上传引擎头文件，按固定大小分块通过SSH通道写入远程文件
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef CHUNKEDUPLOADER_H
+#define CHUNKEDUPLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QCryptographicHash>
+#include <QList>
+#include <QPair>
+#include "streamcompressor.h"
+#include "multistreamuploader.h"
+#include "retrypolicy.h"
+
+class DeltaUploader;
+class RateLimiter;
+class SharedChunkSource;
+class SshProcess;
+
+/**
+ * 上传流程：
+ * 1. 探测：读取远程 <文件>.part.manifest 和 <文件>.part 的大小，结合本地清单确定已落盘的分块；
+ *    若已知本地MD5且远程目标文件大小一致，同时取回远程MD5，完全相同时直接跳过传输；
+ *    没有可续传的分块但远程已有旧版本时，启用增量模式交给 DeltaUploader 只发送差异块
+ * 2. 续传：通过一个SSH通道把剩余分块写入远程 dd（seek 到第一个缺失分块）
+ * 3. 完成：远程校验 .part 大小后重命名为目标文件，并删除远程清单
+ *
+ * 远程 dd 按顺序写入，所以 .part 的大小 / 分块大小 即为完整落盘的分块数。
+ * 本地清单保存在 upload_state 目录下，记录源文件标识和已确认的分块数。
+ *
+ * 本地MD5在发送的同时由同一份读缓冲计算，整个文件只从磁盘读取一次；
+ * 续传时已落盘的前缀在开始传输前分段读取并计入MD5，不阻塞界面。
+ *
+ * 设置了共享数据源（批量上传）时，发送的数据从 SharedChunkSource 取得，文件MD5也由数据源计算；
+ * 数据源要求改为自行读盘时，从当前位置打开本地文件继续发送。
+ *
+ * 启用传输压缩且远程有 gzip 时，每片数据编码为gzip成员发送，远程 gzip -dc 解压后再交给 dd，
+ * 压缩级别由 StreamCompressor 根据链路和CPU的繁忙程度自动调整；进度按已被通道取走的完整成员换算为原始字节数。
+ *
+ * 设置了多个传输通道且剩余数据足够分段时，续传阶段交给 MultiStreamUploader 经多个SSH通道并行发送，
+ * 远程拼接后已校验整文件MD5（verifiedRemotely() 返回 true）。探测同时列出远程的 .part.r* 分段文件，
+ * 上次并行上传中断时按原来的分段继续，各段从自己的落盘位置续传；本地清单也记录各段位置。
+ *
+ * 每个上传有一个设备级限速器，上级为调用方传入的全局限速器，发送的每片数据先取得两级令牌（见 RateLimiter）。
+ */
+class ChunkedUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChunkedUploader(QObject *parent = nullptr);
+    ~ChunkedUploader();
+
+    // 上传参数
+    void setLocalFile(const QString &filePath);
+    void setRemoteTarget(const QString &host, int port, const QString &username, const QString &remoteFilePath);
+    void setSshOptions(const QStringList &options);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setChunkSize(qint64 bytes);
+    void setStateDirectory(const QString &dirPath);
+    void setExpectedMd5(const QString &md5);
+    void setDeltaEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+    void setStreamCount(int count);
+    void setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond);
+    void setChunkSource(SharedChunkSource *source);
+
+    QString localFile() const;
+    QString remoteFile() const;
+    qint64 chunkSize() const;
+    qint64 fileSize() const;
+    int chunkCount() const;
+    int resumedChunks() const;
+    bool isRunning() const;
+    QString fileMd5() const;
+    bool skippedIdentical() const;
+    bool usedDelta() const;
+    bool verifiedRemotely() const;
+
+    // 最近一次失败的类别，finished(false) 之后由调用方决定是否重试；再次 start() 即从断点续传
+    RetryPolicy::ErrorClass lastErrorClass() const;
+
+    void start();
+    void cancel();
+
+    QStringList sshConnectionArguments() const;
+
+    // 远程探测命令的输出，各段以标记分隔；未出现的段保持默认值
+    struct ProbeResult {
+        QString identity;           // 远程分块清单内容（源文件标识）
+        bool hasPart;               // 输出中有 .part 大小段
+        qint64 partSize;
+        bool hasFinal;              // 输出中有目标文件段
+        qint64 finalSize;           // 目标文件大小，不存在时为 0
+        QString finalMd5;           // 大小与本地一致时计算的目标文件MD5（小写）
+        QString rangesSection;      // 并行上传残留分段列表，交给 MultiStreamUploader::parseRemoteRanges()
+        bool hasGzip;
+    };
+    static ProbeResult parseProbeOutput(const QString &output);
+    // 远程目标文件与本地文件大小和MD5都一致时无需传输
+    static bool isRemoteIdentical(const ProbeResult &probe, qint64 size, const QString &md5);
+
+    static const qint64 DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+signals:
+    void logMessage(const QString &message);
+    void progressChanged(qint64 bytesSent, qint64 totalBytes);
+    void finished(bool success, const QString &errorMessage);
+    void cancelled();
+    // 进入一段没有传输进度的工作：探测远程、增量签名和差异查找、续传前计算前缀MD5
+    void preparing();
+
+private slots:
+    void onProbeFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onStreamWritable();
+    void onStreamFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void hashPrefixSlice();
+    void onDeltaFinished(bool success, const QString &errorMessage);
+    void onDeltaNotApplicable(const QString &reason);
+    void onParallelFinished(bool success, const QString &errorMessage);
+
+private:
+    enum Stage {
+        StageIdle,
+        StageProbing,
+        StageDelta,
+        StageParallel,
+        StageHashingPrefix,
+        StageStreaming
+    };
+
+    QStringList buildSshArguments(const QString &remoteCommand) const;
+    QString remotePartFile() const;
+    QString remoteManifestFile() const;
+    QString sourceIdentity() const;
+    QString localManifestPath() const;
+    int loadLocalManifest() const;
+    void saveLocalManifest(int completedChunks,
+                           const QList<MultiStreamUploader::Range> &ranges = QList<MultiStreamUploader::Range>());
+    void removeLocalManifest();
+    void finishIdentical();
+    void startStream(int firstChunk);
+    void startParallel();
+    void launchStream();
+    void feedStream();
+    qint64 updateSentOffset();
+    bool switchToPrivateRead();
+    void releaseChunkSource();
+    void finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass = RetryPolicy::ErrorLocal);
+    void cleanupProcess();
+
+    // 参数
+    QString localFilePath;
+    QString remoteFilePath;
+    QString host;
+    int port;
+    QString username;
+    QStringList sshOptions;
+    QProcessEnvironment sshEnvironment;
+    qint64 chunkBytes;
+    QString stateDirectory;
+    QString expectedMd5;
+    bool deltaEnabled;
+    bool compressionEnabled;
+    int streamCount;
+
+    // 运行状态
+    Stage stage;
+    SshProcess *process;
+    QFile sourceFile;
+    qint64 totalBytes;
+    qint64 lastModifiedMs;
+    qint64 startOffset;
+    qint64 writtenOffset;
+    int startChunk;
+    bool cancelRequested;
+    QCryptographicHash md5Hash;
+    QString md5Hex;
+    bool identicalSkipped;
+    bool deltaUsed;
+    bool remoteVerified;
+    RetryPolicy::ErrorClass errorClass;
+    DeltaUploader *deltaUploader;
+    MultiStreamUploader *multiStreamUploader;
+    RateLimiter *deviceLimiter;
+    int limiterConsumer;
+    SharedChunkSource *chunkSource;
+    int sourceConsumer;
+    bool hashingLocally;
+    QList<MultiStreamUploader::Range> remoteRanges;   // 探测到的上次并行上传的第1段及以后的分段
+
+    // 传输压缩
+    bool remoteHasGzip;
+    bool streamCompressed;
+    StreamCompressor compressor;
+    qint64 streamBytesQueued;                   // 已写入通道的压缩数据总量
+    QList<QPair<qint64, qint64> > pendingMembers; // 尚未被通道取走的成员：(压缩数据结束位置, 原始数据结束位置)
+    qint64 acknowledgedOffset;                  // 已被通道完整取走的原始数据位置
+};
+
+#endif // CHUNKEDUPLOADER_H
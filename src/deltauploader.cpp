@@ -0,0 +1,713 @@
+/**
+ * @File Name: deltauploader.cpp
+ * @brief  块级增量上传实现，以远程旧文件的块签名在新文件上做滑动窗口匹配，只发送差异数据并在远程用一个脚本重建
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "deltauploader.h"
+#include "sshprocess.h"
+#include "sshutils.h"
+#include <QFileInfo>
+#include <QTimer>
+#include <QProcessEnvironment>
+
+// 块大小从64KB起按2倍增长，使远程块数不超过上限（远程每块要启动一次dd）
+static const qint64 MIN_BLOCK_SIZE = 64 * 1024;
+static const qint64 MAX_BLOCK_SIZE = 4 * 1024 * 1024;
+static const qint64 MAX_REMOTE_BLOCKS = 4096;
+
+// 可复用数据低于该比例时增量上传不划算，改为完整上传
+static const double MIN_REUSE_RATIO = 0.1;
+
+// 重建脚本的最大段数，每段在设备上启动一个 dd 或 head 进程
+static const int MAX_APPLY_RANGES = 256;
+
+// 滑动窗口匹配每次事件循环最多前进的字节数，以及每次从本地文件补充读取的数据量
+static const qint64 SEARCH_SLICE_BYTES = 4 * 1024 * 1024;
+static const qint64 SEARCH_READ_BYTES = 8 * 1024 * 1024;
+
+// 远程签名输出中文件大小行的前缀
+static const char *SIGNATURE_SIZE_MARKER = "@@SIZE";
+
+// 弱校验过滤表的大小（按弱校验低16位索引）
+static const int WEAK_FILTER_SIZE = 65536;
+
+const qint64 DeltaUploader::LITERAL_ALIGNMENT;
+
+DeltaUploader::DeltaUploader(QObject *parent)
+    : QObject(parent), sshEnvironment(QProcessEnvironment::systemEnvironment()), stage(StageIdle), process(nullptr),
+      totalBytes(0), baseBytes(0), blockBytes(MIN_BLOCK_SIZE), cancelRequested(false), remoteHasWeak(false),
+      remoteReady(false), md5Hash(QCryptographicHash::Md5), localReady(false), bufferStart(0), searchPos(0),
+      literalStart(0), windowCrc(0), windowValid(false), literalBytes(0), literalFileBytes(0), nextRange(0),
+      rangeOffset(0), literalQueued(0)
+{
+}
+
+DeltaUploader::~DeltaUploader()
+{
+    cleanupProcess();
+}
+
+void DeltaUploader::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+}
+
+void DeltaUploader::setRemoteFile(const QString &remoteFilePath)
+{
+    this->remoteFilePath = remoteFilePath;
+}
+
+void DeltaUploader::setSshConnectionArguments(const QStringList &arguments)
+{
+    connectionArguments = arguments;
+}
+
+void DeltaUploader::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+bool DeltaUploader::isRunning() const
+{
+    return stage != StageIdle;
+}
+
+QString DeltaUploader::fileMd5() const
+{
+    return md5Hex;
+}
+
+void DeltaUploader::start(qint64 remoteBaseSize)
+{
+    if (stage != StageIdle) {
+        return;
+    }
+
+    sourceFile.setFileName(localFilePath);
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        finishNotApplicable(QString("无法打开本地文件: %1").arg(sourceFile.errorString()));
+        return;
+    }
+
+    totalBytes = sourceFile.size();
+    baseBytes = remoteBaseSize;
+    cancelRequested = false;
+    remoteStrong.clear();
+    remoteWeak.clear();
+    remoteHasWeak = false;
+    weakIndex.clear();
+    strongIndex.clear();
+    weakFilter.clear();
+    remoteReady = false;
+    md5Hash.reset();
+    md5Hex.clear();
+    localReady = false;
+    searchBuffer.clear();
+    bufferStart = 0;
+    searchPos = 0;
+    literalStart = 0;
+    windowValid = false;
+    ranges.clear();
+    literalBytes = 0;
+    literalFileBytes = 0;
+    nextRange = 0;
+    rangeOffset = 0;
+    literalQueued = 0;
+
+    blockBytes = MIN_BLOCK_SIZE;
+    while (blockBytes < MAX_BLOCK_SIZE && qMax(baseBytes, totalBytes) / blockBytes > MAX_REMOTE_BLOCKS) {
+        blockBytes *= 2;
+    }
+    rolling.reset(blockBytes);
+
+    emit logMessage(QString("[增量上传] 远程已有旧版本 (%1 字节)，按 %2 KB 分块比对差异")
+                   .arg(baseBytes).arg(blockBytes / 1024));
+
+    // 远程签名与本地整体MD5同时进行
+    stage = StageSignature;
+    process = createProcess();
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &DeltaUploader::onSignatureFinished);
+
+    // 每块输出 "序号 MD5 CRC"，设备没有 cksum 时弱校验为 "-"
+    // 每块只用一次 dd 从旧文件读出，写入 /tmp 下的临时文件，两个校验都从这份副本计算
+    QString signatureCommand = QString(
+        "f=%1; bs=%2; t=/tmp/.delta_sig_$$; s=$(wc -c < \"$f\"); echo \"%3 $s\"; "
+        "ck=; command -v cksum >/dev/null 2>&1 && ck=1; "
+        "n=$(( (s + bs - 1) / bs )); i=0; "
+        "while [ $i -lt $n ]; do "
+        "dd if=\"$f\" of=\"$t\" bs=$bs skip=$i count=1 2>/dev/null || break; "
+        "h=$(md5sum < \"$t\"); w=-; "
+        "if [ -n \"$ck\" ]; then w=$(cksum < \"$t\"); fi; "
+        "echo \"$i ${h%% *} ${w%% *}\"; i=$((i + 1)); "
+        "done; rm -f \"$t\"")
+        .arg(SshUtils::shellQuote(remoteFilePath))
+        .arg(blockBytes)
+        .arg(SIGNATURE_SIZE_MARKER);
+    process->startSsh(buildSshArguments(signatureCommand));
+
+    QTimer::singleShot(0, this, &DeltaUploader::hashLocalFile);
+}
+
+void DeltaUploader::cancel()
+{
+    if (stage == StageIdle) {
+        return;
+    }
+
+    cancelRequested = true;
+    if (process) {
+        process->kill();
+    } else {
+        finishWithError("上传已取消");
+    }
+}
+
+void DeltaUploader::hashLocalFile()
+{
+    if (stage != StageSignature || localReady) {
+        return;
+    }
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    // 每次事件循环只读一块，保持界面响应
+    if (sourceFile.pos() < totalBytes) {
+        QByteArray data = sourceFile.read(qMin(blockBytes, totalBytes - sourceFile.pos()));
+        if (data.isEmpty()) {
+            cleanupProcess();
+            finishNotApplicable(QString("读取本地文件失败: %1").arg(sourceFile.errorString()));
+            return;
+        }
+        md5Hash.addData(data);
+        QTimer::singleShot(0, this, &DeltaUploader::hashLocalFile);
+        return;
+    }
+
+    md5Hex = QString(md5Hash.result().toHex());
+    localReady = true;
+    maybeStartSearch();
+}
+
+void DeltaUploader::onSignatureFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        cleanupProcess();
+        finishNotApplicable(QString("无法获取远程文件块签名%1").arg(error.isEmpty() ? "" : ": " + error));
+        return;
+    }
+
+    QStringList lines = QString::fromUtf8(process->readAllStandardOutput()).split('\n', QString::SkipEmptyParts);
+    cleanupProcess();
+
+    qint64 remoteSize = -1;
+    bool weakComplete = true;
+    for (const QString &line : lines) {
+        QStringList parts = line.trimmed().split(' ', QString::SkipEmptyParts);
+        if (parts.size() == 2 && parts[0] == SIGNATURE_SIZE_MARKER) {
+            remoteSize = parts[1].toLongLong();
+            continue;
+        }
+        if (parts.size() != 3) {
+            continue;
+        }
+
+        bool ok = false;
+        int index = parts[0].toInt(&ok);
+        if (!ok || index != remoteStrong.size() || parts[1].length() != 32) {
+            finishNotApplicable("远程块签名格式异常");
+            return;
+        }
+        remoteStrong.append(parts[1].toLower());
+
+        bool weakOk = false;
+        remoteWeak.append(parts[2].toUInt(&weakOk));
+        weakComplete = weakComplete && weakOk;
+    }
+
+    qint64 expectedBlocks = (remoteSize + blockBytes - 1) / blockBytes;
+    if (remoteSize <= 0 || remoteStrong.size() != expectedBlocks) {
+        finishNotApplicable("远程旧文件在比对期间发生变化");
+        return;
+    }
+    baseBytes = remoteSize;
+    remoteHasWeak = weakComplete;
+
+    // 弱校验索引只收录完整长度的块；最后的不完整块只可能出现在新文件末尾，单独比对
+    int fullBlocks = static_cast<int>(baseBytes / blockBytes);
+    weakFilter.fill(0, WEAK_FILTER_SIZE);
+    for (int i = 0; i < remoteStrong.size(); ++i) {
+        if (!strongIndex.contains(remoteStrong[i])) {
+            strongIndex.insert(remoteStrong[i], i);
+        }
+        if (remoteHasWeak && i < fullBlocks) {
+            weakIndex[remoteWeak[i]].append(i);
+            weakFilter[static_cast<int>(remoteWeak[i] & 0xFFFF)] = 1;
+        }
+    }
+
+    if (!remoteHasWeak) {
+        emit logMessage("[增量上传] 设备没有 cksum，只能复用与块边界对齐的相同数据");
+    }
+
+    remoteReady = true;
+    maybeStartSearch();
+}
+
+void DeltaUploader::maybeStartSearch()
+{
+    if (!remoteReady || !localReady || stage != StageSignature) {
+        return;
+    }
+
+    stage = StageSearch;
+    searchBuffer.clear();
+    bufferStart = 0;
+    searchPos = 0;
+    literalStart = 0;
+    windowValid = false;
+    QTimer::singleShot(0, this, &DeltaUploader::searchMatches);
+}
+
+bool DeltaUploader::ensureBuffered(qint64 end)
+{
+    qint64 bufferEnd = bufferStart + searchBuffer.size();
+    if (end <= bufferEnd) {
+        return true;
+    }
+
+    // 丢弃当前窗口之前的数据，再从文件补充读取
+    qint64 keepFrom = qMin(searchPos, bufferEnd);
+    searchBuffer.remove(0, static_cast<int>(keepFrom - bufferStart));
+    bufferStart = keepFrom;
+
+    qint64 readBytes = qMax(SEARCH_READ_BYTES, end - bufferEnd);
+    readBytes = qMin(readBytes, totalBytes - bufferEnd);
+    if (!sourceFile.seek(bufferEnd)) {
+        return false;
+    }
+    QByteArray data = sourceFile.read(readBytes);
+    if (data.size() != readBytes) {
+        return false;
+    }
+    searchBuffer.append(data);
+    return true;
+}
+
+QString DeltaUploader::windowMd5(qint64 offset, qint64 length) const
+{
+    const char *data = searchBuffer.constData() + (offset - bufferStart);
+    return QString(QCryptographicHash::hash(QByteArray::fromRawData(data, static_cast<int>(length)),
+                                            QCryptographicHash::Md5).toHex());
+}
+
+int DeltaUploader::matchWindow(qint64 offset)
+{
+    // 弱校验命中后才计算窗口的MD5，返回匹配的远程块序号
+    quint32 weak = RollingChecksum::finish(windowCrc, blockBytes);
+    if (!weakFilter.at(static_cast<int>(weak & 0xFFFF))) {
+        return -1;
+    }
+
+    QHash<quint32, QVector<int> >::const_iterator it = weakIndex.constFind(weak);
+    if (it == weakIndex.constEnd()) {
+        return -1;
+    }
+
+    QString strong = windowMd5(offset, blockBytes);
+    for (int block : it.value()) {
+        if (remoteStrong[block] == strong) {
+            return block;
+        }
+    }
+    return -1;
+}
+
+void DeltaUploader::searchMatches()
+{
+    if (stage != StageSearch) {
+        return;
+    }
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    qint64 sliceEnd = searchPos + SEARCH_SLICE_BYTES;
+    while (searchPos + blockBytes <= totalBytes && searchPos < sliceEnd) {
+        // 需要窗口本身以及滚动时移入的下一个字节
+        if (!ensureBuffered(qMin(searchPos + blockBytes + 1, totalBytes))) {
+            finishNotApplicable(QString("读取本地文件失败: %1").arg(sourceFile.errorString()));
+            return;
+        }
+
+        const char *window = searchBuffer.constData() + (searchPos - bufferStart);
+        int block = -1;
+        if (remoteHasWeak) {
+            if (!windowValid) {
+                windowCrc = RollingChecksum::update(0, window, blockBytes);
+                windowValid = true;
+            }
+            block = matchWindow(searchPos);
+        } else if (searchPos % blockBytes == 0) {
+            block = strongIndex.value(windowMd5(searchPos, blockBytes), -1);
+        }
+
+        if (block >= 0) {
+            addRange(false, literalStart, literalStart, searchPos - literalStart);
+            addRange(true, static_cast<qint64>(block) * blockBytes, searchPos, blockBytes);
+            searchPos += blockBytes;
+            literalStart = searchPos;
+            windowValid = false;
+        } else if (!remoteHasWeak) {
+            searchPos += blockBytes;
+        } else {
+            if (searchPos + blockBytes < totalBytes) {
+                windowCrc = rolling.roll(windowCrc, static_cast<uchar>(window[0]),
+                                         static_cast<uchar>(window[blockBytes]));
+            }
+            searchPos++;
+        }
+    }
+
+    if (searchPos + blockBytes <= totalBytes) {
+        QTimer::singleShot(0, this, &DeltaUploader::searchMatches);
+        return;
+    }
+
+    finishSearch();
+}
+
+void DeltaUploader::finishSearch()
+{
+    // 旧文件最后的不完整块只与新文件同长度的末尾比对
+    qint64 tailBytes = baseBytes % blockBytes;
+    qint64 tailOffset = totalBytes - tailBytes;
+    if (tailBytes > 0 && tailOffset >= literalStart) {
+        searchPos = tailOffset;
+        if (ensureBuffered(totalBytes) && windowMd5(tailOffset, tailBytes) == remoteStrong.last()) {
+            addRange(false, literalStart, literalStart, tailOffset - literalStart);
+            addRange(true, baseBytes - tailBytes, tailOffset, tailBytes);
+            literalStart = totalBytes;
+        }
+    }
+    addRange(false, literalStart, literalStart, totalBytes - literalStart);
+    searchBuffer.clear();
+
+    int matchedRanges = ranges.size();
+    limitRanges();
+
+    literalBytes = 0;
+    literalFileBytes = 0;
+    for (const Range &range : ranges) {
+        if (!range.fromBase) {
+            literalBytes += range.length;
+            literalFileBytes += storedLength(range.length);
+        }
+    }
+
+    qint64 reusedBytes = totalBytes - literalBytes;
+    emit logMessage(QString("[增量上传] 可复用 %1 字节，需发送 %2 字节，重建分 %3 段%4")
+                   .arg(reusedBytes)
+                   .arg(literalBytes)
+                   .arg(ranges.size())
+                   .arg(matchedRanges > ranges.size()
+                        ? QString("（匹配结果 %1 段，较短的复用段改为直接发送）").arg(matchedRanges)
+                        : QString()));
+
+    if (totalBytes > 0 && reusedBytes < totalBytes * MIN_REUSE_RATIO) {
+        finishNotApplicable("新旧文件差异过大，增量上传不划算");
+        return;
+    }
+
+    startApply();
+}
+
+void DeltaUploader::addRange(bool fromBase, qint64 srcOffset, qint64 dstOffset, qint64 length)
+{
+    if (length <= 0) {
+        return;
+    }
+
+    // 与上一段首尾相接时合并（复用段还要求旧文件中的位置也连续）
+    if (!ranges.isEmpty()) {
+        Range &last = ranges.last();
+        if (last.fromBase == fromBase && last.dstOffset + last.length == dstOffset
+            && last.srcOffset + last.length == srcOffset) {
+            last.length += length;
+            return;
+        }
+    }
+
+    Range range = { fromBase, srcOffset, dstOffset, length };
+    ranges.append(range);
+}
+
+void DeltaUploader::limitRanges()
+{
+    // 每次把最短的复用段改为直接发送并与相邻的发送段合并，直到段数不超过上限
+    while (ranges.size() > MAX_APPLY_RANGES) {
+        int shortest = -1;
+        for (int i = 0; i < ranges.size(); ++i) {
+            if (ranges[i].fromBase && (shortest < 0 || ranges[i].length < ranges[shortest].length)) {
+                shortest = i;
+            }
+        }
+        if (shortest < 0) {
+            break;
+        }
+
+        QVector<Range> merged;
+        for (int i = 0; i < ranges.size(); ++i) {
+            Range range = ranges[i];
+            if (i == shortest) {
+                range.fromBase = false;
+                range.srcOffset = range.dstOffset;
+            }
+            if (!merged.isEmpty() && !merged.last().fromBase && !range.fromBase) {
+                merged.last().length += range.length;
+            } else {
+                merged.append(range);
+            }
+        }
+        ranges = merged;
+    }
+}
+
+qint64 DeltaUploader::storedLength(qint64 length)
+{
+    return (length + LITERAL_ALIGNMENT - 1) / LITERAL_ALIGNMENT * LITERAL_ALIGNMENT;
+}
+
+QString DeltaUploader::buildScript(const QString &remoteFilePath, const QVector<Range> &ranges,
+                                   qint64 blockBytes, qint64 totalBytes)
+{
+    QString base = SshUtils::shellQuote(remoteFilePath);
+    QString literals = SshUtils::shellQuote(literalFile(remoteFilePath));
+    QString target = SshUtils::shellQuote(newFile(remoteFilePath));
+
+    // 按新文件顺序逐段输出：复用段从旧文件按块拷贝，发送段从差异数据文件按对齐单位拷贝；
+    // 发送段长度不是对齐单位的整数倍时，由 head -c 从这一个 dd 的输出中截取，不涉及共享的标准输入
+    QStringList lines;
+    lines << "set -e"
+          << QString("rm -f %1").arg(target)
+          << "{"
+          << ":";
+
+    qint64 literalOffset = 0;
+    for (const Range &range : ranges) {
+        if (range.fromBase) {
+            lines << QString("dd if=%1 bs=%2 skip=%3 count=%4 2>/dev/null")
+                     .arg(base)
+                     .arg(blockBytes)
+                     .arg(range.srcOffset / blockBytes)
+                     .arg((range.length + blockBytes - 1) / blockBytes);
+        } else {
+            qint64 stored = storedLength(range.length);
+            QString line = QString("dd if=%1 bs=%2 skip=%3 count=%4 2>/dev/null")
+                           .arg(literals)
+                           .arg(LITERAL_ALIGNMENT)
+                           .arg(literalOffset / LITERAL_ALIGNMENT)
+                           .arg(stored / LITERAL_ALIGNMENT);
+            if (stored != range.length) {
+                line += QString(" | head -c %1").arg(range.length);
+            }
+            lines << line;
+            literalOffset += stored;
+        }
+    }
+
+    lines << QString("} > %1").arg(target)
+          << QString("[ $(wc -c < %1) -eq %2 ]").arg(target).arg(totalBytes)
+          << QString("mv -f %1 %2").arg(target).arg(base);
+
+    return lines.join("\n");
+}
+
+void DeltaUploader::startApply()
+{
+    stage = StageApplying;
+    nextRange = 0;
+    rangeOffset = 0;
+    literalQueued = 0;
+
+    process = createProcess();
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &DeltaUploader::onApplyFinished);
+    connect(process, &SshProcess::readyWrite, this, &DeltaUploader::onApplyWritable);
+
+    emit logMessage(QString("[增量上传] 开始发送差异数据 %1 字节").arg(literalBytes));
+    emit progressChanged(totalBytes - literalBytes, totalBytes);
+
+    // 标准输入只有差异数据，远程读到 EOF 后先核对差异数据文件的大小，再执行重建脚本
+    QString literals = SshUtils::shellQuote(literalFile(remoteFilePath));
+    QString applyCommand = QString(
+        "mkdir -p %1 || exit 1\n"
+        "cat > %2 || { rm -f %2; exit 1; }\n"
+        "[ $(wc -c < %2) -eq %3 ] || { rm -f %2; echo \"收到的差异数据不完整\" >&2; exit 1; }\n"
+        "(\n%4\n); rc=$?\n"
+        "rm -f %2; [ $rc -eq 0 ] || rm -f %5\n"
+        "exit $rc")
+        .arg(SshUtils::shellQuote(QFileInfo(remoteFilePath).path()))
+        .arg(literals)
+        .arg(literalFileBytes)
+        .arg(buildScript(remoteFilePath, ranges, blockBytes, totalBytes))
+        .arg(SshUtils::shellQuote(newFile(remoteFilePath)));
+    process->startSsh(buildSshArguments(applyCommand));
+}
+
+void DeltaUploader::onApplyWritable()
+{
+    if (!process) {
+        return;
+    }
+
+    qint64 sent = qBound<qint64>(0, literalQueued - process->bytesToWrite(), literalBytes);
+    emit progressChanged(totalBytes - literalBytes + sent, totalBytes);
+    feedLiterals();
+}
+
+void DeltaUploader::feedLiterals()
+{
+    if (!process || stage != StageApplying) {
+        return;
+    }
+
+    while (nextRange < ranges.size() && process->canWrite()) {
+        const Range &range = ranges[nextRange];
+        qint64 stored = storedLength(range.length);
+        if (range.fromBase || rangeOffset >= stored) {
+            nextRange++;
+            rangeOffset = 0;
+            continue;
+        }
+
+        if (rangeOffset >= range.length) {
+            // 补齐到对齐单位，下一段在差异数据文件中从对齐位置开始
+            process->write(QByteArray(static_cast<int>(stored - rangeOffset), '\0'));
+            rangeOffset = stored;
+            continue;
+        }
+
+        qint64 offset = range.srcOffset + rangeOffset;
+        if (!sourceFile.seek(offset)) {
+            emit logMessage(QString("[错误] 无法定位本地文件偏移: %1").arg(offset));
+            process->kill();
+            return;
+        }
+
+        QByteArray data = sourceFile.read(process->nextSlice(range.length - rangeOffset));
+        if (data.isEmpty()) {
+            emit logMessage(QString("[错误] 读取本地文件失败: %1").arg(sourceFile.errorString()));
+            process->kill();
+            return;
+        }
+
+        process->write(data);
+        literalQueued += data.size();
+        rangeOffset += data.size();
+    }
+
+    if (nextRange >= ranges.size()) {
+        // 差异数据发送完毕，远程 cat 收到 EOF
+        process->closeWriteChannelWhenDrained();
+    }
+}
+
+void DeltaUploader::onApplyFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (cancelRequested) {
+        finishWithError("上传已取消");
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+        cleanupProcess();
+        finishWithError(error.isEmpty() ? QString("远程重建文件失败 (退出码: %1)").arg(exitCode) : error);
+        return;
+    }
+
+    cleanupProcess();
+    sourceFile.close();
+    stage = StageIdle;
+
+    emit progressChanged(totalBytes, totalBytes);
+    emit logMessage(QString("[增量上传] 远程文件重建完成，实际发送 %1 字节 (完整文件 %2 字节)")
+                   .arg(literalBytes).arg(totalBytes));
+    emit finished(true, QString());
+}
+
+QStringList DeltaUploader::buildSshArguments(const QString &remoteCommand) const
+{
+    QStringList arguments = connectionArguments;
+    arguments << remoteCommand;
+    return arguments;
+}
+
+SshProcess *DeltaUploader::createProcess()
+{
+    SshProcess *newProcess = new SshProcess(sshEnvironment, this);
+    connect(newProcess, &SshProcess::failedToStart, this, [this, newProcess](const QString &errorMessage) {
+        // 调用方改为完整上传，随后同样报告启动失败
+        if (newProcess == process) {
+            finishWithError(errorMessage);
+        }
+    });
+    return newProcess;
+}
+
+void DeltaUploader::finishWithError(const QString &errorMessage)
+{
+    cleanupProcess();
+    if (sourceFile.isOpen()) {
+        sourceFile.close();
+    }
+    stage = StageIdle;
+    emit finished(false, errorMessage);
+}
+
+void DeltaUploader::finishNotApplicable(const QString &reason)
+{
+    cleanupProcess();
+    if (sourceFile.isOpen()) {
+        sourceFile.close();
+    }
+    stage = StageIdle;
+    emit notApplicable(reason);
+}
+
+void DeltaUploader::cleanupProcess()
+{
+    if (process) {
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+        process->deleteLater();
+        process = nullptr;
+    }
+}
+
+QString DeltaUploader::literalFile(const QString &remoteFilePath)
+{
+    return remoteFilePath + ".delta.lit";
+}
+
+QString DeltaUploader::newFile(const QString &remoteFilePath)
+{
+    return remoteFilePath + ".delta.new";
+}
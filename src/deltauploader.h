@@ -0,0 +1,157 @@
+/**
+ * @File Name: deltauploader.h
+ * @brief  块级增量上传头文件，以远程已有的旧版本文件为基准，只发送发生变化的数据块并在远程重建新文件
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef DELTAUPLOADER_H
+#define DELTAUPLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QCryptographicHash>
+#include "rollingchecksum.h"
+
+class SshProcess;
+
+/**
+ * 增量上传流程（与 rsync 的块匹配思路相同）：
+ * 1. 签名：远程按固定块大小逐块把旧文件读入 /tmp 下的临时文件，再计算弱校验（cksum 的 CRC32）和强校验（MD5），
+ *    每块只从旧文件读取一次；同时本地计算新文件整体MD5
+ * 2. 匹配：本地在新文件上逐字节滑动窗口并滚动更新窗口的 CRC32，弱校验命中后再比对窗口的MD5，
+ *    因此在文件中插入或删除数据后，偏移不再对齐的相同块也能复用
+ * 3. 发送与重建：标准输入只有未匹配的数据，远程 cat 读到 EOF 写入差异数据文件，每段补齐到 LITERAL_ALIGNMENT；
+ *    文件大小一致后，重建脚本（随SSH命令发送）按新文件顺序从旧文件或差异数据文件用 dd 拷贝各段，
+ *    大小一致后替换目标文件
+ *
+ * 重建时每段要启动一个进程，段数超过上限时把最短的复用段改为直接发送，设备上的进程数因此有上限。
+ * 设备没有 cksum 时退回按块对齐比对（只能复用与块边界对齐的相同数据）；
+ * 可复用比例过低（例如压缩包整体变化）时返回 notApplicable，由调用方改为完整上传。
+ */
+class DeltaUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DeltaUploader(QObject *parent = nullptr);
+    ~DeltaUploader();
+
+    void setLocalFile(const QString &filePath);
+    void setRemoteFile(const QString &remoteFilePath);
+    void setSshConnectionArguments(const QStringList &arguments);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+
+    void start(qint64 remoteBaseSize);
+    void cancel();
+    bool isRunning() const;
+    QString fileMd5() const;
+
+    // 新文件中连续的一段：从旧文件 srcOffset 处复用，或由本地发送（srcOffset 为本地文件偏移）
+    struct Range {
+        bool fromBase;
+        qint64 srcOffset;
+        qint64 dstOffset;
+        qint64 length;
+    };
+
+    // 按 ranges 的顺序重建新文件的脚本；发送段依次存放在差异数据文件中，每段占 storedLength() 字节
+    static QString buildScript(const QString &remoteFilePath, const QVector<Range> &ranges,
+                               qint64 blockBytes, qint64 totalBytes);
+    // 发送段补齐到 LITERAL_ALIGNMENT 后在差异数据文件中占用的字节数
+    static qint64 storedLength(qint64 length);
+
+    static const qint64 LITERAL_ALIGNMENT = 4096;
+
+signals:
+    void logMessage(const QString &message);
+    void progressChanged(qint64 bytesSent, qint64 totalBytes);
+    void finished(bool success, const QString &errorMessage);
+    void notApplicable(const QString &reason);
+
+private slots:
+    void onSignatureFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void hashLocalFile();
+    void searchMatches();
+    void onApplyWritable();
+    void onApplyFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void feedLiterals();
+
+private:
+    enum Stage {
+        StageIdle,
+        StageSignature,
+        StageSearch,
+        StageApplying
+    };
+
+    QStringList buildSshArguments(const QString &remoteCommand) const;
+    SshProcess *createProcess();
+    void maybeStartSearch();
+    bool ensureBuffered(qint64 end);
+    QString windowMd5(qint64 offset, qint64 length) const;
+    int matchWindow(qint64 offset);
+    void addRange(bool fromBase, qint64 srcOffset, qint64 dstOffset, qint64 length);
+    void limitRanges();
+    void finishSearch();
+    void startApply();
+    void finishWithError(const QString &errorMessage);
+    void finishNotApplicable(const QString &reason);
+    void cleanupProcess();
+    static QString literalFile(const QString &remoteFilePath);
+    static QString newFile(const QString &remoteFilePath);
+
+    // 参数
+    QString localFilePath;
+    QString remoteFilePath;
+    QStringList connectionArguments;
+    QProcessEnvironment sshEnvironment;
+
+    // 运行状态
+    Stage stage;
+    SshProcess *process;
+    QFile sourceFile;
+    qint64 totalBytes;
+    qint64 baseBytes;
+    qint64 blockBytes;
+    bool cancelRequested;
+
+    // 签名：remoteWeak 只收录完整长度的块，weakFilter 按弱校验低16位快速排除不可能命中的窗口
+    QVector<QString> remoteStrong;
+    QVector<quint32> remoteWeak;
+    bool remoteHasWeak;
+    QHash<quint32, QVector<int> > weakIndex;
+    QHash<QString, int> strongIndex;
+    QByteArray weakFilter;
+    bool remoteReady;
+    QCryptographicHash md5Hash;
+    QString md5Hex;
+    bool localReady;
+
+    // 滑动窗口匹配
+    RollingChecksum rolling;
+    QByteArray searchBuffer;
+    qint64 bufferStart;
+    qint64 searchPos;
+    qint64 literalStart;
+    quint32 windowCrc;
+    bool windowValid;
+
+    // 发送计划
+    QVector<Range> ranges;
+    qint64 literalBytes;
+    qint64 literalFileBytes;                    // 差异数据文件的大小，含各段的补齐
+    int nextRange;
+    qint64 rangeOffset;
+    qint64 literalQueued;
+};
+
+#endif // DELTAUPLOADER_H
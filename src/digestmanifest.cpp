@@ -0,0 +1,169 @@
+/**
+ * @File Name: digestmanifest.cpp
+ * @brief  远程摘要清单实现，生成按序号输出摘要的远程脚本并解析结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "digestmanifest.h"
+#include "sshutils.h"
+#include <QStringList>
+
+// 远程输出每个文件摘要的行前缀
+static const char *DIGEST_MARKER = "@@DIGEST";
+
+// 内嵌清单的 here-document 结束标记
+static const char *MANIFEST_END_MARKER = "@@MANIFEST_END";
+
+DigestManifest::DigestManifest()
+    : digestAlgorithm(FileDigest::Md5)
+{
+}
+
+void DigestManifest::setBaseDirectory(const QString &dirPath)
+{
+    baseDirectory = dirPath;
+}
+
+void DigestManifest::setAlgorithm(FileDigest::Algorithm algorithm)
+{
+    digestAlgorithm = algorithm;
+}
+
+FileDigest::Algorithm DigestManifest::algorithm() const
+{
+    return digestAlgorithm;
+}
+
+void DigestManifest::addFile(const QString &path, const QString &expectedDigest)
+{
+    Item item;
+    item.path = path;
+    item.expected = expectedDigest.trimmed().toLower();
+    item.status = StatusPending;
+    entries.append(item);
+}
+
+void DigestManifest::clear()
+{
+    entries.clear();
+}
+
+bool DigestManifest::isEmpty() const
+{
+    return entries.isEmpty();
+}
+
+int DigestManifest::size() const
+{
+    return entries.size();
+}
+
+const QList<DigestManifest::Item> &DigestManifest::items() const
+{
+    return entries;
+}
+
+QString DigestManifest::digestLoop() const
+{
+    // 摘要工具从标准输入读取文件内容，输出中不含文件名
+    QStringList lines;
+    if (!baseDirectory.isEmpty()) {
+        lines << QString("cd %1 || exit 1").arg(SshUtils::shellQuote(baseDirectory));
+    }
+    lines << "i=0"
+          << "while IFS= read -r f; do"
+          << QString("  if [ -f \"$f\" ] && s=$(%2 < \"$f\"); then echo \"%1 $i ${s%% *}\"; "
+                     "else echo \"%1 $i -\"; fi").arg(DIGEST_MARKER).arg(FileDigest::remoteCommand(digestAlgorithm))
+          << "  i=$((i+1))"
+          << "done";
+    return lines.join("\n");
+}
+
+QString DigestManifest::remoteCommand() const
+{
+    return QString("%1 <<'%2'\n%3%2").arg(digestLoop()).arg(MANIFEST_END_MARKER)
+           .arg(QString::fromUtf8(pathList()));
+}
+
+QString DigestManifest::streamingCommand() const
+{
+    return digestLoop();
+}
+
+QByteArray DigestManifest::pathList() const
+{
+    QByteArray list;
+    for (const Item &item : entries) {
+        list += item.path.toUtf8() + "\n";
+    }
+    return list;
+}
+
+bool DigestManifest::parseOutput(const QByteArray &output)
+{
+    for (Item &item : entries) {
+        item.actual.clear();
+        item.status = StatusPending;
+    }
+
+    QByteArray markerPrefix = QByteArray(DIGEST_MARKER) + " ";
+    const QList<QByteArray> lines = output.split('\n');
+    for (const QByteArray &rawLine : lines) {
+        QByteArray line = rawLine.trimmed();
+        if (!line.startsWith(markerPrefix)) {
+            continue;
+        }
+
+        // "@@DIGEST <序号> <摘要|->"
+        QList<QByteArray> fields = line.mid(markerPrefix.size()).split(' ');
+        if (fields.size() != 2) {
+            continue;
+        }
+        bool ok = false;
+        int index = fields.at(0).toInt(&ok);
+        if (!ok || index < 0 || index >= entries.size()) {
+            continue;
+        }
+
+        Item &item = entries[index];
+        QString digest = QString::fromLatin1(fields.at(1)).toLower();
+        if (digest == "-") {
+            item.status = StatusMissing;
+        } else {
+            item.actual = digest;
+            item.status = (!item.expected.isEmpty() && digest == item.expected) ? StatusMatched : StatusMismatched;
+        }
+    }
+
+    return count(StatusPending) == 0;
+}
+
+int DigestManifest::count(Status status) const
+{
+    int total = 0;
+    for (const Item &item : entries) {
+        if (item.status == status) {
+            ++total;
+        }
+    }
+    return total;
+}
+
+bool DigestManifest::allMatched() const
+{
+    return !entries.isEmpty() && count(StatusMatched) == entries.size();
+}
+
+QList<DigestManifest::Item> DigestManifest::failedItems() const
+{
+    QList<Item> failed;
+    for (const Item &item : entries) {
+        if (item.status != StatusMatched) {
+            failed.append(item);
+        }
+    }
+    return failed;
+}
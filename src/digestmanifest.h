@@ -0,0 +1,79 @@
+/**
+ * @File Name: digestmanifest.h
+ * @brief  远程摘要清单头文件，一次远程调用计算清单中所有文件的摘要，解析为逐个文件的结构化结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef DIGESTMANIFEST_H
+#define DIGESTMANIFEST_H
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include "filedigest.h"
+
+/**
+ * 校验清单：记录远程文件路径和期望的摘要，生成一条远程命令，在一次SSH往返中计算全部文件的摘要。
+ * - 远程逐行读取清单，每个文件输出一行 "@@DIGEST <序号> <摘要>"，文件不存在或不可读时摘要为 "-"，
+ *   按序号对应清单条目，不解析远程输出中的文件名，路径含空格等字符也不会出错
+ * - 清单可以内嵌在命令中（here-document，适合常驻会话上执行的少量文件），
+ *   也可以由调用方写入标准输入（文件很多时避免命令超出远程参数长度限制）
+ * - parseOutput() 把每个条目标记为一致、不一致、缺失或未返回
+ * 摘要算法默认 MD5，可设为与设备协商得到的算法（见 FileDigest）。
+ * 路径不能包含换行符；相对路径相对于 setBaseDirectory() 设置的目录。
+ */
+class DigestManifest
+{
+public:
+    enum Status {
+        StatusPending,      // 远程没有返回该条目的结果
+        StatusMatched,
+        StatusMismatched,
+        StatusMissing       // 远程文件不存在或不可读
+    };
+
+    struct Item {
+        QString path;
+        QString expected;
+        QString actual;
+        Status status;
+    };
+
+    DigestManifest();
+
+    void setBaseDirectory(const QString &dirPath);
+    void setAlgorithm(FileDigest::Algorithm algorithm);
+    FileDigest::Algorithm algorithm() const;
+    void addFile(const QString &path, const QString &expectedDigest);
+    void clear();
+
+    bool isEmpty() const;
+    int size() const;
+    const QList<Item> &items() const;
+
+    // 清单内嵌在命令中
+    QString remoteCommand() const;
+
+    // 清单从标准输入读取，配合 pathList() 使用
+    QString streamingCommand() const;
+    QByteArray pathList() const;
+
+    // 解析远程输出，所有条目都有结果时返回 true
+    bool parseOutput(const QByteArray &output);
+
+    int count(Status status) const;
+    bool allMatched() const;
+    QList<Item> failedItems() const;
+
+private:
+    QString digestLoop() const;
+
+    QString baseDirectory;
+    FileDigest::Algorithm digestAlgorithm;
+    QList<Item> entries;
+};
+
+#endif // DIGESTMANIFEST_H
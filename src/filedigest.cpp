@@ -0,0 +1,265 @@
+/**
+ * @File Name: filedigest.cpp
+ * @brief  文件摘要算法实现，MD5/SHA-256 使用 QCryptographicHash，XXH64 按参考算法流式计算
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "filedigest.h"
+#include <QStringList>
+#include <cstring>
+
+// XXH64 参考实现中的常量
+static const quint64 PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const quint64 PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const quint64 PRIME64_3 = 0x165667B19E3779F9ULL;
+static const quint64 PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const quint64 PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+// 远程查询结果的行前缀
+static const char *TOOL_MARKER = "@@DIGEST_TOOL";
+
+static inline quint64 rotl64(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline quint64 readLE64(const uchar *p)
+{
+    quint64 value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static inline quint32 readLE32(const uchar *p)
+{
+    return static_cast<quint32>(p[0]) | (static_cast<quint32>(p[1]) << 8)
+           | (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[3]) << 24);
+}
+
+static inline quint64 xxhRound(quint64 acc, quint64 input)
+{
+    acc += input * PRIME64_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline quint64 xxhMergeRound(quint64 acc, quint64 value)
+{
+    acc ^= xxhRound(0, value);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+FileDigest::FileDigest(Algorithm algorithm)
+    : type(algorithm),
+      cryptoHash(algorithm == Sha256 ? QCryptographicHash::Sha256 : QCryptographicHash::Md5)
+{
+    reset();
+}
+
+FileDigest::Algorithm FileDigest::algorithm() const
+{
+    return type;
+}
+
+void FileDigest::reset()
+{
+    cryptoHash.reset();
+    accumulators[0] = PRIME64_1 + PRIME64_2;
+    accumulators[1] = PRIME64_2;
+    accumulators[2] = 0;
+    accumulators[3] = 0 - PRIME64_1;
+    totalLength = 0;
+    bufferSize = 0;
+}
+
+void FileDigest::addData(const QByteArray &data)
+{
+    addData(data.constData(), data.size());
+}
+
+void FileDigest::addData(const char *data, int length)
+{
+    if (type == Xxh64) {
+        xxhConsume(reinterpret_cast<const uchar *>(data), length);
+    } else {
+        cryptoHash.addData(data, length);
+    }
+}
+
+QString FileDigest::resultHex()
+{
+    if (type == Xxh64) {
+        return QString("%1").arg(xxhDigest(), 16, 16, QChar('0'));
+    }
+    return QString(cryptoHash.result().toHex());
+}
+
+void FileDigest::xxhConsume(const uchar *data, int length)
+{
+    totalLength += static_cast<quint64>(length);
+
+    // 不足一个32字节条带时先缓存
+    if (bufferSize + length < 32) {
+        memcpy(buffer + bufferSize, data, length);
+        bufferSize += length;
+        return;
+    }
+
+    const uchar *p = data;
+    const uchar *end = data + length;
+
+    if (bufferSize > 0) {
+        int fill = 32 - bufferSize;
+        memcpy(buffer + bufferSize, p, fill);
+        for (int lane = 0; lane < 4; ++lane) {
+            accumulators[lane] = xxhRound(accumulators[lane], readLE64(buffer + lane * 8));
+        }
+        p += fill;
+        bufferSize = 0;
+    }
+
+    while (end - p >= 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            accumulators[lane] = xxhRound(accumulators[lane], readLE64(p + lane * 8));
+        }
+        p += 32;
+    }
+
+    bufferSize = static_cast<int>(end - p);
+    memcpy(buffer, p, bufferSize);
+}
+
+quint64 FileDigest::xxhDigest() const
+{
+    quint64 hash;
+    if (totalLength >= 32) {
+        hash = rotl64(accumulators[0], 1) + rotl64(accumulators[1], 7)
+               + rotl64(accumulators[2], 12) + rotl64(accumulators[3], 18);
+        for (int lane = 0; lane < 4; ++lane) {
+            hash = xxhMergeRound(hash, accumulators[lane]);
+        }
+    } else {
+        hash = PRIME64_5;
+    }
+    hash += totalLength;
+
+    const uchar *p = buffer;
+    const uchar *end = buffer + bufferSize;
+    while (end - p >= 8) {
+        hash ^= xxhRound(0, readLE64(p));
+        hash = rotl64(hash, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if (end - p >= 4) {
+        hash ^= static_cast<quint64>(readLE32(p)) * PRIME64_1;
+        hash = rotl64(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= (*p) * PRIME64_5;
+        hash = rotl64(hash, 11) * PRIME64_1;
+        ++p;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+QString FileDigest::algorithmName(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Md5:
+        return "md5";
+    case Sha256:
+        return "sha256";
+    case Xxh64:
+        return "xxh64";
+    }
+    return QString();
+}
+
+QString FileDigest::displayName(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Md5:
+        return "MD5";
+    case Sha256:
+        return "SHA-256";
+    case Xxh64:
+        return "XXH64";
+    }
+    return QString();
+}
+
+bool FileDigest::fromName(const QString &name, Algorithm *algorithm)
+{
+    QString lower = name.trimmed().toLower();
+    for (Algorithm candidate : {Md5, Sha256, Xxh64}) {
+        if (lower == algorithmName(candidate)) {
+            *algorithm = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString FileDigest::remoteCommand(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Md5:
+        return "md5sum";
+    case Sha256:
+        return "sha256sum";
+    case Xxh64:
+        return "xxhsum -H1";
+    }
+    return "md5sum";
+}
+
+QString FileDigest::negotiationCommand()
+{
+    return QString("for t in xxhsum sha256sum md5sum; do "
+                   "command -v $t >/dev/null 2>&1 && echo \"%1 $t\"; done; true").arg(TOOL_MARKER);
+}
+
+FileDigest::Algorithm FileDigest::negotiate(const QString &preference, const QByteArray &probeOutput, QString *note)
+{
+    QStringList tools;
+    QByteArray markerPrefix = QByteArray(TOOL_MARKER) + " ";
+    const QList<QByteArray> lines = probeOutput.split('\n');
+    for (const QByteArray &line : lines) {
+        QByteArray trimmed = line.trimmed();
+        if (trimmed.startsWith(markerPrefix)) {
+            tools << QString::fromLatin1(trimmed.mid(markerPrefix.size()));
+        }
+    }
+
+    Algorithm preferred;
+    if (fromName(preference, &preferred)) {
+        if (tools.contains(remoteCommand(preferred).section(' ', 0, 0))) {
+            return preferred;
+        }
+        if (note) {
+            *note = QString("设备上没有 %1，校验退回 MD5").arg(remoteCommand(preferred).section(' ', 0, 0));
+        }
+        return Md5;
+    }
+
+    // 自动：两端都能算 XXH64 时用它提速，否则保持原来的 MD5；SHA-256 更慢，只在明确指定时使用
+    if (tools.contains(remoteCommand(Xxh64).section(' ', 0, 0))) {
+        return Xxh64;
+    }
+    if (note && !tools.contains("md5sum")) {
+        *note = "设备上未检测到摘要工具，按 MD5 校验";
+    }
+    return Md5;
+}
@@ -0,0 +1,70 @@
+/**
+ * @File Name: filedigest.h
+ * @brief  文件摘要算法头文件，提供 MD5 / SHA-256 / XXH64 的增量计算，以及与设备协商可用的远程摘要工具
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef FILEDIGEST_H
+#define FILEDIGEST_H
+
+#include <QString>
+#include <QByteArray>
+#include <QCryptographicHash>
+
+/**
+ * 校验用的摘要算法：
+ * - XXH64：非加密哈希，速度接近内存带宽，适合大升级包的完整性校验；远程需要 xxhsum
+ * - SHA-256：抗碰撞，busybox 和 coreutils 普遍提供 sha256sum
+ * - MD5：所有设备都有 md5sum，作为老设备的兜底
+ * 选择"自动"时设备上有 xxhsum 则用 XXH64（本地总是可用），否则保持 MD5；
+ * SHA-256 只在明确指定时使用。指定的算法在设备上不可用时退回 MD5。
+ *
+ * XXH64 在本地自行实现（种子为0），结果按 xxhsum 的规范形式输出为16位十六进制。
+ */
+class FileDigest
+{
+public:
+    enum Algorithm {
+        Md5,
+        Sha256,
+        Xxh64
+    };
+
+    explicit FileDigest(Algorithm algorithm = Md5);
+
+    Algorithm algorithm() const;
+    void reset();
+    void addData(const QByteArray &data);
+    void addData(const char *data, int length);
+    QString resultHex();
+
+    // 设置中保存的名称："auto"、"xxh64"、"sha256"、"md5"
+    static QString algorithmName(Algorithm algorithm);
+    static QString displayName(Algorithm algorithm);
+    static bool fromName(const QString &name, Algorithm *algorithm);
+
+    // 从标准输入读取数据、输出 "<摘要> ..." 的远程命令
+    static QString remoteCommand(Algorithm algorithm);
+
+    // 查询设备上可用的摘要工具，以及按偏好从查询结果中选择算法
+    static QString negotiationCommand();
+    static Algorithm negotiate(const QString &preference, const QByteArray &probeOutput, QString *note);
+
+private:
+    void xxhConsume(const uchar *data, int length);
+    quint64 xxhDigest() const;
+
+    Algorithm type;
+    QCryptographicHash cryptoHash;
+
+    // XXH64 流式状态
+    quint64 accumulators[4];
+    quint64 totalLength;
+    uchar buffer[32];
+    int bufferSize;
+};
+
+#endif // FILEDIGEST_H
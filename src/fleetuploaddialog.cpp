@@ -0,0 +1,573 @@
+/**
+ * @File Name: fleetuploaddialog.cpp
+ * @brief  批量上传对话框实现，设备列表的编辑、导入与保存，以及批量上传过程的进度展示
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "fleetuploaddialog.h"
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QMessageBox>
+#include <QCloseEvent>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegExp>
+#include <QColor>
+
+FleetUploadDialog::FleetUploadDialog(QWidget *parent)
+    : QDialog(parent), fleetUploader(nullptr), defaultPort(22), defaultUsername("root")
+{
+    setWindowTitle("批量上传");
+    setModal(true);
+    resize(820, 520);
+
+    fleetUploader = new FleetUploader(this);
+    connect(fleetUploader, &FleetUploader::logMessage, this, &FleetUploadDialog::logMessage);
+    connect(fleetUploader, &FleetUploader::deviceStateChanged, this, &FleetUploadDialog::onDeviceStateChanged);
+    connect(fleetUploader, &FleetUploader::deviceProgress, this, &FleetUploadDialog::onDeviceProgress);
+    connect(fleetUploader, &FleetUploader::deviceVerified, this, &FleetUploadDialog::onDeviceVerified);
+    connect(fleetUploader, &FleetUploader::finished, this, &FleetUploadDialog::onFleetFinished);
+    connect(fleetUploader, &FleetUploader::fileMd5Ready, this, [this](const QString &md5) {
+        emit fileMd5Ready(localFilePath, md5);
+    });
+
+    setupUI();
+}
+
+FleetUploadDialog::~FleetUploadDialog()
+{
+}
+
+void FleetUploadDialog::setupUI()
+{
+    mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(10);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+
+    packageLabel = new QLabel(this);
+    packageLabel->setWordWrap(true);
+    mainLayout->addWidget(packageLabel);
+
+    // 设备列表
+    deviceTable = new QTableWidget(0, ColumnCount, this);
+    deviceTable->setObjectName("deviceTable");
+    deviceTable->setHorizontalHeaderLabels(QStringList() << "IP地址" << "端口" << "用户名"
+                                           << "状态" << "进度" << "远程MD5");
+    deviceTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    deviceTable->verticalHeader()->setVisible(false);
+    deviceTable->horizontalHeader()->setSectionResizeMode(ColumnHost, QHeaderView::Stretch);
+    deviceTable->horizontalHeader()->setSectionResizeMode(ColumnProgress, QHeaderView::Stretch);
+    deviceTable->horizontalHeader()->setSectionResizeMode(ColumnMd5, QHeaderView::ResizeToContents);
+    deviceTable->setColumnWidth(ColumnPort, 60);
+    deviceTable->setColumnWidth(ColumnUser, 80);
+    deviceTable->setColumnWidth(ColumnState, 160);
+    mainLayout->addWidget(deviceTable, 1);
+
+    // 设备操作按钮
+    deviceButtonLayout = new QHBoxLayout();
+    addDeviceButton = new QPushButton("添加设备", this);
+    removeDeviceButton = new QPushButton("删除选中", this);
+    importDevicesButton = new QPushButton("导入列表...", this);
+    importDevicesButton->setToolTip("每行一台设备：IP[:端口] [用户名]，也支持逗号分隔，#开头为注释");
+
+    parallelLabel = new QLabel("同时上传:", this);
+    parallelSpinBox = new QSpinBox(this);
+    parallelSpinBox->setRange(1, 16);
+    parallelSpinBox->setValue(4);
+    parallelSpinBox->setSuffix(" 台");
+    parallelSpinBox->setToolTip("同时进行上传的设备数上限，链路带宽有限时适当调小");
+
+    relayCheckBox = new QCheckBox("设备间转发", this);
+    relayCheckBox->setToolTip("只向第一台设备上传，其余设备通过本地网络由已完成的设备转发\n"
+                              "设备之间能免密SSH登录时经SSH传输，否则由上位机直接上传（勾选允许 nc 时改用明文转发）\n"
+                              "上位机链路较慢而设备处于同一交换机时使用，每一跳都进行MD5校验");
+    relayFanoutSpinBox = new QSpinBox(this);
+    relayFanoutSpinBox->setRange(1, 8);
+    relayFanoutSpinBox->setValue(2);
+    relayFanoutSpinBox->setPrefix("每台转发 ");
+    relayFanoutSpinBox->setSuffix(" 台");
+    relayFanoutSpinBox->setEnabled(false);
+    connect(relayCheckBox, &QCheckBox::toggled, relayFanoutSpinBox, &QSpinBox::setEnabled);
+
+    // nc 转发是明文、无认证的，必须单独勾选，默认不使用
+    relayNcCheckBox = new QCheckBox("允许 nc 明文转发", this);
+    relayNcCheckBox->setToolTip("设备之间不能免密SSH登录时，使用设备自带的 nc 明文传输，无加密和认证，仅限可信局域网\n"
+                                "不勾选时这些设备由上位机直接上传");
+    relayNcCheckBox->setChecked(false);
+    relayNcCheckBox->setEnabled(false);
+    connect(relayCheckBox, &QCheckBox::toggled, relayNcCheckBox, &QCheckBox::setEnabled);
+
+    relayPortSpinBox = new QSpinBox(this);
+    relayPortSpinBox->setRange(1024, 65535);
+    relayPortSpinBox->setValue(52000);
+    relayPortSpinBox->setPrefix("nc 端口 ");
+    relayPortSpinBox->setToolTip("设备之间不能SSH登录时，nc 接收端监听的端口");
+    relayPortSpinBox->setEnabled(false);
+    connect(relayCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        relayPortSpinBox->setEnabled(checked && relayNcCheckBox->isChecked());
+    });
+    connect(relayNcCheckBox, &QCheckBox::toggled, this, [this](bool checked) {
+        relayPortSpinBox->setEnabled(checked && relayCheckBox->isChecked());
+    });
+
+    deviceButtonLayout->addWidget(addDeviceButton);
+    deviceButtonLayout->addWidget(removeDeviceButton);
+    deviceButtonLayout->addWidget(importDevicesButton);
+    deviceButtonLayout->addStretch();
+    deviceButtonLayout->addWidget(parallelLabel);
+    deviceButtonLayout->addWidget(parallelSpinBox);
+    deviceButtonLayout->addWidget(relayCheckBox);
+    deviceButtonLayout->addWidget(relayFanoutSpinBox);
+    deviceButtonLayout->addWidget(relayNcCheckBox);
+    deviceButtonLayout->addWidget(relayPortSpinBox);
+    mainLayout->addLayout(deviceButtonLayout);
+
+    summaryLabel = new QLabel(this);
+    mainLayout->addWidget(summaryLabel);
+
+    // 底部按钮
+    buttonLayout = new QHBoxLayout();
+    startButton = new QPushButton("开始批量上传", this);
+    startButton->setObjectName("startButton");
+    startButton->setMinimumWidth(120);
+    cancelButton = new QPushButton("取消上传", this);
+    cancelButton->setEnabled(false);
+    closeButton = new QPushButton("关闭", this);
+
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(startButton);
+    buttonLayout->addWidget(cancelButton);
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(addDeviceButton, &QPushButton::clicked, this, &FleetUploadDialog::onAddDevice);
+    connect(removeDeviceButton, &QPushButton::clicked, this, &FleetUploadDialog::onRemoveDevices);
+    connect(importDevicesButton, &QPushButton::clicked, this, &FleetUploadDialog::onImportDevices);
+    connect(startButton, &QPushButton::clicked, this, &FleetUploadDialog::onStart);
+    connect(cancelButton, &QPushButton::clicked, this, &FleetUploadDialog::onCancel);
+    connect(closeButton, &QPushButton::clicked, this, &FleetUploadDialog::reject);
+}
+
+void FleetUploadDialog::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+    fleetUploader->setLocalFile(filePath);
+    packageLabel->setText(QString("升级包: %1\n目标路径: %2")
+                          .arg(QFileInfo(localFilePath).fileName()).arg(remoteFilePath));
+}
+
+void FleetUploadDialog::setRemoteFile(const QString &remoteFilePath)
+{
+    this->remoteFilePath = remoteFilePath;
+    fleetUploader->setRemoteFile(remoteFilePath);
+    packageLabel->setText(QString("升级包: %1\n目标路径: %2")
+                          .arg(QFileInfo(localFilePath).fileName()).arg(remoteFilePath));
+}
+
+void FleetUploadDialog::setSshOptions(const QStringList &options)
+{
+    fleetUploader->setSshOptions(options);
+}
+
+void FleetUploadDialog::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    fleetUploader->setSshEnvironment(environment);
+}
+
+void FleetUploadDialog::setStateDirectory(const QString &dirPath)
+{
+    fleetUploader->setStateDirectory(dirPath);
+}
+
+void FleetUploadDialog::setExpectedMd5(const QString &md5)
+{
+    fleetUploader->setExpectedMd5(md5);
+}
+
+void FleetUploadDialog::setDeltaEnabled(bool enabled)
+{
+    fleetUploader->setDeltaEnabled(enabled);
+}
+
+void FleetUploadDialog::setCompressionEnabled(bool enabled)
+{
+    fleetUploader->setCompressionEnabled(enabled);
+}
+
+void FleetUploadDialog::setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond)
+{
+    fleetUploader->setRateLimit(sharedLimiter, deviceBytesPerSecond);
+}
+
+void FleetUploadDialog::setRetryAttempts(int attempts)
+{
+    fleetUploader->setRetryAttempts(attempts);
+}
+
+void FleetUploadDialog::setDefaultDevice(const QString &host, int port, const QString &username)
+{
+    defaultHost = host;
+    defaultPort = port;
+    defaultUsername = username;
+}
+
+void FleetUploadDialog::setDeviceListFile(const QString &filePath)
+{
+    deviceListFile = filePath;
+    loadDeviceList();
+}
+
+void FleetUploadDialog::onAddDevice()
+{
+    addDeviceRow(QString(), defaultPort, defaultUsername);
+    deviceTable->setCurrentCell(deviceTable->rowCount() - 1, ColumnHost);
+    deviceTable->editItem(deviceTable->item(deviceTable->rowCount() - 1, ColumnHost));
+    updateSummary();
+}
+
+void FleetUploadDialog::onRemoveDevices()
+{
+    QList<QTableWidgetSelectionRange> ranges = deviceTable->selectedRanges();
+    for (int i = ranges.size() - 1; i >= 0; --i) {
+        for (int row = ranges[i].bottomRow(); row >= ranges[i].topRow(); --row) {
+            deviceTable->removeRow(row);
+        }
+    }
+    updateSummary();
+}
+
+void FleetUploadDialog::onImportDevices()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, "导入设备列表",
+        QFileInfo(deviceListFile).absolutePath(), "设备列表 (*.txt *.csv);;所有文件 (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "导入失败", QString("无法打开文件: %1").arg(file.errorString()));
+        return;
+    }
+
+    int imported = 0;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        // 支持 "IP[:端口] [用户名]" 以及 "IP,端口,用户名" 两种格式
+        QStringList fields = line.split(QRegExp("[,;\\s]+"), QString::SkipEmptyParts);
+        QString host = fields.value(0);
+        int port = defaultPort;
+        QString username = defaultUsername;
+
+        if (host.contains(':')) {
+            port = host.section(':', 1, 1).toInt();
+            host = host.section(':', 0, 0);
+            if (fields.size() > 1) {
+                username = fields[1];
+            }
+        } else if (fields.size() > 1) {
+            bool ok = false;
+            int value = fields[1].toInt(&ok);
+            if (ok) {
+                port = value;
+                if (fields.size() > 2) {
+                    username = fields[2];
+                }
+            } else {
+                username = fields[1];
+            }
+        }
+
+        if (host.isEmpty() || port <= 0 || port > 65535) {
+            continue;
+        }
+        addDeviceRow(host, port, username);
+        imported++;
+    }
+
+    emit logMessage(QString("[批量上传] 从 %1 导入 %2 台设备").arg(QFileInfo(fileName).fileName()).arg(imported));
+    updateSummary();
+}
+
+void FleetUploadDialog::onStart()
+{
+    if (fleetUploader->isRunning()) {
+        return;
+    }
+
+    if (!QFileInfo(localFilePath).isFile()) {
+        QMessageBox::warning(this, "批量上传", "请先在主窗口选择要上传的文件");
+        return;
+    }
+
+    QString errorMessage;
+    QList<FleetUploader::Device> devices = collectDevices(&errorMessage);
+    if (!errorMessage.isEmpty()) {
+        QMessageBox::warning(this, "设备列表错误", errorMessage);
+        return;
+    }
+    if (devices.isEmpty()) {
+        QMessageBox::warning(this, "批量上传", "请先添加或导入设备");
+        return;
+    }
+
+    saveDeviceList();
+
+    // 重置每行的状态显示
+    for (int row = 0; row < deviceTable->rowCount(); ++row) {
+        deviceTable->item(row, ColumnState)->setText(FleetUploader::stateText(FleetUploader::DevicePending));
+        deviceTable->item(row, ColumnMd5)->setText(QString());
+        QProgressBar *bar = qobject_cast<QProgressBar*>(deviceTable->cellWidget(row, ColumnProgress));
+        if (bar) {
+            bar->setValue(0);
+        }
+    }
+
+    setEditing(false);
+    fleetUploader->setDevices(devices);
+    fleetUploader->setMaxParallel(parallelSpinBox->value());
+    fleetUploader->setRelayEnabled(relayCheckBox->isChecked());
+    fleetUploader->setRelayFanout(relayFanoutSpinBox->value());
+    fleetUploader->setRelayPort(relayPortSpinBox->value());
+    fleetUploader->setRelayNcAllowed(relayNcCheckBox->isChecked());
+    fleetUploader->start();
+    updateSummary();
+}
+
+void FleetUploadDialog::onCancel()
+{
+    fleetUploader->cancel();
+}
+
+void FleetUploadDialog::onDeviceStateChanged(int index, FleetUploader::DeviceState state, const QString &detail)
+{
+    if (index >= deviceTable->rowCount()) {
+        return;
+    }
+
+    QString text = FleetUploader::stateText(state);
+    if (!detail.isEmpty()) {
+        text += QString(" - %1").arg(detail);
+    }
+
+    QTableWidgetItem *item = deviceTable->item(index, ColumnState);
+    item->setText(text);
+    item->setToolTip(detail);
+    if (state == FleetUploader::DeviceSucceeded) {
+        item->setForeground(QColor("#2e7d32"));
+    } else if (state == FleetUploader::DeviceFailed) {
+        item->setForeground(QColor("#c62828"));
+    } else {
+        item->setForeground(palette().color(QPalette::Text));
+    }
+    updateSummary();
+}
+
+void FleetUploadDialog::onDeviceProgress(int index, qint64 bytesSent, qint64 totalBytes)
+{
+    QProgressBar *bar = qobject_cast<QProgressBar*>(deviceTable->cellWidget(index, ColumnProgress));
+    if (bar && totalBytes > 0) {
+        bar->setValue(static_cast<int>(bytesSent * 100 / totalBytes));
+    }
+}
+
+void FleetUploadDialog::onDeviceVerified(int index, bool matched, const QString &remoteMd5)
+{
+    QTableWidgetItem *item = deviceTable->item(index, ColumnMd5);
+    item->setText(remoteMd5);
+    item->setForeground(matched ? QColor("#2e7d32") : QColor("#c62828"));
+}
+
+void FleetUploadDialog::onFleetFinished(int succeeded, int failed)
+{
+    setEditing(true);
+    updateSummary();
+
+    if (failed == 0) {
+        QMessageBox::information(this, "批量上传完成",
+            QString("全部 %1 台设备上传并通过MD5校验").arg(succeeded));
+    } else {
+        QMessageBox::warning(this, "批量上传完成",
+            QString("成功 %1 台，失败 %2 台\n失败的设备可再次点击'开始批量上传'，已上传的分块会续传")
+            .arg(succeeded).arg(failed));
+    }
+}
+
+void FleetUploadDialog::closeEvent(QCloseEvent *event)
+{
+    if (fleetUploader->isRunning()) {
+        event->ignore();
+        reject();
+        return;
+    }
+    saveDeviceList();
+    QDialog::closeEvent(event);
+}
+
+void FleetUploadDialog::reject()
+{
+    if (fleetUploader->isRunning()) {
+        QMessageBox::StandardButton reply = QMessageBox::question(this, "批量上传",
+            "批量上传仍在进行中，确定要取消并关闭吗？", QMessageBox::Yes | QMessageBox::No);
+        if (reply != QMessageBox::Yes) {
+            return;
+        }
+        fleetUploader->cancel();
+    }
+    saveDeviceList();
+    QDialog::reject();
+}
+
+void FleetUploadDialog::addDeviceRow(const QString &host, int port, const QString &username)
+{
+    int row = deviceTable->rowCount();
+    deviceTable->insertRow(row);
+
+    deviceTable->setItem(row, ColumnHost, new QTableWidgetItem(host));
+    deviceTable->setItem(row, ColumnPort, new QTableWidgetItem(QString::number(port)));
+    deviceTable->setItem(row, ColumnUser, new QTableWidgetItem(username));
+
+    // 状态、进度和MD5列只读
+    QTableWidgetItem *stateItem = new QTableWidgetItem(QString());
+    stateItem->setFlags(stateItem->flags() & ~Qt::ItemIsEditable);
+    deviceTable->setItem(row, ColumnState, stateItem);
+
+    QTableWidgetItem *md5Item = new QTableWidgetItem(QString());
+    md5Item->setFlags(md5Item->flags() & ~Qt::ItemIsEditable);
+    deviceTable->setItem(row, ColumnMd5, md5Item);
+
+    QProgressBar *bar = new QProgressBar(deviceTable);
+    bar->setRange(0, 100);
+    bar->setValue(0);
+    bar->setMaximumHeight(18);
+    deviceTable->setCellWidget(row, ColumnProgress, bar);
+}
+
+QList<FleetUploader::Device> FleetUploadDialog::collectDevices(QString *errorMessage) const
+{
+    QList<FleetUploader::Device> devices;
+
+    for (int row = 0; row < deviceTable->rowCount(); ++row) {
+        FleetUploader::Device device;
+        device.host = deviceTable->item(row, ColumnHost)->text().trimmed();
+        device.port = deviceTable->item(row, ColumnPort)->text().trimmed().toInt();
+        device.username = deviceTable->item(row, ColumnUser)->text().trimmed();
+
+        if (device.host.isEmpty() || device.username.isEmpty() || device.port <= 0 || device.port > 65535) {
+            *errorMessage = QString("第 %1 行设备信息不完整（IP、端口、用户名均不能为空）").arg(row + 1);
+            return QList<FleetUploader::Device>();
+        }
+        devices.append(device);
+    }
+    return devices;
+}
+
+void FleetUploadDialog::loadDeviceList()
+{
+    deviceTable->setRowCount(0);
+
+    QFile file(deviceListFile);
+    if (file.open(QIODevice::ReadOnly)) {
+        QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+        relayCheckBox->setChecked(root.value("relay").toBool(false));
+        relayFanoutSpinBox->setValue(root.value("relayFanout").toInt(2));
+        relayNcCheckBox->setChecked(root.value("relayNc").toBool(false));
+        relayPortSpinBox->setValue(root.value("relayPort").toInt(52000));
+
+        QJsonArray devices = root.value("devices").toArray();
+        for (int i = 0; i < devices.size(); ++i) {
+            QJsonObject obj = devices.at(i).toObject();
+            addDeviceRow(obj.value("host").toString(),
+                         obj.value("port").toInt(22),
+                         obj.value("username").toString("root"));
+        }
+    }
+
+    // 没有保存的列表时，以主窗口当前设备作为第一行
+    if (deviceTable->rowCount() == 0 && !defaultHost.isEmpty()) {
+        addDeviceRow(defaultHost, defaultPort, defaultUsername);
+    }
+    updateSummary();
+}
+
+void FleetUploadDialog::saveDeviceList()
+{
+    if (deviceListFile.isEmpty()) {
+        return;
+    }
+
+    QJsonArray devices;
+    for (int row = 0; row < deviceTable->rowCount(); ++row) {
+        QString host = deviceTable->item(row, ColumnHost)->text().trimmed();
+        if (host.isEmpty()) {
+            continue;
+        }
+        QJsonObject obj;
+        obj["host"] = host;
+        obj["port"] = deviceTable->item(row, ColumnPort)->text().trimmed().toInt();
+        obj["username"] = deviceTable->item(row, ColumnUser)->text().trimmed();
+        devices.append(obj);
+    }
+
+    QJsonObject root;
+    root["devices"] = devices;
+    root["relay"] = relayCheckBox->isChecked();
+    root["relayFanout"] = relayFanoutSpinBox->value();
+    root["relayNc"] = relayNcCheckBox->isChecked();
+    root["relayPort"] = relayPortSpinBox->value();
+
+    QFile file(deviceListFile);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(root).toJson());
+        file.close();
+    }
+}
+
+void FleetUploadDialog::setEditing(bool enabled)
+{
+    deviceTable->setEditTriggers(enabled ? QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed
+                                         : QAbstractItemView::NoEditTriggers);
+    addDeviceButton->setEnabled(enabled);
+    removeDeviceButton->setEnabled(enabled);
+    importDevicesButton->setEnabled(enabled);
+    parallelSpinBox->setEnabled(enabled);
+    relayCheckBox->setEnabled(enabled);
+    relayFanoutSpinBox->setEnabled(enabled && relayCheckBox->isChecked());
+    relayNcCheckBox->setEnabled(enabled && relayCheckBox->isChecked());
+    relayPortSpinBox->setEnabled(enabled && relayCheckBox->isChecked() && relayNcCheckBox->isChecked());
+    startButton->setEnabled(enabled);
+    cancelButton->setEnabled(!enabled);
+}
+
+void FleetUploadDialog::updateSummary()
+{
+    if (!fleetUploader->isRunning() && fleetUploader->deviceCount() == 0) {
+        summaryLabel->setText(QString("共 %1 台设备").arg(deviceTable->rowCount()));
+        return;
+    }
+
+    int counts[FleetUploader::DeviceCancelled + 1] = { 0 };
+    for (int i = 0; i < fleetUploader->deviceCount(); ++i) {
+        counts[fleetUploader->deviceState(i)]++;
+    }
+
+    summaryLabel->setText(QString("共 %1 台设备：等待 %2，上传中 %3，校验中 %4，成功 %5，失败 %6")
+                          .arg(fleetUploader->deviceCount())
+                          .arg(counts[FleetUploader::DevicePending])
+                          .arg(counts[FleetUploader::DeviceUploading])
+                          .arg(counts[FleetUploader::DeviceVerifying])
+                          .arg(counts[FleetUploader::DeviceSucceeded])
+                          .arg(counts[FleetUploader::DeviceFailed] + counts[FleetUploader::DeviceCancelled]));
+}
@@ -0,0 +1,115 @@
+/**
+ * @File Name: fleetuploaddialog.h
+ * @brief  批量上传对话框头文件，管理设备列表并显示每台设备的上传进度和MD5校验结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef FLEETUPLOADDIALOG_H
+#define FLEETUPLOADDIALOG_H
+
+#include <QDialog>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QTableWidget>
+#include <QProgressBar>
+#include <QList>
+#include "fleetuploader.h"
+
+class FleetUploadDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit FleetUploadDialog(QWidget *parent = nullptr);
+    ~FleetUploadDialog();
+
+    // 上传参数（由主窗口根据当前设置传入）
+    void setLocalFile(const QString &filePath);
+    void setRemoteFile(const QString &remoteFilePath);
+    void setSshOptions(const QStringList &options);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setStateDirectory(const QString &dirPath);
+    void setExpectedMd5(const QString &md5);
+    void setDeltaEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+    void setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond);
+    void setRetryAttempts(int attempts);
+    void setDefaultDevice(const QString &host, int port, const QString &username);
+    void setDeviceListFile(const QString &filePath);
+
+signals:
+    void logMessage(const QString &message);
+    void fileMd5Ready(const QString &filePath, const QString &md5);
+
+protected:
+    void closeEvent(QCloseEvent *event) override;
+    void reject() override;
+
+private slots:
+    void onAddDevice();
+    void onRemoveDevices();
+    void onImportDevices();
+    void onStart();
+    void onCancel();
+    void onDeviceStateChanged(int index, FleetUploader::DeviceState state, const QString &detail);
+    void onDeviceProgress(int index, qint64 bytesSent, qint64 totalBytes);
+    void onDeviceVerified(int index, bool matched, const QString &remoteMd5);
+    void onFleetFinished(int succeeded, int failed);
+
+private:
+    void setupUI();
+    void addDeviceRow(const QString &host, int port, const QString &username);
+    QList<FleetUploader::Device> collectDevices(QString *errorMessage) const;
+    void loadDeviceList();
+    void saveDeviceList();
+    void setEditing(bool enabled);
+    void updateSummary();
+
+    enum Column {
+        ColumnHost,
+        ColumnPort,
+        ColumnUser,
+        ColumnState,
+        ColumnProgress,
+        ColumnMd5,
+        ColumnCount
+    };
+
+    // UI组件
+    QVBoxLayout *mainLayout;
+    QLabel *packageLabel;
+    QTableWidget *deviceTable;
+    QHBoxLayout *deviceButtonLayout;
+    QPushButton *addDeviceButton;
+    QPushButton *removeDeviceButton;
+    QPushButton *importDevicesButton;
+    QLabel *parallelLabel;
+    QSpinBox *parallelSpinBox;
+    QCheckBox *relayCheckBox;
+    QSpinBox *relayFanoutSpinBox;
+    QCheckBox *relayNcCheckBox;
+    QSpinBox *relayPortSpinBox;
+    QLabel *summaryLabel;
+    QHBoxLayout *buttonLayout;
+    QPushButton *startButton;
+    QPushButton *cancelButton;
+    QPushButton *closeButton;
+
+    // 上传参数
+    FleetUploader *fleetUploader;
+    QString localFilePath;
+    QString remoteFilePath;
+    QString deviceListFile;
+    QString defaultHost;
+    int defaultPort;
+    QString defaultUsername;
+};
+
+#endif // FLEETUPLOADDIALOG_H
@@ -0,0 +1,906 @@
+/**
+ * @File Name: fleetuploader.cpp
+ * @brief  批量上传调度器实现，按并发上限依次启动各设备的分块上传，完成后逐台校验MD5
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "fleetuploader.h"
+#include "chunkeduploader.h"
+#include "sharedchunksource.h"
+#include "sshutils.h"
+#include <QProcessEnvironment>
+#include <QFileInfo>
+
+// 设备之间SSH登录检查的输出标记
+static const char *RELAY_SSH_MARKER = "@@RELAY_SSH";
+
+// nc 接收端等待连接的最长时间（秒），超时仍没有收到数据则结束监听
+static const int RELAY_LISTEN_TIMEOUT = 60;
+
+FleetUploader::FleetUploader(QObject *parent)
+    : QObject(parent), chunkSource(nullptr), sshEnvironment(QProcessEnvironment::systemEnvironment()), deltaEnabled(false), compressionEnabled(false), maxParallel(4),
+      rateLimiter(nullptr), deviceRateLimit(0), retryAttempts(RetryPolicy::DEFAULT_MAX_ATTEMPTS), relayEnabled(false), relayFanout(2), relayPort(52000), relayNcAllowed(false), packageSize(0), running(false), cancelRequested(false)
+{
+}
+
+FleetUploader::~FleetUploader()
+{
+    // 上传器在共享数据源之前销毁，确保它们先从数据源注销
+    for (int i = 0; i < runs.size(); ++i) {
+        delete runs[i].uploader;
+        runs[i].uploader = nullptr;
+        releaseRun(i);
+    }
+    delete chunkSource;
+}
+
+void FleetUploader::setDevices(const QList<Device> &devices)
+{
+    if (running) {
+        return;
+    }
+    this->devices = devices;
+}
+
+void FleetUploader::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+}
+
+void FleetUploader::setRemoteFile(const QString &remoteFilePath)
+{
+    this->remoteFilePath = remoteFilePath;
+}
+
+void FleetUploader::setSshOptions(const QStringList &options)
+{
+    sshOptions = options;
+}
+
+void FleetUploader::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+void FleetUploader::setStateDirectory(const QString &dirPath)
+{
+    stateDirectory = dirPath;
+}
+
+void FleetUploader::setExpectedMd5(const QString &md5)
+{
+    expectedMd5 = md5.trimmed().toLower();
+}
+
+void FleetUploader::setDeltaEnabled(bool enabled)
+{
+    deltaEnabled = enabled;
+}
+
+void FleetUploader::setCompressionEnabled(bool enabled)
+{
+    compressionEnabled = enabled;
+}
+
+void FleetUploader::setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond)
+{
+    // 全局限速由所有设备共享，设备级限速每台设备各自一个
+    rateLimiter = sharedLimiter;
+    deviceRateLimit = deviceBytesPerSecond;
+}
+
+void FleetUploader::setRetryAttempts(int attempts)
+{
+    retryAttempts = qMax(0, attempts);
+}
+
+void FleetUploader::setMaxParallel(int count)
+{
+    maxParallel = qMax(1, count);
+}
+
+void FleetUploader::setRelayEnabled(bool enabled)
+{
+    relayEnabled = enabled;
+}
+
+void FleetUploader::setRelayFanout(int count)
+{
+    relayFanout = qMax(1, count);
+}
+
+void FleetUploader::setRelayPort(int port)
+{
+    if (port > 0 && port < 65536) {
+        relayPort = port;
+    }
+}
+
+void FleetUploader::setRelayNcAllowed(bool allowed)
+{
+    relayNcAllowed = allowed;
+}
+
+int FleetUploader::deviceCount() const
+{
+    return devices.size();
+}
+
+const FleetUploader::Device &FleetUploader::device(int index) const
+{
+    return devices.at(index);
+}
+
+FleetUploader::DeviceState FleetUploader::deviceState(int index) const
+{
+    if (index < 0 || index >= runs.size()) {
+        return DevicePending;
+    }
+    return runs[index].state;
+}
+
+QString FleetUploader::fileMd5() const
+{
+    return md5Hex;
+}
+
+bool FleetUploader::isRunning() const
+{
+    return running;
+}
+
+void FleetUploader::start()
+{
+    if (running || devices.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < runs.size(); ++i) {
+        releaseRun(i);
+    }
+
+    runs.clear();
+    for (int i = 0; i < devices.size(); ++i) {
+        DeviceRun run;
+        run.state = DevicePending;
+        run.uploader = nullptr;
+        run.verifyProcess = nullptr;
+        run.awaitingMd5 = false;
+        run.relaySource = -1;
+        run.receiveProcess = nullptr;
+        run.sendProcess = nullptr;
+        run.receiveDone = false;
+        run.sendDone = false;
+        run.relayProbing = false;
+        run.directOnly = false;
+        run.retry.setMaxAttempts(retryAttempts);
+        run.retryTimer = nullptr;
+        runs.append(run);
+    }
+    packageSize = QFileInfo(localFilePath).size();
+
+    md5Hex = expectedMd5;
+
+    // 本地文件由共享数据源统一读取，打开失败时各设备退回单独读取
+    if (chunkSource) {
+        chunkSource->deleteLater();
+    }
+    chunkSource = new SharedChunkSource(localFilePath, this);
+    connect(chunkSource, &SharedChunkSource::logMessage, this, &FleetUploader::logMessage);
+    connect(chunkSource, &SharedChunkSource::md5Ready, this, &FleetUploader::onSourceMd5Ready);
+    QString sourceError;
+    if (!chunkSource->open(&sourceError)) {
+        emit logMessage(QString("[批量上传] %1，各设备将单独读取本地文件").arg(sourceError));
+        chunkSource->deleteLater();
+        chunkSource = nullptr;
+    }
+    running = true;
+    cancelRequested = false;
+
+    emit logMessage(QString("[批量上传] 共 %1 台设备，最多同时上传 %2 台")
+                   .arg(devices.size()).arg(maxParallel));
+    if (relayEnabled) {
+        emit logMessage(QString("[批量上传] 转发模式：只上传一台种子设备，其余由设备之间转发 (每台最多转发 %1 台，%2)")
+                       .arg(relayFanout)
+                       .arg(relayNcAllowed ? QString("不能SSH登录时经 nc 端口 %1 明文转发").arg(relayPort)
+                                           : QString("仅经设备间SSH转发")));
+    }
+
+    for (int i = 0; i < devices.size(); ++i) {
+        setState(i, DevicePending);
+    }
+    scheduleNext();
+}
+
+void FleetUploader::cancel()
+{
+    if (!running) {
+        return;
+    }
+
+    cancelRequested = true;
+    emit logMessage("[批量上传] 用户取消，正在停止所有设备的上传...");
+
+    for (int i = 0; i < runs.size(); ++i) {
+        DeviceState state = runs[i].state;
+        if (state == DevicePending || state == DeviceUploading || state == DeviceVerifying) {
+            bool relaying = runs[i].receiveProcess || runs[i].sendProcess;
+            releaseRun(i);
+            if (relaying) {
+                cleanupRelayTarget(i);
+            }
+            setState(i, DeviceCancelled);
+        }
+    }
+    checkFinished();
+}
+
+QString FleetUploader::stateText(DeviceState state)
+{
+    switch (state) {
+    case DevicePending:
+        return "等待中";
+    case DeviceUploading:
+        return "上传中";
+    case DeviceVerifying:
+        return "校验中";
+    case DeviceSucceeded:
+        return "成功";
+    case DeviceFailed:
+        return "失败";
+    case DeviceCancelled:
+        return "已取消";
+    }
+    return QString();
+}
+
+void FleetUploader::scheduleNext()
+{
+    if (cancelRequested) {
+        return;
+    }
+
+    if (relayEnabled) {
+        scheduleRelay();
+        checkFinished();
+        return;
+    }
+
+    for (int i = 0; i < runs.size() && activeCount() < maxParallel; ++i) {
+        if (runs[i].state == DevicePending && !runs[i].retryTimer) {
+            startDevice(i);
+        }
+    }
+    checkFinished();
+}
+
+void FleetUploader::scheduleRelay()
+{
+    // 已持有文件（或正在获取文件）的设备存在时，其余设备等待转发而不占用上位机链路
+    bool holderExists = false;
+    for (int i = 0; i < runs.size(); ++i) {
+        DeviceState state = runs[i].state;
+        if (state == DeviceUploading || state == DeviceVerifying || state == DeviceSucceeded) {
+            holderExists = true;
+            break;
+        }
+    }
+
+    for (int i = 0; i < runs.size() && activeCount() < maxParallel; ++i) {
+        if (runs[i].state != DevicePending || runs[i].retryTimer) {
+            continue;
+        }
+
+        if (!runs[i].directOnly) {
+            int source = findRelaySource();
+            if (source >= 0) {
+                startRelay(source, i);
+                holderExists = true;
+                continue;
+            }
+        }
+
+        // 上位机同一时间只直接上传一台：种子设备，或转发失败的设备
+        if (directUploadCount() == 0 && (runs[i].directOnly || !holderExists)) {
+            startDevice(i);
+            holderExists = true;
+        }
+    }
+}
+
+int FleetUploader::findRelaySource() const
+{
+    // 选择转发任务最少的已校验设备，使分发树尽量均衡
+    int best = -1;
+    int bestCount = relayFanout;
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs[i].state != DeviceSucceeded) {
+            continue;
+        }
+        int count = activeRelayCount(i);
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+    return best;
+}
+
+int FleetUploader::activeRelayCount(int sourceIndex) const
+{
+    int count = 0;
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs[i].relaySource == sourceIndex
+                && (runs[i].state == DeviceUploading || runs[i].state == DeviceVerifying)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int FleetUploader::directUploadCount() const
+{
+    int count = 0;
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs[i].uploader) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void FleetUploader::startRelay(int sourceIndex, int index)
+{
+    const Device &source = devices.at(sourceIndex);
+    const Device &target = devices.at(index);
+    DeviceRun &run = runs[index];
+
+    run.relaySource = sourceIndex;
+    run.receiveDone = false;
+    run.sendDone = false;
+    run.relayProbing = true;
+    setState(index, DeviceUploading, QString("由 %1 转发").arg(source.host));
+    emit deviceProgress(index, 0, packageSize);
+
+    // 先检查源设备能否免密SSH登录目标设备（BatchMode 下不会等待输入密码），能登录时走SSH
+    QString probeCommand = QString("if command -v ssh >/dev/null 2>&1 && "
+                                   "ssh -o BatchMode=yes -o ConnectTimeout=10 -o StrictHostKeyChecking=no "
+                                   "-o UserKnownHostsFile=/dev/null -p %1 %2@%3 true </dev/null >/dev/null 2>&1; "
+                                   "then echo %4; fi")
+                          .arg(target.port)
+                          .arg(target.username)
+                          .arg(target.host)
+                          .arg(RELAY_SSH_MARKER);
+
+    run.sendProcess = new QProcess(this);
+    run.sendProcess->setProcessEnvironment(sshEnvironment);
+    connect(run.sendProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, index](int exitCode, QProcess::ExitStatus exitStatus) {
+        onRelayProbeFinished(index, exitCode, exitStatus);
+    });
+    connect(run.sendProcess, &QProcess::errorOccurred, this, [this, index](QProcess::ProcessError error) {
+        // ssh 程序无法启动时不会收到 finished，按 ssh 失败处理
+        if (error == QProcess::FailedToStart) {
+            onRelayProbeFinished(index, 255, QProcess::NormalExit);
+        }
+    });
+    run.sendProcess->start("ssh", buildSshArguments(source, probeCommand));
+}
+
+void FleetUploader::onRelayProbeFinished(int index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    DeviceRun &run = runs[index];
+    QProcess *process = run.sendProcess;
+    if (!process || !run.relayProbing || run.state != DeviceUploading) {
+        return;
+    }
+
+    QString output = QString::fromUtf8(process->readAllStandardOutput());
+    QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+    run.sendProcess = nullptr;
+    run.relayProbing = false;
+    process->deleteLater();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        fallBackToDirect(index, QString("无法登录源设备%1").arg(error.isEmpty() ? "" : ": " + error));
+        scheduleNext();
+        return;
+    }
+
+    if (output.contains(RELAY_SSH_MARKER)) {
+        startSshHop(index);
+    } else if (relayNcAllowed) {
+        startNcHop(index);
+    } else {
+        fallBackToDirect(index, "源设备不能免密SSH登录目标设备，未允许 nc 明文转发");
+        scheduleNext();
+    }
+}
+
+void FleetUploader::startSshHop(int index)
+{
+    const Device &source = devices.at(runs[index].relaySource);
+    const Device &target = devices.at(index);
+    DeviceRun &run = runs[index];
+
+    emit logMessage(QString("[转发] %1 -> %2 (设备间SSH)").arg(source.host).arg(target.host));
+
+    // 目标设备上写入临时文件，大小正确后再替换目标文件；cat 的进程号记录下来，失败或取消时用于清理
+    QString relayFile = SshUtils::shellQuote(remoteFilePath + ".relay");
+    QString pidFile = SshUtils::shellQuote(remoteFilePath + ".relay.pid");
+    QString receiveCommand = QString("mkdir -p %1 && rm -f %2 && sh -c 'echo $$ > \"$1\"; exec cat' sh %3 > %2; "
+                                     "rc=$?; rm -f %3; [ $rc -eq 0 ] && [ $(wc -c < %2) -eq %4 ] && mv -f %2 %5 "
+                                     "|| { rm -f %2; exit 1; }")
+                            .arg(SshUtils::shellQuote(QFileInfo(remoteFilePath).path()))
+                            .arg(relayFile)
+                            .arg(pidFile)
+                            .arg(packageSize)
+                            .arg(SshUtils::shellQuote(remoteFilePath));
+
+    QString sendCommand = QString("ssh -o BatchMode=yes -o ConnectTimeout=10 -o StrictHostKeyChecking=no "
+                                  "-o UserKnownHostsFile=/dev/null -p %1 %2@%3 %4 < %5")
+                         .arg(target.port)
+                         .arg(target.username)
+                         .arg(target.host)
+                         .arg(SshUtils::shellQuote(receiveCommand))
+                         .arg(SshUtils::shellQuote(remoteFilePath));
+
+    // 没有单独的接收进程，源设备上的SSH命令成功即表示目标设备已替换文件
+    run.receiveDone = true;
+    run.sendProcess = createRelayProcess(index, false);
+    run.sendProcess->start("ssh", buildSshArguments(source, sendCommand));
+}
+
+void FleetUploader::startNcHop(int index)
+{
+    const Device &source = devices.at(runs[index].relaySource);
+    const Device &target = devices.at(index);
+    DeviceRun &run = runs[index];
+
+    emit logMessage(QString("[转发] %1 -> %2 (nc 端口 %3，明文传输)").arg(source.host).arg(target.host).arg(relayPort));
+
+    QString remoteFile = SshUtils::shellQuote(remoteFilePath);
+    QString relayFile = SshUtils::shellQuote(remoteFilePath + ".relay");
+    QString pidFile = SshUtils::shellQuote(remoteFilePath + ".relay.pid");
+
+    // 接收端：记录监听进程号，超时没有收到数据时由后台计时结束监听；大小正确后再替换目标文件
+    QString receiveCommand = QString("mkdir -p %1 && rm -f %2 %3 || exit 1; "
+                                     "( sleep %4; [ -s %2 ] || kill $(cat %3) ) >/dev/null 2>&1 & w=$!; "
+                                     "sh -c 'echo $$ > \"$1\"; exec nc -l -p %5' sh %3 > %2; "
+                                     "rc=$?; rm -f %3; kill $w 2>/dev/null; "
+                                     "[ $rc -eq 0 ] && [ $(wc -c < %2) -eq %6 ] && mv -f %2 %7 || { rm -f %2; exit 1; }")
+                            .arg(SshUtils::shellQuote(QFileInfo(remoteFilePath).path()))
+                            .arg(relayFile)
+                            .arg(pidFile)
+                            .arg(RELAY_LISTEN_TIMEOUT)
+                            .arg(relayPort)
+                            .arg(packageSize)
+                            .arg(remoteFile);
+
+    // 发送端：接收端可能还没开始监听，连接失败时每秒重试，最多10次；
+    // 接收端被结束后连接被拒绝，发送端也会在重试用完后退出
+    QString sendCommand = QString("i=0; while ! nc -w 10 %1 %2 < %3; do i=$((i+1)); "
+                                  "[ $i -ge 10 ] && exit 1; sleep 1; done")
+                         .arg(target.host)
+                         .arg(relayPort)
+                         .arg(remoteFile);
+
+    run.receiveProcess = createRelayProcess(index, true);
+    run.sendProcess = createRelayProcess(index, false);
+    run.receiveProcess->start("ssh", buildSshArguments(target, receiveCommand));
+    run.sendProcess->start("ssh", buildSshArguments(source, sendCommand));
+}
+
+QProcess *FleetUploader::createRelayProcess(int index, bool receiver)
+{
+    QProcess *process = new QProcess(this);
+    process->setProcessEnvironment(sshEnvironment);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, index, receiver](int exitCode, QProcess::ExitStatus exitStatus) {
+        onRelayProcessFinished(index, receiver, exitCode, exitStatus);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, index, receiver](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            onRelayProcessFinished(index, receiver, 255, QProcess::NormalExit);
+        }
+    });
+    return process;
+}
+
+void FleetUploader::cleanupRelayTarget(int index)
+{
+    // 结束本地SSH不会结束设备上的监听/接收进程：按记录的进程号结束它并删除临时文件。
+    // 清理命令独立运行，不等待结果
+    QString relayFile = SshUtils::shellQuote(remoteFilePath + ".relay");
+    QString pidFile = SshUtils::shellQuote(remoteFilePath + ".relay.pid");
+    QString cleanupCommand = QString("[ -f %1 ] && kill $(cat %1) 2>/dev/null; rm -f %1 %2")
+                            .arg(pidFile)
+                            .arg(relayFile);
+
+    QProcess cleanup;
+    cleanup.setProcessEnvironment(sshEnvironment);
+    cleanup.setProgram("ssh");
+    cleanup.setArguments(buildSshArguments(devices.at(index), cleanupCommand));
+    cleanup.startDetached();
+}
+
+void FleetUploader::onRelayProcessFinished(int index, bool receiver, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    DeviceRun &run = runs[index];
+    QProcess *process = receiver ? run.receiveProcess : run.sendProcess;
+    if (!process || run.state != DeviceUploading) {
+        return;
+    }
+
+    QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+    if (receiver) {
+        run.receiveProcess = nullptr;
+    } else {
+        run.sendProcess = nullptr;
+    }
+    process->deleteLater();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        QString reason = QString("%1失败").arg(receiver ? "接收" : "发送");
+        if (!error.isEmpty()) {
+            reason += ": " + error;
+        }
+        fallBackToDirect(index, reason);
+        scheduleNext();
+        return;
+    }
+
+    if (receiver) {
+        run.receiveDone = true;
+    } else {
+        run.sendDone = true;
+    }
+
+    // 接收端确认文件大小并替换目标文件后，进入MD5校验
+    if (run.receiveDone && run.sendDone) {
+        emit deviceProgress(index, packageSize, packageSize);
+        startVerification(index);
+    }
+}
+
+void FleetUploader::fallBackToDirect(int index, const QString &reason)
+{
+    emit logMessage(QString("[转发] %1 -> %2 %3，改为由上位机直接上传")
+                   .arg(devices.at(runs[index].relaySource).host)
+                   .arg(devices.at(index).host)
+                   .arg(reason));
+
+    releaseRun(index);
+    cleanupRelayTarget(index);
+    runs[index].relaySource = -1;
+    runs[index].directOnly = true;
+    setState(index, DevicePending, "转发失败，等待直接上传");
+}
+
+void FleetUploader::startDevice(int index)
+{
+    const Device &target = devices.at(index);
+
+    ChunkedUploader *uploader = new ChunkedUploader(this);
+    uploader->setLocalFile(localFilePath);
+    uploader->setRemoteTarget(target.host, target.port, target.username, remoteFilePath);
+    uploader->setSshOptions(sshOptions);
+    uploader->setSshEnvironment(sshEnvironment);
+    uploader->setStateDirectory(stateDirectory);
+    uploader->setExpectedMd5(md5Hex);
+    uploader->setDeltaEnabled(deltaEnabled);
+    uploader->setCompressionEnabled(compressionEnabled);
+    uploader->setRateLimit(rateLimiter, deviceRateLimit);
+    uploader->setChunkSource(chunkSource);
+
+    connect(uploader, &ChunkedUploader::progressChanged, this, [this, index](qint64 bytesSent, qint64 totalBytes) {
+        emit deviceProgress(index, bytesSent, totalBytes);
+    });
+    connect(uploader, &ChunkedUploader::logMessage, this, [this, index](const QString &message) {
+        emit logMessage(QString("[%1] %2").arg(devices.at(index).host).arg(message));
+    });
+    connect(uploader, &ChunkedUploader::finished, this, [this, index](bool success, const QString &errorMessage) {
+        onDeviceUploadFinished(index, success, errorMessage);
+    });
+
+    runs[index].uploader = uploader;
+    setState(index, DeviceUploading);
+    uploader->start();
+}
+
+void FleetUploader::onDeviceUploadFinished(int index, bool success, const QString &errorMessage)
+{
+    if (runs[index].state != DeviceUploading) {
+        return;
+    }
+
+    ChunkedUploader *uploader = runs[index].uploader;
+    runs[index].uploader = nullptr;
+    QString sentMd5 = uploader->fileMd5();
+    bool skipped = uploader->skippedIdentical();
+    RetryPolicy::ErrorClass errorClass = uploader->lastErrorClass();
+    uploader->deleteLater();
+
+    if (!success) {
+        // 网络中断时重新排队，再次上传会从远程已落盘的分块续传
+        if (!scheduleRetry(index, false, errorClass, errorMessage)) {
+            setState(index, DeviceFailed, errorMessage);
+        }
+        scheduleNext();
+        return;
+    }
+    runs[index].retry.reset();
+
+    // 第一台设备上传完成后即得到文件MD5，后续设备可直接用于预检查
+    if (!sentMd5.isEmpty() && md5Hex.isEmpty()) {
+        md5Hex = sentMd5;
+        emit fileMd5Ready(md5Hex);
+    }
+
+    if (md5Hex.isEmpty() && chunkSource) {
+        // 共享数据源还没读完整个文件（例如其他设备仍在传输），MD5就绪后再校验
+        runs[index].awaitingMd5 = true;
+        setState(index, DeviceVerifying, "等待本地文件MD5");
+        chunkSource->computeMd5();
+        return;
+    }
+
+    if (skipped) {
+        // 预检查已确认远程文件MD5一致
+        runs[index].remoteMd5 = md5Hex;
+        emit deviceVerified(index, true, md5Hex);
+        setState(index, DeviceSucceeded, "文件已存在，MD5一致");
+        scheduleNext();
+        return;
+    }
+
+    startVerification(index);
+}
+
+void FleetUploader::startVerification(int index)
+{
+    setState(index, DeviceVerifying);
+
+    QProcess *process = new QProcess(this);
+    process->setProcessEnvironment(sshEnvironment);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, index](int exitCode, QProcess::ExitStatus exitStatus) {
+        onVerifyFinished(index, exitCode, exitStatus);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, index](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            onVerifyFinished(index, 255, QProcess::NormalExit);
+        }
+    });
+    runs[index].verifyProcess = process;
+
+    process->start("ssh", buildSshArguments(devices.at(index), verificationManifest().remoteCommand()));
+}
+
+DigestManifest FleetUploader::verificationManifest() const
+{
+    // 每台设备一次远程调用，结果按清单条目解析
+    DigestManifest manifest;
+    manifest.addFile(remoteFilePath, md5Hex);
+    return manifest;
+}
+
+void FleetUploader::onSourceMd5Ready(const QString &md5)
+{
+    if (!running || !md5Hex.isEmpty()) {
+        return;
+    }
+
+    md5Hex = md5;
+    if (!md5Hex.isEmpty()) {
+        emit fileMd5Ready(md5Hex);
+    }
+
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs[i].awaitingMd5 && runs[i].state == DeviceVerifying) {
+            runs[i].awaitingMd5 = false;
+            if (md5Hex.isEmpty()) {
+                setState(i, DeviceFailed, "无法计算本地文件MD5");
+            } else {
+                startVerification(i);
+            }
+        }
+    }
+    scheduleNext();
+}
+
+void FleetUploader::onVerifyFinished(int index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QProcess *process = runs[index].verifyProcess;
+    if (!process || runs[index].state != DeviceVerifying) {
+        return;
+    }
+
+    DigestManifest manifest = verificationManifest();
+    bool parsed = manifest.parseOutput(process->readAllStandardOutput());
+    QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+    QProcess::ProcessError processError = process->error();
+    runs[index].verifyProcess = nullptr;
+    process->deleteLater();
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0 || !parsed
+            || manifest.items().first().status == DigestManifest::StatusMissing) {
+        if (runs[index].relaySource >= 0) {
+            fallBackToDirect(index, "校验失败");
+        } else if (scheduleRetry(index, true, RetryPolicy::classify(exitCode, exitStatus, error, processError),
+                                 error.isEmpty() ? "无法计算远程文件MD5" : error)) {
+            return;
+        } else {
+            setState(index, DeviceFailed, error.isEmpty() ? "无法计算远程文件MD5" : error);
+        }
+        scheduleNext();
+        return;
+    }
+
+    QString remoteMd5 = manifest.items().first().actual;
+    bool matched = manifest.allMatched();
+    runs[index].remoteMd5 = remoteMd5;
+    emit deviceVerified(index, matched, remoteMd5);
+
+    if (matched) {
+        setState(index, DeviceSucceeded, "MD5校验通过");
+    } else if (runs[index].relaySource >= 0) {
+        fallBackToDirect(index, QString("MD5不一致 (远程 %1)").arg(remoteMd5));
+    } else {
+        setState(index, DeviceFailed, QString("MD5不一致 (远程 %1)").arg(remoteMd5));
+    }
+    scheduleNext();
+}
+
+bool FleetUploader::scheduleRetry(int index, bool verify, RetryPolicy::ErrorClass errorClass, const QString &reason)
+{
+    DeviceRun &run = runs[index];
+    if (cancelRequested || !run.retry.shouldRetry(errorClass)) {
+        return false;
+    }
+
+    int delayMs = run.retry.nextDelayMs();
+    emit logMessage(QString("[%1] [重试] %2: %3，%4 秒后第 %5/%6 次重试%7")
+                   .arg(devices.at(index).host)
+                   .arg(RetryPolicy::className(errorClass))
+                   .arg(reason)
+                   .arg(delayMs / 1000.0, 0, 'f', 1)
+                   .arg(run.retry.attempt())
+                   .arg(run.retry.maxAttempts())
+                   .arg(verify ? "校验" : "上传"));
+
+    run.retryTimer = new QTimer(this);
+    run.retryTimer->setSingleShot(true);
+    connect(run.retryTimer, &QTimer::timeout, this, [this, index, verify]() {
+        onRetryTimer(index, verify);
+    });
+    run.retryTimer->start(delayMs);
+
+    setState(index, verify ? DeviceVerifying : DevicePending,
+             QString("%1，等待第 %2 次重试").arg(RetryPolicy::className(errorClass)).arg(run.retry.attempt()));
+    return true;
+}
+
+void FleetUploader::onRetryTimer(int index, bool verify)
+{
+    DeviceRun &run = runs[index];
+    if (run.retryTimer) {
+        run.retryTimer->deleteLater();
+        run.retryTimer = nullptr;
+    }
+    if (cancelRequested) {
+        return;
+    }
+
+    if (verify) {
+        startVerification(index);
+    } else {
+        scheduleNext();
+    }
+}
+
+void FleetUploader::setState(int index, DeviceState state, const QString &detail)
+{
+    runs[index].state = state;
+
+    if (state == DeviceSucceeded || state == DeviceFailed) {
+        emit logMessage(QString("[批量上传] %1: %2%3")
+                       .arg(devices.at(index).host)
+                       .arg(stateText(state))
+                       .arg(detail.isEmpty() ? "" : "，" + detail));
+    }
+    emit deviceStateChanged(index, state, detail);
+}
+
+void FleetUploader::releaseRun(int index)
+{
+    DeviceRun &run = runs[index];
+    run.awaitingMd5 = false;
+
+    if (run.retryTimer) {
+        run.retryTimer->stop();
+        run.retryTimer->deleteLater();
+        run.retryTimer = nullptr;
+    }
+
+    if (run.uploader) {
+        run.uploader->disconnect(this);
+        run.uploader->cancel();
+        run.uploader->deleteLater();
+        run.uploader = nullptr;
+    }
+    if (run.verifyProcess) {
+        run.verifyProcess->disconnect(this);
+        run.verifyProcess->kill();
+        run.verifyProcess->deleteLater();
+        run.verifyProcess = nullptr;
+    }
+    if (run.receiveProcess) {
+        run.receiveProcess->disconnect(this);
+        run.receiveProcess->kill();
+        run.receiveProcess->deleteLater();
+        run.receiveProcess = nullptr;
+    }
+    run.relayProbing = false;
+    if (run.sendProcess) {
+        run.sendProcess->disconnect(this);
+        run.sendProcess->kill();
+        run.sendProcess->deleteLater();
+        run.sendProcess = nullptr;
+    }
+}
+
+void FleetUploader::checkFinished()
+{
+    if (!running) {
+        return;
+    }
+
+    int succeeded = 0;
+    int failed = 0;
+    for (int i = 0; i < runs.size(); ++i) {
+        switch (runs[i].state) {
+        case DeviceSucceeded:
+            succeeded++;
+            break;
+        case DeviceFailed:
+        case DeviceCancelled:
+            failed++;
+            break;
+        default:
+            return;
+        }
+    }
+
+    running = false;
+    if (chunkSource) {
+        chunkSource->deleteLater();
+        chunkSource = nullptr;
+    }
+    emit logMessage(QString("[批量上传] 全部结束：成功 %1 台，失败 %2 台").arg(succeeded).arg(failed));
+    emit finished(succeeded, failed);
+}
+
+QStringList FleetUploader::buildSshArguments(const Device &device, const QString &remoteCommand) const
+{
+    QStringList arguments = SshUtils::commonArguments();
+    arguments << sshOptions;
+    arguments << "-p" << QString::number(device.port)
+              << QString("%1@%2").arg(device.username).arg(device.host)
+              << remoteCommand;
+    return arguments;
+}
+
+int FleetUploader::activeCount() const
+{
+    int count = 0;
+    for (int i = 0; i < runs.size(); ++i) {
+        if (runs[i].state == DeviceUploading || runs[i].state == DeviceVerifying) {
+            count++;
+        }
+    }
+    return count;
+}
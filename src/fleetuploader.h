@@ -0,0 +1,180 @@
+/**
+ * @File Name: fleetuploader.h
+ * @brief  批量上传调度器头文件，把同一个升级包并发上传到多台设备，并逐台进行MD5校验
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef FLEETUPLOADER_H
+#define FLEETUPLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QTimer>
+#include "retrypolicy.h"
+#include "digestmanifest.h"
+
+class ChunkedUploader;
+class SharedChunkSource;
+class RateLimiter;
+
+/**
+ * 每台设备独立使用一个 ChunkedUploader（支持断点续传、跳过相同文件和增量上传），
+ * 同时运行的设备数不超过并发上限，其余设备排队等待。
+ * 上传完成后在该设备上执行 md5sum，与实际发送数据的MD5比对。
+ *
+ * 所有设备共用一个 SharedChunkSource：同时上传的设备共享同一份读缓冲，本地文件只读取一次，
+ * 文件MD5也在读取过程中得到；MD5尚未算完时已上传完成的设备先等待，再开始校验。
+ *
+ * 转发模式（设备之间走本地交换机，上位机只有一条慢速链路时使用）：
+ * - 上位机只把升级包上传到一台种子设备，其余设备由已校验通过的设备转发，形成分发树
+ * - 每台设备同时最多向 relayFanout 台设备转发；每一跳先检查源设备能否免密SSH登录目标设备：
+ *   能登录时数据经设备之间的SSH传输（ssh 目标 'cat > 临时文件'），加密且经过认证；
+ *   否则只有调用方明确允许（setRelayNcAllowed，默认关闭）时才使用设备自带的 nc：接收端通过SSH启动监听
+ *   （可配置端口，60秒内没有连接自动退出），监听进程号记录在 <文件>.relay.pid，转发失败或取消时按进程号
+ *   结束监听并删除临时文件。nc 方式为明文、无认证的传输，只应在可信的设备局域网内使用；
+ *   未允许时该设备改为由上位机直接上传
+ * - 每一跳完成后都在接收设备上执行 md5sum 校验，通过后该设备也成为转发源
+ * - 转发失败或MD5不一致的设备改为由上位机直接上传
+ *
+ * 每台设备有独立的重试状态：上传或校验因网络中断失败时，按退避间隔重新排队（上传从中断处续传）
+ * 或重新校验，等待期间不占用并发名额；认证失败和远程命令失败直接判定为失败。
+ */
+class FleetUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Device {
+        QString host;
+        int port;
+        QString username;
+    };
+
+    enum DeviceState {
+        DevicePending,
+        DeviceUploading,
+        DeviceVerifying,
+        DeviceSucceeded,
+        DeviceFailed,
+        DeviceCancelled
+    };
+
+    explicit FleetUploader(QObject *parent = nullptr);
+    ~FleetUploader();
+
+    void setDevices(const QList<Device> &devices);
+    void setLocalFile(const QString &filePath);
+    void setRemoteFile(const QString &remoteFilePath);
+    void setSshOptions(const QStringList &options);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setStateDirectory(const QString &dirPath);
+    void setExpectedMd5(const QString &md5);
+    void setDeltaEnabled(bool enabled);
+    void setCompressionEnabled(bool enabled);
+    void setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond);
+    void setRetryAttempts(int attempts);
+    void setMaxParallel(int count);
+    void setRelayEnabled(bool enabled);
+    void setRelayFanout(int count);
+    void setRelayPort(int port);
+    // 设备之间不能SSH登录时是否允许退回 nc 明文转发，默认不允许
+    void setRelayNcAllowed(bool allowed);
+
+    int deviceCount() const;
+    const Device &device(int index) const;
+    DeviceState deviceState(int index) const;
+    QString fileMd5() const;
+    bool isRunning() const;
+
+    void start();
+    void cancel();
+
+    static QString stateText(DeviceState state);
+
+signals:
+    void logMessage(const QString &message);
+    void deviceStateChanged(int index, FleetUploader::DeviceState state, const QString &detail);
+    void deviceProgress(int index, qint64 bytesSent, qint64 totalBytes);
+    void deviceVerified(int index, bool matched, const QString &remoteMd5);
+    void fileMd5Ready(const QString &md5);
+    void finished(int succeeded, int failed);
+
+private:
+    struct DeviceRun {
+        DeviceState state;
+        ChunkedUploader *uploader;
+        QProcess *verifyProcess;
+        QString remoteMd5;
+        bool awaitingMd5;
+        int relaySource;            // 正在/已经从哪台设备转发，-1 表示由上位机直接上传
+        QProcess *receiveProcess;   // 转发接收端（nc 监听）
+        QProcess *sendProcess;      // 转发发送端（检查设备间SSH期间为检查进程）
+        bool relayProbing;          // 正在检查源设备能否SSH登录目标设备
+        bool receiveDone;
+        bool sendDone;
+        bool directOnly;            // 转发失败后只允许直接上传
+        RetryPolicy retry;
+        QTimer *retryTimer;         // 等待重试，非空时不参与调度
+    };
+
+    void scheduleNext();
+    void startDevice(int index);
+    void scheduleRelay();
+    int findRelaySource() const;
+    int activeRelayCount(int sourceIndex) const;
+    int directUploadCount() const;
+    void startRelay(int sourceIndex, int index);
+    void onRelayProbeFinished(int index, int exitCode, QProcess::ExitStatus exitStatus);
+    void startSshHop(int index);
+    void startNcHop(int index);
+    void cleanupRelayTarget(int index);
+    QProcess *createRelayProcess(int index, bool receiver);
+    void onRelayProcessFinished(int index, bool receiver, int exitCode, QProcess::ExitStatus exitStatus);
+    void fallBackToDirect(int index, const QString &reason);
+    void onDeviceUploadFinished(int index, bool success, const QString &errorMessage);
+    void startVerification(int index);
+    DigestManifest verificationManifest() const;
+    void onSourceMd5Ready(const QString &md5);
+    void onVerifyFinished(int index, int exitCode, QProcess::ExitStatus exitStatus);
+    bool scheduleRetry(int index, bool verify, RetryPolicy::ErrorClass errorClass, const QString &reason);
+    void onRetryTimer(int index, bool verify);
+    void setState(int index, DeviceState state, const QString &detail = QString());
+    void releaseRun(int index);
+    void checkFinished();
+    QStringList buildSshArguments(const Device &device, const QString &remoteCommand) const;
+    int activeCount() const;
+
+    QList<Device> devices;
+    QVector<DeviceRun> runs;
+    SharedChunkSource *chunkSource;
+    QString localFilePath;
+    QString remoteFilePath;
+    QStringList sshOptions;
+    QProcessEnvironment sshEnvironment;
+    QString stateDirectory;
+    QString expectedMd5;
+    QString md5Hex;
+    bool deltaEnabled;
+    bool compressionEnabled;
+    int maxParallel;
+    RateLimiter *rateLimiter;
+    qint64 deviceRateLimit;
+    int retryAttempts;
+    bool relayEnabled;
+    int relayFanout;
+    int relayPort;
+    bool relayNcAllowed;
+    qint64 packageSize;
+    bool running;
+    bool cancelRequested;
+};
+
+#endif // FLEETUPLOADER_H
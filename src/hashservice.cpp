@@ -0,0 +1,345 @@
+/**
+ * @File Name: hashservice.cpp
+ * @brief  后台文件摘要服务实现，工作线程分段读取文件按指定算法计算摘要，结果写入磁盘缓存
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "hashservice.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+// 工作线程每次读取的数据量，以及进度通知的间隔
+static const qint64 HASH_READ_SIZE = 1024 * 1024;
+static const qint64 PROGRESS_INTERVAL = 32 * 1024 * 1024;
+
+// 缓存最多保留的条目数，超出时淘汰最久未使用的记录
+static const int MAX_CACHE_ENTRIES = 200;
+
+HashWorker::HashWorker(QObject *parent)
+    : QObject(parent)
+{
+    for (int i = 0; i < ALGORITHM_COUNT; ++i) {
+        currentGenerations[i].storeRelease(0);
+    }
+}
+
+void HashWorker::setGeneration(int algorithm, int generation)
+{
+    if (algorithm >= 0 && algorithm < ALGORITHM_COUNT) {
+        currentGenerations[algorithm].storeRelease(generation);
+    }
+}
+
+void HashWorker::hashFile(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, int generation)
+{
+    if (algorithm < 0 || algorithm >= ALGORITHM_COUNT) {
+        return;
+    }
+    QAtomicInt &currentGeneration = currentGenerations[algorithm];
+    if (currentGeneration.loadAcquire() != generation) {
+        return;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        emit failed(filePath, algorithm, QString("无法打开文件: %1").arg(file.errorString()));
+        return;
+    }
+
+    FileDigest hash(static_cast<FileDigest::Algorithm>(algorithm));
+    qint64 bytesDone = 0;
+    qint64 nextProgress = PROGRESS_INTERVAL;
+
+    while (!file.atEnd()) {
+        // 同一算法有新请求或被取消时立即放弃，不产生任何结果
+        if (currentGeneration.loadAcquire() != generation) {
+            return;
+        }
+
+        QByteArray data = file.read(HASH_READ_SIZE);
+        if (data.isEmpty()) {
+            emit failed(filePath, algorithm, QString("读取文件失败: %1").arg(file.errorString()));
+            return;
+        }
+
+        hash.addData(data);
+        bytesDone += data.size();
+
+        if (bytesDone >= nextProgress) {
+            emit progress(filePath, bytesDone, size);
+            nextProgress += PROGRESS_INTERVAL;
+        }
+    }
+
+    // 计算期间文件被修改则结果无效
+    QFileInfo fileInfo(filePath);
+    if (fileInfo.size() != size || fileInfo.lastModified().toMSecsSinceEpoch() != mtimeMs) {
+        emit failed(filePath, algorithm, "计算期间文件已被修改");
+        return;
+    }
+
+    emit hashed(filePath, size, mtimeMs, algorithm, hash.resultHex());
+}
+
+HashService::HashService(const QString &cacheFilePath, QObject *parent)
+    : QObject(parent), cacheFilePath(cacheFilePath), worker(nullptr), generation(0)
+{
+    loadCache();
+
+    worker = new HashWorker();
+    worker->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(this, &HashService::hashRequested, worker, &HashWorker::hashFile);
+    connect(worker, &HashWorker::progress, this, &HashService::hashProgress);
+    connect(worker, &HashWorker::hashed, this, &HashService::onWorkerHashed);
+    connect(worker, &HashWorker::failed, this, &HashService::onWorkerFailed);
+    workerThread.start();
+}
+
+HashService::~HashService()
+{
+    // 让正在进行的计算尽快退出，再停止工作线程
+    for (int algorithm : {FileDigest::Md5, FileDigest::Sha256, FileDigest::Xxh64}) {
+        worker->setGeneration(algorithm, -1);
+    }
+    workerThread.quit();
+    workerThread.wait();
+}
+
+QString HashService::cachedMd5(const QString &filePath)
+{
+    return cachedDigest(filePath, FileDigest::Md5);
+}
+
+void HashService::requestMd5(const QString &filePath)
+{
+    requestDigest(filePath, FileDigest::Md5);
+}
+
+void HashService::storeMd5(const QString &filePath, const QString &md5)
+{
+    storeDigest(filePath, FileDigest::Md5, md5);
+}
+
+QString HashService::cachedDigest(const QString &filePath, FileDigest::Algorithm algorithm)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists()) {
+        return QString();
+    }
+
+    QString key = cacheKey(filePath);
+    if (!cache.contains(key)) {
+        return QString();
+    }
+
+    CacheEntry &entry = cache[key];
+    if (entry.size != fileInfo.size() || entry.mtimeMs != fileInfo.lastModified().toMSecsSinceEpoch()) {
+        return QString();
+    }
+
+    entry.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    return entry.digests.value(FileDigest::algorithmName(algorithm));
+}
+
+void HashService::requestDigest(const QString &filePath, FileDigest::Algorithm algorithm)
+{
+    QString digest = cachedDigest(filePath, algorithm);
+    if (!digest.isEmpty()) {
+        if (algorithm == FileDigest::Md5) {
+            emit md5Ready(filePath, digest, true);
+        }
+        emit digestReady(filePath, algorithm, digest, true);
+        return;
+    }
+
+    // 同一文件同一算法已在计算中则无需重复提交
+    QString activeFile = activeFiles.value(algorithm);
+    if (!activeFile.isEmpty() && cacheKey(activeFile) == cacheKey(filePath)) {
+        return;
+    }
+
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists() || !fileInfo.isFile()) {
+        emit hashFailed(filePath, "文件不存在");
+        return;
+    }
+
+    // 只取代同一算法未完成的请求，其他算法的计算照常进行
+    generation++;
+    worker->setGeneration(algorithm, generation);
+    activeFiles.insert(algorithm, filePath);
+    emit hashRequested(filePath, fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch(), algorithm, generation);
+}
+
+void HashService::storeDigest(const QString &filePath, FileDigest::Algorithm algorithm, const QString &digest)
+{
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.exists() || digest.isEmpty()) {
+        return;
+    }
+
+    // 文件未变化时保留其他算法的结果
+    QString key = cacheKey(filePath);
+    qint64 size = fileInfo.size();
+    qint64 mtimeMs = fileInfo.lastModified().toMSecsSinceEpoch();
+    CacheEntry entry = cache.value(key);
+    if (!cache.contains(key) || entry.size != size || entry.mtimeMs != mtimeMs) {
+        entry.size = size;
+        entry.mtimeMs = mtimeMs;
+        entry.digests.clear();
+    }
+    entry.digests.insert(FileDigest::algorithmName(algorithm), digest.toLower());
+    entry.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    cache.insert(key, entry);
+    saveCache();
+}
+
+void HashService::cancel()
+{
+    if (activeFiles.isEmpty()) {
+        return;
+    }
+
+    generation++;
+    for (auto it = activeFiles.constBegin(); it != activeFiles.constEnd(); ++it) {
+        worker->setGeneration(it.key(), generation);
+    }
+    activeFiles.clear();
+}
+
+bool HashService::isHashing() const
+{
+    return !activeFiles.isEmpty();
+}
+
+QString HashService::hashingFile() const
+{
+    return activeFiles.isEmpty() ? QString() : activeFiles.first();
+}
+
+void HashService::onWorkerHashed(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, const QString &digest)
+{
+    if (activeFiles.value(algorithm) == filePath) {
+        activeFiles.remove(algorithm);
+    }
+
+    QString key = cacheKey(filePath);
+    CacheEntry entry = cache.value(key);
+    if (!cache.contains(key) || entry.size != size || entry.mtimeMs != mtimeMs) {
+        entry.size = size;
+        entry.mtimeMs = mtimeMs;
+        entry.digests.clear();
+    }
+    entry.digests.insert(FileDigest::algorithmName(static_cast<FileDigest::Algorithm>(algorithm)), digest);
+    entry.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    cache.insert(key, entry);
+    saveCache();
+
+    if (algorithm == FileDigest::Md5) {
+        emit md5Ready(filePath, digest, false);
+    }
+    emit digestReady(filePath, algorithm, digest, false);
+}
+
+void HashService::onWorkerFailed(const QString &filePath, int algorithm, const QString &errorMessage)
+{
+    if (activeFiles.value(algorithm) == filePath) {
+        activeFiles.remove(algorithm);
+    }
+    emit hashFailed(filePath, errorMessage);
+}
+
+QString HashService::cacheKey(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    QString canonical = fileInfo.canonicalFilePath();
+    QString key = canonical.isEmpty() ? fileInfo.absoluteFilePath() : canonical;
+#ifdef Q_OS_WIN
+    // Windows路径不区分大小写
+    key = key.toLower();
+#endif
+    return key;
+}
+
+void HashService::loadCache()
+{
+    cache.clear();
+
+    QFile file(cacheFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QJsonArray entries = doc.object().value("entries").toArray();
+    for (int i = 0; i < entries.size(); ++i) {
+        QJsonObject obj = entries.at(i).toObject();
+        QString path = obj.value("path").toString();
+        if (path.isEmpty()) {
+            continue;
+        }
+
+        // 每种算法的摘要以算法名称为键保存
+        CacheEntry entry;
+        for (FileDigest::Algorithm algorithm : {FileDigest::Md5, FileDigest::Sha256, FileDigest::Xxh64}) {
+            QString name = FileDigest::algorithmName(algorithm);
+            QString digest = obj.value(name).toString();
+            if (!digest.isEmpty()) {
+                entry.digests.insert(name, digest);
+            }
+        }
+        if (entry.digests.isEmpty()) {
+            continue;
+        }
+        entry.size = static_cast<qint64>(obj.value("size").toDouble());
+        entry.mtimeMs = static_cast<qint64>(obj.value("mtime").toDouble());
+        entry.lastUsedMs = static_cast<qint64>(obj.value("lastUsed").toDouble());
+        cache.insert(path, entry);
+    }
+}
+
+void HashService::saveCache()
+{
+    // 淘汰最久未使用的条目
+    while (cache.size() > MAX_CACHE_ENTRIES) {
+        QMap<QString, CacheEntry>::iterator oldest = cache.begin();
+        for (QMap<QString, CacheEntry>::iterator it = cache.begin(); it != cache.end(); ++it) {
+            if (it.value().lastUsedMs < oldest.value().lastUsedMs) {
+                oldest = it;
+            }
+        }
+        cache.erase(oldest);
+    }
+
+    QJsonArray entries;
+    for (QMap<QString, CacheEntry>::const_iterator it = cache.constBegin(); it != cache.constEnd(); ++it) {
+        QJsonObject obj;
+        obj["path"] = it.key();
+        obj["size"] = static_cast<double>(it.value().size);
+        obj["mtime"] = static_cast<double>(it.value().mtimeMs);
+        for (QMap<QString, QString>::const_iterator digest = it.value().digests.constBegin();
+             digest != it.value().digests.constEnd(); ++digest) {
+            obj[digest.key()] = digest.value();
+        }
+        obj["lastUsed"] = static_cast<double>(it.value().lastUsedMs);
+        entries.append(obj);
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["entries"] = entries;
+
+    QFile file(cacheFilePath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(root).toJson());
+        file.close();
+    }
+}
@@ -0,0 +1,110 @@
+/**
+ * @File Name: hashservice.h
+ * @brief  后台文件摘要服务头文件，在工作线程中计算MD5等摘要，并按(路径, 大小, 修改时间)持久化缓存结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef HASHSERVICE_H
+#define HASHSERVICE_H
+
+#include <QObject>
+#include <QThread>
+#include <QString>
+#include <QMap>
+#include <QAtomicInt>
+#include "filedigest.h"
+
+/**
+ * 工作线程中的哈希计算对象，由 HashService 创建并移动到工作线程。
+ * 每个请求带有一个序号，各算法分别记录当前序号；序号过期（同一算法有新请求或被取消）时立即放弃当前计算，
+ * 不影响其他算法排队中的请求。
+ */
+class HashWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HashWorker(QObject *parent = nullptr);
+
+    void setGeneration(int algorithm, int generation);
+
+public slots:
+    void hashFile(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, int generation);
+
+signals:
+    void progress(const QString &filePath, qint64 bytesDone, qint64 totalBytes);
+    void hashed(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, const QString &digest);
+    void failed(const QString &filePath, int algorithm, const QString &errorMessage);
+
+private:
+    static const int ALGORITHM_COUNT = FileDigest::Xxh64 + 1;
+
+    QAtomicInt currentGenerations[ALGORITHM_COUNT];
+};
+
+/**
+ * 文件摘要服务：
+ * - cachedMd5() 在缓存命中（路径、大小、修改时间均一致）时直接返回结果
+ * - requestMd5() 未命中时交给工作线程计算，工作线程依次计算；同一算法的新请求取代该算法未完成的请求，
+ *   不同算法的请求互不取消（例如上传前的MD5和校验用的XXH64）
+ * - storeMd5() 用于登记其他途径算出的摘要（例如上传时边发送边计算的MD5）
+ * - *Digest() 系列按指定算法计算和缓存（校验算法协商为 SHA-256 或 XXH64 时使用），同一文件的各算法结果共用一条缓存
+ * 缓存以JSON格式保存在程序目录下，批量升级多台设备时同一个升级包只需计算一次。
+ */
+class HashService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HashService(const QString &cacheFilePath, QObject *parent = nullptr);
+    ~HashService();
+
+    QString cachedMd5(const QString &filePath);
+    void requestMd5(const QString &filePath);
+    void storeMd5(const QString &filePath, const QString &md5);
+    QString cachedDigest(const QString &filePath, FileDigest::Algorithm algorithm);
+    void requestDigest(const QString &filePath, FileDigest::Algorithm algorithm);
+    void storeDigest(const QString &filePath, FileDigest::Algorithm algorithm, const QString &digest);
+    void cancel();
+
+    bool isHashing() const;
+    QString hashingFile() const;
+
+signals:
+    void md5Ready(const QString &filePath, const QString &md5, bool fromCache);
+    void digestReady(const QString &filePath, int algorithm, const QString &digest, bool fromCache);
+    void hashProgress(const QString &filePath, qint64 bytesDone, qint64 totalBytes);
+    void hashFailed(const QString &filePath, const QString &errorMessage);
+
+    // 内部使用：把请求排队到工作线程
+    void hashRequested(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, int generation);
+
+private slots:
+    void onWorkerHashed(const QString &filePath, qint64 size, qint64 mtimeMs, int algorithm, const QString &digest);
+    void onWorkerFailed(const QString &filePath, int algorithm, const QString &errorMessage);
+
+private:
+    struct CacheEntry {
+        qint64 size;
+        qint64 mtimeMs;
+        QMap<QString, QString> digests;     // 算法名称 -> 摘要
+        qint64 lastUsedMs;
+    };
+
+    static QString cacheKey(const QString &filePath);
+    void loadCache();
+    void saveCache();
+
+    QString cacheFilePath;
+    QMap<QString, CacheEntry> cache;
+
+    QThread workerThread;
+    HashWorker *worker;
+    int generation;
+    QMap<int, QString> activeFiles;     // 算法 -> 正在计算或排队中的文件
+};
+
+#endif // HASHSERVICE_H
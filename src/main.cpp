@@ -17,6 +17,7 @@
 #include <QCryptographicHash>
 #include "mainwindow.h"
 #include "crypto_utils.h"
+#include "sshsession.h"
 
 // 获取机器码
 QString getMachineCode()
@@ -81,6 +82,12 @@ bool checkMachineAuthorization()
 
 int main(int argc, char *argv[])
 {
+    // 作为 ssh 的 SSH_ASKPASS 被调用时只向主程序取得密码并输出，不做授权检查也不创建界面
+    int askPassResult = SshSessionManager::answerAskPass(argc, argv);
+    if (askPassResult >= 0) {
+        return askPassResult;
+    }
+    
     QApplication app(argc, argv);
     
     // 启动时检查机器授权
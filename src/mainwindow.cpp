@@ -21,14 +21,17 @@
 #include <QSysInfo>
 #include <QNetworkInterface>
 #include "settingsdialog.h"
+#include "sshutils.h"
 
 // 静态变量记录最后一次成功的认证方式
 static QString lastSuccessfulAuthMethod = "None";
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), uploadProcess(nullptr), testProcess(nullptr), verifyProcess(nullptr),
-              remoteCommandProcess(nullptr), customCommandProcess(nullptr), preCheck7evProcess(nullptr), upgrade7evProcess(nullptr),
-        upgradeKu5pProcess(nullptr), sshKeyGenProcess(nullptr), builtinCommandProcess(nullptr), progressTimer(nullptr), timeoutTimer(nullptr), keyFile(nullptr),
+    : QMainWindow(parent), chunkedUploader(nullptr), hashService(nullptr), sshSessionManager(nullptr), streamExtractor(nullptr), batchUploader(nullptr), uploadRateLimiter(nullptr), testProcess(nullptr), testReusedConnection(false), testAskPassAnswers(0), verifyProcess(nullptr),
+              upgradePipeline(nullptr), customCommandProcess(nullptr),
+        sshKeyGenProcess(nullptr), builtinCommandProcess(nullptr), keyInstallCommand(nullptr), progressTimer(nullptr), uploadWatchdog(nullptr),
+        retryTimer(nullptr), pendingRetry(RetryNone), transferStalled(false),
+        verifyAlgorithm(FileDigest::Md5), verifyAwaitingDigest(false), keyFile(nullptr), logFile(nullptr),
         settingsDialog(nullptr), remoteDirectory("/media/sata/ue_data/"), waitingForPassword(false), isGeneratingAndDeploying(false), sshKeyEnabled(false)
 {
     // 设置应用程序信息
@@ -60,9 +63,64 @@ MainWindow::MainWindow(QWidget *parent)
     progressTimer = new QTimer(this);
     connect(progressTimer, &QTimer::timeout, this, &MainWindow::onUploadProgress);
     
-    timeoutTimer = new QTimer(this);
-    timeoutTimer->setSingleShot(true);
-    connect(timeoutTimer, &QTimer::timeout, this, &MainWindow::onUploadTimeout);
+    // 上传看门狗：进度停滞或超过按文件大小和吞吐量估算的截止时间才终止上传
+    uploadWatchdog = new TransferWatchdog(this);
+    connect(uploadWatchdog, &TransferWatchdog::expired, this, &MainWindow::onUploadTimeout);
+    connect(uploadWatchdog, &TransferWatchdog::logMessage, this, &MainWindow::logMessage);
+    
+    // 失败重试定时器：网络中断后按带抖动的指数退避重新执行当前步骤
+    retryTimer = new QTimer(this);
+    retryTimer->setSingleShot(true);
+    connect(retryTimer, &QTimer::timeout, this, &MainWindow::onRetryTimer);
+    
+    // 初始化分块上传引擎
+    chunkedUploader = new ChunkedUploader(this);
+    connect(chunkedUploader, &ChunkedUploader::finished, this, &MainWindow::onUploadFinished);
+    connect(chunkedUploader, &ChunkedUploader::logMessage, this, &MainWindow::logMessage);
+    connect(chunkedUploader, &ChunkedUploader::progressChanged, this, &MainWindow::onUploadBytesProgress);
+    connect(chunkedUploader, &ChunkedUploader::preparing, uploadWatchdog, &TransferWatchdog::beginPreparing);
+    
+    // 初始化流式解压升级（升级包经SSH直接送入远程tar，不在设备上落盘）
+    streamExtractor = new StreamExtractor(this);
+    connect(streamExtractor, &StreamExtractor::finished, this, &MainWindow::onStreamExtractFinished);
+    connect(streamExtractor, &StreamExtractor::logMessage, this, &MainWindow::logMessage);
+    connect(streamExtractor, &StreamExtractor::progressChanged, this, &MainWindow::onUploadBytesProgress);
+    
+    // 初始化多文件上传（小文件打包为一个tar流，大文件分块上传，最后统一校验）
+    batchUploader = new BatchUploader(this);
+    connect(batchUploader, &BatchUploader::finished, this, &MainWindow::onBatchUploadFinished);
+    connect(batchUploader, &BatchUploader::logMessage, this, &MainWindow::logMessage);
+    connect(batchUploader, &BatchUploader::progressChanged, this, &MainWindow::onUploadBytesProgress);
+    // 下一个大文件探测、计算增量期间没有进度，不算作停滞
+    connect(batchUploader, &BatchUploader::preparing, uploadWatchdog, &TransferWatchdog::beginPreparing);
+    connect(batchUploader, &BatchUploader::verificationStarted, this, [this](int fileCount) {
+        // 远程校验期间没有传输进度，停止看门狗
+        uploadWatchdog->stop();
+        statusLabel->setText(QString("正在校验 %1 个文件的完整性...").arg(fileCount));
+        statusBar()->showMessage("正在校验文件...", 0);
+    });
+    
+    // 初始化升级流水线（qt、7ev、ku5p 升级按步骤在常驻SSH会话上执行）
+    upgradePipeline = new UpgradePipeline(this);
+    connect(upgradePipeline, &UpgradePipeline::stepStarted, this, &MainWindow::onUpgradeStepStarted);
+    connect(upgradePipeline, &UpgradePipeline::stepFinished, this, &MainWindow::onUpgradeStepFinished);
+    connect(upgradePipeline, &UpgradePipeline::outputReceived, this, &MainWindow::onUpgradeOutput);
+    connect(upgradePipeline, &UpgradePipeline::progressChanged, this, &MainWindow::onUpgradeProgress);
+    connect(upgradePipeline, &UpgradePipeline::errorReceived, this, &MainWindow::onUpgradeError);
+    connect(upgradePipeline, &UpgradePipeline::finished, this, &MainWindow::onUpgradeFinished);
+    
+    // 初始化全局上传限速（所有上传共享，设备级限速由各上传引擎自行创建）
+    uploadRateLimiter = new RateLimiter(this);
+    
+    // 初始化后台摘要服务（选择文件后即开始计算MD5，结果持久化缓存）
+    hashService = new HashService(getHashCacheFilePath(), this);
+    connect(hashService, &HashService::md5Ready, this, &MainWindow::onLocalMd5Ready);
+    connect(hashService, &HashService::hashFailed, this, &MainWindow::onLocalMd5Failed);
+    connect(hashService, &HashService::digestReady, this, &MainWindow::onLocalDigestReady);
+    
+    // 初始化SSH会话管理（远程命令复用同一条已认证的连接，空闲超时后自动断开）
+    sshSessionManager = new SshSessionManager(this);
+    connect(sshSessionManager, &SshSessionManager::logMessage, this, &MainWindow::logMessage);
     
     // 设置默认值（SCP配置）
     ipLineEdit->setText("172.16.10.161");
@@ -118,6 +176,7 @@ MainWindow::MainWindow(QWidget *parent)
     
     // 加载应用设置
     loadApplicationSettings();
+    applyRateLimitSettings();
     
     // 根据设置初始化界面
     if (showLogByDefault) {
@@ -170,46 +229,29 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
-    if (uploadProcess) {
-        uploadProcess->kill();
-        uploadProcess->waitForFinished(3000);
-        uploadProcess->deleteLater();
+    if (chunkedUploader) {
+        chunkedUploader->cancel();
+    }
+    if (batchUploader) {
+        batchUploader->cancel();
     }
     if (testProcess) {
+        testProcess->disconnect(this);
         testProcess->kill();
-        testProcess->waitForFinished(1000);
         testProcess->deleteLater();
     }
     if (verifyProcess) {
+        verifyProcess->disconnect(this);
         verifyProcess->kill();
-        verifyProcess->waitForFinished(1000);
         verifyProcess->deleteLater();
     }
-    if (remoteCommandProcess) {
-        remoteCommandProcess->kill();
-        remoteCommandProcess->waitForFinished(1000);
-        remoteCommandProcess->deleteLater();
-    }
+    upgradePipeline->disconnect(this);
+    upgradePipeline->cancel();
     if (customCommandProcess) {
+        customCommandProcess->disconnect(this);
         customCommandProcess->kill();
-        customCommandProcess->waitForFinished(1000);
         customCommandProcess->deleteLater();
     }
-    if (preCheck7evProcess) {
-        preCheck7evProcess->kill();
-        preCheck7evProcess->waitForFinished(1000);
-        preCheck7evProcess->deleteLater();
-    }
-    if (upgrade7evProcess) {
-        upgrade7evProcess->kill();
-        upgrade7evProcess->waitForFinished(1000);
-        upgrade7evProcess->deleteLater();
-    }
-    if (upgradeKu5pProcess) {
-        upgradeKu5pProcess->kill();
-        upgradeKu5pProcess->waitForFinished(1000);
-        upgradeKu5pProcess->deleteLater();
-    }
     if (sshKeyGenProcess) {
         sshKeyGenProcess->kill();
         sshKeyGenProcess->waitForFinished(1000);
@@ -220,6 +262,11 @@ MainWindow::~MainWindow()
         builtinCommandProcess->waitForFinished(1000);
         builtinCommandProcess->deleteLater();
     }
+    if (keyInstallCommand) {
+        keyInstallCommand->disconnect(this);
+        keyInstallCommand->kill();
+        keyInstallCommand->deleteLater();
+    }
     if (keyFile) {
         keyFile->close();
         delete keyFile;
@@ -316,19 +363,24 @@ void MainWindow::setupUI()
     fileLabel = new QLabel("选择文件:", this);
     filePathLineEdit = new QLineEdit(this);
     filePathLineEdit->setObjectName("filePathLineEdit");
-    filePathLineEdit->setPlaceholderText("点击浏览按钮选择要上传的文件");
+    filePathLineEdit->setPlaceholderText("点击浏览按钮选择要上传的文件（可多选）或目录");
     filePathLineEdit->setReadOnly(true);
     
     selectFileButton = new QPushButton("浏览文件", this);
     selectFileButton->setObjectName("selectFileButton");
     selectFileButton->setFixedWidth(100); // 固定按钮宽度
     
+    selectDirButton = new QPushButton("浏览目录", this);
+    selectDirButton->setObjectName("selectDirButton");
+    selectDirButton->setFixedWidth(100);
+    
     // 设置文件路径输入框的拉伸策略
     filePathLineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     
     fileLayout->addWidget(fileLabel);
     fileLayout->addWidget(filePathLineEdit, 1); // 设置拉伸因子，使其占用更多空间
     fileLayout->addWidget(selectFileButton);
+    fileLayout->addWidget(selectDirButton);
     
     mainLayout->addWidget(fileGroup);
     
@@ -660,9 +712,14 @@ void MainWindow::setupMenuBar()
     // 文件菜单
     fileMenu = menuBar()->addMenu("文件(&F)");
     
+    fleetUploadAction = new QAction("批量上传(&M)...", this);
+    fleetUploadAction->setShortcut(QKeySequence("Ctrl+M"));
+    
     exitAction = new QAction("退出(&X)", this);
     exitAction->setShortcut(QKeySequence::Quit);
     
+    fileMenu->addAction(fleetUploadAction);
+    fileMenu->addSeparator();
     fileMenu->addAction(exitAction);
     
     // 设置菜单
@@ -712,6 +769,10 @@ void MainWindow::setupMenuBar()
     toggleBuiltinCommandAction->setCheckable(true);
     toggleBuiltinCommandAction->setChecked(false); // 默认隐藏内置命令窗口
     viewMenu->addAction(toggleBuiltinCommandAction);
+    viewMenu->addSeparator();
+    
+    upgradeTimelineAction = new QAction("升级耗时记录(&T)...", this);
+    viewMenu->addAction(upgradeTimelineAction);
     
     // 帮助菜单
     helpMenu = menuBar()->addMenu("帮助(&H)");
@@ -733,6 +794,7 @@ void MainWindow::connectSignals()
 {
     // 连接按钮信号
     connect(selectFileButton, &QPushButton::clicked, this, &MainWindow::onSelectFile);
+    connect(selectDirButton, &QPushButton::clicked, this, &MainWindow::onSelectDirectory);
     connect(uploadButton, &QPushButton::clicked, this, &MainWindow::onUploadFile);
     connect(cancelButton, &QPushButton::clicked, this, &MainWindow::onCancelUpload);
     connect(clearLogButton, &QPushButton::clicked, this, &MainWindow::onClearLog);
@@ -759,6 +821,8 @@ void MainWindow::connectSignals()
     
     // 连接菜单动作
     connect(openSettingsAction, &QAction::triggered, this, &MainWindow::onOpenSettings);
+    connect(fleetUploadAction, &QAction::triggered, this, &MainWindow::onOpenFleetUpload);
+    connect(upgradeTimelineAction, &QAction::triggered, this, &MainWindow::onShowUpgradeTimeline);
     connect(saveSettingsAction, &QAction::triggered, this, &MainWindow::onMenuAction);
     connect(loadSettingsAction, &QAction::triggered, this, &MainWindow::onMenuAction);
     connect(exitAction, &QAction::triggered, this, &QWidget::close);
@@ -779,17 +843,29 @@ void MainWindow::onSelectFile()
         startPath = QDir::currentPath();
     }
     
-    QString fileName = QFileDialog::getOpenFileName(this, 
-        "选择要上传的文件", 
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, 
+        "选择要上传的文件（可多选）", 
         startPath, 
         "所有文件 (*)");
     
-    if (!fileName.isEmpty()) {
+    if (fileNames.size() > 1) {
+        // 多个文件通过同一连接上传，最后统一校验
+        selectBatchPaths(fileNames, QString("%1 个文件").arg(fileNames.size()));
+        return;
+    }
+    
+    if (!fileNames.isEmpty()) {
+        QString fileName = fileNames.first();
+        batchPaths.clear();
         selectedFilePath = fileName;
         filePathLineEdit->setText(fileName);
         logMessage(QString("已选择文件: %1").arg(QFileInfo(fileName).fileName()));
         statusBar()->showMessage("文件选择完成", 2000);
         
+        // 后台计算MD5，缓存命中时立即返回
+        localFileMD5.clear();
+        hashService->requestMd5(fileName);
+        
         // 如果启用自动保存，更新默认路径为选择文件的目录
         if (autoSaveSettings) {
             QString newDefaultPath = QFileInfo(fileName).absolutePath();
@@ -802,6 +878,39 @@ void MainWindow::onSelectFile()
     }
 }
 
+void MainWindow::onSelectDirectory()
+{
+    QString startPath = defaultLocalPath;
+    if (!QDir(startPath).exists()) {
+        startPath = QDir::currentPath();
+    }
+    
+    QString dirName = QFileDialog::getExistingDirectory(this, "选择要上传的目录", startPath);
+    if (!dirName.isEmpty()) {
+        selectBatchPaths(QStringList() << dirName, QString("目录 %1").arg(QDir::toNativeSeparators(dirName)));
+    }
+}
+
+void MainWindow::selectBatchPaths(const QStringList &paths, const QString &summary)
+{
+    batchPaths = paths;
+    selectedFilePath.clear();
+    localFileMD5.clear();
+    filePathLineEdit->setText(QString("%1（多文件上传）").arg(summary));
+    logMessage(QString("已选择 %1，将通过同一连接上传并统一校验").arg(summary));
+    statusBar()->showMessage("文件选择完成", 2000);
+    
+    // 如果启用自动保存，更新默认路径为所选内容所在的目录
+    if (autoSaveSettings) {
+        QString newDefaultPath = QFileInfo(paths.first()).absolutePath();
+        if (newDefaultPath != defaultLocalPath) {
+            defaultLocalPath = newDefaultPath;
+            saveApplicationSettings();
+            logMessage(QString("默认文件路径已更新为: %1").arg(defaultLocalPath));
+        }
+    }
+}
+
 void MainWindow::onUploadFile()
 {
     if (!validateSettings()) {
@@ -820,8 +929,8 @@ void MainWindow::onClearLog()
 void MainWindow::onTestConnection()
 {    
     if (testProcess) {
+        testProcess->disconnect(this);
         testProcess->kill();
-        testProcess->waitForFinished(1000);
         testProcess->deleteLater();
         testProcess = nullptr;
     }
@@ -842,230 +951,260 @@ void MainWindow::onTestConnection()
     testConnectionButton->setText("连接中...");
     testConnectionButton->setEnabled(false);
     
-    // 创建SSH连接测试进程
-    testProcess = new QProcess(this);
-    
-    connect(testProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onTestFinished);
-    
-    // 设置环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    
-    QString program;
-    QStringList arguments;
-    
     // 检查是否有SSH密钥和密码
     bool hasSSHKey = checkSSHKeyExists();
     bool hasPassword = !password.isEmpty();
     
     if (hasSSHKey && hasPassword) {
-        // 有SSH密钥和密码，使用Python脚本同时支持两种认证方式
         logMessage("[测试] 检测到SSH密钥和密码，优先使用密钥认证");
-        
-        // 获取Python脚本路径 - 使用程序同级目录
-        QString execDir = QCoreApplication::applicationDirPath();
-        QString scriptPath = QDir(execDir).absoluteFilePath("test_ssh_connection.py");
-        
-        // 检查Python脚本是否存在
-        if (!QFile::exists(scriptPath)) {
-            logMessage(QString("[错误] SSH连接测试脚本不存在: %1").arg(scriptPath));
-            testConnectionButton->setText("测试连接");
-            testConnectionButton->setEnabled(true);
-            return;
-        }
-        
-        program = "python";
-        arguments << scriptPath
-                  << "--host" << ip
-                  << "--port" << QString::number(port)
-                  << "--user" << username
-                  << "--password" << password;
-                  
-        // 添加SSH密钥文件
-        QString keyPath = getSSHKeyPath();
-        if (QFile::exists(keyPath)) {
-            arguments << "--key-file" << keyPath;
-        }
-        
         logMessage("[提示] 将尝试SSH密钥认证，如果失败会自动尝试密码认证");
     } else if (hasSSHKey) {
-        // 只有SSH密钥，使用密钥认证
         logMessage("[测试] 检测到SSH密钥，使用密钥认证");
-        
-        program = "ssh";
-        arguments << "-o" << "ConnectTimeout=10"
-                  << "-o" << "StrictHostKeyChecking=no"
-                  << "-o" << "UserKnownHostsFile=/dev/null"
-                  << "-o" << "PreferredAuthentications=publickey"
-                  << "-o" << "PubkeyAuthentication=yes"
-                  << "-o" << "PasswordAuthentication=no"
-                  << "-o" << "BatchMode=yes"
-                  << "-p" << QString::number(port)
-                  << QString("%1@%2").arg(username).arg(ip)
-                  << "echo 'SSH连接测试成功'";
-        
         logMessage("[提示] 使用SSH密钥认证，无需密码");
     } else if (hasPassword) {
-        // 只有密码，使用Python脚本进行连接测试
         logMessage("[测试] 未检测到SSH密钥，使用密码认证进行连接测试");
-        
-        // 获取Python脚本路径 - 使用程序同级目录
-        QString execDir = QCoreApplication::applicationDirPath();
-        QString scriptPath = QDir(execDir).absoluteFilePath("test_ssh_connection.py");
-        
-        // 检查Python脚本是否存在
-        if (!QFile::exists(scriptPath)) {
-            logMessage(QString("[错误] SSH连接测试脚本不存在: %1").arg(scriptPath));
-            testConnectionButton->setText("测试连接");
-            testConnectionButton->setEnabled(true);
-            return;
-        }
-        
-        program = "python";
-        arguments << scriptPath
-                  << "--host" << ip
-                  << "--port" << QString::number(port)
-                  << "--user" << username
-                  << "--password" << password;
-        
-        // 如果有SSH密钥，也传递给脚本
-        if (hasSSHKey) {
-            QString keyPath = getSSHKeyPath();
-            if (QFile::exists(keyPath)) {
-                arguments << "--key-file" << keyPath;
-            }
-        }
-        
-        logMessage("[提示] 使用Python脚本进行连接测试，支持密码和密钥认证");
     } else {
         // 既没有SSH密钥也没有密码，尝试使用系统默认SSH连接
         logMessage("[测试] 未检测到SSH密钥和密码，尝试系统默认SSH连接");
-        logMessage("[说明] 将尝试使用系统默认SSH配置进行连接测试");
-        
-        program = "ssh";
-        arguments << "-o" << "ConnectTimeout=10"
-                  << "-o" << "StrictHostKeyChecking=no"
-                  << "-o" << "UserKnownHostsFile=/dev/null"
-                  << "-o" << "BatchMode=yes"
-                  << "-p" << QString::number(port)
-                  << QString("%1@%2").arg(username).arg(ip)
-                  << "echo 'SSH连接测试成功'";
-        
         logMessage("[提示] 如果连接失败，请配置密码或SSH密钥认证");
     }
     
-    testProcess->setProcessEnvironment(env);
+    // 在常驻会话上执行测试命令：密码由程序自身作为 SSH_ASKPASS 提供，不再启动 python 脚本；
+    // 测试成功后连接保持，后续上传、校验和升级命令直接复用
+    testProcess = new SshCommand(this);
+    
+    connect(testProcess, &SshCommand::finished, this, &MainWindow::onTestFinished);
+    connect(testProcess, &SshCommand::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            logMessage("[错误] 无法启动SSH进程，请确认系统已安装 OpenSSH 客户端");
+        }
+    });
     
     // 设置10秒超时
     QTimer::singleShot(10000, this, [this](){
-        if (testProcess && testProcess->state() == QProcess::Running) {
-            testProcess->kill();
+        if (testProcess && testProcess->state() != QProcess::NotRunning) {
             logMessage("[错误] 连接测试超时，请检查网络和服务器设置");
-            testConnectionButton->setText("测试连接");
-            testConnectionButton->setEnabled(true);
+            testProcess->kill();
         }
     });
     
-    testProcess->start(program, arguments);
+    // 记下连接状态和密码应答次数，结束后据此判断实际使用的认证方式
+    SshSession *session = currentSshSession();
+    testReusedConnection = session->isConnected();
+    testAskPassAnswers = sshSessionManager->askPassAnswerCount();
+    testProcess->start(session, "echo 'SSH连接测试成功'");
 }
 
-void MainWindow::onUploadFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void MainWindow::onUploadFinished(bool success, const QString &errorMessage)
 {
-    timeoutTimer->stop();
+    uploadWatchdog->stop();
     progressTimer->stop();
+    finishUploadStats();
+    
+    if (!success && scheduleRetry(RetryUpload, chunkedUploader->lastErrorClass(), errorMessage)) {
+        // 界面保持上传状态，退避后从中断处续传
+        return;
+    }
+    
     uploadButton->setEnabled(true);
     upgradeQtButton->setEnabled(true);
     upgrade7evButton->setEnabled(true);
     upgradeKu5pButton->setEnabled(true);
     cancelButton->setVisible(false);
-    transferProgressBar->setVisible(false);  // 隐藏传输进度条
+    resetTransferProgressBar();  // 隐藏传输进度条
     
-    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+    if (success) {
+        QString sentMd5 = chunkedUploader->fileMd5();
+        if (!sentMd5.isEmpty()) {
+            if (!localFileMD5.isEmpty() && localFileMD5.toLower() != sentMd5.toLower()) {
+                logMessage("[警告] 实际发送数据的MD5与缓存不一致，以发送数据为准");
+            }
+            localFileMD5 = sentMd5;
+            hashService->storeMd5(selectedFilePath, sentMd5);
+        } else if (localFileMD5.isEmpty()) {
+            // 正常情况下不会出现，保底重新读取一次文件
+            localFileMD5 = calculateFileMD5(selectedFilePath);
+        }
+        logMessage(QString("本地文件MD5: %1").arg(localFileMD5));
+        
+        if (chunkedUploader->skippedIdentical()) {
+            // 预检查时已确认远程文件大小和MD5一致，无需再次校验
+            logMessage("远程文件与本地文件完全一致，跳过上传");
+            reportVerificationPassed(FileDigest::Md5, localFileMD5.toLower(), localFileMD5.toLower(), true);
+            return;
+        }
+        
+        if (chunkedUploader->verifiedRemotely()) {
+            // 并行上传在远程拼接时已校验整文件MD5
+            logMessage("文件上传成功！远程拼接时已校验整文件MD5");
+            reportVerificationPassed(FileDigest::Md5, localFileMD5.toLower(), localFileMD5.toLower(), false);
+            return;
+        }
+        
         logMessage("文件上传成功！开始校验文件完整性...");
         statusLabel->setText("正在校验文件完整性...");
         statusBar()->showMessage("正在校验文件...", 0);
         
-        // 读取进程输出
-        QString output = uploadProcess->readAllStandardOutput();
-        if (!output.isEmpty()) {
-            logMessage(QString("SCP输出: %1").arg(output.trimmed()));
-        }
-        
-        // 开始MD5校验
+        // 开始摘要校验，校验步骤重新计算重试次数
+        stepRetry.reset();
         startFileVerification();
     } else {
-        QString error = uploadProcess->readAllStandardError();
-        QString output = uploadProcess->readAllStandardOutput();
-        
-        logMessage(QString("文件上传失败！退出码: %1").arg(exitCode));
+        logMessage("文件上传失败！");
         statusLabel->setText("上传失败");
         statusBar()->showMessage("上传失败", 3000);
         
-        if (!error.isEmpty()) {
-            logMessage(QString("错误信息: %1").arg(error.trimmed()));
-        }
-        if (!output.isEmpty()) {
-            logMessage(QString("输出信息: %1").arg(output.trimmed()));
+        if (!errorMessage.isEmpty()) {
+            logMessage(QString("错误信息: %1").arg(errorMessage));
         }
+        logMessage("[提示] 已上传的分块会保留在服务器上，重新点击'开始上传'将从中断处继续");
         
         QMessageBox::warning(this, "上传失败", 
-            QString("SCP上传失败\n错误代码: %1\n%2")
-            .arg(exitCode)
-            .arg(error.isEmpty() ? "请检查网络连接和服务器设置" : error.trimmed()));
-    }
-    
-    if (uploadProcess) {
-        uploadProcess->deleteLater();
-        uploadProcess = nullptr;
+            QString("文件上传失败\n%1\n\n重新上传时将从中断处继续传输。")
+            .arg(errorMessage.isEmpty() ? "请检查网络连接和服务器设置" : errorMessage));
     }
 }
 
 void MainWindow::onUploadProgress()
 {
-    // 使用滚动点来显示上传状态
-    static int dotCount = 0;
-    static QString baseStatus = "正在上传文件";
-    
-    if (uploadProcess && uploadProcess->state() == QProcess::Running) {
-        dotCount = (dotCount + 1) % 4; // 0-3循环
-        QString dots = QString(".").repeated(dotCount);
-        QString spaces = QString(" ").repeated(3 - dotCount);
+    // 每秒采样一次吞吐量，并显示实际进度
+    if (chunkedUploader->isRunning() || streamExtractor->isRunning() || batchUploader->isRunning()) {
+        uploadStats.sample();
         
-        QString displayStatus = baseStatus + dots + spaces;
-        statusLabel->setText(displayStatus);
+        if (uploadStats.history().isEmpty()) {
+            // 尚未收到进度（正在连接或检查已上传的分块）
+            statusLabel->setText("正在连接服务器...");
+            return;
+        }
+        
+        QString displayStatus = QString("正在上传 %1").arg(uploadStats.summaryText());
+        statusLabel->setText(QString("正在上传 %1%").arg(uploadStats.percent()));
         statusBar()->showMessage(displayStatus, 0);
         
-        // 每10秒记录一次状态
-        static int logCounter = 0;
-        logCounter++;
-        if (logCounter % 10 == 0) {
-            logMessage("文件上传中，请等待...");
+        // 每10秒记录一次进度
+        if (uploadStats.history().size() % 10 == 0) {
+            logMessage(QString("[上传进度] %1").arg(uploadStats.summaryText()));
         }
     } else {
-        dotCount = 0; // 重置
         statusLabel->setText("准备就绪");
     }
 }
 
-void MainWindow::onUploadOutput()
+void MainWindow::onUploadBytesProgress(qint64 bytesSent, qint64 totalBytes)
 {
-    if (uploadProcess) {
-        QByteArray data = uploadProcess->readAllStandardOutput();
-        if (!data.isEmpty()) {
-            QString output = QString::fromUtf8(data).trimmed();
-            logMessage(QString("SCP输出: %1").arg(output));
-        }
+    uploadStats.update(bytesSent, totalBytes);
+    uploadWatchdog->update(bytesSent, totalBytes);
+    
+    // 进度条按千分比显示，避免大文件超出int范围
+    if (totalBytes > 0) {
+        transferProgressBar->setMaximum(1000);
+        transferProgressBar->setValue(static_cast<int>(bytesSent * 1000 / totalBytes));
+        transferProgressBar->setFormat(QString("%1 / %2")
+            .arg(TransferStats::formatBytes(bytesSent))
+            .arg(TransferStats::formatBytes(totalBytes)));
+        transferProgressBar->setTextVisible(true);
+    }
+}
+
+void MainWindow::onLocalMd5Ready(const QString &filePath, const QString &md5, bool fromCache)
+{
+    if (filePath != selectedFilePath) {
+        return;
+    }
+    
+    localFileMD5 = md5;
+    logMessage(QString("本地文件MD5%1: %2").arg(fromCache ? "(缓存)" : "").arg(md5));
+}
+
+void MainWindow::onLocalDigestReady(const QString &filePath, int algorithm, const QString &digest, bool fromCache)
+{
+    if (!verifyAwaitingDigest || filePath != selectedFilePath || algorithm != verifyAlgorithm) {
+        return;
+    }
+    
+    // 校验所需的本地摘要已算好，继续远程校验
+    verifyAwaitingDigest = false;
+    logMessage(QString("本地文件%1%2: %3").arg(FileDigest::displayName(verifyAlgorithm))
+              .arg(fromCache ? "(缓存)" : "").arg(digest));
+    startFileVerification();
+}
+
+void MainWindow::onLocalMd5Failed(const QString &filePath, const QString &errorMessage)
+{
+    if (filePath != selectedFilePath) {
+        return;
+    }
+    
+    if (verifyAwaitingDigest) {
+        verifyAwaitingDigest = false;
+        
+        uploadWatchdog->stop();
+        progressTimer->stop();
+        enableAllOperationButtons();
+        cancelButton->setVisible(false);
+        transferProgressBar->setVisible(false);  // 隐藏传输进度条
+        
+        logMessage(QString("[错误] 计算本地文件%1失败: %2")
+                  .arg(FileDigest::displayName(verifyAlgorithm)).arg(errorMessage));
+        statusBar()->showMessage("校验失败", 3000);
+        
+        QMessageBox::warning(this, "校验失败", 
+            QString("无法计算本地文件摘要，但文件已上传成功\n错误: %1").arg(errorMessage));
+        return;
     }
+    
+    logMessage(QString("[警告] 后台计算MD5失败: %1，将在上传时计算").arg(errorMessage));
+}
+
+void MainWindow::finishUploadStats()
+{
+    if (!uploadStats.isActive()) {
+        return;
+    }
+    
+    uploadStats.stop();
+    
+    // 吞吐量历史写入上传日志，便于对比不同站点的链路质量
+    QStringList report = uploadStats.historyReport();
+    for (const QString &line : report) {
+        logMessage(line);
+    }
+}
+
+void MainWindow::resetTransferProgressBar()
+{
+    // 恢复为不确定模式，升级流程仍使用滚动动画
+    transferProgressBar->setVisible(false);
+    transferProgressBar->setMaximum(0);
+    transferProgressBar->setValue(0);
+    transferProgressBar->setTextVisible(false);
 }
 
 void MainWindow::onCancelUpload()
 {
-    if (uploadProcess) {
+    if (retryTimer->isActive()) {
+        // 正在等待重试：不再重新执行，界面直接恢复
+        retryTimer->stop();
+        pendingRetry = RetryNone;
+        logMessage("用户取消了等待中的重试");
+        
+        uploadWatchdog->stop();
+        progressTimer->stop();
+        cancelButton->setVisible(false);
+        resetTransferProgressBar();  // 隐藏传输进度条
+        enableAllOperationButtons();
+        
+        statusLabel->setText("已取消重试");
+        statusBar()->showMessage("已取消重试", 3000);
+        return;
+    }
+    
+    if (chunkedUploader->isRunning()) {
         logMessage("用户取消上传操作...");
         
-        timeoutTimer->stop();
+        uploadWatchdog->stop();
         progressTimer->stop();
-        uploadProcess->kill();
+        chunkedUploader->cancel();
+        finishUploadStats();
         
         statusLabel->setText("上传已取消");
         uploadButton->setEnabled(true);
@@ -1073,46 +1212,176 @@ void MainWindow::onCancelUpload()
         upgrade7evButton->setEnabled(true);
         upgradeKu5pButton->setEnabled(true);
         cancelButton->setVisible(false);
-        transferProgressBar->setVisible(false);  // 隐藏传输进度条
+        resetTransferProgressBar();  // 隐藏传输进度条
         
-        logMessage("上传已取消");
+        logMessage("上传已取消，已上传的分块将在下次上传时续传");
         statusBar()->showMessage("上传已取消", 3000);
+    } else if (batchUploader->isRunning()) {
+        logMessage("用户取消多文件上传操作...");
+        
+        uploadWatchdog->stop();
+        progressTimer->stop();
+        batchUploader->cancel();
+        finishUploadStats();
+        
+        statusLabel->setText("上传已取消");
+        uploadButton->setEnabled(true);
+        upgradeQtButton->setEnabled(true);
+        upgrade7evButton->setEnabled(true);
+        upgradeKu5pButton->setEnabled(true);
+        cancelButton->setVisible(false);
+        resetTransferProgressBar();  // 隐藏传输进度条
         
-        uploadProcess->waitForFinished(1000);
-        uploadProcess->deleteLater();
-        uploadProcess = nullptr;
+        logMessage("上传已取消，大文件已上传的分块将在下次上传时续传");
+        statusBar()->showMessage("上传已取消", 3000);
+    } else if (streamExtractor->isRunning()) {
+        // 界面在 onStreamExtractFinished 中恢复
+        logMessage("用户取消流式升级操作...");
+        uploadWatchdog->stop();
+        streamExtractor->cancel();
     }
 }
 
 
-void MainWindow::onUploadTimeout()
+void MainWindow::onUploadTimeout(const QString &reason)
 {
-    if (uploadProcess) {
-        logMessage("上传超时！强制终止上传...");
+    if (streamExtractor->isRunning()) {
+        // 界面在 onStreamExtractFinished 中恢复
+        logMessage(QString("流式升级超时：%1，强制终止...").arg(reason));
+        transferStalled = true;
+        streamExtractor->cancel();
+        return;
+    }
+    
+    bool batchRunning = batchUploader->isRunning();
+    if (chunkedUploader->isRunning() || batchRunning) {
+        logMessage(QString("上传超时：%1，强制终止上传...").arg(reason));
         
         progressTimer->stop();
-        uploadProcess->kill();
+        if (batchRunning) {
+            batchUploader->cancel();
+        } else {
+            chunkedUploader->cancel();
+        }
+        finishUploadStats();
+        
+        // 传输停滞视为网络中断，等上传引擎退出后从中断处续传
+        if (scheduleRetry(batchRunning ? RetryBatchUpload : RetryUpload, RetryPolicy::ErrorNetwork, reason)) {
+            return;
+        }
+        
         statusLabel->setText("上传超时");
         uploadButton->setEnabled(true);
         upgradeQtButton->setEnabled(true);
         upgrade7evButton->setEnabled(true);
         upgradeKu5pButton->setEnabled(true);
         cancelButton->setVisible(false);
-        transferProgressBar->setVisible(false);  // 隐藏传输进度条
+        resetTransferProgressBar();  // 隐藏传输进度条
         
         logMessage("上传超时失败！请检查网络连接和服务器设置。");
         statusBar()->showMessage("上传超时", 3000);
         
         QMessageBox::warning(this, "上传超时", 
-            "SCP上传操作超时（5分钟），请检查：\n"
+            QString("上传操作超时：%1\n\n请检查：\n"
             "1. 网络连接是否正常\n"
             "2. 服务器是否可达\n"
             "3. SSH服务是否正常\n"
-            "4. 用户名密码是否正确");
-            
-        uploadProcess->waitForFinished(1000);
-        uploadProcess->deleteLater();
-        uploadProcess = nullptr;
+            "4. 用户名密码是否正确\n\n"
+            "已上传的分块已保留，重新上传时将从中断处继续。").arg(reason));
+    }
+}
+
+bool MainWindow::scheduleRetry(RetryStep step, RetryPolicy::ErrorClass errorClass, const QString &reason)
+{
+    if (!stepRetry.shouldRetry(errorClass)) {
+        if (errorClass == RetryPolicy::ErrorAuth) {
+            logMessage("[重试] 认证失败，重试不会成功，请检查用户名、密码或SSH密钥");
+        } else if (errorClass == RetryPolicy::ErrorNetwork && stepRetry.maxAttempts() > 0) {
+            logMessage(QString("[重试] 已重试 %1 次仍然失败，不再重试").arg(stepRetry.attempt()));
+        }
+        return false;
+    }
+    
+    int delayMs = stepRetry.nextDelayMs();
+    logMessage(QString("[重试] %1: %2").arg(RetryPolicy::className(errorClass)).arg(reason.trimmed()));
+    logMessage(QString("[重试] %1 秒后进行第 %2/%3 次重试")
+               .arg(delayMs / 1000.0, 0, 'f', 1)
+               .arg(stepRetry.attempt())
+               .arg(stepRetry.maxAttempts()));
+    
+    // 等待期间保留取消按钮，用户可以放弃重试
+    pendingRetry = step;
+    cancelButton->setVisible(true);
+    statusLabel->setText(QString("连接中断，等待第 %1 次重试").arg(stepRetry.attempt()));
+    statusBar()->showMessage("等待重试...", 0);
+    retryTimer->start(delayMs);
+    return true;
+}
+
+void MainWindow::onRetryTimer()
+{
+    RetryStep step = pendingRetry;
+    pendingRetry = RetryNone;
+    
+    switch (step) {
+    case RetryUpload:
+    case RetryStreamExtract:
+        if (chunkedUploader->isRunning() || streamExtractor->isRunning() || batchUploader->isRunning()) {
+            // 被看门狗终止的传输尚未完全退出
+            pendingRetry = step;
+            retryTimer->start(500);
+            return;
+        }
+        
+        logMessage(QString("[重试] 第 %1 次重试%2").arg(stepRetry.attempt())
+                   .arg(step == RetryUpload ? "上传，从中断处续传" : "流式升级，从头发送升级包"));
+        statusLabel->setText("正在连接服务器...");
+        transferProgressBar->setVisible(true);
+        uploadStats.start(QFileInfo(selectedFilePath).size());
+        uploadWatchdog->setStallTimeout(stallTimeoutSeconds);
+        uploadWatchdog->start(QFileInfo(selectedFilePath).size());
+        if (step == RetryUpload) {
+            chunkedUploader->start();
+        } else {
+            streamExtractor->start();
+        }
+        progressTimer->start(1000);
+        break;
+        
+    case RetryBatchUpload:
+        if (batchUploader->isRunning()) {
+            pendingRetry = step;
+            retryTimer->start(500);
+            return;
+        }
+        
+        logMessage(QString("[重试] 第 %1 次重试多文件上传，只发送未完成的文件").arg(stepRetry.attempt()));
+        statusLabel->setText("正在连接服务器...");
+        transferProgressBar->setVisible(true);
+        uploadStats.start(batchUploader->totalSize());
+        uploadWatchdog->setStallTimeout(stallTimeoutSeconds);
+        uploadWatchdog->start(batchUploader->totalSize());
+        batchUploader->start();
+        progressTimer->start(1000);
+        break;
+        
+    case RetryVerify:
+        cancelButton->setVisible(false);
+        logMessage(QString("[重试] 第 %1 次重新校验远程文件摘要").arg(stepRetry.attempt()));
+        statusLabel->setText("正在校验文件完整性...");
+        startFileVerification();
+        break;
+        
+    case RetryUpgradePipeline:
+        // 整个流水线重新执行，已满足的步骤由跳过条件跳过
+        cancelButton->setVisible(false);
+        logMessage(QString("[重试] 第 %1 次重新执行%2").arg(stepRetry.attempt()).arg(upgradePipeline->name()));
+        statusLabel->setText(QString("正在执行%1").arg(upgradePipeline->name()));
+        runUpgradePipeline();
+        break;
+        
+    case RetryNone:
+        break;
     }
 }
 
@@ -1129,12 +1398,18 @@ void MainWindow::onTestFinished(int exitCode, QProcess::ExitStatus exitStatus)
             logMessage(QString("[响应] %1").arg(output.trimmed()));
         }
         
-        // 根据当前认证方式给出相应提示
+        // 根据实际发生的认证给出提示：应答过密码提示说明走了密码认证，否则是密钥或免密登录
         bool hasSSHKey = checkSSHKeyExists();
         bool hasPassword = !passwordLineEdit->text().isEmpty();
+        bool passwordUsed = sshSessionManager->askPassAnswerCount() > testAskPassAnswers;
         
-        // 检查输出中是否包含认证方式信息（来自Python脚本）
-        if (output.contains("公钥认证") || output.contains("SSH密钥认证成功")) {
+        if (testReusedConnection) {
+            logMessage("[提示] 复用了已建立的SSH连接，本次未重新认证");
+        } else if (passwordUsed && hasSSHKey) {
+            logMessage("[提示] 连接成功，但SSH密钥未被服务器接受，本次使用密码认证");
+            logMessage("[建议] 请检查公钥是否已部署到服务器，可点击'SSH密钥'按钮重新部署");
+            lastSuccessfulAuthMethod = "Password";
+        } else if (!passwordUsed && hasSSHKey) {
             logMessage("[安全] SSH密钥认证成功，这是最安全的连接方式");
             lastSuccessfulAuthMethod = "SSHKey";
             // 如果使用SSH密钥认证成功，清空密码字段避免混淆
@@ -1142,40 +1417,19 @@ void MainWindow::onTestFinished(int exitCode, QProcess::ExitStatus exitStatus)
                 passwordLineEdit->clear();
                 logMessage("[安全] 已清空密码字段，当前使用SSH密钥认证");
             }
-        } else if (output.contains("密码认证") || output.contains("密码认证成功")) {
+        } else if (passwordUsed) {
             logMessage("[成功] 密码认证连接成功");
-            lastSuccessfulAuthMethod = "Password";
-            logMessage("[提示] 连接正常，如需要自动化操作建议配置SSH密钥");
-            logMessage("[建议] 点击'SSH密钥'按钮可以生成并部署SSH密钥");
+            logMessage("[提示] 连接正常，如需自动化操作建议配置SSH密钥：");
+            logMessage("        点击'SSH密钥'按钮可以生成并部署SSH密钥");
             logMessage("        SSH密钥认证更安全且无需每次输入密码");
+            lastSuccessfulAuthMethod = "Password";
         } else {
-            // 传统SSH命令的处理逻辑
-            if (hasSSHKey && hasPassword) {
-                logMessage("[提示] 连接成功！当前同时配置了SSH密钥和密码认证");
-                logMessage("[建议] 为了安全和便利，建议优先使用SSH密钥认证");
-                lastSuccessfulAuthMethod = "Mixed";
-            } else if (hasSSHKey) {
-                logMessage("[安全] SSH密钥认证成功，这是最安全的连接方式");
-                lastSuccessfulAuthMethod = "SSHKey";
-                // 如果使用SSH密钥认证成功，清空密码字段避免混淆
-                if (hasPassword) {
-                    passwordLineEdit->clear();
-                    logMessage("[安全] 已清空密码字段，当前使用SSH密钥认证");
-                }
-            } else if (hasPassword) {
-                logMessage("[成功] 密码认证连接成功");
-                logMessage("[提示] 连接正常，如需自动化操作建议配置SSH密钥：");
-                logMessage("        点击'SSH密钥'按钮可以生成并部署SSH密钥");
-                logMessage("        SSH密钥认证更安全且无需每次输入密码");
-                lastSuccessfulAuthMethod = "Password";
-            } else {
-                // 既没有密钥也没有密码，但连接成功了
-                logMessage("[成功] 使用系统默认SSH配置连接成功");
-                logMessage("[说明] 服务器可能配置了免密码登录或其他认证方式");
-                logMessage("[建议] 如需要稳定的自动化操作，建议配置SSH密钥：");
-                logMessage("        点击'SSH密钥'按钮可以生成并部署SSH密钥");
-                lastSuccessfulAuthMethod = "NoAuth";
-            }
+            // 没有密钥也没有应答密码，但连接成功了
+            logMessage("[成功] 使用系统默认SSH配置连接成功");
+            logMessage("[说明] 服务器可能配置了免密码登录或其他认证方式");
+            logMessage("[建议] 如需要稳定的自动化操作，建议配置SSH密钥：");
+            logMessage("        点击'SSH密钥'按钮可以生成并部署SSH密钥");
+            lastSuccessfulAuthMethod = "NoAuth";
         }
     } else {
         QString error = testProcess->readAllStandardError();
@@ -1328,12 +1582,17 @@ bool MainWindow::validateSettings()
         }
     }
     
-    if (selectedFilePath.isEmpty()) {
+    if (!batchPaths.isEmpty()) {
+        for (const QString &path : batchPaths) {
+            if (!QFileInfo::exists(path)) {
+                QMessageBox::warning(this, "文件错误", QString("选择的文件或目录不存在:\n%1").arg(path));
+                return false;
+            }
+        }
+    } else if (selectedFilePath.isEmpty()) {
         QMessageBox::warning(this, "文件错误", "请先选择要上传的文件");
         return false;
-    }
-    
-    if (!QFile::exists(selectedFilePath)) {
+    } else if (!QFile::exists(selectedFilePath)) {
         QMessageBox::warning(this, "文件错误", "选择的文件不存在");
         return false;
     }
@@ -1360,24 +1619,26 @@ bool MainWindow::validateSettings()
 
 void MainWindow::startUpload()
 {
+    if (!batchPaths.isEmpty()) {
+        startBatchUpload();
+        return;
+    }
+    
     logMessage(QString("开始上传文件: %1").arg(QFileInfo(selectedFilePath).fileName()));
     logMessage(QString("文件大小: %1 字节").arg(QFileInfo(selectedFilePath).size()));
     
-    // 计算本地文件MD5值
-    logMessage("正在计算本地文件MD5值...");
-    localFileMD5 = calculateFileMD5(selectedFilePath);
-    if (localFileMD5.isEmpty()) {
-        logMessage("[错误] 无法计算本地文件MD5值");
-        QMessageBox::warning(this, "错误", "无法计算本地文件MD5值，上传取消");
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
+        logMessage("[警告] 上一次上传仍在进行中，请先取消或等待完成");
         return;
     }
-    logMessage(QString("本地文件MD5: %1").arg(localFileMD5));
     
-    if (uploadProcess) {
-        uploadProcess->kill();
-        uploadProcess->waitForFinished(1000);
-        uploadProcess->deleteLater();
-        uploadProcess = nullptr;
+    // 优先使用缓存的MD5；未命中时停止后台计算，由上传过程边发送边计算
+    localFileMD5 = hashService->cachedMd5(selectedFilePath);
+    if (!localFileMD5.isEmpty()) {
+        logMessage(QString("本地文件MD5(缓存): %1").arg(localFileMD5));
+    } else if (hashService->isHashing()) {
+        hashService->cancel();
+        logMessage("后台MD5计算未完成，改为上传时同步计算");
     }
     
     uploadButton->setEnabled(false);
@@ -1387,9 +1648,10 @@ void MainWindow::startUpload()
     cancelButton->setVisible(true);
     statusLabel->setText("正在连接服务器...");
     transferProgressBar->setVisible(true);  // 显示传输进度条
-    timeoutTimer->start(300000); // 5分钟超时
+    uploadWatchdog->setStallTimeout(stallTimeoutSeconds);
+    uploadWatchdog->start(QFileInfo(selectedFilePath).size());  // 按进度停滞和估算的截止时间判断超时
     
-    // 准备SCP命令
+    // 准备上传参数
     QString ip = ipLineEdit->text().trimmed();
     int port = portSpinBox->value();
     QString username = usernameLineEdit->text().trimmed();
@@ -1401,85 +1663,243 @@ void MainWindow::startUpload()
     }
     
     // 构建远程文件路径
-    QString remoteFile = QString("%1@%2:%3%4")
-                        .arg(username)
-                        .arg(ip)
-                        .arg(remotePath)
-                        .arg(QFileInfo(selectedFilePath).fileName());
-    
-    uploadProcess = new QProcess(this);
-    
-    // 连接信号
-    connect(uploadProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &MainWindow::onUploadFinished);
-    connect(uploadProcess, &QProcess::readyReadStandardOutput, this, &MainWindow::onUploadOutput);
-    
-    // 设置环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    uploadProcess->setProcessEnvironment(env);
+    QString remoteFile = remotePath + QFileInfo(selectedFilePath).fileName();
     
-    // 根据之前的连接测试结果构建SCP命令
-    QString program = "scp";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null";
+    // 远程文件即将被覆盖，之前的校验结果作废
+    verifiedUploads.remove(verifiedUploadKey(QFileInfo(selectedFilePath).fileName()));
     
-    // 根据上次成功的认证方式设置认证参数
-    if (lastSuccessfulAuthMethod == "NoAuth") {
-        // 无认证方式，使用最简单的连接
-        arguments << "-o" << "BatchMode=yes"
-                  << "-o" << "PasswordAuthentication=no"
-                  << "-o" << "PubkeyAuthentication=yes";
-        logMessage("[认证] 使用无密码认证方式进行文件传输");
-    } else if (lastSuccessfulAuthMethod == "SSHKey") {
-        // SSH密钥认证
-        arguments << "-o" << "PreferredAuthentications=publickey"
-                  << "-o" << "PubkeyAuthentication=yes"
-                  << "-o" << "PasswordAuthentication=no"
-                  << "-o" << "BatchMode=yes";
-        logMessage("[认证] 使用SSH密钥认证进行文件传输");
-    } else if (lastSuccessfulAuthMethod == "Password") {
-        // 密码认证
-        arguments << "-o" << "PreferredAuthentications=password"
-                  << "-o" << "PubkeyAuthentication=no"
-                  << "-o" << "PasswordAuthentication=yes"
-                  << "-o" << "BatchMode=yes";
-        logMessage("[认证] 使用密码认证进行文件传输");
-    } else {
-        // 混合认证或默认情况
-        arguments << "-o" << "PreferredAuthentications=publickey,password"
-                  << "-o" << "PubkeyAuthentication=yes"
-                  << "-o" << "PasswordAuthentication=yes"
-                  << "-o" << "BatchMode=yes";
-        logMessage("[认证] 使用混合认证方式进行文件传输");
-    }
+    // 根据之前的连接测试结果构建SSH认证参数
+    QStringList arguments = buildUploadAuthOptions();
     
-    arguments << "-P" << QString::number(port)  // 注意SCP用大写P
-              << selectedFilePath
-              << remoteFile;
+    chunkedUploader->setLocalFile(selectedFilePath);
+    chunkedUploader->setRemoteTarget(ip, port, username, remoteFile);
+    chunkedUploader->setSshOptions(arguments);
+    chunkedUploader->setSshEnvironment(sshSessionManager->sshEnvironment());
+    chunkedUploader->setStateDirectory(getUploadStateDirectory());
+    chunkedUploader->setExpectedMd5(localFileMD5);  // 已知MD5时预检查远程文件，相同则跳过传输
+    chunkedUploader->setDeltaEnabled(deltaUploadEnabled);  // 远程已有旧版本时只发送差异块
+    chunkedUploader->setCompressionEnabled(compressUploadEnabled);  // 慢速链路上压缩传输
+    chunkedUploader->setStreamCount(uploadStreamCount);  // 高延迟链路上分段并行发送
+    chunkedUploader->setRateLimit(uploadRateLimiter, deviceRateLimitKBps * 1024);  // 生产时段限速
     
-    logMessage(QString("SCP命令: %1 %2").arg(program).arg(arguments.join(" ")));
-    logMessage("开始SCP上传...");
+    logMessage(QString("上传目标: %1@%2:%3").arg(username).arg(ip).arg(remoteFile));
+    logMessage("开始分块上传...");
     
-    // 启动进程
-    uploadProcess->start(program, arguments);
+    // 启动分块上传（自动从上次中断的分块续传）
+    stepRetry.reset();
+    uploadStats.start(QFileInfo(selectedFilePath).size());
+    chunkedUploader->start();
     
-    // 启动进度模拟定时器
-    progressTimer->start(1000); // 每秒更新一次进度
+    // 启动进度采样定时器
+    progressTimer->start(1000); // 每秒采样一次吞吐量
     
     statusBar()->showMessage("正在上传文件...", 0);
 }
 
-QString MainWindow::getSettingsFilePath()
-{
-    // 获取可执行程序所在目录
-    QString appDir = QApplication::applicationDirPath();
-    QString settingsFile = appDir + "/upload_settings.json";
-    return settingsFile;
-}
-
-void MainWindow::saveSettingsToFile()
+void MainWindow::startBatchUpload()
+{
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
+        logMessage("[警告] 上一次上传仍在进行中，请先取消或等待完成");
+        return;
+    }
+    
+    // 展开目录得到文件清单，重新选择前每次上传都按磁盘上的最新内容重新扫描
+    QString collectError;
+    QList<BatchUploader::Entry> entries = BatchUploader::collectEntries(batchPaths, &collectError);
+    if (entries.isEmpty()) {
+        QMessageBox::warning(this, "文件错误", collectError);
+        return;
+    }
+    
+    qint64 totalBytes = 0;
+    for (const BatchUploader::Entry &entry : entries) {
+        totalBytes += entry.size;
+    }
+    logMessage(QString("开始多文件上传: %1 个文件，共 %2 字节").arg(entries.size()).arg(totalBytes));
+    
+    uploadButton->setEnabled(false);
+    upgradeQtButton->setEnabled(false);
+    upgrade7evButton->setEnabled(false);
+    upgradeKu5pButton->setEnabled(false);
+    cancelButton->setVisible(true);
+    statusLabel->setText("正在连接服务器...");
+    transferProgressBar->setVisible(true);  // 显示传输进度条
+    uploadWatchdog->setStallTimeout(stallTimeoutSeconds);
+    uploadWatchdog->start(totalBytes);
+    
+    // 远程文件即将被覆盖，之前的校验结果作废
+    for (const BatchUploader::Entry &entry : entries) {
+        verifiedUploads.remove(verifiedUploadKey(entry.relativePath));
+    }
+    
+    // 所有通道复用同一条SSH主连接
+    batchUploader->setEntries(entries);
+    batchUploader->setRemoteTarget(ipLineEdit->text().trimmed(), portSpinBox->value(),
+                                   usernameLineEdit->text().trimmed(), remoteDirectory.trimmed());
+    batchUploader->setSshOptions(buildUploadAuthOptions());
+    batchUploader->setSshEnvironment(sshSessionManager->sshEnvironment());
+    batchUploader->setStateDirectory(getUploadStateDirectory());
+    batchUploader->setDeltaEnabled(deltaUploadEnabled);
+    batchUploader->setCompressionEnabled(compressUploadEnabled);
+    batchUploader->setRateLimit(uploadRateLimiter, deviceRateLimitKBps * 1024);  // 生产时段限速
+    
+    stepRetry.reset();
+    uploadStats.start(totalBytes);
+    batchUploader->start();
+    
+    progressTimer->start(1000);
+    statusBar()->showMessage("正在上传文件...", 0);
+}
+
+void MainWindow::onBatchUploadFinished(bool success, const QString &errorMessage)
+{
+    uploadWatchdog->stop();
+    progressTimer->stop();
+    finishUploadStats();
+    
+    if (!success && scheduleRetry(RetryBatchUpload, batchUploader->lastErrorClass(), errorMessage)) {
+        // 界面保持上传状态，退避后只重发未完成的文件
+        return;
+    }
+    
+    uploadButton->setEnabled(true);
+    upgradeQtButton->setEnabled(true);
+    upgrade7evButton->setEnabled(true);
+    upgradeKu5pButton->setEnabled(true);
+    cancelButton->setVisible(false);
+    resetTransferProgressBar();  // 隐藏传输进度条
+    
+    int fileCount = batchUploader->entries().size();
+    if (success) {
+        logMessage(QString("[成功] %1 个文件上传完成并通过MD5校验！").arg(fileCount));
+        statusLabel->setText("上传并校验成功");
+        statusBar()->showMessage("上传并校验成功", 3000);
+        
+        QMessageBox::information(this, "上传成功", 
+            QString("%1 个文件 (%2 字节) 已成功上传到服务器并通过MD5校验\n目标路径: %3")
+            .arg(fileCount).arg(batchUploader->totalSize()).arg(remoteDirectory));
+    } else {
+        logMessage("多文件上传失败！");
+        statusLabel->setText("上传失败");
+        statusBar()->showMessage("上传失败", 3000);
+        
+        if (!errorMessage.isEmpty()) {
+            logMessage(QString("错误信息: %1").arg(errorMessage));
+        }
+        logMessage("[提示] 大文件已上传的分块会保留在服务器上，重新点击'开始上传'将从中断处继续");
+        
+        QMessageBox::warning(this, "上传失败", 
+            QString("多文件上传失败\n%1")
+            .arg(errorMessage.isEmpty() ? "请检查网络连接和服务器设置" : errorMessage));
+    }
+}
+
+QStringList MainWindow::buildUploadAuthOptions()
+{
+    QStringList arguments;
+    
+    // 密码通过 SSH_ASKPASS 提供，上传进程使用 sshSessionManager->sshEnvironment() 启动
+    sshSessionManager->setPassword(passwordLineEdit->text());
+    
+    // 根据上次成功的认证方式设置认证参数
+    if (lastSuccessfulAuthMethod == "NoAuth") {
+        // 无认证方式，使用最简单的连接
+        arguments << "-o" << "BatchMode=yes"
+                  << "-o" << "PasswordAuthentication=no"
+                  << "-o" << "PubkeyAuthentication=yes";
+        logMessage("[认证] 使用无密码认证方式进行文件传输");
+    } else if (lastSuccessfulAuthMethod == "SSHKey") {
+        // SSH密钥认证
+        arguments << "-o" << "PreferredAuthentications=publickey"
+                  << "-o" << "PubkeyAuthentication=yes"
+                  << "-o" << "PasswordAuthentication=no"
+                  << "-o" << "BatchMode=yes";
+        logMessage("[认证] 使用SSH密钥认证进行文件传输");
+    } else if (lastSuccessfulAuthMethod == "Password") {
+        // 密码认证
+        arguments << "-o" << "PreferredAuthentications=password"
+                  << "-o" << "PubkeyAuthentication=no"
+                  << "-o" << "PasswordAuthentication=yes"
+                  << sshSessionManager->batchArguments();
+        logMessage("[认证] 使用密码认证进行文件传输");
+    } else {
+        // 混合认证或默认情况
+        arguments << "-o" << "PreferredAuthentications=publickey,password"
+                  << "-o" << "PubkeyAuthentication=yes"
+                  << "-o" << "PasswordAuthentication=yes"
+                  << sshSessionManager->batchArguments();
+        logMessage("[认证] 使用混合认证方式进行文件传输");
+    }
+    
+    // 支持连接复用的平台上，上传通道复用已建立的SSH主连接
+    arguments << sshSessionManager->controlArguments();
+    
+    return arguments;
+}
+
+QString MainWindow::currentDeviceKey() const
+{
+    return QString("%1@%2:%3").arg(usernameLineEdit->text().trimmed())
+           .arg(ipLineEdit->text().trimmed()).arg(portSpinBox->value());
+}
+
+QString MainWindow::verifiedUploadKey(const QString &fileName) const
+{
+    QString remotePath = remoteDirectory.trimmed();
+    if (!remotePath.endsWith('/')) {
+        remotePath += '/';
+    }
+    return currentDeviceKey() + '|' + remotePath + fileName;
+}
+
+SshSession *MainWindow::currentSshSession()
+{
+    // 与原先各远程操作使用的认证参数一致；填写了密码时由 SSH_ASKPASS 完成密码认证
+    sshSessionManager->setPassword(passwordLineEdit->text());
+    
+    QStringList options;
+    options << "-o" << "PreferredAuthentications=publickey,password"
+            << "-o" << "PubkeyAuthentication=yes"
+            << "-o" << "PasswordAuthentication=yes"
+            << sshSessionManager->batchArguments();
+    
+    return sshSessionManager->session(ipLineEdit->text().trimmed(), portSpinBox->value(),
+                                      usernameLineEdit->text().trimmed(), options);
+}
+
+QString MainWindow::getSettingsFilePath()
+{
+    // 获取可执行程序所在目录
+    QString appDir = QApplication::applicationDirPath();
+    QString settingsFile = appDir + "/upload_settings.json";
+    return settingsFile;
+}
+
+QString MainWindow::getUploadStateDirectory()
+{
+    // 分块上传的本地清单保存在可执行程序目录下
+    return QApplication::applicationDirPath() + "/upload_state";
+}
+
+QString MainWindow::getHashCacheFilePath()
+{
+    // 文件摘要缓存保存在可执行程序目录下
+    return QApplication::applicationDirPath() + "/hash_cache.json";
+}
+
+QString MainWindow::getUpgradeTelemetryPath()
+{
+    // 升级耗时记录保存在可执行程序目录下，每行一次升级
+    return QApplication::applicationDirPath() + "/upgrade_telemetry.jsonl";
+}
+
+QString MainWindow::getFleetDeviceListPath()
+{
+    // 批量上传的设备列表保存在可执行程序目录下
+    return QApplication::applicationDirPath() + "/fleet_devices.json";
+}
+
+void MainWindow::saveSettingsToFile()
 {
     QString filePath = getSettingsFilePath();
     
@@ -1684,24 +2104,28 @@ QString MainWindow::getLogFilePath()
 
 void MainWindow::writeLogToFile(const QString &message)
 {
+    // 日志路径在设置中修改后重新打开
     QString filePath = getLogFilePath();
-    
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
-        QTextStream stream(&file);
-        stream.setCodec("UTF-8"); // 设置UTF-8编码以支持中文
-        
-        // 添加日期信息（仅在每天第一次写入时）
-        static QString lastDate;
-        QString currentDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
-        if (lastDate != currentDate) {
-            stream << "\n========== " << currentDate << " ==========\n";
-            lastDate = currentDate;
+    if (!logFile || logFile->fileName() != filePath) {
+        delete logFile;
+        logFile = new QFile(filePath, this);
+        if (!logFile->open(QIODevice::WriteOnly | QIODevice::Append)) {
+            delete logFile;
+            logFile = nullptr;
+            return;
         }
-        
-        stream << message << "\n";
-        file.close();
     }
+    
+    // 添加日期信息（仅在每天第一次写入时），以UTF-8编码写入以支持中文
+    static QString lastDate;
+    QString currentDate = QDateTime::currentDateTime().toString("yyyy-MM-dd");
+    if (lastDate != currentDate) {
+        logFile->write(QString("\n========== %1 ==========\n").arg(currentDate).toUtf8());
+        lastDate = currentDate;
+    }
+    
+    logFile->write((message + "\n").toUtf8());
+    logFile->flush();
 }
 
 QString MainWindow::calculateFileMD5(const QString &filePath)
@@ -1722,15 +2146,12 @@ QString MainWindow::calculateFileMD5(const QString &filePath)
 void MainWindow::startFileVerification()
 {
     if (verifyProcess) {
+        verifyProcess->disconnect(this);
         verifyProcess->kill();
-        verifyProcess->waitForFinished(1000);
         verifyProcess->deleteLater();
         verifyProcess = nullptr;
     }
     
-    QString ip = ipLineEdit->text().trimmed();
-    int port = portSpinBox->value();
-    QString username = usernameLineEdit->text().trimmed();
     QString remotePath = remoteDirectory.trimmed();
     
     // 确保远程路径以/结尾
@@ -1741,39 +2162,101 @@ void MainWindow::startFileVerification()
     // 构建远程文件路径
     QString remoteFilePath = remotePath + QFileInfo(selectedFilePath).fileName();
     
-    // 创建SSH进程来计算远程文件MD5
-    verifyProcess = new QProcess(this);
+    // 每台设备首次校验时查询可用的摘要工具，结果在本次运行中复用
+    QString deviceKey = currentDeviceKey();
+    if (!deviceDigests.contains(deviceKey)) {
+        verifyProcess = new SshCommand(this);
+        connect(verifyProcess, &SshCommand::finished,
+                this, &MainWindow::onDigestNegotiated);
+        
+        logMessage("查询设备可用的摘要工具...");
+        verifyProcess->start(currentSshSession(), FileDigest::negotiationCommand());
+        return;
+    }
+    verifyAlgorithm = deviceDigests.value(deviceKey);
+    
+    // 本地摘要：MD5 在上传时已得到，其他算法由后台摘要服务计算（有缓存时直接使用）
+    QString localDigest = localFileMD5;
+    if (verifyAlgorithm != FileDigest::Md5) {
+        localDigest = hashService->cachedDigest(selectedFilePath, verifyAlgorithm);
+        if (localDigest.isEmpty() && verifyDigestPreference == "auto" && !localFileMD5.isEmpty()) {
+            // 自动模式下不为校验再读一遍本地文件：没有缓存的摘要时改用上传时已得到的MD5
+            logMessage(QString("[提示] 本地没有缓存的%1，使用上传时已得到的MD5校验")
+                      .arg(FileDigest::displayName(verifyAlgorithm)));
+            verifyAlgorithm = FileDigest::Md5;
+            localDigest = localFileMD5;
+        } else if (localDigest.isEmpty()) {
+            verifyAwaitingDigest = true;
+            logMessage(QString("计算本地文件%1...").arg(FileDigest::displayName(verifyAlgorithm)));
+            hashService->requestDigest(selectedFilePath, verifyAlgorithm);
+            return;
+        }
+    }
+    
+    // 按清单在一次远程调用中计算摘要，结果按条目解析
+    verifyManifest.clear();
+    verifyManifest.setAlgorithm(verifyAlgorithm);
+    verifyManifest.addFile(remoteFilePath, localDigest);
     
-    connect(verifyProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+    verifyProcess = new SshCommand(this);
+    
+    connect(verifyProcess, &SshCommand::finished,
             this, &MainWindow::onVerifyFileFinished);
     
-    // 设置环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    verifyProcess->setProcessEnvironment(env);
+    logMessage(QString("执行远程%1计算: %2").arg(FileDigest::displayName(verifyAlgorithm)).arg(remoteFilePath));
     
-    // 构建SSH命令来计算远程文件MD5
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(port)
-              << QString("%1@%2").arg(username).arg(ip)
-              << QString("md5sum '%1'").arg(remoteFilePath);
-    
-    logMessage(QString("执行远程MD5计算: md5sum '%1'").arg(remoteFilePath));
+    // 通过当前设备的常驻SSH会话执行，不再为每条命令重新建立连接
+    verifyProcess->start(currentSshSession(), verifyManifest.remoteCommand());
+}
+
+void MainWindow::onDigestNegotiated(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!verifyProcess) {
+        return;
+    }
     
-    // 启动进程
-    verifyProcess->start(program, arguments);
+    QByteArray probeOutput = verifyProcess->readAllStandardOutput();
+    QString probeError = verifyProcess->readAllStandardError();
+    QProcess::ProcessError processError = verifyProcess->error();
+    verifyProcess->deleteLater();
+    verifyProcess = nullptr;
+    
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        if (scheduleRetry(RetryVerify, RetryPolicy::classify(exitCode, exitStatus, probeError, processError),
+                          probeError.isEmpty() ? QString("查询摘要工具失败 (退出码: %1)").arg(exitCode) : probeError)) {
+            return;
+        }
+        // 无法查询时按所有设备都支持的 MD5 校验，实际错误由校验命令报告
+        logMessage("[警告] 查询设备摘要工具失败，按 MD5 校验");
+        probeOutput.clear();
+    }
+    
+    QString note;
+    FileDigest::Algorithm algorithm = FileDigest::negotiate(verifyDigestPreference, probeOutput, &note);
+    if (!note.isEmpty()) {
+        logMessage(QString("[提示] %1").arg(note));
+    }
+    logMessage(QString("设备 %1 校验算法: %2").arg(currentDeviceKey()).arg(FileDigest::displayName(algorithm)));
+    deviceDigests.insert(currentDeviceKey(), algorithm);
+    
+    startFileVerification();
 }
 
 void MainWindow::onVerifyFileFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    timeoutTimer->stop();
+    QString digestName = FileDigest::displayName(verifyManifest.algorithm());
+    QString verifyError;
+    if (verifyProcess && (exitStatus != QProcess::NormalExit || exitCode != 0)) {
+        verifyError = verifyProcess->readAllStandardError();
+        if (scheduleRetry(RetryVerify, RetryPolicy::classify(exitCode, exitStatus, verifyError, verifyProcess->error()),
+                          verifyError.isEmpty() ? QString("远程%1计算失败 (退出码: %2)").arg(digestName).arg(exitCode) : verifyError)) {
+            verifyProcess->deleteLater();
+            verifyProcess = nullptr;
+            return;
+        }
+    }
+    
+    uploadWatchdog->stop();
     progressTimer->stop();
     uploadButton->setEnabled(true);
     upgradeQtButton->setEnabled(true);
@@ -1782,65 +2265,54 @@ void MainWindow::onVerifyFileFinished(int exitCode, QProcess::ExitStatus exitSta
     cancelButton->setVisible(false);
     transferProgressBar->setVisible(false);  // 隐藏传输进度条
     
+    // 只有校验通过时才重新登记（见 reportVerificationPassed），其余结果一律视为未校验
+    verifiedUploads.remove(verifiedUploadKey(QFileInfo(selectedFilePath).fileName()));
+    
     if (verifyProcess) {
         if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = verifyProcess->readAllStandardOutput().trimmed();
-            
-            if (!output.isEmpty()) {
-                // md5sum的输出格式: "MD5值 文件名"
-                QStringList parts = output.split(" ", QString::SkipEmptyParts);
-                if (!parts.isEmpty()) {
-                    QString remoteMD5 = parts[0].toLower();
-                    QString localMD5Lower = localFileMD5.toLower();
+            if (verifyManifest.parseOutput(verifyProcess->readAllStandardOutput())) {
+                const DigestManifest::Item &item = verifyManifest.items().first();
+                if (item.status != DigestManifest::StatusMissing) {
+                    QString remoteDigest = item.actual;
+                    QString localDigest = item.expected;
                     
-                    logMessage(QString("远程文件MD5: %1").arg(remoteMD5));
-                    logMessage(QString("本地文件MD5: %1").arg(localMD5Lower));
+                    logMessage(QString("远程文件%1: %2").arg(digestName).arg(remoteDigest));
+                    logMessage(QString("本地文件%1: %2").arg(digestName).arg(localDigest));
                     
-                    if (remoteMD5 == localMD5Lower) {
-                        logMessage("[成功] 文件校验通过，上传完整无误！");
-                        statusLabel->setText("上传并校验成功");
-                        statusBar()->showMessage("上传并校验成功", 3000);
-                        
-                        QMessageBox::information(this, "上传成功", 
-                            QString("文件 %1 已成功上传到服务器并通过MD5校验\n"
-                                   "目标路径: %2\n"
-                                   "本地MD5: %3\n"
-                                   "远程MD5: %4")
-                            .arg(QFileInfo(selectedFilePath).fileName())
-                            .arg(remoteDirectory)
-                            .arg(localMD5Lower)
-                            .arg(remoteMD5));
+                    if (item.status == DigestManifest::StatusMatched) {
+                        reportVerificationPassed(verifyManifest.algorithm(), localDigest, remoteDigest, false);
                     } else {
-                        logMessage("[错误] MD5校验失败！文件可能损坏或不完整");
-                        statusLabel->setText("MD5校验失败");
+                        logMessage(QString("[错误] %1校验失败！文件可能损坏或不完整").arg(digestName));
+                        statusLabel->setText(QString("%1校验失败").arg(digestName));
                         statusBar()->showMessage("校验失败", 3000);
                         
                         QMessageBox::warning(this, "校验失败", 
-                            QString("文件上传成功但MD5校验失败！\n"
-                                   "本地MD5: %1\n"
-                                   "远程MD5: %2\n"
+                            QString("文件上传成功但%1校验失败！\n"
+                                   "本地%1: %2\n"
+                                   "远程%1: %3\n"
                                    "建议重新上传文件")
-                            .arg(localMD5Lower)
-                            .arg(remoteMD5));
+                            .arg(digestName)
+                            .arg(localDigest)
+                            .arg(remoteDigest));
                     }
                 } else {
-                    logMessage("[错误] 无法解析远程MD5值");
+                    logMessage("[错误] 远程文件不存在或不可读");
                     statusLabel->setText("校验失败");
                     statusBar()->showMessage("校验失败", 3000);
                     
                     QMessageBox::warning(this, "校验失败", 
-                        "无法获取远程文件MD5值，但文件已上传成功");
+                        QString("无法读取远程文件，无法获取远程文件%1值").arg(digestName));
                 }
             } else {
-                logMessage("[错误] 远程MD5计算无输出");
+                logMessage(QString("[错误] 远程%1计算未返回结果").arg(digestName));
                 statusBar()->showMessage("校验失败", 3000);
                 
                 QMessageBox::warning(this, "校验失败", 
-                    "无法计算远程文件MD5值，但文件已上传成功");
+                    QString("无法计算远程文件%1值，但文件已上传成功").arg(digestName));
             }
         } else {
-            QString error = verifyProcess->readAllStandardError();
-            logMessage(QString("[错误] 远程MD5计算失败 (退出码: %1)").arg(exitCode));
+            QString error = verifyError;
+            logMessage(QString("[错误] 远程%1计算失败 (退出码: %2)").arg(digestName).arg(exitCode));
             
             if (!error.isEmpty()) {
                 logMessage(QString("[错误信息] %1").arg(error.trimmed()));
@@ -1858,6 +2330,40 @@ void MainWindow::onVerifyFileFinished(int exitCode, QProcess::ExitStatus exitSta
     }
 }
 
+void MainWindow::reportVerificationPassed(FileDigest::Algorithm algorithm, const QString &localDigest,
+                                          const QString &remoteDigest, bool transferSkipped)
+{
+    QString digestName = FileDigest::displayName(algorithm);
+    VerifiedUpload verified;
+    verified.algorithm = algorithm;
+    verified.digestName = digestName;
+    verified.digest = remoteDigest;
+    verifiedUploads.insert(verifiedUploadKey(QFileInfo(selectedFilePath).fileName()), verified);
+    
+    if (transferSkipped) {
+        logMessage(QString("[成功] 远程文件已通过%1校验，无需重新上传！").arg(digestName));
+        statusLabel->setText("文件已存在，校验成功");
+        statusBar()->showMessage("文件已存在，校验成功", 3000);
+    } else {
+        logMessage("[成功] 文件校验通过，上传完整无误！");
+        statusLabel->setText("上传并校验成功");
+        statusBar()->showMessage("上传并校验成功", 3000);
+    }
+    
+    QMessageBox::information(this, "上传成功", 
+        QString("文件 %1 %2\n"
+               "目标路径: %3\n"
+               "本地%4: %5\n"
+               "远程%4: %6")
+        .arg(QFileInfo(selectedFilePath).fileName())
+        .arg(transferSkipped ? QString("在服务器上已存在且%1一致，已跳过上传").arg(digestName)
+                             : QString("已成功上传到服务器并通过%1校验").arg(digestName))
+        .arg(remoteDirectory)
+        .arg(digestName)
+        .arg(localDigest)
+        .arg(remoteDigest));
+}
+
 QString MainWindow::getMachineCode()
 {
     QString machineCode;
@@ -1963,13 +2469,19 @@ void MainWindow::onUpgradeQtSoftware()
     }
     
     // 检查是否有进程正在运行
-    if (uploadProcess && uploadProcess->state() != QProcess::NotRunning) {
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
         QMessageBox::warning(this, "操作进行中", "请等待当前操作完成后再执行升级操作！");
         return;
     }
     
-    if (remoteCommandProcess && remoteCommandProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "远程命令正在执行中，请稍等...");
+    if (upgradePipeline->isRunning()) {
+        QMessageBox::warning(this, "操作进行中", QString("%1正在执行中，请稍等...").arg(upgradePipeline->name()));
+        return;
+    }
+    
+    if (streamQtUpgradeEnabled) {
+        // 本地升级包直接流式解压到目标目录，无需先上传
+        startStreamedQtUpgrade();
         return;
     }
     
@@ -1984,7 +2496,7 @@ void MainWindow::onUpgradeQtSoftware()
     int ret = QMessageBox::question(this, "确认升级", 
         QString("即将在远程服务器上执行qt软件升级操作：\n\n"
         "工作目录：%1\n"
-        "执行命令：tar -xzvf qt_update.tar.gz -C %2 && sync\n\n"
+        "执行命令：解压 qt_update.tar.gz 到 %2 && sync（设备有 pigz 时多线程解压）\n\n"
         "说明：\n"
         "1. 从 %3 解压qt_update.tar.gz到%2目录\n"
         "2. 执行sync命令同步数据到磁盘\n\n"
@@ -2000,42 +2512,149 @@ void MainWindow::onUpgradeQtSoftware()
     }
     
     logMessage("开始执行qt软件升级操作...");
-    logMessage("操作步骤：1. 解压qt软件包  2. 同步数据到磁盘");
+    logMessage("操作步骤：1. 检查升级包  2. 解压qt软件包  3. 同步数据到磁盘");
     statusLabel->setText("正在升级qt软件");
     transferProgressBar->setVisible(true);
     
     // 禁用所有操作按钮
     disableAllOperationButtons();
     
-    // 执行远程命令（升级后自动同步磁盘）
-    QString qtCommand = QString("tar -xzvf qt_update.tar.gz -C %1 && sync").arg(qtExtractPath);
-    executeRemoteCommand(qtCommand, sourceDir.trimmed());
+    // 按步骤执行升级（升级后自动同步磁盘）
+    buildQtUpgradePipeline();
+    stepRetry.reset();
+    runUpgradePipeline();
 }
 
-void MainWindow::onUpgrade7evFirmware()
+void MainWindow::buildQtUpgradePipeline()
 {
-    if (!validateSettings()) {
+    QString sourceDir = remoteDirectory.trimmed();
+    if (!sourceDir.endsWith('/')) {
+        sourceDir += '/';
+    }
+    QString sourceFile = SshUtils::shellQuote(sourceDir + "qt_update.tar.gz");
+    
+    upgradePipeline->reset("qt软件升级");
+    upgradePackageName = "qt_update.tar.gz";
+    upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查qt升级包",
+        QString("ls -la %1").arg(sourceFile),
+        QString("1. 请先上传 qt_update.tar.gz 到 %1 目录\n"
+                "2. 确认文件名为 qt_update.tar.gz（区分大小写）").arg(sourceDir));
+    int extractStep = upgradePipeline->addStep(UpgradePipeline::StepExtract, QString("解压qt软件包到 %1").arg(qtExtractPath),
+        UpgradePipeline::extractCommand(sourceDir + upgradePackageName, qtExtractPath),
+        "1. 检查 qt_update.tar.gz 文件是否完整\n"
+        "2. 确认解压目录存在且有写入权限\n"
+        "3. 检查目标分区是否有足够空间");
+    upgradePipeline->setDataFile(extractStep, sourceDir + upgradePackageName);
+    upgradePipeline->addStep(UpgradePipeline::StepSync, "同步数据到磁盘", "sync");
+    upgradeSuccessNote = "升级详情请查看操作日志。";
+}
+
+void MainWindow::startStreamedQtUpgrade()
+{
+    if (selectedFilePath.isEmpty() || !QFileInfo::exists(selectedFilePath)) {
+        QMessageBox::warning(this, "未选择升级包", 
+            "流式升级直接发送本地升级包，请先选择 qt_update.tar.gz 文件。");
         return;
     }
     
-    // 检查是否有进程正在运行
-    if (uploadProcess && uploadProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "请等待当前操作完成后再执行7ev固件升级操作！");
+    QString fileName = QFileInfo(selectedFilePath).fileName();
+    
+    // 确认对话框
+    int ret = QMessageBox::question(this, "确认升级", 
+        QString("即将以流式方式执行qt软件升级：\n\n"
+        "本地升级包：%1\n"
+        "解压路径：%2\n\n"
+        "说明：\n"
+        "1. 升级包经SSH直接送入远程 tar 解压，不在设备上保存压缩包\n"
+        "2. 传输过程中两端分别计算MD5并比对\n"
+        "3. 解压完成后执行sync命令同步数据到磁盘\n\n"
+        "注意：此操作将解压并覆盖目标目录中的文件，请确认无误后继续。\n\n"
+        "是否继续执行升级操作？")
+        .arg(fileName).arg(qtExtractPath),
+        QMessageBox::Yes | QMessageBox::No,
+        QMessageBox::No);
+    
+    if (ret != QMessageBox::Yes) {
+        logMessage("用户取消了qt软件升级操作");
+        return;
+    }
+    
+    logMessage("开始执行qt软件流式升级...");
+    logMessage("操作步骤：升级包边传输边解压，完成后比对两端MD5并同步数据到磁盘");
+    statusLabel->setText("正在流式升级qt软件");
+    
+    // 禁用所有操作按钮，保留取消按钮
+    disableAllOperationButtons();
+    cancelButton->setVisible(true);
+    
+    streamExtractor->setLocalFile(selectedFilePath);
+    streamExtractor->setRemoteTarget(ipLineEdit->text().trimmed(), portSpinBox->value(),
+                                     usernameLineEdit->text().trimmed());
+    streamExtractor->setExtractPath(qtExtractPath);
+    streamExtractor->setSshOptions(buildUploadAuthOptions());
+    streamExtractor->setSshEnvironment(sshSessionManager->sshEnvironment());
+    streamExtractor->setSession(currentSshSession());
+    streamExtractor->setRateLimit(uploadRateLimiter, deviceRateLimitKBps * 1024);
+    
+    stepRetry.reset();
+    transferStalled = false;
+    uploadStats.start(QFileInfo(selectedFilePath).size());
+    uploadWatchdog->setStallTimeout(stallTimeoutSeconds);
+    uploadWatchdog->start(QFileInfo(selectedFilePath).size());
+    streamExtractor->start();
+    progressTimer->start(1000); // 每秒采样一次吞吐量
+}
+
+void MainWindow::onStreamExtractFinished(bool success, const QString &errorMessage)
+{
+    uploadWatchdog->stop();
+    progressTimer->stop();
+    finishUploadStats();
+    
+    // 升级包不落盘，重试时从头发送，tar 覆盖已解压的文件
+    RetryPolicy::ErrorClass errorClass = transferStalled ? RetryPolicy::ErrorNetwork : streamExtractor->lastErrorClass();
+    transferStalled = false;
+    if (!success && scheduleRetry(RetryStreamExtract, errorClass, errorMessage)) {
         return;
     }
     
-    if (remoteCommandProcess && remoteCommandProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "远程命令正在执行中，请稍等...");
+    cancelButton->setVisible(false);
+    resetTransferProgressBar();  // 隐藏传输进度条
+    enableAllOperationButtons();
+    
+    if (success) {
+        // 发送时计算的MD5登记到缓存，后续上传同一文件时无需重新计算
+        localFileMD5 = streamExtractor->localMd5();
+        hashService->storeMd5(selectedFilePath, localFileMD5);
+        
+        logMessage("[流式升级] 两端MD5一致，qt软件已解压并同步到磁盘");
+        statusLabel->setText("qt软件升级完成");
+        statusBar()->showMessage("qt软件升级完成", 3000);
+        QMessageBox::information(this, "升级完成", 
+            QString("qt软件已解压到 %1\n\nMD5: %2").arg(qtExtractPath).arg(localFileMD5));
+    } else {
+        logMessage(QString("[流式升级] 失败: %1").arg(errorMessage));
+        statusLabel->setText("qt软件升级失败");
+        statusBar()->showMessage("qt软件升级失败", 3000);
+        QMessageBox::warning(this, "升级失败", 
+            QString("qt软件流式升级失败\n%1").arg(errorMessage));
+    }
+}
+
+void MainWindow::onUpgrade7evFirmware()
+{
+    if (!validateSettings()) {
         return;
     }
     
-    if (preCheck7evProcess && preCheck7evProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "7ev固件升级预检查正在执行中，请稍等...");
+    // 检查是否有进程正在运行
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
+        QMessageBox::warning(this, "操作进行中", "请等待当前操作完成后再执行7ev固件升级操作！");
         return;
     }
     
-    if (upgrade7evProcess && upgrade7evProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "7ev固件升级正在执行中，请稍等...");
+    if (upgradePipeline->isRunning()) {
+        QMessageBox::warning(this, "操作进行中", QString("%1正在执行中，请稍等...").arg(upgradePipeline->name()));
         return;
     }
     
@@ -2084,679 +2703,88 @@ void MainWindow::onUpgrade7evFirmware()
     // 禁用所有操作按钮
     disableAllOperationButtons();
     
-    // 先执行预检查
-    executePreCheck7ev();
+    // 预检查作为流水线的检查步骤，与升级在同一条远程命令中执行
+    stepRetry.reset();
+    build7evUpgradePipeline();
+    runUpgradePipeline();
 }
 
-void MainWindow::executePreCheck7ev()
+void MainWindow::build7evUpgradePipeline()
 {
-    logMessage("[预检查] 正在验证升级环境...");
-    
     // 构建源文件路径
     QString sourceDir = remoteDirectory.trimmed();
     if (!sourceDir.endsWith('/')) {
         sourceDir += '/';
     }
-    QString sourceFile = sourceDir + "boots.tar.gz";
-    
-    // 构建预检查命令
-    QString preCheckCommand = 
-        "echo 'Pre-check: Verifying system environment...' && "
-        "echo 'Checking device /dev/mmcblk0p1...' && "
-        "ls -la /dev/mmcblk0p1 && "
-        "echo 'Checking firmware directory...' && "
-        "ls -la " + sourceDir + " && "
-        "echo 'Checking firmware file...' && "
-        "if [ -f " + sourceFile + " ]; then "
-        "  ls -la " + sourceFile + " && "
-        "  echo 'File size:' && du -h " + sourceFile + " && "
-        "  echo 'Testing file integrity...' && "
-        "  tar -tzf " + sourceFile + " > /dev/null && "
-        "  echo 'Testing extraction compatibility...' && "
-        "  tar -tf " + sourceFile + " | head -5 && "
-        "  echo 'Firmware file verification passed'; "
-        "else "
-        "  echo 'ERROR: Firmware file not found'; exit 1; "
-        "fi && "
-        "echo 'Checking available space...' && "
-        "df -h " + sourceDir + " && "
-        "echo 'Pre-check completed successfully'";
-    
-    executePreCheck7evCommand(preCheckCommand);
-}
-
-void MainWindow::executePreCheck7evCommand(const QString &command)
-{
-    if (preCheck7evProcess) {
-        preCheck7evProcess->kill();
-        preCheck7evProcess->waitForFinished(1000);
-        preCheck7evProcess->deleteLater();
-        preCheck7evProcess = nullptr;
-    }
-    
-    preCheck7evProcess = new QProcess(this);
-    
-    // 连接信号
-    connect(preCheck7evProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = preCheck7evProcess->readAllStandardOutput();
-            logMessage("[预检查] 系统环境验证通过，开始正式升级...");
-            if (!output.isEmpty()) {
-                logMessage(QString("[预检查输出] %1").arg(output.trimmed()));
-            }
-            
-            // 预检查通过，执行正式升级
-            executeActual7evUpgrade();
-        } else {
-            QString error = preCheck7evProcess->readAllStandardError();
-            QString output = preCheck7evProcess->readAllStandardOutput();
-            
-            logMessage("[错误] 7ev固件升级预检查失败");
-            if (!error.isEmpty()) {
-                logMessage(QString("[预检查错误] %1").arg(error.trimmed()));
-            }
-            if (!output.isEmpty()) {
-                logMessage(QString("[预检查输出] %1").arg(output.trimmed()));
-            }
-            
-            transferProgressBar->setVisible(false);
-            statusLabel->setText("预检查失败");
-            
-            // 恢复所有操作按钮
-            enableAllOperationButtons();
-            statusBar()->showMessage("升级预检查失败", 3000);
-            
-            QMessageBox::warning(this, "预检查失败", 
-                "7ev固件升级预检查失败！\n\n"
-                "在执行实际升级前发现以下问题，升级已中止：\n\n" + 
-                (output.isEmpty() ? "无法获取详细信息" : output.trimmed()) + "\n\n"
-                "请解决以上问题后重新尝试升级。");
-        }
-        
-        if (preCheck7evProcess) {
-            preCheck7evProcess->deleteLater();
-            preCheck7evProcess = nullptr;
-        }
-    });
-    
-    // 连接输出信号
-    connect(preCheck7evProcess, &QProcess::readyReadStandardOutput, 
-            this, [this]() {
-        QString output = preCheck7evProcess->readAllStandardOutput();
-        if (!output.isEmpty()) {
-            logMessage(QString("[预检查] %1").arg(output.trimmed()));
-        }
-    });
-    
-    connect(preCheck7evProcess, &QProcess::readyReadStandardError, 
-            this, [this]() {
-        QString error = preCheck7evProcess->readAllStandardError();
-        if (!error.isEmpty()) {
-            logMessage(QString("[预检查警告] %1").arg(error.trimmed()));
-        }
-    });
-    
-    // 设置进程环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    preCheck7evProcess->setProcessEnvironment(env);
-    
-    // 构建SSH命令
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(portSpinBox->value())
-              << QString("%1@%2").arg(usernameLineEdit->text()).arg(ipLineEdit->text())
-              << command;
-    
-    logMessage("开始执行7ev固件升级预检查...");
-    
-    // 启动进程
-    preCheck7evProcess->start(program, arguments);
-    
-            if (!preCheck7evProcess->waitForStarted(5000)) {
-        logMessage("[错误] 无法启动SSH进程进行预检查");
-        logMessage("[提示] 请确保SSH密钥认证已正确配置");
-        transferProgressBar->setVisible(false);
-        statusLabel->setText("预检查失败");
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        QMessageBox::critical(this, "预检查失败", 
-            "无法启动SSH进程进行预检查。\n建议配置SSH密钥认证后重试。");
-        
-        if (preCheck7evProcess) {
-            preCheck7evProcess->deleteLater();
-            preCheck7evProcess = nullptr;
-        }
-    }
+    QString sourceFile = SshUtils::shellQuote(sourceDir + "boots.tar.gz");
+    QString mountPoint = SshUtils::shellQuote(sevEvExtractPath);
+    const QString device = "/dev/mmcblk0p1";
+    
+    upgradePipeline->reset("7ev固件升级");
+    upgradePackageName = "boots.tar.gz";
+    upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查存储设备",
+        QString("ls -la %1").arg(device),
+        "1. 检查存储设备是否正确连接\n"
+        "2. 确认设备路径是否正确\n"
+        "3. 检查系统是否识别到存储设备\n"
+        "4. 可能需要重启设备或重新插拔存储设备");
+    upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查固件文件",
+        QString("ls -la %1").arg(sourceFile),
+        QString("1. 请先上传 boots.tar.gz 固件文件到 %1 目录\n"
+                "2. 确认文件名为 boots.tar.gz（区分大小写）\n"
+                "3. 确认文件完整且未损坏").arg(sourceDir));
+    
+    // 本次运行中已校验过摘要时，在设备上重新计算同一摘要确认文件未变，省去一次完整的解压检查
+    QMap<QString, VerifiedUpload>::const_iterator verified =
+        verifiedUploads.constFind(verifiedUploadKey(upgradePackageName));
+    if (verified != verifiedUploads.constEnd()) {
+        logMessage(QString("[7ev固件升级] 固件已在上传后通过%1校验 (%2)，复核%1后跳过解压完整性检查")
+                  .arg(verified->digestName).arg(verified->digest));
+        upgradePipeline->addStep(UpgradePipeline::StepCheck, QString("确认固件%1与已校验的上传一致").arg(verified->digestName),
+            QString("[ \"$(%1 %2 | cut -d ' ' -f 1)\" = \"%3\" ]")
+                .arg(FileDigest::remoteCommand(verified->algorithm)).arg(sourceFile).arg(verified->digest),
+            "1. 固件文件在校验后被替换或损坏\n"
+            "2. 请重新上传 boots.tar.gz 并等待校验通过");
+    } else {
+        upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查固件压缩包完整性",
+            UpgradePipeline::testArchiveCommand(sourceDir + upgradePackageName),
+            "1. boots.tar.gz 已损坏或不完整，请重新上传\n"
+            "2. 通过本程序上传并校验后再升级，可省去此项检查");
+    }
+    
+    // 先卸载挂载点和设备上已有的挂载，再挂载到目标位置；已挂载在目标位置时跳过
+    int mountStep = upgradePipeline->addStep(UpgradePipeline::StepMount, QString("挂载 %1 到 %2").arg(device).arg(sevEvExtractPath),
+        QString("mkdir -p %1 && "
+                "if mountpoint -q %1; then umount %1; fi && "
+                "if grep -q '^%2 ' /proc/mounts; then umount %2; fi && "
+                "mount %2 %1 && df -h %1").arg(mountPoint).arg(device),
+        "1. 设备可能已经被其他程序挂载或正在使用\n"
+        "2. 确认当前用户是否有挂载权限\n"
+        "3. 检查分区文件系统是否正常\n"
+        + QString("4. 尝试手动卸载：umount %1").arg(device));
+    upgradePipeline->setSkipCondition(mountStep, QString("grep -q '^%1 %2 ' /proc/mounts").arg(device).arg(sevEvExtractPath));
+    upgradePipeline->setUndoCommand(mountStep, QString("umount %1").arg(mountPoint));
+    
+    int extractStep = upgradePipeline->addStep(UpgradePipeline::StepExtract, "解压固件到目标分区",
+        QString("%1 && ls -la %2/").arg(UpgradePipeline::extractCommand(sourceDir + upgradePackageName, sevEvExtractPath,
+                                                                       "--no-same-owner --no-same-permissions")).arg(mountPoint),
+        "1. 检查 boots.tar.gz 文件是否完整\n"
+        "2. 确认文件是否为有效的 tar.gz 格式\n"
+        "3. 检查目标分区是否有足够空间\n"
+        "4. 重新上传固件文件");
+    upgradePipeline->setDataFile(extractStep, sourceDir + upgradePackageName);
+    upgradePipeline->addStep(UpgradePipeline::StepSync, "同步数据到磁盘", "sync");
+    upgradePipeline->addStep(UpgradePipeline::StepUnmount, "卸载分区",
+        QString("umount %1").arg(mountPoint),
+        QString("固件已写入并同步，可稍后手动卸载：umount %1").arg(sevEvExtractPath));
+    
+    // 7ev升级可能需要较长时间，超过15分钟视为异常
+    upgradePipeline->setTimeout(900);
+    upgradePipeline->setAbortPatterns(hardwareErrorPatterns());
+    upgradeSuccessNote = "固件升级详情请查看操作日志。\n建议重启设备以应用新固件。";
 }
 
-void MainWindow::executeActual7evUpgrade()
-{
-    logMessage("[正式升级] 预检查通过，开始执行7ev固件升级...");
-    
-    // 构建源文件路径
-    QString sourceDir = remoteDirectory.trimmed();
-    if (!sourceDir.endsWith('/')) {
-        sourceDir += '/';
-    }
-    QString sourceFile = sourceDir + "boots.tar.gz";
-    
-    // 构建复合命令：检查挂载状态->挂载->检查文件->解压->同步
-    QString command = 
-        QString("echo 'Step 1: Creating mount point...' && "
-        "mkdir -p %1 && "                                               // 确保挂载点存在
-        "echo 'Step 2: Checking device /dev/mmcblk0p1...' && "
-        "ls -la /dev/mmcblk0p1 && "                                     // 检查设备是否存在
-        "echo 'Step 3: Checking mount status...' && "
-        "if mountpoint -q %1; then "                                   // 检查挂载点是否已挂载
-        "  echo 'Mount point already in use, unmounting...'; "
-        "  umount %1; "                                                 // 如果已挂载则卸载
-        "fi && "
-        "if mount | grep -q /dev/mmcblk0p1; then "                     // 检查设备是否在其他地方被挂载
-        "  echo 'Device mounted elsewhere, unmounting...'; "
-        "  umount /dev/mmcblk0p1; "                                     // 卸载设备
-        "fi && "
-        "echo 'Step 4: Mounting partition...' && "
-        "mount /dev/mmcblk0p1 %1 && "                                  // 挂载分区
-        "echo 'Mount successful, checking mount point...' && "
-        "df -h %1 && "                                                  // 显示挂载信息
-        "echo 'Step 5: Checking firmware file...' && "
-        "ls -la %2 && "                                                 // 列出目录内容
-        "if [ ! -f %3 ]; then "                                        // 检查文件是否存在
-        "  echo 'ERROR: boots.tar.gz not found in %2'; "
-        "  echo 'Directory contents:'; ls -la %2; "
-        "  umount %1; "                                                 // 如果文件不存在，卸载并退出
-        "  exit 1; "
-        "fi && "
-        "echo 'Found boots.tar.gz, file info:' && "
-        "ls -la %3 && "                                                 // 显示文件信息
-        "echo 'Step 6: Starting extraction...' && "
-        "tar -xzvf %3 -C %1 --no-same-owner --no-same-permissions && " // 解压到目标分区，忽略所有权和权限
-        "echo 'Step 7: Verifying extracted files...' && "
-        "ls -la %1/ && "                                               // 显示解压后的文件
-        "echo 'Step 8: Syncing data...' && "
-        "sync && "                                                      // 同步数据
-        "echo 'Step 9: Unmounting partition...' && "
-        "umount %1 && "                                                // 卸载分区
-        "echo '7ev firmware upgrade completed successfully'")           // 完成提示
-        .arg(sevEvExtractPath).arg(sourceDir).arg(sourceFile);
-    
-    execute7evRemoteCommand(command);
-}
-
-void MainWindow::execute7evRemoteCommand(const QString &command)
-{
-    if (upgrade7evProcess) {
-        upgrade7evProcess->kill();
-        upgrade7evProcess->waitForFinished(1000);
-        upgrade7evProcess->deleteLater();
-        upgrade7evProcess = nullptr;
-    }
-    
-    upgrade7evProcess = new QProcess(this);
-    
-    // 连接信号
-    connect(upgrade7evProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                
-        transferProgressBar->setVisible(false);
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = upgrade7evProcess->readAllStandardOutput();
-            QString error = upgrade7evProcess->readAllStandardError();
-            
-            logMessage("[成功] 7ev固件升级操作执行完成！");
-            if (!output.isEmpty()) {
-                logMessage(QString("[输出] %1").arg(output.trimmed()));
-            }
-            if (!error.isEmpty()) {
-                logMessage(QString("[信息] %1").arg(error.trimmed()));
-            }
-            
-            statusLabel->setText("7ev固件升级完成");
-            statusBar()->showMessage("7ev固件升级操作成功完成", 3000);
-            
-            QString sourceDir = remoteDirectory.trimmed();
-            if (!sourceDir.endsWith('/')) {
-                sourceDir += '/';
-            }
-            QString sourceFile = sourceDir + "boots.tar.gz";
-            
-            QMessageBox::information(this, "升级成功", 
-                QString("7ev固件升级操作已成功完成！\n\n"
-                "完成的操作：\n"
-                "1. ✓ 检查并处理已有挂载状态\n"
-                "2. ✓ 挂载分区 /dev/mmcblk0p1 到 %1\n"
-                "3. ✓ 检查固件文件 %2\n"
-                "4. ✓ 解压固件到目标分区（忽略权限问题）\n"
-                "5. ✓ 验证解压结果\n"
-                "6. ✓ 同步数据到磁盘并卸载分区\n\n"
-                "固件升级详情请查看操作日志。\n"
-                "建议重启设备以应用新固件。").arg(sevEvExtractPath).arg(sourceFile));
-        } else {
-            QString error = upgrade7evProcess->readAllStandardError();
-            QString output = upgrade7evProcess->readAllStandardOutput();
-            
-            // 详细分析错误原因
-            QString errorDetails = "";
-            QString solutionDetails = "";
-            
-            if (output.contains("boots.tar.gz not found") || error.contains("boots.tar.gz not found")) {
-                QString sourceDir = remoteDirectory.trimmed();
-                if (!sourceDir.endsWith('/')) {
-                    sourceDir += '/';
-                }
-                QString sourceFile = sourceDir + "boots.tar.gz";
-                
-                logMessage(QString("[错误] 7ev固件升级失败：%1 文件不存在").arg(sourceFile));
-                statusLabel->setText("固件文件不存在");
-                statusBar()->showMessage("固件文件不存在", 3000);
-                errorDetails = QString("在 %1 目录下找不到 boots.tar.gz 固件文件").arg(sourceDir);
-                solutionDetails = QString("1. 请先上传 boots.tar.gz 固件文件到 %1 目录\n"
-                                "2. 确认文件名为 boots.tar.gz（区分大小写）\n"
-                                "3. 确认文件完整且未损坏\n"
-                                "4. 重新执行升级操作").arg(sourceDir);
-                
-                QMessageBox::critical(this, "固件文件不存在", 
-                    QString("7ev固件升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("No such file or directory") && output.contains("/dev/mmcblk0p1")) {
-                logMessage("[错误] 7ev固件升级失败：设备 /dev/mmcblk0p1 不存在");
-                statusLabel->setText("存储设备不存在");
-                statusBar()->showMessage("存储设备不存在", 3000);
-                errorDetails = "设备 /dev/mmcblk0p1 不存在，可能是存储设备未连接或驱动问题";
-                solutionDetails = "1. 检查存储设备是否正确连接\n"
-                                "2. 确认设备路径是否正确\n"
-                                "3. 检查系统是否识别到存储设备\n"
-                                "4. 可能需要重启设备或重新插拔存储设备";
-                
-                QMessageBox::critical(this, "存储设备不存在", 
-                    QString("7ev固件升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("mount:") || error.contains("mount:")) {
-                // 检查是否是设备忙碌错误
-                if (output.contains("Device or resource busy") || error.contains("Device or resource busy")) {
-                    logMessage("[错误] 7ev固件升级失败：设备正在使用中");
-                    statusLabel->setText("设备使用中");
-                    statusBar()->showMessage("设备使用中", 3000);
-                    errorDetails = "设备 /dev/mmcblk0p1 正在使用中，无法挂载";
-                    solutionDetails = "1. 设备可能已经被其他程序挂载\n"
-                                    "2. 检查是否有其他升级操作正在进行\n"
-                                    "3. 尝试手动卸载：umount /dev/mmcblk0p1\n"
-                                    "4. 重启设备后重新尝试升级\n"
-                                    "5. 检查是否有程序正在访问该分区";
-                } else {
-                    logMessage("[错误] 7ev固件升级失败：分区挂载失败");
-                    statusLabel->setText("分区挂载失败");
-                    statusBar()->showMessage("分区挂载失败", 3000);
-                    errorDetails = "无法挂载分区 /dev/mmcblk0p1，可能是分区损坏或权限不足";
-                    solutionDetails = "1. 检查分区是否已经被挂载\n"
-                                    "2. 确认当前用户是否有挂载权限\n"
-                                    "3. 检查分区文件系统是否正常\n"
-                                    "4. 尝试手动卸载后重新挂载";
-                }
-                
-                QMessageBox::critical(this, "挂载失败", 
-                    QString("7ev固件升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("tar:") || error.contains("tar:")) {
-                // 检查是否是权限相关错误
-                if (output.contains("Cannot change ownership") || error.contains("Cannot change ownership") ||
-                    output.contains("Operation not permitted") || error.contains("Operation not permitted")) {
-                    logMessage("[错误] 7ev固件升级失败：解压时权限问题");
-                    statusLabel->setText("解压权限错误");
-                    statusBar()->showMessage("解压权限错误", 3000);
-                    errorDetails = "tar解压时无法设置文件所有权，这通常是文件系统权限限制";
-                    solutionDetails = "1. 这是正常现象，固件文件已解压但权限可能不同\n"
-                                    "2. 检查目标分区中的文件是否已正确解压\n"
-                                    "3. 如果文件存在且完整，升级可能已成功\n"
-                                    "4. 可以忽略所有权警告，重点检查文件内容";
-                } else {
-                    logMessage("[错误] 7ev固件升级失败：压缩包解压失败");
-                    statusLabel->setText("解压失败");
-                    statusBar()->showMessage("解压失败", 3000);
-                    errorDetails = "boots.tar.gz 文件解压失败，可能是文件损坏或格式错误";
-                    solutionDetails = "1. 检查 boots.tar.gz 文件是否完整\n"
-                                    "2. 确认文件是否为有效的 tar.gz 格式\n"
-                                    "3. 检查目标分区是否有足够空间\n"
-                                    "4. 重新下载或重新生成固件文件";
-                }
-                
-                QMessageBox::critical(this, "解压问题", 
-                    QString("7ev固件升级遇到解压问题！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("Input/output error") || error.contains("Input/output error") ||
-                       output.contains("I/O error") || error.contains("I/O error")) {
-                logMessage("[错误] 7ev固件升级失败：硬件I/O错误，可能是存储设备损坏或断电");
-                statusLabel->setText("硬件I/O错误");
-                statusBar()->showMessage("硬件I/O错误", 3000);
-                errorDetails = "检测到硬件输入/输出错误，通常是存储设备损坏、断电或连接问题导致";
-                solutionDetails = "1. 检查设备是否正常供电\n"
-                                "2. 检查存储设备连接是否牢固\n"
-                                "3. 重启设备后重新尝试\n"
-                                "4. 如果问题持续，可能需要更换存储设备\n"
-                                "5. 联系技术支持进行硬件检测";
-                
-                QMessageBox::critical(this, "硬件I/O错误", 
-                    QString("7ev固件升级遇到严重硬件错误！\n\n错误原因：%1\n\n紧急处理方案：\n%2\n\n"
-                           "⚠️ 警告：此错误可能导致设备损坏，请立即停止操作并联系技术支持！")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else {
-                logMessage(QString("[错误] 7ev固件升级失败 (退出码: %1)").arg(exitCode));
-                
-                if (!error.isEmpty()) {
-                    logMessage(QString("[错误信息] %1").arg(error.trimmed()));
-                }
-                if (!output.isEmpty()) {
-                    logMessage(QString("[输出信息] %1").arg(output.trimmed()));
-                }
-                
-                statusLabel->setText("7ev固件升级失败");
-                statusBar()->showMessage("升级操作失败", 3000);
-                
-                QString sourceDir = remoteDirectory.trimmed();
-                if (!sourceDir.endsWith('/')) {
-                    sourceDir += '/';
-                }
-                
-                QMessageBox::warning(this, "升级失败", 
-                    QString("7ev固件升级操作执行失败！\n\n"
-                           "错误信息：%1\n\n"
-                           "请检查：\n"
-                           "1. 服务器连接是否正常\n"
-                           "2. boots.tar.gz 文件是否存在于 %2 目录\n"
-                           "3. 分区 /dev/mmcblk0p1 是否可用\n"
-                           "4. 目标目录权限是否足够\n"
-                           "5. 网络连接是否稳定")
-                    .arg(error.isEmpty() ? "命令执行失败" : error.trimmed())
-                    .arg(sourceDir));
-            }
-        }
-        
-        if (upgrade7evProcess) {
-            upgrade7evProcess->deleteLater();
-            upgrade7evProcess = nullptr;
-        }
-    });
-    
-    // 连接输出信号，实时显示命令执行过程
-    connect(upgrade7evProcess, &QProcess::readyReadStandardOutput, 
-            this, [this]() {
-        QString output = upgrade7evProcess->readAllStandardOutput();
-        if (!output.isEmpty()) {
-            logMessage(QString("[7ev升级] %1").arg(output.trimmed()));
-        }
-    });
-    
-    connect(upgrade7evProcess, &QProcess::readyReadStandardError, 
-            this, [this]() {
-        QString error = upgrade7evProcess->readAllStandardError();
-        if (!error.isEmpty()) {
-            logMessage(QString("[7ev信息] %1").arg(error.trimmed()));
-            
-            // 检测严重的硬件错误
-            if (error.contains("Input/output error") || 
-                error.contains("I/O error") ||
-                error.contains("Device or resource busy") ||
-                error.contains("No such device") ||
-                error.contains("Operation not permitted") ||
-                error.contains("Permission denied") ||
-                error.contains("Read-only file system")) {
-                
-                logMessage(QString("[严重错误] 检测到硬件I/O错误，立即终止7ev升级操作"));
-                logMessage(QString("[错误详情] %1").arg(error.trimmed()));
-                
-                // 立即终止进程
-                if (upgrade7evProcess && upgrade7evProcess->state() == QProcess::Running) {
-                    upgrade7evProcess->kill();
-                    logMessage("[系统] 已强制终止7ev升级进程");
-                }
-            }
-        }
-    });
-    
-    // 设置进程环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    upgrade7evProcess->setProcessEnvironment(env);
-    
-    // 构建SSH命令
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(portSpinBox->value())
-              << QString("%1@%2").arg(usernameLineEdit->text()).arg(ipLineEdit->text())
-              << command;
-    
-    logMessage("开始执行7ev固件升级命令...");
-    
-    // 启动进程
-    upgrade7evProcess->start(program, arguments);
-    
-    // 设置升级超时检测（15分钟，7ev升级可能需要更长时间）
-    QTimer::singleShot(900000, this, [this](){
-        if (upgrade7evProcess && upgrade7evProcess->state() == QProcess::Running) {
-            logMessage("[警告] 7ev固件升级操作超时（15分钟），可能遇到问题");
-            logMessage("[系统] 正在强制终止升级进程...");
-            
-            upgrade7evProcess->kill();
-            upgrade7evProcess->waitForFinished(3000);
-            
-            transferProgressBar->setVisible(false);
-            statusLabel->setText("升级超时");
-            statusBar()->showMessage("升级操作超时", 3000);
-            
-            // 恢复所有操作按钮
-            enableAllOperationButtons();
-            
-            QMessageBox::critical(this, "升级超时", 
-                "7ev固件升级操作超时（15分钟）！\n\n"
-                "可能的原因：\n"
-                "1. 网络连接中断\n"
-                "2. 远程设备无响应\n"
-                "3. 升级过程中遇到硬件错误\n"
-                "4. 存储设备I/O错误\n\n"
-                "建议：\n"
-                "1. 检查网络连接\n"
-                "2. 检查远程设备状态\n"
-                "3. 重启设备后重新尝试\n"
-                "4. 如果问题持续，请联系技术支持");
-            
-            if (upgrade7evProcess) {
-                upgrade7evProcess->deleteLater();
-                upgrade7evProcess = nullptr;
-            }
-        }
-    });
-    
-    if (!upgrade7evProcess->waitForStarted(5000)) {
-        logMessage("[错误] 无法启动SSH进程");
-        logMessage("[提示] 请确保SSH密钥认证已正确配置");
-        transferProgressBar->setVisible(false);
-        statusLabel->setText("命令执行失败");
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        QMessageBox::critical(this, "执行失败", 
-            "无法启动SSH进程。\n建议配置SSH密钥认证后重试。");
-        
-        if (upgrade7evProcess) {
-            upgrade7evProcess->deleteLater();
-            upgrade7evProcess = nullptr;
-        }
-    }
-}
-
-void MainWindow::executeRemoteCommand(const QString &command, const QString &workingDir)
-{
-    if (remoteCommandProcess) {
-        remoteCommandProcess->deleteLater();
-        remoteCommandProcess = nullptr;
-    }
-    
-    remoteCommandProcess = new QProcess(this);
-    
-    // 连接信号
-    connect(remoteCommandProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                
-        transferProgressBar->setVisible(false);
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = remoteCommandProcess->readAllStandardOutput();
-            QString error = remoteCommandProcess->readAllStandardError();
-            
-            logMessage("[成功] qt软件升级操作执行完成！");
-            if (!output.isEmpty()) {
-                logMessage(QString("[输出] %1").arg(output.trimmed()));
-            }
-            if (!error.isEmpty()) {
-                logMessage(QString("[信息] %1").arg(error.trimmed()));
-            }
-            
-            statusLabel->setText("qt软件升级完成");
-            statusBar()->showMessage("升级操作成功完成", 3000);
-            
-            QString sourceDir = remoteDirectory.trimmed();
-            if (!sourceDir.endsWith('/')) {
-                sourceDir += '/';
-            }
-            QString sourceFile = sourceDir + "qt_update.tar.gz";
-            
-            QMessageBox::information(this, "升级成功", 
-                QString("qt软件升级操作已成功完成！\n\n"
-                "完成的操作：\n"
-                "1. ✓ 从 %1 解压qt_update.tar.gz到%2目录\n"
-                "2. ✓ 执行sync命令同步数据到磁盘\n\n"
-                "升级详情请查看操作日志。").arg(sourceFile).arg(qtExtractPath));
-        } else {
-            QString error = remoteCommandProcess->readAllStandardError();
-            logMessage(QString("[错误] qt软件升级失败 (退出码: %1)").arg(exitCode));
-            
-            if (!error.isEmpty()) {
-                logMessage(QString("[错误信息] %1").arg(error.trimmed()));
-            }
-            
-            statusLabel->setText("qt软件升级失败");
-            statusBar()->showMessage("升级操作失败", 3000);
-            
-            QString sourceDir = remoteDirectory.trimmed();
-            if (!sourceDir.endsWith('/')) {
-                sourceDir += '/';
-            }
-            
-            QMessageBox::warning(this, "升级失败", 
-                QString("qt软件升级操作执行失败！\n\n"
-                       "错误信息：%1\n\n"
-                       "请检查：\n"
-                       "1. 服务器连接是否正常\n"
-                       "2. qt_update.tar.gz文件是否存在于 %2 目录\n"
-                       "3. 目标目录权限是否足够\n"
-                       "4. 网络连接是否稳定")
-                .arg(error.isEmpty() ? "命令执行失败" : error.trimmed())
-                .arg(sourceDir));
-        }
-        
-        if (remoteCommandProcess) {
-            remoteCommandProcess->deleteLater();
-            remoteCommandProcess = nullptr;
-        }
-    });
-    
-    // 连接输出信号，实时显示命令执行过程
-    connect(remoteCommandProcess, &QProcess::readyReadStandardOutput, 
-            this, [this]() {
-        QString output = remoteCommandProcess->readAllStandardOutput();
-        if (!output.isEmpty()) {
-            logMessage(QString("[命令输出] %1").arg(output.trimmed()));
-        }
-    });
-    
-    connect(remoteCommandProcess, &QProcess::readyReadStandardError, 
-            this, [this]() {
-        QString error = remoteCommandProcess->readAllStandardError();
-        if (!error.isEmpty()) {
-            logMessage(QString("[命令信息] %1").arg(error.trimmed()));
-        }
-    });
-    
-    // 设置进程环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    remoteCommandProcess->setProcessEnvironment(env);
-    
-    // 构建SSH命令
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(portSpinBox->value())
-              << QString("%1@%2").arg(usernameLineEdit->text()).arg(ipLineEdit->text());
-    
-    // 如果指定了工作目录，先切换目录再执行命令
-    QString fullCommand;
-    if (!workingDir.isEmpty()) {
-        fullCommand = QString("cd '%1' && %2").arg(workingDir).arg(command);
-    } else {
-        fullCommand = command;
-    }
-    
-    arguments << fullCommand;
-    
-    logMessage(QString("执行远程命令: %1").arg(fullCommand));
-    if (!workingDir.isEmpty()) {
-        logMessage(QString("工作目录: %1").arg(workingDir));
-    }
-    
-    // 启动进程
-    remoteCommandProcess->start(program, arguments);
-    
-    if (!remoteCommandProcess->waitForStarted(5000)) {
-        logMessage("[错误] 无法启动SSH进程");
-        logMessage("[提示] 请确保SSH密钥认证已正确配置");
-        transferProgressBar->setVisible(false);
-        statusLabel->setText("命令执行失败");
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        QMessageBox::critical(this, "执行失败", 
-            "无法启动SSH进程。\n建议配置SSH密钥认证后重试。");
-        
-        if (remoteCommandProcess) {
-            remoteCommandProcess->deleteLater();
-            remoteCommandProcess = nullptr;
-        }
-    }
-}
-
-void MainWindow::onExecuteCustomCommand()
+void MainWindow::onExecuteCustomCommand()
 {
     QString command = commandLineEdit->text().trimmed();
     if (command.isEmpty()) {
@@ -2796,14 +2824,14 @@ void MainWindow::executeCustomRemoteCommand(const QString &command)
         customCommandProcess = nullptr;
     }
     
-    customCommandProcess = new QProcess(this);
+    customCommandProcess = new SshCommand(this);
     
     // 在输出区域显示执行的命令
     QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
     commandOutputEdit->append(QString("<span style='color: #74b9ff;'>[%1] $ %2</span>").arg(timestamp).arg(command));
     
     // 连接信号处理实时输出
-    connect(customCommandProcess, &QProcess::readyReadStandardOutput, 
+    connect(customCommandProcess, &SshCommand::readyReadStandardOutput, 
             this, [this]() {
         QString output = customCommandProcess->readAllStandardOutput();
         if (!output.isEmpty()) {
@@ -2817,7 +2845,7 @@ void MainWindow::executeCustomRemoteCommand(const QString &command)
         commandOutputEdit->setTextCursor(cursor);
     });
     
-    connect(customCommandProcess, &QProcess::readyReadStandardError, 
+    connect(customCommandProcess, &SshCommand::readyReadStandardError, 
             this, [this]() {
         QString error = customCommandProcess->readAllStandardError();
         if (!error.isEmpty()) {
@@ -2829,8 +2857,15 @@ void MainWindow::executeCustomRemoteCommand(const QString &command)
         commandOutputEdit->setTextCursor(cursor);
     });
     
+    connect(customCommandProcess, &SshCommand::errorOccurred,
+            this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            commandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动SSH进程，建议配置SSH密钥认证</span>");
+        }
+    });
+    
     // 连接完成信号
-    connect(customCommandProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+    connect(customCommandProcess, &SshCommand::finished,
             this, [this, command](int exitCode, QProcess::ExitStatus exitStatus) {
                 
         QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
@@ -2862,39 +2897,87 @@ void MainWindow::executeCustomRemoteCommand(const QString &command)
         }
     });
     
-    // 设置进程环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    customCommandProcess->setProcessEnvironment(env);
-    
-    // 构建SSH命令
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(portSpinBox->value())
-              << QString("%1@%2").arg(usernameLineEdit->text()).arg(ipLineEdit->text())
-              << command;
-    
     // 禁用执行按钮防止重复执行
     executeCommandButton->setEnabled(false);
     
-    // 启动进程
-    customCommandProcess->start(program, arguments);
+    // 通过当前设备的常驻SSH会话执行
+    customCommandProcess->start(currentSshSession(), command);
+}
+
+void MainWindow::onOpenFleetUpload()
+{
+    if (selectedFilePath.isEmpty() || !QFileInfo(selectedFilePath).isFile()) {
+        QMessageBox::warning(this, "批量上传", "请先选择要上传的文件");
+        return;
+    }
     
-    if (!customCommandProcess->waitForStarted(5000)) {
-        commandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动SSH进程，建议配置SSH密钥认证</span>");
-        executeCommandButton->setEnabled(true);
-        
-        if (customCommandProcess) {
-            customCommandProcess->deleteLater();
-            customCommandProcess = nullptr;
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
+        QMessageBox::warning(this, "批量上传", "当前有上传任务正在进行，请等待完成后再进行批量上传");
+        return;
+    }
+    
+    QString remotePath = remoteDirectory.trimmed();
+    if (!remotePath.endsWith('/')) {
+        remotePath += '/';
+    }
+    QString remoteFile = remotePath + QFileInfo(selectedFilePath).fileName();
+    
+    // 各设备上的这个文件都可能被覆盖，之前的校验结果作废
+    QString remoteSuffix = '|' + remoteFile;
+    for (QMap<QString, VerifiedUpload>::iterator it = verifiedUploads.begin(); it != verifiedUploads.end();) {
+        if (it.key().endsWith(remoteSuffix)) {
+            it = verifiedUploads.erase(it);
+        } else {
+            ++it;
         }
     }
+    
+    // 批量上传沿用主窗口的认证方式、远程目录和上传设置
+    FleetUploadDialog dialog(this);
+    dialog.setDefaultDevice(ipLineEdit->text().trimmed(), portSpinBox->value(), usernameLineEdit->text().trimmed());
+    dialog.setDeviceListFile(getFleetDeviceListPath());
+    dialog.setLocalFile(selectedFilePath);
+    dialog.setRemoteFile(remoteFile);
+    dialog.setSshOptions(buildUploadAuthOptions());
+    dialog.setSshEnvironment(sshSessionManager->sshEnvironment());
+    dialog.setStateDirectory(getUploadStateDirectory());
+    dialog.setExpectedMd5(hashService->cachedMd5(selectedFilePath));
+    dialog.setDeltaEnabled(deltaUploadEnabled);
+    dialog.setCompressionEnabled(compressUploadEnabled);
+    dialog.setRateLimit(uploadRateLimiter, deviceRateLimitKBps * 1024);
+    dialog.setRetryAttempts(retryAttempts);
+    
+    connect(&dialog, &FleetUploadDialog::logMessage, this, &MainWindow::logMessage);
+    connect(&dialog, &FleetUploadDialog::fileMd5Ready, hashService, &HashService::storeMd5);
+    
+    logMessage(QString("打开批量上传: %1 -> %2").arg(QFileInfo(selectedFilePath).fileName()).arg(remoteFile));
+    dialog.exec();
+}
+
+void MainWindow::recordUpgradeTelemetry(bool success)
+{
+    UpgradeTelemetry::RunRecord record = UpgradeTelemetry::fromPipeline(*upgradePipeline, success);
+    record.device = currentDeviceKey();
+    record.packageFile = upgradePackageName;
+    
+    // 记录设备上这个升级包通过校验时的摘要，便于区分同一设备上不同版本的升级；
+    // 本地当前选中的文件不一定是设备上的那一个，不能作为依据
+    QMap<QString, VerifiedUpload>::const_iterator verified = verifiedUploads.constFind(verifiedUploadKey(upgradePackageName));
+    if (verified != verifiedUploads.constEnd()) {
+        record.packageDigest = verified->digest;
+        record.packageDigestName = verified->digestName;
+    }
+    
+    if (!UpgradeTelemetry(getUpgradeTelemetryPath()).append(record)) {
+        logMessage(QString("[耗时记录] 无法写入 %1").arg(getUpgradeTelemetryPath()));
+    }
+}
+
+void MainWindow::onShowUpgradeTimeline()
+{
+    UpgradeTimelineDialog dialog(this);
+    dialog.setTelemetryFile(getUpgradeTelemetryPath());
+    dialog.exec();
 }
 
 void MainWindow::onOpenSettings()
@@ -2913,6 +2996,17 @@ void MainWindow::onOpenSettings()
     settingsDialog->setLogRetentionDays(logRetentionDays);
     settingsDialog->setQtExtractPath(qtExtractPath);
     settingsDialog->set7evExtractPath(sevEvExtractPath);
+    settingsDialog->setDeltaUploadEnabled(deltaUploadEnabled);
+    settingsDialog->setCompressUploadEnabled(compressUploadEnabled);
+    settingsDialog->setUploadStreams(uploadStreamCount);
+    settingsDialog->setStallTimeout(stallTimeoutSeconds);
+    settingsDialog->setRetryAttempts(retryAttempts);
+    settingsDialog->setUploadRateLimit(uploadRateLimitKBps);
+    settingsDialog->setDeviceRateLimit(deviceRateLimitKBps);
+    settingsDialog->setRateLimitWindow(rateLimitStart, rateLimitEnd);
+    settingsDialog->setStreamQtUpgradeEnabled(streamQtUpgradeEnabled);
+    settingsDialog->setExtractFileListEnabled(extractFileListEnabled);
+    settingsDialog->setVerifyDigest(verifyDigestPreference);
     
     logMessage("打开设置对话框");
     logMessage(QString("当前设置 - 自动保存: %1, 显示日志: %2, 自动清理: %3")
@@ -2935,6 +3029,24 @@ void MainWindow::onOpenSettings()
         logRetentionDays = settingsDialog->getLogRetentionDays();
         qtExtractPath = settingsDialog->getQtExtractPath();
         sevEvExtractPath = settingsDialog->get7evExtractPath();
+        deltaUploadEnabled = settingsDialog->getDeltaUploadEnabled();
+        compressUploadEnabled = settingsDialog->getCompressUploadEnabled();
+        uploadStreamCount = settingsDialog->getUploadStreams();
+        stallTimeoutSeconds = settingsDialog->getStallTimeout();
+        retryAttempts = settingsDialog->getRetryAttempts();
+        stepRetry.setMaxAttempts(retryAttempts);
+        uploadRateLimitKBps = settingsDialog->getUploadRateLimit();
+        deviceRateLimitKBps = settingsDialog->getDeviceRateLimit();
+        rateLimitStart = settingsDialog->getRateLimitStart();
+        rateLimitEnd = settingsDialog->getRateLimitEnd();
+        applyRateLimitSettings();
+        streamQtUpgradeEnabled = settingsDialog->getStreamQtUpgradeEnabled();
+        extractFileListEnabled = settingsDialog->getExtractFileListEnabled();
+        QString oldVerifyDigest = verifyDigestPreference;
+        verifyDigestPreference = settingsDialog->getVerifyDigest();
+        if (oldVerifyDigest != verifyDigestPreference) {
+            deviceDigests.clear();  // 偏好改变后重新与设备协商
+        }
         
         logMessage("设置已更新");
         logMessage(QString("远程目录: %1").arg(remoteDirectory));
@@ -2946,6 +3058,19 @@ void MainWindow::onOpenSettings()
         logMessage(QString("日志存储路径: %1").arg(logStoragePath));
         logMessage(QString("Qt软件解压路径: %1").arg(qtExtractPath));
         logMessage(QString("7ev固件解压路径: %1").arg(sevEvExtractPath));
+        logMessage(QString("增量上传: %1").arg(deltaUploadEnabled ? "启用" : "禁用"));
+        logMessage(QString("传输压缩: %1").arg(compressUploadEnabled ? "启用" : "禁用"));
+        logMessage(QString("并行传输通道: %1").arg(uploadStreamCount));
+        logMessage(QString("无进度超时: %1 秒").arg(stallTimeoutSeconds));
+        logMessage(QString("失败重试次数: %1").arg(retryAttempts));
+        logMessage(QString("上传限速: 总计 %1，每台设备 %2，限速时段 %3 - %4")
+                  .arg(uploadRateLimitKBps > 0 ? QString("%1 KB/s").arg(uploadRateLimitKBps) : QString("不限速"))
+                  .arg(deviceRateLimitKBps > 0 ? QString("%1 KB/s").arg(deviceRateLimitKBps) : QString("不限速"))
+                  .arg(rateLimitStart.toString("HH:mm"))
+                  .arg(rateLimitEnd.toString("HH:mm")));
+        logMessage(QString("Qt流式升级: %1").arg(streamQtUpgradeEnabled ? "启用" : "禁用"));
+        logMessage(QString("保存解压文件列表: %1").arg(extractFileListEnabled ? "启用" : "禁用"));
+        logMessage(QString("校验算法: %1").arg(verifyDigestPreference));
         
         if (autoCleanLog) {
             logMessage(QString("自动清理日志已启用，保留 %1 天 %2")
@@ -2991,6 +3116,19 @@ void MainWindow::loadApplicationSettings()
     logRetentionDays = settings.value("logRetentionDays", 30).toInt();
     qtExtractPath = settings.value("qtExtractPath", "/mnt/qtfs").toString();
     sevEvExtractPath = settings.value("sevEvExtractPath", "/mnt/mmcblk0p1").toString();
+    deltaUploadEnabled = settings.value("deltaUpload", true).toBool();
+    compressUploadEnabled = settings.value("compressUpload", false).toBool();
+    uploadStreamCount = settings.value("uploadStreams", 1).toInt();
+    stallTimeoutSeconds = settings.value("stallTimeout", TransferWatchdog::DEFAULT_STALL_TIMEOUT).toInt();
+    retryAttempts = settings.value("retryAttempts", RetryPolicy::DEFAULT_MAX_ATTEMPTS).toInt();
+    stepRetry.setMaxAttempts(retryAttempts);
+    uploadRateLimitKBps = settings.value("uploadRateLimit", 0).toInt();
+    deviceRateLimitKBps = settings.value("deviceRateLimit", 0).toInt();
+    rateLimitStart = QTime::fromString(settings.value("rateLimitStart", "08:00").toString(), "HH:mm");
+    rateLimitEnd = QTime::fromString(settings.value("rateLimitEnd", "20:00").toString(), "HH:mm");
+    streamQtUpgradeEnabled = settings.value("streamQtUpgrade", false).toBool();
+    extractFileListEnabled = settings.value("extractFileList", false).toBool();
+    verifyDigestPreference = settings.value("verifyDigest", "auto").toString();
     settings.endGroup();
     
     // 确保日志目录存在
@@ -3027,6 +3165,18 @@ void MainWindow::saveApplicationSettings()
     settings.setValue("logRetentionDays", logRetentionDays);
     settings.setValue("qtExtractPath", qtExtractPath);
     settings.setValue("sevEvExtractPath", sevEvExtractPath);
+    settings.setValue("deltaUpload", deltaUploadEnabled);
+    settings.setValue("compressUpload", compressUploadEnabled);
+    settings.setValue("uploadStreams", uploadStreamCount);
+    settings.setValue("stallTimeout", stallTimeoutSeconds);
+    settings.setValue("retryAttempts", retryAttempts);
+    settings.setValue("uploadRateLimit", uploadRateLimitKBps);
+    settings.setValue("deviceRateLimit", deviceRateLimitKBps);
+    settings.setValue("rateLimitStart", rateLimitStart.toString("HH:mm"));
+    settings.setValue("rateLimitEnd", rateLimitEnd.toString("HH:mm"));
+    settings.setValue("streamQtUpgrade", streamQtUpgradeEnabled);
+    settings.setValue("extractFileList", extractFileListEnabled);
+    settings.setValue("verifyDigest", verifyDigestPreference);
     settings.endGroup();
     
     settings.sync();
@@ -3034,6 +3184,13 @@ void MainWindow::saveApplicationSettings()
     logMessage("应用设置已保存");
 }
 
+void MainWindow::applyRateLimitSettings()
+{
+    // 全局限速立即生效，设备级限速在下一次上传开始时传给上传引擎
+    uploadRateLimiter->setRate(static_cast<qint64>(uploadRateLimitKBps) * 1024);
+    uploadRateLimiter->setActiveWindow(rateLimitStart, rateLimitEnd);
+}
+
 void MainWindow::cleanExpiredLogs()
 {
     if (!autoCleanLog || logRetentionDays <= 0) {
@@ -3056,6 +3213,10 @@ void MainWindow::cleanExpiredLogs()
     int deletedCount = 0;
     qint64 deletedSize = 0;
     
+    // 当前日志文件打开时在Windows上无法删除，删除后也会继续写入已删除的文件；先关闭，下次写日志时重新打开
+    delete logFile;
+    logFile = nullptr;
+    
     foreach (const QFileInfo &fileInfo, logFiles) {
         if (fileInfo.lastModified() < expireDate) {
             deletedSize += fileInfo.size();
@@ -3081,18 +3242,13 @@ void MainWindow::onUpgradeKu5p()
     }
     
     // 检查是否有进程正在运行
-    if (uploadProcess && uploadProcess->state() != QProcess::NotRunning) {
+    if (chunkedUploader->isRunning() || batchUploader->isRunning()) {
         QMessageBox::warning(this, "操作进行中", "请等待当前操作完成后再执行ku5p升级操作！");
         return;
     }
     
-    if (remoteCommandProcess && remoteCommandProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "远程命令正在执行中，请稍等...");
-        return;
-    }
-    
-    if (upgradeKu5pProcess && upgradeKu5pProcess->state() != QProcess::NotRunning) {
-        QMessageBox::warning(this, "操作进行中", "ku5p升级正在执行中，请稍等...");
+    if (upgradePipeline->isRunning()) {
+        QMessageBox::warning(this, "操作进行中", QString("%1正在执行中，请稍等...").arg(upgradePipeline->name()));
         return;
     }
     
@@ -3140,6 +3296,7 @@ void MainWindow::onUpgradeKu5p()
     disableAllOperationButtons();
     
     // 执行ku5p升级
+    stepRetry.reset();
     executeKu5pUpgrade();
 }
 
@@ -3152,365 +3309,257 @@ void MainWindow::executeKu5pUpgrade()
     if (!sourceDir.endsWith('/')) {
         sourceDir += '/';
     }
-    QString sourceFile = sourceDir + "ku5p_package.tar.gz";
+    QString sourceFile = SshUtils::shellQuote(sourceDir + "ku5p_package.tar.gz");
     QString targetDir = sourceDir + "updatepackage";
+    QString quotedTarget = SshUtils::shellQuote(targetDir);
+    
+    upgradePipeline->reset("ku5p升级");
+    upgradePackageName = "ku5p_package.tar.gz";
+    upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查ku5p软件包",
+        QString("ls -la %1").arg(sourceFile),
+        QString("1. 请先上传 ku5p_package.tar.gz 软件包文件到 %1 目录\n"
+                "2. 确认文件名为 ku5p_package.tar.gz（区分大小写）\n"
+                "3. 确认文件完整且未损坏").arg(sourceDir));
+    int extractStep = upgradePipeline->addStep(UpgradePipeline::StepExtract, QString("解压软件包到 %1").arg(targetDir),
+        QString("mkdir -p %1 && cd %1 && %2 && ls -la").arg(quotedTarget)
+            .arg(UpgradePipeline::extractCommand(sourceDir + upgradePackageName, QString())),
+        "1. 检查 ku5p_package.tar.gz 文件是否完整\n"
+        "2. 确认文件是否为有效的 tar.gz 格式\n"
+        "3. 检查目标目录是否有足够空间");
+    upgradePipeline->setDataFile(extractStep, sourceDir + upgradePackageName);
+    upgradePipeline->addStep(UpgradePipeline::StepCheck, "检查升级程序和bit文件",
+        QString("cd %1 && ls -la ku5pupgrade ku5p_package.bit && chmod +x ku5pupgrade").arg(quotedTarget),
+        "1. 确认软件包中包含 ku5pupgrade 和 ku5p_package.bit\n"
+        "2. 重新生成或下载正确的软件包");
+    
+    // 烧写开始后设备上的升级程序可能仍在运行，连接中断后不能重新执行
+    int flashStep = upgradePipeline->addStep(UpgradePipeline::StepRun, "执行 ./ku5pupgrade ku5p_package.bit",
+        QString("cd %1 && ./ku5pupgrade ku5p_package.bit").arg(quotedTarget),
+        "1. 检查设备是否正常供电\n"
+        "2. 查看操作日志中升级程序的输出\n"
+        "3. 确认设备状态后再手动重新升级");
+    upgradePipeline->setRepeatable(flashStep, false);
+    upgradePipeline->addStep(UpgradePipeline::StepSync, "同步数据到磁盘", "sync");
+    
+    upgradePipeline->setTimeout(600);
+    upgradePipeline->setAbortPatterns(hardwareErrorPatterns());
+    upgradeSuccessNote = "ku5p升级详情请查看操作日志。";
+    
+    runUpgradePipeline();
+}
+
+QStringList MainWindow::hardwareErrorPatterns()
+{
+    // 标准错误中出现这些内容时立即终止升级，避免在硬件故障时继续写入
+    return QStringList() << "Input/output error"
+                         << "I/O error"
+                         << "Device or resource busy"
+                         << "No such device"
+                         << "Operation not permitted"
+                         << "Permission denied"
+                         << "Read-only file system";
+}
+
+void MainWindow::runUpgradePipeline()
+{
+    logMessage(QString("开始执行%1，共 %2 个步骤...").arg(upgradePipeline->name()).arg(upgradePipeline->steps().size()));
+    upgradePipeline->setFileListEnabled(extractFileListEnabled);
     
-    // 构建升级命令
-    QString command = 
-        QString("echo 'Step 1: Checking ku5p package file...' && "
-        "if [ ! -f %1 ]; then "                                               // 检查文件是否存在
-        "  echo 'ERROR: ku5p_package.tar.gz not found in %2'; "
-        "  echo 'Available files in directory:'; "
-        "  ls -la %2; "
-        "  exit 1; "
-        "fi && "
-        "echo 'Found ku5p_package.tar.gz, file info:' && "
-        "ls -la %1 && "                                                       // 显示文件信息
-        "echo 'Step 2: Creating target directory...' && "
-        "mkdir -p %3 && "                                                     // 创建目标目录
-        "echo 'Step 3: Extracting ku5p package to %3...' && "
-        "cd %3 && "                                                           // 切换到目标目录
-        "tar -xzvf %1 && "                                                    // 解压文件到当前目录
-        "echo 'Step 4: Verifying extracted files...' && "
-        "ls -la %3 && "                                                       // 显示解压后的文件
-        "echo 'Step 5: Checking for upgrade script...' && "
-        "if [ ! -f ku5pupgrade ]; then "                                      // 检查升级脚本是否存在
-        "  echo 'ERROR: ku5pupgrade script not found'; "
-        "  ls -la; "
-        "  exit 1; "
-        "fi && "
-        "if [ ! -f ku5p_package.bit ]; then "                                 // 检查bit文件是否存在
-        "  echo 'ERROR: ku5p_package.bit not found'; "
-        "  ls -la; "
-        "  exit 1; "
-        "fi && "
-        "echo 'Making upgrade script executable...' && "
-        "chmod +x ku5pupgrade && "                                            // 设置可执行权限
-        "echo 'Step 6: Starting ku5p upgrade...' && "
-        "./ku5pupgrade ku5p_package.bit && "                                  // 执行升级
-        "echo 'Step 7: Syncing data...' && "
-        "sync && "                                                            // 同步数据
-        "echo 'ku5p upgrade completed successfully'")                         // 完成提示
-        .arg(sourceFile).arg(sourceDir).arg(targetDir);
-    
-    executeKu5pRemoteCommand(command);
-}
-
-void MainWindow::executeKu5pRemoteCommand(const QString &command)
-{
-    if (upgradeKu5pProcess) {
-        upgradeKu5pProcess->kill();
-        upgradeKu5pProcess->waitForFinished(1000);
-        upgradeKu5pProcess->deleteLater();
-        upgradeKu5pProcess = nullptr;
-    }
-    
-    upgradeKu5pProcess = new QProcess(this);
-    
-    // 连接信号
-    connect(upgradeKu5pProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                
-        transferProgressBar->setVisible(false);
-        
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
-        if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-            QString output = upgradeKu5pProcess->readAllStandardOutput();
-            QString error = upgradeKu5pProcess->readAllStandardError();
-            
-            logMessage("[成功] ku5p升级操作执行完成！");
-            if (!output.isEmpty()) {
-                logMessage(QString("[输出] %1").arg(output.trimmed()));
-            }
-            if (!error.isEmpty()) {
-                logMessage(QString("[信息] %1").arg(error.trimmed()));
-            }
-            
-            statusLabel->setText("ku5p升级完成");
-            statusBar()->showMessage("ku5p升级操作成功完成", 3000);
-            
-            QString sourceDir = remoteDirectory.trimmed();
-            if (!sourceDir.endsWith('/')) {
-                sourceDir += '/';
-            }
-            QString targetDir = sourceDir + "updatepackage";
-            
-            QMessageBox::information(this, "升级成功", 
-                QString("ku5p升级操作已成功完成！\n\n"
-                "完成的操作：\n"
-                "1. ✓ 检查 ku5p_package.tar.gz 文件\n"
-                "2. ✓ 创建目标目录 %1\n"
-                "3. ✓ 解压 ku5p_package.tar.gz 到 %1 目录\n"
-                "4. ✓ 执行 ./ku5pupgrade ku5p_package.bit 升级程序\n"
-                "5. ✓ 同步数据到磁盘\n\n"
-                "ku5p升级详情请查看操作日志。").arg(targetDir));
-        } else {
-            QString error = upgradeKu5pProcess->readAllStandardError();
-            QString output = upgradeKu5pProcess->readAllStandardOutput();
-            
-            // 详细分析错误原因
-            QString errorDetails = "";
-            QString solutionDetails = "";
-            
-            if (output.contains("ku5p_package.tar.gz not found") || error.contains("ku5p_package.tar.gz not found")) {
-                QString sourceDir = remoteDirectory.trimmed();
-                if (!sourceDir.endsWith('/')) {
-                    sourceDir += '/';
-                }
-                QString sourceFile = sourceDir + "ku5p_package.tar.gz";
-                
-                logMessage(QString("[错误] ku5p升级失败：%1 文件不存在").arg(sourceFile));
-                statusLabel->setText("ku5p软件包不存在");
-                statusBar()->showMessage("ku5p软件包不存在", 3000);
-                errorDetails = QString("在 %1 目录下找不到 ku5p_package.tar.gz 软件包文件").arg(sourceDir);
-                solutionDetails = QString("1. 请先上传 ku5p_package.tar.gz 软件包文件到 %1 目录\n"
-                                "2. 确认文件名为 ku5p_package.tar.gz（区分大小写）\n"
-                                "3. 确认文件完整且未损坏\n"
-                                "4. 重新执行升级操作").arg(sourceDir);
-                
-                QMessageBox::critical(this, "软件包文件不存在", 
-                    QString("ku5p升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("ku5pupgrade script not found") || error.contains("ku5pupgrade script not found")) {
-                logMessage("[错误] ku5p升级失败：升级脚本 ku5pupgrade 不存在");
-                statusLabel->setText("升级脚本不存在");
-                statusBar()->showMessage("升级脚本不存在", 3000);
-                errorDetails = "解压后的软件包中找不到 ku5pupgrade 升级脚本";
-                solutionDetails = "1. 检查 ku5p_package.tar.gz 软件包是否完整\n"
-                                "2. 确认软件包中包含 ku5pupgrade 脚本文件\n"
-                                "3. 重新生成或下载正确的软件包\n"
-                                "4. 重新执行升级操作";
-                
-                QMessageBox::critical(this, "升级脚本缺失", 
-                    QString("ku5p升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("ku5p_package.bit not found") || error.contains("ku5p_package.bit not found")) {
-                logMessage("[错误] ku5p升级失败：bit文件 ku5p_package.bit 不存在");
-                statusLabel->setText("bit文件不存在");
-                statusBar()->showMessage("bit文件不存在", 3000);
-                errorDetails = "解压后的软件包中找不到 ku5p_package.bit 文件";
-                solutionDetails = "1. 检查 ku5p_package.tar.gz 软件包是否完整\n"
-                                "2. 确认软件包中包含 ku5p_package.bit 文件\n"
-                                "3. 重新生成或下载正确的软件包\n"
-                                "4. 重新执行升级操作";
-                
-                QMessageBox::critical(this, "bit文件缺失", 
-                    QString("ku5p升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("Input/output error") || error.contains("Input/output error") ||
-                       output.contains("I/O error") || error.contains("I/O error")) {
-                logMessage("[错误] ku5p升级失败：硬件I/O错误，可能是存储设备损坏或断电");
-                statusLabel->setText("硬件I/O错误");
-                statusBar()->showMessage("硬件I/O错误", 3000);
-                errorDetails = "检测到硬件输入/输出错误，通常是存储设备损坏、断电或连接问题导致";
-                solutionDetails = "1. 检查设备是否正常供电\n"
-                                "2. 检查存储设备连接是否牢固\n"
-                                "3. 重启设备后重新尝试\n"
-                                "4. 如果问题持续，可能需要更换存储设备\n"
-                                "5. 联系技术支持进行硬件检测";
-                
-                QMessageBox::critical(this, "硬件I/O错误", 
-                    QString("ku5p升级遇到严重硬件错误！\n\n错误原因：%1\n\n紧急处理方案：\n%2\n\n"
-                           "⚠️ 警告：此错误可能导致设备损坏，请立即停止操作并联系技术支持！")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else if (output.contains("tar:") || error.contains("tar:")) {
-                logMessage("[错误] ku5p升级失败：软件包解压失败");
-                statusLabel->setText("解压失败");
-                statusBar()->showMessage("解压失败", 3000);
-                errorDetails = "ku5p_package.tar.gz 文件解压失败，可能是文件损坏或格式错误";
-                solutionDetails = "1. 检查 ku5p_package.tar.gz 文件是否完整\n"
-                                "2. 确认文件是否为有效的 tar.gz 格式\n"
-                                "3. 检查目标目录是否有足够空间\n"
-                                "4. 重新下载或重新生成软件包文件";
-                
-                QMessageBox::critical(this, "解压失败", 
-                    QString("ku5p升级失败！\n\n错误原因：%1\n\n解决方案：\n%2")
-                    .arg(errorDetails).arg(solutionDetails));
-            } else {
-                logMessage(QString("[错误] ku5p升级失败 (退出码: %1)").arg(exitCode));
-                
-                if (!error.isEmpty()) {
-                    logMessage(QString("[错误信息] %1").arg(error.trimmed()));
-                }
-                if (!output.isEmpty()) {
-                    logMessage(QString("[输出信息] %1").arg(output.trimmed()));
-                }
-                
-                statusLabel->setText("ku5p升级失败");
-                statusBar()->showMessage("升级操作失败", 3000);
-                
-                QString sourceDir = remoteDirectory.trimmed();
-                if (!sourceDir.endsWith('/')) {
-                    sourceDir += '/';
-                }
-                
-                QMessageBox::warning(this, "升级失败", 
-                    QString("ku5p升级操作执行失败！\n\n"
-                           "错误信息：%1\n\n"
-                           "请检查：\n"
-                           "1. 服务器连接是否正常\n"
-                           "2. ku5p_package.tar.gz 文件是否存在于 %2 目录\n"
-                           "3. 软件包是否包含完整的升级文件\n"
-                           "4. 目标目录权限是否足够\n"
-                           "5. 网络连接是否稳定")
-                    .arg(error.isEmpty() ? "命令执行失败" : error.trimmed())
-                    .arg(sourceDir));
-            }
-        }
-        
-        if (upgradeKu5pProcess) {
-            upgradeKu5pProcess->deleteLater();
-            upgradeKu5pProcess = nullptr;
-        }
-    });
+    // 通过当前设备的常驻SSH会话执行
+    upgradePipeline->start(currentSshSession());
+}
+
+void MainWindow::onUpgradeStepStarted(int index)
+{
+    const UpgradePipeline::Step &step = upgradePipeline->steps().at(index);
+    logMessage(QString("[%1] 步骤 %2/%3：[%4] %5").arg(upgradePipeline->name()).arg(index + 1)
+              .arg(upgradePipeline->steps().size()).arg(UpgradePipeline::typeName(step.type)).arg(step.title));
+    statusLabel->setText(QString("%1 - %2").arg(upgradePipeline->name()).arg(step.title));
+}
+
+void MainWindow::onUpgradeStepFinished(int index)
+{
+    const UpgradePipeline::StepResult &result = upgradePipeline->results().at(index);
+    if (result.status == UpgradePipeline::StatusSkipped) {
+        logMessage(QString("[%1] 步骤 %2 已满足，跳过").arg(upgradePipeline->name()).arg(index + 1));
+    } else if (result.status == UpgradePipeline::StatusSucceeded) {
+        logMessage(QString("[%1] 步骤 %2 完成，耗时 %3 秒").arg(upgradePipeline->name()).arg(index + 1)
+                  .arg(result.elapsedMs / 1000.0, 0, 'f', 1));
+    }
     
-    // 连接输出信号，实时显示命令执行过程
-    connect(upgradeKu5pProcess, &QProcess::readyReadStandardOutput, 
-            this, [this]() {
-        QString output = upgradeKu5pProcess->readAllStandardOutput();
-        if (!output.isEmpty()) {
-            logMessage(QString("[ku5p升级] %1").arg(output.trimmed()));
-            
-            // 监控擦除进度
-            if (output.contains("Erasing blocks:")) {
-                // 提取进度信息，格式如：Erasing blocks: 788/3302 (23%)
-                QRegExp progressRegex("Erasing blocks: (\\d+)/(\\d+) \\((\\d+)%\\)");
-                if (progressRegex.indexIn(output) != -1) {
-                    QString current = progressRegex.cap(1);
-                    QString total = progressRegex.cap(2);
-                    QString percent = progressRegex.cap(3);
-                    
-                    statusLabel->setText(QString("ku5p升级中 - 擦除进度: %1/%2 (%3%)")
-                                       .arg(current).arg(total).arg(percent));
-                    
-                    // 每10%记录一次进度
-                    int percentInt = percent.toInt();
-                    static int lastLoggedPercent = -1;
-                    if (percentInt % 10 == 0 && percentInt != lastLoggedPercent) {
-                        logMessage(QString("[进度] ku5p擦除进度: %1% (%2/%3)")
-                                 .arg(percent).arg(current).arg(total));
-                        lastLoggedPercent = percentInt;
-                    }
-                }
-            }
-            
-            // 监控写入进度
-            if (output.contains("Writing data:")) {
-                statusLabel->setText("ku5p升级中 - 正在写入数据...");
-            }
-            
-            // 监控验证进度
-            if (output.contains("Verifying:")) {
-                statusLabel->setText("ku5p升级中 - 正在验证数据...");
-            }
-        }
-    });
+    // 解压结束后进度条恢复为滚动动画
+    if (upgradePipeline->steps().at(index).type == UpgradePipeline::StepExtract) {
+        transferProgressBar->setMaximum(0);
+        transferProgressBar->setValue(0);
+        transferProgressBar->setTextVisible(false);
+    }
+}
+
+void MainWindow::onUpgradeOutput(int index, const QString &text)
+{
+    QString output = text.trimmed();
+    if (output.isEmpty()) {
+        return;
+    }
+    logMessage(QString("[%1] %2").arg(upgradePipeline->name()).arg(output));
     
-    connect(upgradeKu5pProcess, &QProcess::readyReadStandardError, 
-            this, [this]() {
-        QString error = upgradeKu5pProcess->readAllStandardError();
-        if (!error.isEmpty()) {
-            logMessage(QString("[ku5p信息] %1").arg(error.trimmed()));
+    if (index >= 0 && upgradePipeline->steps().at(index).type == UpgradePipeline::StepRun) {
+        updateUpgradeRunProgress(output);
+    }
+}
+
+void MainWindow::onUpgradeProgress(int index, qint64 done, qint64 total)
+{
+    // 解压进度按已读取的压缩包字节数显示
+    transferProgressBar->setMaximum(1000);
+    transferProgressBar->setValue(static_cast<int>(done * 1000 / total));
+    transferProgressBar->setFormat(QString("%1 / %2")
+                                   .arg(TransferStats::formatBytes(done))
+                                   .arg(TransferStats::formatBytes(total)));
+    transferProgressBar->setTextVisible(true);
+    statusLabel->setText(QString("%1 - %2 %3%").arg(upgradePipeline->name())
+                         .arg(upgradePipeline->steps().at(index).title).arg(done * 100 / total));
+}
+
+void MainWindow::onUpgradeError(int index, const QString &text)
+{
+    Q_UNUSED(index);
+    QString error = text.trimmed();
+    if (!error.isEmpty()) {
+        logMessage(QString("[%1信息] %2").arg(upgradePipeline->name()).arg(error));
+    }
+}
+
+void MainWindow::updateUpgradeRunProgress(const QString &output)
+{
+    // 监控擦除进度
+    if (output.contains("Erasing blocks:")) {
+        // 提取进度信息，格式如：Erasing blocks: 788/3302 (23%)
+        QRegExp progressRegex("Erasing blocks: (\\d+)/(\\d+) \\((\\d+)%\\)");
+        if (progressRegex.indexIn(output) != -1) {
+            QString current = progressRegex.cap(1);
+            QString total = progressRegex.cap(2);
+            QString percent = progressRegex.cap(3);
             
-            // 检测严重的硬件错误
-            if (error.contains("Input/output error") || 
-                error.contains("I/O error") ||
-                error.contains("Device or resource busy") ||
-                error.contains("No such device") ||
-                error.contains("Operation not permitted") ||
-                error.contains("Permission denied") ||
-                error.contains("Read-only file system")) {
-                
-                logMessage(QString("[严重错误] 检测到硬件I/O错误，立即终止升级操作"));
-                logMessage(QString("[错误详情] %1").arg(error.trimmed()));
-                
-                // 立即终止进程
-                if (upgradeKu5pProcess && upgradeKu5pProcess->state() == QProcess::Running) {
-                    upgradeKu5pProcess->kill();
-                    logMessage("[系统] 已强制终止ku5p升级进程");
-                }
+            statusLabel->setText(QString("%1中 - 擦除进度: %2/%3 (%4%)")
+                               .arg(upgradePipeline->name()).arg(current).arg(total).arg(percent));
+            
+            // 每10%记录一次进度
+            int percentInt = percent.toInt();
+            static int lastLoggedPercent = -1;
+            if (percentInt % 10 == 0 && percentInt != lastLoggedPercent) {
+                logMessage(QString("[进度] 擦除进度: %1% (%2/%3)")
+                         .arg(percent).arg(current).arg(total));
+                lastLoggedPercent = percentInt;
             }
         }
-    });
+    }
     
-    // 设置进程环境变量
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    upgradeKu5pProcess->setProcessEnvironment(env);
+    // 监控写入进度
+    if (output.contains("Writing data:")) {
+        statusLabel->setText(QString("%1中 - 正在写入数据...").arg(upgradePipeline->name()));
+    }
     
-    // 构建SSH命令
-    QString program = "ssh";
-    QStringList arguments;
-    arguments << "-o" << "ConnectTimeout=30"
-              << "-o" << "StrictHostKeyChecking=no"
-              << "-o" << "UserKnownHostsFile=/dev/null"
-              << "-o" << "PreferredAuthentications=publickey,password"
-              << "-o" << "PubkeyAuthentication=yes"
-              << "-o" << "PasswordAuthentication=yes"
-              << "-o" << "BatchMode=yes"  // 非交互模式
-              << "-p" << QString::number(portSpinBox->value())
-              << QString("%1@%2").arg(usernameLineEdit->text()).arg(ipLineEdit->text())
-              << command;
-    
-    logMessage("开始执行ku5p升级命令...");
+    // 监控验证进度
+    if (output.contains("Verifying:")) {
+        statusLabel->setText(QString("%1中 - 正在验证数据...").arg(upgradePipeline->name()));
+    }
+}
+
+void MainWindow::onUpgradeFinished(bool success)
+{
+    QString title = upgradePipeline->name();
     
-    // 启动进程
-    upgradeKu5pProcess->start(program, arguments);
+    // 每次执行（包括随后自动重试的失败执行）都记入耗时记录
+    recordUpgradeTelemetry(success);
     
-    // 设置升级超时检测（10分钟）
-    QTimer::singleShot(600000, this, [this](){
-        if (upgradeKu5pProcess && upgradeKu5pProcess->state() == QProcess::Running) {
-            logMessage("[警告] ku5p升级操作超时（10分钟），可能遇到问题");
-            logMessage("[系统] 正在强制终止升级进程...");
-            
-            upgradeKu5pProcess->kill();
-            upgradeKu5pProcess->waitForFinished(3000);
-            
-            transferProgressBar->setVisible(false);
-            statusLabel->setText("升级超时");
-            statusBar()->showMessage("升级操作超时", 3000);
-            
-            // 恢复所有操作按钮
-            enableAllOperationButtons();
-            
-            QMessageBox::critical(this, "升级超时", 
-                "ku5p升级操作超时（10分钟）！\n\n"
-                "可能的原因：\n"
-                "1. 网络连接中断\n"
-                "2. 远程设备无响应\n"
-                "3. 升级过程中遇到硬件错误\n"
-                "4. 存储设备I/O错误\n\n"
-                "建议：\n"
-                "1. 检查网络连接\n"
-                "2. 检查远程设备状态\n"
-                "3. 重启设备后重新尝试\n"
-                "4. 如果问题持续，请联系技术支持");
-            
-            if (upgradeKu5pProcess) {
-                upgradeKu5pProcess->deleteLater();
-                upgradeKu5pProcess = nullptr;
-            }
+    if (!success) {
+        RetryPolicy::ErrorClass errorClass = upgradePipeline->lastErrorClass();
+        if (upgradePipeline->unrepeatableStepStarted() && errorClass == RetryPolicy::ErrorNetwork) {
+            // 烧写类步骤开始后设备上的程序可能仍在运行，重新执行会同时写入两次
+            logMessage("[重试] 连接在不可重复执行的步骤开始后中断，不自动重新执行，请确认设备状态后手动重试");
+        } else if (scheduleRetry(RetryUpgradePipeline, errorClass, upgradePipeline->failureReason())) {
+            return;
         }
-    });
+    }
+    
+    resetTransferProgressBar();
+    
+    // 恢复所有操作按钮
+    enableAllOperationButtons();
     
-    if (!upgradeKu5pProcess->waitForStarted(5000)) {
+    // 每个步骤的结果写入日志
+    QStringList summary = upgradePipeline->summary();
+    logMessage(QString("[%1] 步骤结果：").arg(title));
+    for (const QString &line : summary) {
+        logMessage(QString("  %1").arg(line));
+    }
+    
+    if (success) {
+        logMessage(QString("[成功] %1操作执行完成！").arg(title));
+        statusLabel->setText(QString("%1完成").arg(title));
+        statusBar()->showMessage(QString("%1操作成功完成").arg(title), 3000);
+        
+        QMessageBox::information(this, "升级成功", 
+            QString("%1操作已成功完成！\n\n"
+                    "执行的步骤：\n%2\n\n"
+                    "%3").arg(title).arg(summary.join("\n")).arg(upgradeSuccessNote));
+        return;
+    }
+    
+    if (upgradePipeline->startFailed()) {
         logMessage("[错误] 无法启动SSH进程");
         logMessage("[提示] 请确保SSH密钥认证已正确配置");
-        transferProgressBar->setVisible(false);
         statusLabel->setText("命令执行失败");
         
-        // 恢复所有操作按钮
-        enableAllOperationButtons();
-        
         QMessageBox::critical(this, "执行失败", 
             "无法启动SSH进程。\n建议配置SSH密钥认证后重试。");
+        return;
+    }
+    
+    QString reason = upgradePipeline->failureReason();
+    int failedIndex = upgradePipeline->failedStep();
+    logMessage(QString("[错误] %1失败：%2").arg(title).arg(reason));
+    
+    if (failedIndex < 0) {
+        statusLabel->setText(QString("%1失败").arg(title));
+        statusBar()->showMessage("升级操作失败", 3000);
         
-        if (upgradeKu5pProcess) {
-            upgradeKu5pProcess->deleteLater();
-            upgradeKu5pProcess = nullptr;
-        }
+        QMessageBox::warning(this, "升级失败", 
+            QString("%1操作执行失败！\n\n"
+                    "错误信息：%2\n\n"
+                    "请检查：\n"
+                    "1. 服务器连接是否正常\n"
+                    "2. 网络连接是否稳定").arg(title).arg(reason));
+        return;
+    }
+    
+    const UpgradePipeline::Step &step = upgradePipeline->steps().at(failedIndex);
+    const UpgradePipeline::StepResult &result = upgradePipeline->results().at(failedIndex);
+    QString errorOutput = result.errorOutput.trimmed();
+    if (!errorOutput.isEmpty()) {
+        logMessage(QString("[错误信息] %1").arg(errorOutput));
     }
+    
+    statusLabel->setText(QString("%1失败").arg(step.title));
+    statusBar()->showMessage(QString("%1失败").arg(step.title), 3000);
+    
+    QString message = QString("%1失败！\n\n"
+                              "失败步骤：%2. [%3] %4\n"
+                              "失败原因：%5\n")
+                      .arg(title).arg(failedIndex + 1).arg(UpgradePipeline::typeName(step.type))
+                      .arg(step.title).arg(reason);
+    if (!errorOutput.isEmpty()) {
+        message += QString("错误输出：%1\n").arg(errorOutput);
+    }
+    if (!step.failureHint.isEmpty()) {
+        message += QString("\n解决方案：\n%1\n").arg(step.failureHint);
+    }
+    if (errorOutput.contains("Input/output error") || errorOutput.contains("I/O error")) {
+        message += "\n⚠️ 警告：检测到硬件I/O错误，可能导致设备损坏，请立即停止操作并联系技术支持！";
+    }
+    
+    QMessageBox::critical(this, QString("%1失败").arg(title), message);
 }
 
 void MainWindow::disableAllOperationButtons()
@@ -3519,6 +3568,7 @@ void MainWindow::disableAllOperationButtons()
     uploadButton->setEnabled(false);
     testConnectionButton->setEnabled(false);
     selectFileButton->setEnabled(false);
+    selectDirButton->setEnabled(false);
     upgradeQtButton->setEnabled(false);
     upgrade7evButton->setEnabled(false);
     upgradeKu5pButton->setEnabled(false);
@@ -3551,6 +3601,7 @@ void MainWindow::enableAllOperationButtons()
     uploadButton->setEnabled(true);
     testConnectionButton->setEnabled(true);
     selectFileButton->setEnabled(true);
+    selectDirButton->setEnabled(true);
     upgradeQtButton->setEnabled(true);
     upgrade7evButton->setEnabled(true);
     upgradeKu5pButton->setEnabled(true);
@@ -4319,9 +4370,9 @@ void MainWindow::installPublicKeyToServer()
     logMessage("[智能部署] 使用服务器连接设置中的密码进行部署");
     
     // 智能部署：直接使用SSH命令进行安装
-    QString installCommand = generateReliableSSHInstallCommand(username, ip, port, publicKey);
+    QString installCommand = generateReliableSSHInstallCommand(publicKey);
     
-    if (installCommand.contains("ERROR")) {
+    if (installCommand.isEmpty()) {
         QMessageBox::critical(this, "部署失败", 
             "生成SSH安装命令时发生错误。\n\n"
             "请检查SSH密钥文件是否存在。");
@@ -4330,7 +4381,7 @@ void MainWindow::installPublicKeyToServer()
     }
     
     // 直接使用服务器连接设置中的密码进行部署
-    executeSSHWithPassword(installCommand, password);
+    executeSSHWithPassword(installCommand);
 }
 
 void MainWindow::showSSHKeyStatus()
@@ -4997,65 +5048,21 @@ void MainWindow::showManualInstallationGuide()
     logMessage("已显示SSH公钥手动安装指导");
 }
 
-QString MainWindow::generateReliableSSHInstallCommand(const QString &username, const QString &ip, int port, const QString &publicKey)
+QString MainWindow::generateReliableSSHInstallCommand(const QString &publicKey)
 {
-    // 使用SSH生成的公钥文件路径，而不是临时文件
-    Q_UNUSED(publicKey); // 标记publicKey参数为未使用，避免编译警告
-    QString pubKeyPath = getSSHPublicKeyPath();
-    
-    // 检查SSH公钥文件是否存在
-    if (!QFile::exists(pubKeyPath)) {
-        qDebug() << "[错误] SSH公钥文件不存在:" << pubKeyPath;
-        return QString("echo ERROR: SSH public key file not found: %1").arg(pubKeyPath);
-    }
-    
-    // 验证公钥文件内容
-    QFile keyFile(pubKeyPath);
-    if (keyFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QString content = keyFile.readAll();
-        keyFile.close();
-        
-        qDebug() << "[调试] 使用SSH公钥文件:" << pubKeyPath;
-        qDebug() << "[调试] 文件大小:" << content.length() << "字节";
-        qDebug() << "[调试] 公钥内容前50字符:" << content.left(50);
-        
-        if (content.isEmpty()) {
-            qDebug() << "[警告] SSH公钥文件内容为空！";
-            return QString("echo ERROR: Empty SSH public key file");
-        }
-    } else {
-        qDebug() << "[错误] 无法读取SSH公钥文件:" << pubKeyPath;
-        return QString("echo ERROR: Cannot read SSH public key file");
-    }
-    
-    // 获取Python脚本路径 - 使用程序同级目录
-    QString execDir = QCoreApplication::applicationDirPath();
-    QString scriptPath = QDir(execDir).absoluteFilePath("install_ssh_key.py");
-    
-    // 检查Python脚本是否存在
-    if (!QFile::exists(scriptPath)) {
-        qDebug() << "[错误] Python脚本不存在:" << scriptPath;
-        return QString("echo ERROR: Python script not found: %1").arg(scriptPath);
-    }
-    
-    qDebug() << "[信息] 找到Python脚本:" << scriptPath;
-    
-    // 生成Python命令 - 使用SSH生成的公钥文件路径
-    QString pythonCommand;
-    if (QSysInfo::productType() == "windows") {
-        // Windows下使用python，使用原生路径分隔符
-        // 注意：不在这里添加引号，让executeSSHWithSshpass函数中的cmd处理路径转义
-        pythonCommand = QString("python install_ssh_key.py --host %1 --port %2 --user %3 --key-file %4")
-                       .arg(ip).arg(port).arg(username).arg(QDir::toNativeSeparators(pubKeyPath));
-    } else {
-        // Linux/macOS下使用python3
-        pythonCommand = QString("python3 install_ssh_key.py --host %1 --port %2 --user %3 --key-file \"%4\"")
-                       .arg(ip).arg(port).arg(username).arg(pubKeyPath);
+    // 公钥只能是单行内容
+    QString key = publicKey.trimmed();
+    if (key.isEmpty() || key.contains('\n')) {
+        return QString();
     }
     
-    return pythonCommand;
+    // 在服务器上直接追加到 authorized_keys（已存在相同公钥时不重复添加），并修正目录和文件权限
+    QString quotedKey = SshUtils::shellQuote(key);
+    return QString("umask 077 && mkdir -p ~/.ssh && touch ~/.ssh/authorized_keys && "
+                   "chmod 700 ~/.ssh && chmod 600 ~/.ssh/authorized_keys && "
+                   "(grep -qxF %1 ~/.ssh/authorized_keys || echo %1 >> ~/.ssh/authorized_keys)")
+           .arg(quotedKey);
 }
-
 // ==================== SSH密码输入功能实现 ====================
 
 void MainWindow::executeSSHCommandWithPassword(const QString &command)
@@ -5156,16 +5163,6 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
         return;
     }
     
-    // 如果是Python脚本命令，需要添加密码参数
-    QString finalCommand = pendingSSHCommand;
-    if (finalCommand.contains("install_ssh_key.py")) {
-        finalCommand += QString(" --password \"%1\"").arg(password);
-        
-        // 添加调试：验证密码参数（显示密码长度而不是内容）
-        builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 密码参数长度: %1 字符</span>").arg(password.length()));
-        builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 密码首字符: %1</span>").arg(password.isEmpty() ? "空" : password.left(1)));
-    }
-    
     builtinCommandProcess = new QProcess(this);
     
     // 连接信号处理实时输出
@@ -5173,13 +5170,9 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
             this, [this]() {
         QByteArray data = builtinCommandProcess->readAllStandardOutput();
         if (!data.isEmpty()) {
-            QString output = QString::fromLocal8Bit(data); // Windows下使用本地编码
+            QString output = QString::fromLocal8Bit(data).trimmed(); // Windows下使用本地编码
             if (!output.isEmpty()) {
-                // 清理和格式化输出
-                output = output.trimmed();
-                if (!output.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ffffff;'>%1</span>").arg(output));
-                }
+                builtinCommandOutputEdit->append(QString("<span style='color: #ffffff;'>%1</span>").arg(output));
             }
         }
         // 自动滚动到底部
@@ -5192,13 +5185,9 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
             this, [this]() {
         QByteArray data = builtinCommandProcess->readAllStandardError();
         if (!data.isEmpty()) {
-            QString error = QString::fromLocal8Bit(data); // Windows下使用本地编码
-            
+            QString error = QString::fromLocal8Bit(data).trimmed(); // Windows下使用本地编码
             if (!error.isEmpty()) {
-                error = error.trimmed();
-                if (!error.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ff7675;'>%1</span>").arg(error));
-                }
+                builtinCommandOutputEdit->append(QString("<span style='color: #ff7675;'>%1</span>").arg(error));
             }
         }
         QTextCursor cursor = builtinCommandOutputEdit->textCursor();
@@ -5214,22 +5203,8 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
         
         if (exitStatus == QProcess::NormalExit) {
             if (exitCode == 0) {
-                builtinCommandOutputEdit->append(QString("<span style='color: #00b894;'>[%1] SSH公钥安装完成 (退出码: %2)</span>")
+                builtinCommandOutputEdit->append(QString("<span style='color: #00b894;'>[%1] SSH命令执行完成 (退出码: %2)</span>")
                                                .arg(timestamp).arg(exitCode));
-                builtinCommandOutputEdit->append("<span style='color: #00b894;'>[提示] SSH公钥安装可能已完成，建议测试连接验证</span>");
-                
-                QTimer::singleShot(2000, this, [this]() {
-                    int ret = QMessageBox::question(this, "SSH公钥安装", 
-                        "SSH公钥安装命令已执行完成。\n\n"
-                        "是否立即测试SSH连接验证安装结果？",
-                        QMessageBox::Yes | QMessageBox::No,
-                        QMessageBox::Yes);
-                    
-                    if (ret == QMessageBox::Yes) {
-                        logMessage("[SSH安装后] 用户选择测试连接");
-                        onTestConnection();
-                    }
-                });
             } else {
                 builtinCommandOutputEdit->append(QString("<span style='color: #e17055;'>[%1] SSH命令执行有错误 (退出码: %2)</span>")
                                                .arg(timestamp).arg(exitCode));
@@ -5237,8 +5212,6 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
                 // 分析常见错误
                 if (exitCode == 255) {
                     builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 可能的原因：密码错误、网络连接问题或SSH服务未启动</span>");
-                } else if (exitCode == 5) {
-                    builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 密码认证失败，请检查密码是否正确</span>");
                 } else if (exitCode == 1) {
                     builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 可能的原因：权限不足或目标路径不存在</span>");
                 }
@@ -5254,229 +5227,18 @@ void MainWindow::executeSSHWithSshpass(const QString &password)
         cursor.movePosition(QTextCursor::End);
         builtinCommandOutputEdit->setTextCursor(cursor);
         
-        // 延迟清理批处理文件，确保批处理文件执行完成
-        // 注意：批处理文件会在执行完成后自动删除自己
-        QTimer::singleShot(60000, this, [this]() {
-            QString execDir = QCoreApplication::applicationDirPath();
-            QString batFile = QDir(execDir).absoluteFilePath("ssh_install_auto.bat");
-            // 如果批处理文件没有自动删除，手动清理
-            if (QFile::exists(batFile)) {
-                QFile::remove(batFile);
-            }
-        });
-        
         if (builtinCommandProcess) {
             builtinCommandProcess->deleteLater();
             builtinCommandProcess = nullptr;
         }
     });
     
-    // 设置进程环境
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    // 密码通过 SSH_ASKPASS 交给命令中的 ssh / scp，不再生成批处理文件或另开CMD窗口；
+    // 环境中只有一次性令牌，密码不会暴露给命令启动的其他程序
+    QProcessEnvironment env = sshSessionManager->oneShotEnvironment(password);
     env.insert("LANG", "zh_CN.UTF-8");
-    
-    // 添加调试：显示关键环境变量
-    builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] PATH环境变量: %1</span>").arg(env.value("PATH")));
-    builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] PYTHON路径检查: %1</span>").arg(env.value("PYTHONPATH", "未设置")));
-    
     builtinCommandProcess->setProcessEnvironment(env);
-    
-    QString program;
-    QStringList arguments;
-    
-    if (QSysInfo::productType() == "windows") {
-        // Windows下启动新的cmd窗口并自动执行命令
-        program = "cmd";
-        
-        // 创建批处理文件到程序执行目录
-        QString execDir = QCoreApplication::applicationDirPath();
-        QString batFile = QDir(execDir).absoluteFilePath("ssh_install_auto.bat");
-        
-        QFile file(batFile);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&file);
-            out.setCodec("GBK"); // Windows批处理文件使用GBK编码
-            
-            // 写入批处理命令
-            out << "@echo off\n";
-            out << "title SSH公钥自动安装\n";
-            out << "color 0a\n"; // 设置绿色字体
-            out << "echo ========================================\n";
-            out << "echo        SSH公钥自动安装工具\n";
-            out << "echo ========================================\n";
-            out << "echo.\n";
-            QString nativeExecDir = QDir::toNativeSeparators(execDir);
-            out << "echo 程序目录: " << nativeExecDir << "\n";
-            out << "echo 脚本位置: %~dp0\n";
-            out << "echo.\n";
-            out << "echo 正在执行SSH公钥安装命令...\n";
-            out << "echo 命令: " << finalCommand << "\n";
-            out << "echo.\n";
-            out << "echo [执行中] 请等待...\n";
-            out << "echo.\n";
-            out << finalCommand << "\n";
-            out << "echo.\n";
-            out << "echo ========================================\n";
-            out << "if %ERRORLEVEL% EQU 0 (\n";
-            out << "    echo [✓成功] SSH公钥安装完成！\n";
-            out << "    echo.\n";
-            out << "    echo 现在您可以使用SSH密钥连接服务器：\n";
-            out << "    echo ssh -p 22 ubuntu@1.13.80.192\n";
-            out << ") else (\n";
-            out << "    echo [✗失败] SSH公钥安装失败，错误码: %ERRORLEVEL%\n";
-            out << "    echo.\n";
-            out << "    echo 请检查：\n";
-            out << "    echo 1. 网络连接是否正常\n";
-            out << "    echo 2. 服务器地址和端口是否正确\n";
-            out << "    echo 3. 用户名和密码是否正确\n";
-            out << ")\n";
-            out << "echo ========================================\n";
-            out << "echo.\n";
-            out << "echo 按任意键关闭窗口...\n";
-            out << "pause >nul\n";
-            out << "del \"%~f0\" >nul 2>&1\n"; // 执行完成后自动删除批处理文件
-            
-            file.close();
-            
-            // 启动新的cmd窗口执行批处理文件
-            QString nativeBatFile = QDir::toNativeSeparators(batFile);
-            arguments << "/c" << nativeBatFile;
-            
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] 正在启动独立的CMD窗口执行SSH安装命令...</span>");
-            builtinCommandOutputEdit->append("<span style='color: #74b9ff;'>[提示] 请在弹出的CMD窗口中查看执行结果</span>");
-            builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 批处理文件: %1</span>").arg(nativeBatFile));
-            builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 执行命令: %1</span>").arg(finalCommand));
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法创建批处理文件</span>");
-            return;
-        }
-    } else {
-        // Linux/macOS下使用sh执行
-        program = "sh";
-        arguments << "-c" << finalCommand;
-    }
-    
-    // 设置工作目录为程序目录（确保能找到install_ssh_key.py和批处理文件）
-    QString execDir = QCoreApplication::applicationDirPath();
-    builtinCommandProcess->setWorkingDirectory(execDir);
-    
-    // 添加调试：显示工作目录和文件信息
-    builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 工作目录: %1</span>").arg(execDir));
-    
-    // 验证Python脚本文件是否存在
-    QString scriptPath = QDir(execDir).absoluteFilePath("install_ssh_key.py");
-    builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] Python脚本路径: %1</span>").arg(scriptPath));
-    builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] Python脚本存在: %1</span>").arg(QFile::exists(scriptPath) ? "是" : "否"));
-    
-    // 启动进程
-    builtinCommandProcess->start(program, arguments);
-    
-    // 启动进程
-    if (builtinCommandProcess->waitForStarted(3000)) {
-        if (QSysInfo::productType() == "windows") {
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] CMD窗口已启动，SSH公钥安装正在独立窗口中执行...</span>");
-            builtinCommandOutputEdit->append("<span style='color: #74b9ff;'>[说明] 安装过程将在弹出的CMD窗口中显示，完成后窗口会自动关闭</span>");
-            
-            // 立即清理进程，因为cmd会立即返回
-            QTimer::singleShot(2000, this, [this]() {
-                if (builtinCommandProcess) {
-                    builtinCommandProcess->deleteLater();
-                    builtinCommandProcess = nullptr;
-                }
-            });
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] Python脚本已启动，正在处理SSH连接...</span>");
-            
-            // 设置超时保护 - 60秒后强制终止进程
-            QTimer::singleShot(60000, this, [this]() {
-                if (builtinCommandProcess && builtinCommandProcess->state() == QProcess::Running) {
-                    builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[警告] Python脚本执行超时，正在终止进程...</span>");
-                    builtinCommandProcess->kill();
-                }
-            });
-        }
-    } else {
-        if (QSysInfo::productType() == "windows") {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动CMD窗口</span>");
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动Python脚本</span>");
-        }
-        
-        if (builtinCommandProcess) {
-            builtinCommandProcess->deleteLater();
-            builtinCommandProcess = nullptr;
-        }
-    }
-}
-
-void MainWindow::executeDirectSSHCommand(const QString &password)
-{
-    builtinCommandProcess = new QProcess(this);
-    
-    // 连接信号处理实时输出
-    connect(builtinCommandProcess, &QProcess::readyReadStandardOutput, 
-            this, [this]() {
-        QByteArray data = builtinCommandProcess->readAllStandardOutput();
-        if (!data.isEmpty()) {
-            QString output = QString::fromLocal8Bit(data);
-            if (!output.isEmpty()) {
-                output = output.trimmed();
-                if (!output.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ffffff;'>%1</span>").arg(output));
-                }
-            }
-        }
-        QTextCursor cursor = builtinCommandOutputEdit->textCursor();
-        cursor.movePosition(QTextCursor::End);
-        builtinCommandOutputEdit->setTextCursor(cursor);
-    });
-    
-    connect(builtinCommandProcess, &QProcess::readyReadStandardError, 
-            this, [this]() {
-        QByteArray data = builtinCommandProcess->readAllStandardError();
-        if (!data.isEmpty()) {
-            QString error = QString::fromLocal8Bit(data);
-            if (!error.isEmpty()) {
-                error = error.trimmed();
-                if (!error.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ff7675;'>%1</span>").arg(error));
-                }
-            }
-        }
-        QTextCursor cursor = builtinCommandOutputEdit->textCursor();
-        cursor.movePosition(QTextCursor::End);
-        builtinCommandOutputEdit->setTextCursor(cursor);
-    });
-    
-    // 连接完成信号
-    connect(builtinCommandProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
-                
-        QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
-        
-        if (exitStatus == QProcess::NormalExit) {
-            if (exitCode == 0) {
-                builtinCommandOutputEdit->append(QString("<span style='color: #00b894;'>[%1] SSH命令执行完成 (退出码: %2)</span>")
-                                               .arg(timestamp).arg(exitCode));
-            } else {
-                builtinCommandOutputEdit->append(QString("<span style='color: #e17055;'>[%1] SSH命令执行有错误 (退出码: %2)</span>")
-                                               .arg(timestamp).arg(exitCode));
-            }
-        } else {
-            builtinCommandOutputEdit->append(QString("<span style='color: #ff6b6b;'>[%1] SSH命令执行异常终止</span>").arg(timestamp));
-        }
-        
-        builtinCommandOutputEdit->append("<span style='color: #74b9ff;'>---</span>");
-        
-        QTextCursor cursor = builtinCommandOutputEdit->textCursor();
-        cursor.movePosition(QTextCursor::End);
-        builtinCommandOutputEdit->setTextCursor(cursor);
-        
-        if (builtinCommandProcess) {
-            builtinCommandProcess->deleteLater();
-            builtinCommandProcess = nullptr;
-        }
-    });
+    builtinCommandProcess->setWorkingDirectory(QCoreApplication::applicationDirPath());
     
     QString program;
     QStringList arguments;
@@ -5488,25 +5250,19 @@ void MainWindow::executeDirectSSHCommand(const QString &password)
         program = "sh";
         arguments << "-c" << pendingSSHCommand;
     }
+    pendingSSHCommand.clear();
     
     builtinCommandProcess->start(program, arguments);
     
-    if (builtinCommandProcess->waitForStarted(3000)) {
-        QTimer::singleShot(2000, this, [this, password]() {
-            if (builtinCommandProcess && builtinCommandProcess->state() == QProcess::Running) {
-                builtinCommandProcess->write((password + "\r\n").toLocal8Bit());
-            }
-        });
-    } else {
-        builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动SSH进程</span>");
-        
-        if (builtinCommandProcess) {
-            builtinCommandProcess->deleteLater();
-            builtinCommandProcess = nullptr;
+    // 设置超时保护 - 60秒后强制终止进程
+    QProcess *startedProcess = builtinCommandProcess;
+    QTimer::singleShot(60000, this, [this, startedProcess]() {
+        if (builtinCommandProcess == startedProcess && builtinCommandProcess->state() == QProcess::Running) {
+            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[警告] SSH命令执行超时，正在终止进程...</span>");
+            builtinCommandProcess->kill();
         }
-    }
+    });
 }
-
 void MainWindow::onPasswordInputEnterPressed()
 {
     onPasswordInputFinished();
@@ -5631,7 +5387,7 @@ bool MainWindow::validateSSHSettings()
     return true;
 }
 
-void MainWindow::executeSSHWithPassword(const QString &command, const QString &password)
+void MainWindow::executeSSHWithPassword(const QString &command)
 {
     // 直接使用已有密码执行SSH命令，不需要密码输入界面
     logMessage("[智能部署] 使用服务器连接密码自动执行SSH命令");
@@ -5661,41 +5417,27 @@ void MainWindow::executeSSHWithPassword(const QString &command, const QString &p
     builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] SSH命令: %1</span>").arg(command));
     
     // 直接执行SSH命令
-    executeSSHWithDirectPassword(command, password);
+    executeSSHWithDirectPassword(command);
 }
 
-void MainWindow::executeSSHWithDirectPassword(const QString &command, const QString &password)
+void MainWindow::executeSSHWithDirectPassword(const QString &command)
 {
-    if (builtinCommandProcess) {
-        builtinCommandProcess->deleteLater();
-        builtinCommandProcess = nullptr;
-    }
-    
-    // 如果是Python脚本命令，需要添加密码参数
-    QString finalCommand = command;
-    if (finalCommand.contains("install_ssh_key.py")) {
-        finalCommand += QString(" --password \"%1\"").arg(password);
-        
-        // 添加调试：验证密码参数（显示密码长度而不是内容）
-        builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 密码参数长度: %1 字符</span>").arg(password.length()));
-        builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 密码首字符: %1</span>").arg(password.isEmpty() ? "空" : password.left(1)));
+    if (keyInstallCommand) {
+        keyInstallCommand->disconnect(this);
+        keyInstallCommand->kill();
+        keyInstallCommand->deleteLater();
+        keyInstallCommand = nullptr;
     }
     
-    builtinCommandProcess = new QProcess(this);
+    // 安装命令在SSH会话上执行，密码由程序自身作为 SSH_ASKPASS 提供，不再生成批处理文件或调用Python脚本
+    keyInstallCommand = new SshCommand(this);
     
     // 连接信号处理实时输出
-    connect(builtinCommandProcess, &QProcess::readyReadStandardOutput, 
+    connect(keyInstallCommand, &SshCommand::readyReadStandardOutput, 
             this, [this]() {
-        QByteArray data = builtinCommandProcess->readAllStandardOutput();
-        if (!data.isEmpty()) {
-            QString output = QString::fromLocal8Bit(data); // Windows下使用本地编码
-            if (!output.isEmpty()) {
-                // 清理和格式化输出
-                output = output.trimmed();
-                if (!output.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ffffff;'>%1</span>").arg(output));
-                }
-            }
+        QString output = QString::fromUtf8(keyInstallCommand->readAllStandardOutput()).trimmed();
+        if (!output.isEmpty()) {
+            builtinCommandOutputEdit->append(QString("<span style='color: #ffffff;'>%1</span>").arg(output));
         }
         // 自动滚动到底部
         QTextCursor cursor = builtinCommandOutputEdit->textCursor();
@@ -5703,18 +5445,11 @@ void MainWindow::executeSSHWithDirectPassword(const QString &command, const QStr
         builtinCommandOutputEdit->setTextCursor(cursor);
     });
     
-    connect(builtinCommandProcess, &QProcess::readyReadStandardError, 
+    connect(keyInstallCommand, &SshCommand::readyReadStandardError, 
             this, [this]() {
-        QByteArray data = builtinCommandProcess->readAllStandardError();
-        if (!data.isEmpty()) {
-            QString error = QString::fromLocal8Bit(data); // Windows下使用本地编码
-            
-            if (!error.isEmpty()) {
-                error = error.trimmed();
-                if (!error.isEmpty()) {
-                    builtinCommandOutputEdit->append(QString("<span style='color: #ff7675;'>%1</span>").arg(error));
-                }
-            }
+        QString error = QString::fromUtf8(keyInstallCommand->readAllStandardError()).trimmed();
+        if (!error.isEmpty()) {
+            builtinCommandOutputEdit->append(QString("<span style='color: #ff7675;'>%1</span>").arg(error));
         }
         QTextCursor cursor = builtinCommandOutputEdit->textCursor();
         cursor.movePosition(QTextCursor::End);
@@ -5722,7 +5457,7 @@ void MainWindow::executeSSHWithDirectPassword(const QString &command, const QStr
     });
     
     // 连接完成信号
-    connect(builtinCommandProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+    connect(keyInstallCommand, &SshCommand::finished,
             this, [this](int exitCode, QProcess::ExitStatus exitStatus) {
                 
         QString timestamp = QDateTime::currentDateTime().toString("hh:mm:ss");
@@ -5731,7 +5466,7 @@ void MainWindow::executeSSHWithDirectPassword(const QString &command, const QStr
             if (exitCode == 0) {
                 builtinCommandOutputEdit->append(QString("<span style='color: #00b894;'>[%1] SSH公钥安装完成 (退出码: %2)</span>")
                                                .arg(timestamp).arg(exitCode));
-                builtinCommandOutputEdit->append("<span style='color: #00b894;'>[提示] SSH公钥安装可能已完成，建议测试连接验证</span>");
+                builtinCommandOutputEdit->append("<span style='color: #00b894;'>[提示] SSH公钥已写入服务器 ~/.ssh/authorized_keys，建议测试连接验证</span>");
                 
                 QTimer::singleShot(2000, this, [this]() {
                     int ret = QMessageBox::question(this, "SSH公钥安装", 
@@ -5752,8 +5487,6 @@ void MainWindow::executeSSHWithDirectPassword(const QString &command, const QStr
                 // 分析常见错误
                 if (exitCode == 255) {
                     builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 可能的原因：密码错误、网络连接问题或SSH服务未启动</span>");
-                } else if (exitCode == 5) {
-                    builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 密码认证失败，请检查密码是否正确</span>");
                 } else if (exitCode == 1) {
                     builtinCommandOutputEdit->append("<span style='color: #ffa500;'>[分析] 可能的原因：权限不足或目标路径不存在</span>");
                 }
@@ -5775,138 +5508,24 @@ void MainWindow::executeSSHWithDirectPassword(const QString &command, const QStr
             logMessage("[一体化部署] SSH密钥生成和部署流程完成");
         }
         
-        if (builtinCommandProcess) {
-            builtinCommandProcess->deleteLater();
-            builtinCommandProcess = nullptr;
+        if (keyInstallCommand) {
+            keyInstallCommand->deleteLater();
+            keyInstallCommand = nullptr;
         }
     });
     
-    // 设置进程环境
-    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
-    env.insert("LANG", "zh_CN.UTF-8");
-    
-    builtinCommandProcess->setProcessEnvironment(env);
-    
-    QString program;
-    QStringList arguments;
-    
-    if (QSysInfo::productType() == "windows") {
-        // Windows下启动新的cmd窗口并自动执行命令
-        program = "cmd";
-        
-        // 创建批处理文件到程序执行目录
-        QString execDir = QCoreApplication::applicationDirPath();
-        QString batFile = QDir(execDir).absoluteFilePath("ssh_install_auto.bat");
-        
-        QFile file(batFile);
-        if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            QTextStream out(&file);
-            out.setCodec("GBK"); // Windows批处理文件使用GBK编码
-            
-            // 写入批处理命令
-            out << "@echo off\n";
-            out << "title SSH公钥自动安装\n";
-            out << "color 0a\n"; // 设置绿色字体
-            out << "echo ========================================\n";
-            out << "echo        SSH公钥自动安装工具\n";
-            out << "echo ========================================\n";
-            out << "echo.\n";
-            QString nativeExecDir = QDir::toNativeSeparators(execDir);
-            out << "echo 程序目录: " << nativeExecDir << "\n";
-            out << "echo 脚本位置: %~dp0\n";
-            out << "echo.\n";
-            out << "echo 正在执行SSH公钥安装命令...\n";
-            out << "echo 命令: " << finalCommand << "\n";
-            out << "echo.\n";
-            out << "echo [执行中] 请等待...\n";
-            out << "echo.\n";
-            out << finalCommand << "\n";
-            out << "echo.\n";
-            out << "echo ========================================\n";
-            out << "if %ERRORLEVEL% EQU 0 (\n";
-            out << "    echo [✓成功] SSH公钥安装完成！\n";
-            out << "    echo.\n";
-            out << "    echo 现在您可以使用SSH密钥连接服务器：\n";
-            out << "    echo ssh -p 22 ubuntu@1.13.80.192\n";
-            out << ") else (\n";
-            out << "    echo [✗失败] SSH公钥安装失败，错误码: %ERRORLEVEL%\n";
-            out << "    echo.\n";
-            out << "    echo 请检查：\n";
-            out << "    echo 1. 网络连接是否正常\n";
-            out << "    echo 2. 服务器地址和端口是否正确\n";
-            out << "    echo 3. 用户名和密码是否正确\n";
-            out << ")\n";
-            out << "echo ========================================\n";
-            out << "echo.\n";
-            out << "echo 按任意键关闭窗口...\n";
-            out << "pause >nul\n";
-            out << "del \"%~f0\" >nul 2>&1\n"; // 执行完成后自动删除批处理文件
-            
-            file.close();
-            
-            // 启动新的cmd窗口执行批处理文件
-            QString nativeBatFile = QDir::toNativeSeparators(batFile);
-            arguments << "/c" << nativeBatFile;
-            
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] 正在启动独立的CMD窗口执行SSH安装命令...</span>");
-            builtinCommandOutputEdit->append("<span style='color: #74b9ff;'>[提示] 请在弹出的CMD窗口中查看执行结果</span>");
-            builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 批处理文件: %1</span>").arg(nativeBatFile));
-            builtinCommandOutputEdit->append(QString("<span style='color: #6c5ce7;'>[调试] 执行命令: %1</span>").arg(finalCommand));
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法创建批处理文件</span>");
-            return;
-        }
-    } else {
-        // Linux/macOS下使用sh执行
-        program = "sh";
-        arguments << "-c" << finalCommand;
-    }
-    
-    // 设置工作目录为程序目录（确保能找到install_ssh_key.py和批处理文件）
-    QString execDir = QCoreApplication::applicationDirPath();
-    builtinCommandProcess->setWorkingDirectory(execDir);
-    
-    // 启动进程
-    builtinCommandProcess->start(program, arguments);
+    builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] 正在通过SSH会话安装公钥...</span>");
+    keyInstallCommand->start(currentSshSession(), command);
     
-    // 启动进程
-    if (builtinCommandProcess->waitForStarted(3000)) {
-        if (QSysInfo::productType() == "windows") {
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] CMD窗口已启动，SSH公钥安装正在独立窗口中执行...</span>");
-            builtinCommandOutputEdit->append("<span style='color: #74b9ff;'>[说明] 安装过程将在弹出的CMD窗口中显示，完成后窗口会自动关闭</span>");
-            
-            // 立即清理进程，因为cmd会立即返回
-            QTimer::singleShot(2000, this, [this]() {
-                if (builtinCommandProcess) {
-                    builtinCommandProcess->deleteLater();
-                    builtinCommandProcess = nullptr;
-                }
-            });
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #00b894;'>[系统] Python脚本已启动，正在处理SSH连接...</span>");
-            
-            // 设置超时保护 - 60秒后强制终止进程
-            QTimer::singleShot(60000, this, [this]() {
-                if (builtinCommandProcess && builtinCommandProcess->state() == QProcess::Running) {
-                    builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[警告] Python脚本执行超时，正在终止进程...</span>");
-                    builtinCommandProcess->kill();
-                }
-            });
-        }
-    } else {
-        if (QSysInfo::productType() == "windows") {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动CMD窗口</span>");
-        } else {
-            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[错误] 无法启动Python脚本</span>");
+    // 设置超时保护 - 60秒后强制终止
+    SshCommand *startedCommand = keyInstallCommand;
+    QTimer::singleShot(60000, this, [this, startedCommand]() {
+        if (keyInstallCommand == startedCommand && keyInstallCommand->state() != QProcess::NotRunning) {
+            builtinCommandOutputEdit->append("<span style='color: #ff6b6b;'>[警告] SSH公钥安装超时，正在终止...</span>");
+            keyInstallCommand->kill();
         }
-        
-        if (builtinCommandProcess) {
-            builtinCommandProcess->deleteLater();
-            builtinCommandProcess = nullptr;
-        }
-    }
+    });
 }
-
 void MainWindow::onEnableSSHKey()
 {
     // 如果SSH密钥功能已启用，则直接返回
@@ -31,6 +31,7 @@
 #include <QAction>
 #include <QStatusBar>
 #include <QTimer>
+#include <QTime>
 #include <QFileDialog>
 #include <QProcess>
 #include <QTcpSocket>
@@ -47,6 +48,19 @@
 #include <QTextStream>
 #include <QCryptographicHash>
 #include <QClipboard>
+#include "chunkeduploader.h"
+#include "transferstats.h"
+#include "hashservice.h"
+#include "fleetuploaddialog.h"
+#include "sshsession.h"
+#include "streamextractor.h"
+#include "ratelimiter.h"
+#include "transferwatchdog.h"
+#include "retrypolicy.h"
+#include "batchuploader.h"
+#include "digestmanifest.h"
+#include "upgradepipeline.h"
+#include "upgradetimelinedialog.h"
 
 class SettingsDialog;
 
@@ -60,20 +74,34 @@ public:
 
 private slots:
     void onSelectFile();
+    void onSelectDirectory();
     void onUploadFile();
     void onClearLog();
     void onTestConnection();
     void onCancelUpload();
-    void onUploadFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onUploadFinished(bool success, const QString &errorMessage);
+    void onBatchUploadFinished(bool success, const QString &errorMessage);
     void onUploadProgress();
-    void onUploadOutput();
-    void onUploadTimeout();
+    void onUploadBytesProgress(qint64 bytesSent, qint64 totalBytes);
+    void onStreamExtractFinished(bool success, const QString &errorMessage);
+    void onLocalMd5Ready(const QString &filePath, const QString &md5, bool fromCache);
+    void onLocalMd5Failed(const QString &filePath, const QString &errorMessage);
+    void onLocalDigestReady(const QString &filePath, int algorithm, const QString &digest, bool fromCache);
+    void onUploadTimeout(const QString &reason);
+    void onRetryTimer();
     void onTestFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onMenuAction();
     void onToggleLogView();
     void onToggleCommandView();
     void onToggleBuiltinCommandView();
+    void onDigestNegotiated(int exitCode, QProcess::ExitStatus exitStatus);
     void onVerifyFileFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onUpgradeStepStarted(int index);
+    void onUpgradeStepFinished(int index);
+    void onUpgradeOutput(int index, const QString &text);
+    void onUpgradeProgress(int index, qint64 done, qint64 total);
+    void onUpgradeError(int index, const QString &text);
+    void onUpgradeFinished(bool success);
     void onShowMachineCode();
     void onUpgradeQtSoftware();
     void onUpgrade7evFirmware();
@@ -82,6 +110,8 @@ private slots:
     void onClearCommandOutput();
     void onCommandInputEnterPressed();
     void onOpenSettings();
+    void onOpenFleetUpload();
+    void onShowUpgradeTimeline();
     
     // SSH密钥管理相关槽函数
     void onManageSSHKeys();
@@ -113,11 +143,23 @@ private:
     bool validateSettings();
     bool validateSSHSettings();  // SSH密钥功能专用验证函数
     void startUpload();
+    void startBatchUpload();
+    void selectBatchPaths(const QStringList &paths, const QString &summary);
+    QStringList buildUploadAuthOptions();
+    SshSession *currentSshSession();
+    QString currentDeviceKey() const;
+    QString verifiedUploadKey(const QString &fileName) const;   // verifiedUploads 中当前设备远程目录下文件的键
+    void finishUploadStats();
+    void resetTransferProgressBar();
     
     // 设置保存和加载
     void saveSettingsToFile();
     void loadSettingsFromFile();
     QString getSettingsFilePath();
+    QString getUploadStateDirectory();
+    QString getHashCacheFilePath();
+    QString getFleetDeviceListPath();
+    QString getUpgradeTelemetryPath();
     
     // 日志管理
     void writeLogToFile(const QString &message);
@@ -126,16 +168,32 @@ private:
     // 文件校验
     QString calculateFileMD5(const QString &filePath);
     void startFileVerification();
+    void reportVerificationPassed(FileDigest::Algorithm algorithm, const QString &localDigest,
+                                  const QString &remoteDigest, bool transferSkipped);
+    
+    // 失败重试：网络中断时等待退避间隔后重新执行当前步骤
+    enum RetryStep {
+        RetryNone,
+        RetryUpload,
+        RetryBatchUpload,
+        RetryVerify,
+        RetryStreamExtract,
+        RetryUpgradePipeline
+    };
+    bool scheduleRetry(RetryStep step, RetryPolicy::ErrorClass errorClass, const QString &reason);
     
     // SSH远程命令执行
-    void executeRemoteCommand(const QString &command, const QString &workingDir = QString());
+    void startStreamedQtUpgrade();
     void executeCustomRemoteCommand(const QString &command);
-    void execute7evRemoteCommand(const QString &command);
-    void executePreCheck7ev();
-    void executePreCheck7evCommand(const QString &command);
-    void executeActual7evUpgrade();
     void executeKu5pUpgrade();
-    void executeKu5pRemoteCommand(const QString &command);
+    
+    // 升级流水线：各升级描述为步骤列表，由 UpgradePipeline 执行
+    void buildQtUpgradePipeline();
+    void build7evUpgradePipeline();
+    void runUpgradePipeline();
+    void updateUpgradeRunProgress(const QString &output);
+    static QStringList hardwareErrorPatterns();
+    void recordUpgradeTelemetry(bool success);
     
     // 机器码验证相关函数
     QString getMachineCode();
@@ -159,16 +217,15 @@ private:
     // 内置命令窗口相关函数
     void executeBuiltinSystemCommand(const QString &command);
     void executeSSHCommandWithPassword(const QString &command);
-    void executeSSHWithPassword(const QString &command, const QString &password);
-    void executeSSHWithDirectPassword(const QString &command, const QString &password);
+    void executeSSHWithPassword(const QString &command);
+    void executeSSHWithDirectPassword(const QString &command);
     bool validateBasicSettings();
     void setBuiltinCommand(const QString &command);
-    QString generateReliableSSHInstallCommand(const QString &username, const QString &ip, int port, const QString &publicKey);
+    QString generateReliableSSHInstallCommand(const QString &publicKey);
     void showPasswordInput(const QString &prompt);
     void hidePasswordInput();
     void processPasswordInput(const QString &password);
     void executeSSHWithSshpass(const QString &password);
-    void executeDirectSSHCommand(const QString &password);
     void executeSSHKeyGenerationAndDeployment();
     
     // UI组件
@@ -195,6 +252,7 @@ private:
     QLabel *fileLabel;
     QLineEdit *filePathLineEdit;
     QPushButton *selectFileButton;
+    QPushButton *selectDirButton;
     
     // 上传控制组
     QGroupBox *uploadGroup;
@@ -252,32 +310,52 @@ private:
     QAction *saveSettingsAction;
     QAction *loadSettingsAction;
     QAction *exitAction;
+    QAction *fleetUploadAction;
     QAction *aboutAction;
     QAction *toggleLogAction;
     QAction *toggleCommandAction;
     QAction *toggleBuiltinCommandAction;
+    QAction *upgradeTimelineAction;
     QAction *showMachineCodeAction;
     QAction *openSettingsAction;
     QAction *enableSSHKeyAction;
     QAction *disableSSHKeyAction; // 新增：退出SSH密钥菜单项
     
     // 上传相关
-    QProcess *uploadProcess;
-    QProcess *testProcess;
-    QProcess *verifyProcess;
-    QProcess *remoteCommandProcess;
-    QProcess *customCommandProcess;
-    QProcess *preCheck7evProcess;
-    QProcess *upgrade7evProcess;
-    QProcess *upgradeKu5pProcess;
+    ChunkedUploader *chunkedUploader;
+    TransferStats uploadStats;
+    HashService *hashService;
+    SshSessionManager *sshSessionManager;
+    StreamExtractor *streamExtractor;
+    BatchUploader *batchUploader;
+    RateLimiter *uploadRateLimiter;
+    SshCommand *testProcess;
+    bool testReusedConnection;      // 测试开始时会话已连接，本次没有重新认证
+    int testAskPassAnswers;         // 测试开始时已应答的密码提示次数
+    SshCommand *verifyProcess;
+    UpgradePipeline *upgradePipeline;
+    SshCommand *customCommandProcess;
     QProcess *sshKeyGenProcess;
     QProcess *builtinCommandProcess;
+    SshCommand *keyInstallCommand;
     QTimer *progressTimer;
-    QTimer *timeoutTimer;
+    TransferWatchdog *uploadWatchdog;
+    QTimer *retryTimer;
+    RetryStep pendingRetry;
+    bool transferStalled;           // 看门狗终止了传输，随后的失败按网络中断处理
+    QString upgradeSuccessNote;     // 升级成功对话框末尾的说明
+    QString upgradePackageName;     // 当前升级使用的升级包文件名，记入耗时记录
+    RetryPolicy stepRetry;
+    QString remoteStepErrors;       // 升级命令的错误输出，用于判断失败类别
     QString selectedFilePath;
+    QStringList batchPaths;         // 选择了多个文件或目录时改为多文件上传，selectedFilePath 为空
     QString localFileMD5;
+    DigestManifest verifyManifest;  // 上传后校验的远程文件及期望摘要
+    FileDigest::Algorithm verifyAlgorithm;
+    bool verifyAwaitingDigest;      // 等待后台摘要服务算出本地摘要后再发起远程校验
     QPushButton *cancelButton;
     QTemporaryFile *keyFile;
+    QFile *logFile;                 // 日志文件保持打开，不再每行重新打开
     
     // 设置相关
     SettingsDialog *settingsDialog;
@@ -292,10 +370,33 @@ private:
     int logRetentionDays;
     QString qtExtractPath;
     QString sevEvExtractPath;
+    bool deltaUploadEnabled;
+    bool compressUploadEnabled;
+    int uploadStreamCount;
+    int stallTimeoutSeconds;
+    int retryAttempts;
+    int uploadRateLimitKBps;
+    int deviceRateLimitKBps;
+    QTime rateLimitStart;
+    QTime rateLimitEnd;
+    bool streamQtUpgradeEnabled;
+    bool extractFileListEnabled;
+    QString verifyDigestPreference;                     // "auto" 或指定算法名称
+    QMap<QString, FileDigest::Algorithm> deviceDigests; // 已协商的设备（user@host:port）及其校验算法
+    
+    // 本次运行中通过摘要校验的远程文件，键为 "设备|远程路径"；升级时重新计算同一摘要确认升级包未变，不再解压检查。
+    // 开始上传到该路径或校验失败时移除
+    struct VerifiedUpload {
+        FileDigest::Algorithm algorithm;
+        QString digestName;
+        QString digest;
+    };
+    QMap<QString, VerifiedUpload> verifiedUploads;
     
     // 应用设置管理
     void loadApplicationSettings();
     void saveApplicationSettings();
+    void applyRateLimitSettings();
     
     // 日志清理功能
     void cleanExpiredLogs();
@@ -0,0 +1,633 @@
+/**
+ * @File Name: multistreamuploader.cpp
+ * @brief  多通道并行上传实现，各通道分别写入远程分段文件，全部完成后远程拼接并校验整文件MD5
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "multistreamuploader.h"
+#include "chunkeduploader.h"
+#include "ratelimiter.h"
+#include "sshprocess.h"
+#include "sshutils.h"
+#include <QFileInfo>
+#include <QTimer>
+
+// 计算整文件MD5时每次事件循环读取的数据量
+static const qint64 HASH_SLICE_SIZE = 4 * 1024 * 1024;
+
+// 并行通道数上限
+static const int MAX_STREAMS = 8;
+
+// 拼接命令输出远程MD5的行前缀
+static const char *ASSEMBLE_MD5_MARKER = "@@MD5";
+
+MultiStreamUploader::MultiStreamUploader(QObject *parent)
+    : QObject(parent), sshEnvironment(QProcessEnvironment::systemEnvironment()),
+      chunkBytes(ChunkedUploader::DEFAULT_CHUNK_SIZE), compressed(false), rateLimiter(nullptr), running(false), cancelRequested(false),
+      assembleProcess(nullptr), totalBytes(0), landedBytes(0), md5Hash(QCryptographicHash::Md5), hashReady(false),
+      errorClass(RetryPolicy::ErrorNone)
+{
+}
+
+MultiStreamUploader::~MultiStreamUploader()
+{
+    cleanup();
+    clearStreams();
+}
+
+void MultiStreamUploader::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+}
+
+void MultiStreamUploader::setRemoteFile(const QString &remoteFilePath)
+{
+    this->remoteFilePath = remoteFilePath;
+}
+
+void MultiStreamUploader::setSshConnectionArguments(const QStringList &arguments)
+{
+    connectionArguments = arguments;
+}
+
+void MultiStreamUploader::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+void MultiStreamUploader::setChunkSize(qint64 bytes)
+{
+    if (bytes > 0) {
+        chunkBytes = bytes;
+    }
+}
+
+void MultiStreamUploader::setCompressed(bool compressed)
+{
+    this->compressed = compressed;
+}
+
+void MultiStreamUploader::setRateLimiter(RateLimiter *limiter)
+{
+    if (!running) {
+        rateLimiter = limiter;
+    }
+}
+
+void MultiStreamUploader::setExpectedMd5(const QString &md5)
+{
+    expectedMd5 = md5.trimmed().toLower();
+}
+
+bool MultiStreamUploader::isRunning() const
+{
+    return running;
+}
+
+QString MultiStreamUploader::fileMd5() const
+{
+    return md5Hex;
+}
+
+QString MultiStreamUploader::remoteMd5() const
+{
+    return remoteMd5Hex;
+}
+
+RetryPolicy::ErrorClass MultiStreamUploader::lastErrorClass() const
+{
+    return errorClass;
+}
+
+int MultiStreamUploader::usableStreams(qint64 remainingBytes, qint64 chunkBytes, int requested)
+{
+    if (remainingBytes <= 0 || chunkBytes <= 0) {
+        return 1;
+    }
+    qint64 chunks = (remainingBytes + chunkBytes - 1) / chunkBytes;
+    return static_cast<int>(qBound<qint64>(1, qMin<qint64>(requested, chunks), MAX_STREAMS));
+}
+
+QList<MultiStreamUploader::Range> MultiStreamUploader::splitRanges(qint64 startOffset, qint64 totalBytes,
+                                                                   qint64 chunkBytes, int streamCount)
+{
+    // 按分块边界均分剩余部分，前几段多分到余下的分块
+    QList<Range> ranges;
+    qint64 remainingChunks = (totalBytes - startOffset + chunkBytes - 1) / chunkBytes;
+    int count = usableStreams(totalBytes - startOffset, chunkBytes, streamCount);
+    qint64 begin = startOffset;
+    for (int i = 0; i < count; ++i) {
+        qint64 chunks = remainingChunks / count + (i < remainingChunks % count ? 1 : 0);
+        Range range;
+        range.begin = i == 0 ? 0 : begin;
+        range.end = qMin(begin + chunks * chunkBytes, totalBytes);
+        range.landed = i == 0 ? startOffset : 0;
+        ranges.append(range);
+        begin = range.end;
+    }
+    return ranges;
+}
+
+QString MultiStreamUploader::rangeSuffix(const Range &range, qint64 chunkBytes)
+{
+    return QString(".r%1-%2").arg(range.begin / chunkBytes).arg((range.end + chunkBytes - 1) / chunkBytes);
+}
+
+QList<MultiStreamUploader::Range> MultiStreamUploader::parseRemoteRanges(const QString &section, qint64 totalBytes,
+                                                                         qint64 chunkBytes)
+{
+    QMap<qint64, Range> sorted;
+    const QStringList lines = section.split('\n', QString::SkipEmptyParts);
+    for (const QString &line : lines) {
+        QStringList fields = line.trimmed().split(' ', QString::SkipEmptyParts);
+        QStringList chunks = fields.value(0).split('-');
+        bool beginOk = false, endOk = false, sizeOk = false;
+        qint64 beginChunk = chunks.value(0).toLongLong(&beginOk);
+        qint64 endChunk = chunks.value(1).toLongLong(&endOk);
+        qint64 size = fields.value(1).toLongLong(&sizeOk);
+        if (fields.size() != 2 || chunks.size() != 2 || !beginOk || !endOk || !sizeOk
+            || beginChunk <= 0 || endChunk <= beginChunk) {
+            return QList<Range>();
+        }
+
+        // 与 .part 相同：文件大小按分块向下取整即为完整落盘的部分，整段写完时取整段长度
+        Range range;
+        range.begin = beginChunk * chunkBytes;
+        range.end = qMin(endChunk * chunkBytes, totalBytes);
+        qint64 length = range.end - range.begin;
+        range.landed = size >= length ? length : size / chunkBytes * chunkBytes;
+        if (length <= 0) {
+            return QList<Range>();
+        }
+        sorted.insert(range.begin, range);
+    }
+
+    QList<Range> ranges = sorted.values();
+    for (int i = 1; i < ranges.size(); ++i) {
+        if (ranges[i].begin != ranges[i - 1].end) {
+            return QList<Range>();
+        }
+    }
+    if (!ranges.isEmpty() && ranges.last().end != totalBytes) {
+        return QList<Range>();
+    }
+    return ranges;
+}
+
+void MultiStreamUploader::start(const QList<Range> &ranges, const QString &identity)
+{
+    if (running) {
+        return;
+    }
+
+    clearStreams();
+    running = true;
+    cancelRequested = false;
+    sourceIdentity = identity;
+    totalBytes = QFileInfo(localFilePath).size();
+    landedBytes = 0;
+    md5Hash.reset();
+    md5Hex.clear();
+    hashReady = false;
+    remoteMd5Hex.clear();
+    errorClass = RetryPolicy::ErrorNone;
+
+    int activeCount = 0;
+    for (int i = 0; i < ranges.size(); ++i) {
+        const Range &range = ranges[i];
+        Stream *stream = new Stream;
+        stream->index = i;
+        stream->process = nullptr;
+        stream->file = new QFile(localFilePath);
+        stream->rangeBegin = range.begin;
+        stream->begin = range.begin + range.landed;
+        stream->end = range.end;
+        stream->writtenOffset = stream->begin;
+        stream->done = stream->begin >= stream->end;
+        stream->compressor = compressed && !stream->done ? new StreamCompressor : nullptr;
+        stream->bytesQueued = 0;
+        stream->acknowledgedOffset = stream->begin;
+        stream->limiterConsumer = rateLimiter && !stream->done ? rateLimiter->attach() : -1;
+        streams.append(stream);
+        landedBytes += range.landed;
+        if (!stream->done) {
+            ++activeCount;
+        }
+    }
+
+    if (landedBytes > 0) {
+        emit logMessage(QString("[并行上传] 文件分为 %1 段，各段已落盘共 %2 字节，从各自的位置继续发送")
+                       .arg(streams.size()).arg(landedBytes));
+    }
+    emit logMessage(QString("[并行上传] 剩余 %1 字节经 %2 个SSH通道同时发送")
+                   .arg(totalBytes - landedBytes).arg(activeCount));
+    emit progressChanged(landedBytes, totalBytes);
+
+    if (rateLimiter) {
+        connect(rateLimiter, &RateLimiter::tokensAvailable, this, &MultiStreamUploader::feedAllStreams);
+    }
+
+    for (Stream *stream : streams) {
+        if (stream->done) {
+            continue;
+        }
+        if (!stream->file->open(QIODevice::ReadOnly) || !stream->file->seek(stream->begin)) {
+            finishWithError(QString("无法打开本地文件: %1").arg(stream->file->errorString()));
+            return;
+        }
+
+        stream->process = new SshProcess(sshEnvironment, this);
+        connect(stream->process, &SshProcess::readyWrite, this, [this, stream]() {
+            onStreamWritable(stream);
+        });
+        connect(stream->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this, stream](int exitCode, QProcess::ExitStatus exitStatus) {
+            onStreamFinished(stream, exitCode, exitStatus);
+        });
+        connect(stream->process, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+            finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+        });
+        stream->process->startSsh(buildSshArguments(streamCommand(stream)));
+    }
+
+    if (!expectedMd5.isEmpty()) {
+        // 调用方已知整文件MD5，不再重新读取文件
+        md5Hex = expectedMd5;
+        hashReady = true;
+        maybeAssemble();
+        return;
+    }
+
+    // 各通道从不同位置读取，整文件MD5另行顺序计算
+    hashFile.setFileName(localFilePath);
+    if (!hashFile.open(QIODevice::ReadOnly)) {
+        finishWithError(QString("无法打开本地文件: %1").arg(hashFile.errorString()));
+        return;
+    }
+    QTimer::singleShot(0, this, &MultiStreamUploader::hashSlice);
+}
+
+void MultiStreamUploader::cancel()
+{
+    if (!running) {
+        return;
+    }
+    cancelRequested = true;
+    finishWithError("上传已取消");
+}
+
+QString MultiStreamUploader::streamFile(const Stream *stream) const
+{
+    QString part = remoteFilePath + ".part";
+    if (stream->index == 0) {
+        return part;
+    }
+    Range range = { stream->rangeBegin, stream->end, 0 };
+    return part + rangeSuffix(range, chunkBytes);
+}
+
+QString MultiStreamUploader::streamCommand(const Stream *stream) const
+{
+    QString file = SshUtils::shellQuote(streamFile(stream));
+    QString command = QString("mkdir -p %1 && ").arg(SshUtils::shellQuote(QFileInfo(remoteFilePath).path()));
+    QString decompress = compressed ? "gzip -dc | " : "";
+
+    if (stream->index == 0) {
+        // 第0段与单通道续传相同：写入清单，seek 到起始分块覆盖写入 .part；
+        // 不属于当前分段的 .part.r* 是其他版本或其他分段方式残留的，先删除，避免下次探测时混在一起
+        QStringList suffixes;
+        for (int i = 1; i < streams.size(); ++i) {
+            Range range = { streams[i]->rangeBegin, streams[i]->end, 0 };
+            suffixes << "*" + rangeSuffix(range, chunkBytes);
+        }
+        command.prepend(QString("for f in %1.r*; do case \"$f\" in %2) ;; *) rm -f \"$f\" ;; esac; done; ")
+                        .arg(file)
+                        .arg(suffixes.isEmpty() ? QString("\"\"") : suffixes.join("|")));
+        qint64 seekChunk = stream->begin / chunkBytes;
+        if (seekChunk == 0) {
+            command += QString("rm -f %1 && ").arg(file);
+        }
+        command += QString("printf '%s\\n' %1 > %2 && %3dd of=%4 bs=%5 seek=%6 conv=notrunc 2>/dev/null && "
+                           "[ $(wc -c < %4) -eq %7 ]")
+                   .arg(SshUtils::shellQuote(sourceIdentity))
+                   .arg(SshUtils::shellQuote(remoteFilePath + ".part.manifest"))
+                   .arg(decompress)
+                   .arg(file)
+                   .arg(chunkBytes)
+                   .arg(seekChunk)
+                   .arg(stream->end);
+    } else {
+        // 其他各段写入自己的分段文件，续传时同样 seek 到第一个缺失分块
+        qint64 seekChunk = (stream->begin - stream->rangeBegin) / chunkBytes;
+        if (seekChunk == 0) {
+            command += QString("rm -f %1 && ").arg(file);
+        }
+        command += QString("%2dd of=%1 bs=%3 seek=%4 conv=notrunc 2>/dev/null && [ $(wc -c < %1) -eq %5 ]")
+                   .arg(file)
+                   .arg(decompress)
+                   .arg(chunkBytes)
+                   .arg(seekChunk)
+                   .arg(stream->end - stream->rangeBegin);
+    }
+    return command;
+}
+
+void MultiStreamUploader::feedStream(Stream *stream)
+{
+    SshProcess *process = stream->process;
+    if (!running || !process || process->state() != QProcess::Running) {
+        return;
+    }
+
+    qint64 sliceBytes;
+    while ((sliceBytes = process->nextSlice(stream->end - stream->writtenOffset)) > 0) {
+        if (rateLimiter) {
+            sliceBytes = rateLimiter->acquire(stream->limiterConsumer, sliceBytes);
+            if (sliceBytes <= 0) {
+                return;
+            }
+        }
+
+        QByteArray data = stream->file->read(sliceBytes);
+        if (data.isEmpty()) {
+            emit logMessage(QString("[错误] 读取本地文件失败: %1").arg(stream->file->errorString()));
+            process->kill();
+            return;
+        }
+
+        stream->writtenOffset += data.size();
+        if (stream->compressor) {
+            QByteArray member = stream->compressor->compress(data);
+            process->write(member);
+            if (rateLimiter) {
+                rateLimiter->release(data.size() - member.size());
+            }
+            stream->bytesQueued += member.size();
+            stream->pendingMembers.append(qMakePair(stream->bytesQueued, stream->writtenOffset));
+        } else {
+            process->write(data);
+        }
+    }
+
+    if (stream->writtenOffset >= stream->end) {
+        process->closeWriteChannelWhenDrained();
+    }
+}
+
+qint64 MultiStreamUploader::sentOffset(Stream *stream)
+{
+    if (stream->done) {
+        return stream->end;
+    }
+    if (!stream->process) {
+        return stream->acknowledgedOffset;
+    }
+    if (!stream->compressor) {
+        stream->acknowledgedOffset = stream->writtenOffset - stream->process->bytesToWrite();
+        return stream->acknowledgedOffset;
+    }
+
+    // 压缩数据按成员换算，与 ChunkedUploader 相同
+    qint64 drained = stream->bytesQueued - stream->process->bytesToWrite();
+    while (!stream->pendingMembers.isEmpty() && stream->pendingMembers.first().first <= drained) {
+        stream->acknowledgedOffset = stream->pendingMembers.takeFirst().second;
+    }
+    return stream->acknowledgedOffset;
+}
+
+qint64 MultiStreamUploader::resumableOffset() const
+{
+    if (streams.isEmpty()) {
+        return 0;
+    }
+    const Stream *first = streams.first();
+    return first->done ? first->end : first->acknowledgedOffset;
+}
+
+QList<MultiStreamUploader::Range> MultiStreamUploader::resumableRanges() const
+{
+    QList<Range> ranges;
+    for (const Stream *stream : streams) {
+        Range range;
+        range.begin = stream->rangeBegin;
+        range.end = stream->end;
+        qint64 sent = (stream->done ? stream->end : stream->acknowledgedOffset) - stream->rangeBegin;
+        range.landed = stream->done ? sent : sent / chunkBytes * chunkBytes;
+        ranges.append(range);
+    }
+    return ranges;
+}
+
+void MultiStreamUploader::onStreamWritable(Stream *stream)
+{
+    emitProgress();
+    feedStream(stream);
+}
+
+void MultiStreamUploader::feedAllStreams()
+{
+    for (Stream *stream : streams) {
+        feedStream(stream);
+    }
+}
+
+void MultiStreamUploader::emitProgress()
+{
+    qint64 sent = landedBytes;
+    for (Stream *stream : streams) {
+        sent += sentOffset(stream) - stream->begin;
+    }
+    emit progressChanged(sent, totalBytes);
+}
+
+void MultiStreamUploader::onStreamFinished(Stream *stream, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!running) {
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0 || stream->writtenOffset < stream->end) {
+        QString error = QString::fromUtf8(stream->process->readAllStandardError()).trimmed();
+        sentOffset(stream);
+        finishWithError(error.isEmpty()
+                        ? QString("第 %1 个传输通道异常退出 (退出码: %2)").arg(stream->index + 1).arg(exitCode)
+                        : error,
+                        RetryPolicy::classify(exitCode, exitStatus, error));
+        return;
+    }
+
+    stream->done = true;
+    stream->file->close();
+    emit logMessage(QString("[并行上传] 通道 %1 完成 (%2 字节)")
+                   .arg(stream->index + 1).arg(stream->end - stream->begin));
+    emitProgress();
+    maybeAssemble();
+}
+
+void MultiStreamUploader::hashSlice()
+{
+    if (!running || hashReady) {
+        return;
+    }
+
+    QByteArray data = hashFile.read(HASH_SLICE_SIZE);
+    if (!data.isEmpty()) {
+        md5Hash.addData(data);
+        QTimer::singleShot(0, this, &MultiStreamUploader::hashSlice);
+        return;
+    }
+
+    if (hashFile.pos() < totalBytes) {
+        finishWithError(QString("读取本地文件失败: %1").arg(hashFile.errorString()));
+        return;
+    }
+
+    hashFile.close();
+    md5Hex = QString(md5Hash.result().toHex());
+    hashReady = true;
+    maybeAssemble();
+}
+
+void MultiStreamUploader::maybeAssemble()
+{
+    if (!running || !hashReady || assembleProcess) {
+        return;
+    }
+    for (Stream *stream : streams) {
+        if (!stream->done) {
+            return;
+        }
+    }
+
+    // 各段按位置写回 .part，整文件MD5一致才替换目标文件；不一致时删除 .part，避免下次被当作已完成续传
+    QString part = SshUtils::shellQuote(streamFile(streams.first()));
+    QStringList steps;
+    for (int i = 1; i < streams.size(); ++i) {
+        QString file = SshUtils::shellQuote(streamFile(streams[i]));
+        steps << QString("dd if=%1 of=%2 bs=%3 seek=%4 conv=notrunc 2>/dev/null && rm -f %1")
+                 .arg(file).arg(part).arg(chunkBytes).arg(streams[i]->rangeBegin / chunkBytes);
+    }
+    steps << QString("[ $(wc -c < %1) -eq %2 ]").arg(part).arg(totalBytes)
+          << QString("m=$(md5sum < %1 | cut -d' ' -f1)").arg(part)
+          << QString("echo \"%1 $m\"").arg(ASSEMBLE_MD5_MARKER);
+    QString command = steps.join(" && ");
+    command += QString(" && if [ \"$m\" = %1 ]; then mv -f %2 %3 && rm -f %4 %2.r*; else rm -f %2 %4; exit 1; fi")
+               .arg(md5Hex)
+               .arg(part)
+               .arg(SshUtils::shellQuote(remoteFilePath))
+               .arg(SshUtils::shellQuote(remoteFilePath + ".part.manifest"));
+
+    emit logMessage("[并行上传] 所有通道已完成，正在远程拼接并校验整文件MD5...");
+
+    assembleProcess = new SshProcess(sshEnvironment, this);
+    connect(assembleProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &MultiStreamUploader::onAssembleFinished);
+    connect(assembleProcess, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+    assembleProcess->startSsh(buildSshArguments(command));
+}
+
+void MultiStreamUploader::onAssembleFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QString output = QString::fromUtf8(assembleProcess->readAllStandardOutput());
+    QString error = QString::fromUtf8(assembleProcess->readAllStandardError()).trimmed();
+
+    QString markerPrefix = QString(ASSEMBLE_MD5_MARKER) + " ";
+    const QStringList lines = output.split('\n');
+    for (const QString &line : lines) {
+        if (line.startsWith(markerPrefix)) {
+            remoteMd5Hex = line.mid(markerPrefix.length()).trimmed().toLower();
+        }
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        if (!remoteMd5Hex.isEmpty() && remoteMd5Hex != md5Hex) {
+            finishWithError(QString("拼接后的远程文件MD5不一致 (本地 %1，远程 %2)，已删除远程临时文件")
+                            .arg(md5Hex).arg(remoteMd5Hex), RetryPolicy::ErrorRemote);
+        } else {
+            finishWithError(error.isEmpty() ? QString("远程拼接失败 (退出码: %1)").arg(exitCode) : error,
+                            RetryPolicy::classify(exitCode, exitStatus, error));
+        }
+        return;
+    }
+
+    emit logMessage(QString("[并行上传] 远程文件MD5校验通过: %1").arg(remoteMd5Hex));
+    emit progressChanged(totalBytes, totalBytes);
+    cleanup();
+    emit finished(true, QString());
+}
+
+void MultiStreamUploader::finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass)
+{
+    if (!running) {
+        return;
+    }
+    this->errorClass = errorClass;
+
+    // 先记下第0段的发送位置再清理进程
+    for (Stream *stream : streams) {
+        sentOffset(stream);
+    }
+    cleanup();
+    emit finished(false, errorMessage);
+}
+
+void MultiStreamUploader::cleanup()
+{
+    running = false;
+
+    if (rateLimiter) {
+        rateLimiter->disconnect(this);
+    }
+
+    for (Stream *stream : streams) {
+        if (rateLimiter && stream->limiterConsumer >= 0) {
+            rateLimiter->detach(stream->limiterConsumer);
+            stream->limiterConsumer = -1;
+        }
+        if (stream->process) {
+            stream->process->disconnect(this);
+            if (stream->process->state() != QProcess::NotRunning) {
+                stream->process->kill();
+                stream->process->waitForFinished(1000);
+            }
+            stream->process->deleteLater();
+            stream->process = nullptr;
+        }
+    }
+
+    if (assembleProcess) {
+        assembleProcess->disconnect(this);
+        if (assembleProcess->state() != QProcess::NotRunning) {
+            assembleProcess->kill();
+            assembleProcess->waitForFinished(1000);
+        }
+        assembleProcess->deleteLater();
+        assembleProcess = nullptr;
+    }
+
+    if (hashFile.isOpen()) {
+        hashFile.close();
+    }
+}
+
+void MultiStreamUploader::clearStreams()
+{
+    for (Stream *stream : streams) {
+        delete stream->file;
+        delete stream->compressor;
+        delete stream;
+    }
+    streams.clear();
+}
+
+QStringList MultiStreamUploader::buildSshArguments(const QString &remoteCommand) const
+{
+    QStringList arguments = connectionArguments;
+    arguments << remoteCommand;
+    return arguments;
+}
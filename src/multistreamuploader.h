@@ -0,0 +1,164 @@
+/**
+ * @File Name: multistreamuploader.h
+ * @brief  多通道并行上传头文件，把文件剩余部分按分块切成几段，经多个SSH通道同时发送，远程拼接后校验整文件MD5
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef MULTISTREAMUPLOADER_H
+#define MULTISTREAMUPLOADER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QPair>
+#include <QCryptographicHash>
+#include "streamcompressor.h"
+#include "retrypolicy.h"
+
+class RateLimiter;
+class SshProcess;
+
+/**
+ * 高延迟链路上单个SSH通道受窗口大小限制，吞吐量远低于链路带宽；多个通道同时发送可以填满链路。
+ *
+ * 上传流程：
+ * 1. 把 [起始位置, 文件末尾) 按分块边界切成 N 段（见 splitRanges），每段一个 ssh 进程（ControlMaster 可用时复用同一条主连接）
+ * 2. 第0段接着写入 <文件>.part（与单通道续传格式相同），其余各段写入 <文件>.part.r<起始分块>-<结束分块>
+ * 3. 调用方已知整文件MD5时直接使用，否则本地另行顺序读取整个文件计算MD5，与发送并行进行
+ * 4. 所有通道完成后，远程用 dd 把各段按位置写回 .part，校验大小和MD5一致后重命名为目标文件
+ *
+ * 各段都按分块顺序写入自己的文件，与 .part 一样由文件大小得出已落盘的分块数；分段文件名记录了分段位置，
+ * 中途失败后调用方探测这些文件（见 parseRemoteRanges），下次按原来的分段从各自的落盘位置继续发送。
+ * 启用传输压缩时每个通道各自压缩，远程用 gzip -dc 解压后再写入。
+ * 设置了限速器时每个通道是它的一个使用者，各通道轮流取得令牌。
+ */
+class MultiStreamUploader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MultiStreamUploader(QObject *parent = nullptr);
+    ~MultiStreamUploader();
+
+    void setLocalFile(const QString &filePath);
+    void setRemoteFile(const QString &remoteFilePath);
+    void setSshConnectionArguments(const QStringList &arguments);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setChunkSize(qint64 bytes);
+    void setCompressed(bool compressed);
+    void setRateLimiter(RateLimiter *limiter);
+
+    // 已知的整文件MD5（例如上传前已计算过），设置后不再读取整个文件计算
+    void setExpectedMd5(const QString &md5);
+
+    // 一段数据 [begin, end)，landed 为远程已落盘的字节数（从 begin 算起，分块的整数倍）
+    struct Range {
+        qint64 begin;
+        qint64 end;
+        qint64 landed;
+    };
+
+    // 按 ranges 并行发送，第0段从文件开头开始；identity 写入远程清单，与单通道续传共用
+    void start(const QList<Range> &ranges, const QString &identity);
+    void cancel();
+    bool isRunning() const;
+
+    QString fileMd5() const;
+    QString remoteMd5() const;
+    RetryPolicy::ErrorClass lastErrorClass() const;
+
+    // 第0段已交给SSH通道的位置，失败时据此保存续传清单
+    qint64 resumableOffset() const;
+    // 各段已交给SSH通道的位置，landed 按分块向下取整
+    QList<Range> resumableRanges() const;
+
+    // 按文件大小和分块大小计算实际可用的通道数：每个通道至少分到一个分块
+    static int usableStreams(qint64 remainingBytes, qint64 chunkBytes, int requested);
+
+    // 把 [startOffset, totalBytes) 按分块边界均分为若干段，第0段从文件开头算起，已落盘 startOffset 字节
+    static QList<Range> splitRanges(qint64 startOffset, qint64 totalBytes, qint64 chunkBytes, int streamCount);
+
+    // 第1段及以后的远程分段文件名后缀
+    static QString rangeSuffix(const Range &range, qint64 chunkBytes);
+
+    // 探测命令对每个分段文件输出一行 "<起始分块>-<结束分块> <文件大小>"，还原第1段及以后的分段；
+    // 各段必须首尾相接并覆盖到文件末尾，否则返回空列表
+    static QList<Range> parseRemoteRanges(const QString &section, qint64 totalBytes, qint64 chunkBytes);
+
+signals:
+    void logMessage(const QString &message);
+    void progressChanged(qint64 bytesSent, qint64 totalBytes);
+    void finished(bool success, const QString &errorMessage);
+
+private slots:
+    void hashSlice();
+    void onAssembleFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    // 一个数据通道：负责 [rangeBegin, end) 这一段，从 begin 开始发送
+    struct Stream {
+        int index;
+        SshProcess *process;
+        QFile *file;
+        qint64 rangeBegin;
+        qint64 begin;
+        qint64 end;
+        qint64 writtenOffset;
+        bool done;
+        StreamCompressor *compressor;
+        qint64 bytesQueued;                     // 已写入通道的压缩数据总量
+        QList<QPair<qint64, qint64> > pendingMembers;
+        qint64 acknowledgedOffset;
+        int limiterConsumer;
+    };
+
+    QStringList buildSshArguments(const QString &remoteCommand) const;
+    QString streamFile(const Stream *stream) const;
+    QString streamCommand(const Stream *stream) const;
+    void feedStream(Stream *stream);
+    qint64 sentOffset(Stream *stream);
+    void onStreamWritable(Stream *stream);
+    void onStreamFinished(Stream *stream, int exitCode, QProcess::ExitStatus exitStatus);
+    void emitProgress();
+    void feedAllStreams();
+    void maybeAssemble();
+    void finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass = RetryPolicy::ErrorLocal);
+    void cleanup();
+    void clearStreams();
+
+    // 参数
+    QString localFilePath;
+    QString remoteFilePath;
+    QStringList connectionArguments;
+    QProcessEnvironment sshEnvironment;
+    qint64 chunkBytes;
+    bool compressed;
+    RateLimiter *rateLimiter;
+
+    // 运行状态
+    bool running;
+    bool cancelRequested;
+    QList<Stream*> streams;
+    SshProcess *assembleProcess;
+    QString sourceIdentity;
+    qint64 totalBytes;
+    qint64 landedBytes;                         // 开始前各段已落盘的字节数之和
+    QString expectedMd5;
+
+    // 整文件MD5，与发送并行顺序读取
+    QFile hashFile;
+    QCryptographicHash md5Hash;
+    QString md5Hex;
+    bool hashReady;
+    QString remoteMd5Hex;
+    RetryPolicy::ErrorClass errorClass;
+};
+
+#endif // MULTISTREAMUPLOADER_H
@@ -0,0 +1,215 @@
+/**
+ * @File Name: ratelimiter.cpp
+ * @brief  上传限速实现，令牌桶按时间补充令牌，等待中的上传通道按队列顺序轮流发送
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "ratelimiter.h"
+
+// 令牌补充间隔
+static const int REFILL_INTERVAL_MS = 20;
+
+// 桶容量：约0.2秒的数据量，但不小于一次合理的写入量，避免低速时频繁小块写入
+static const qint64 BURST_DIVISOR = 5;
+static const qint64 MIN_BURST_BYTES = 16 * 1024;
+
+RateLimiter::RateLimiter(QObject *parent)
+    : QObject(parent), bytesPerSecond(0), upstream(nullptr), upstreamConsumer(-1), tokens(0),
+      refillTimer(nullptr), nextConsumerId(0)
+{
+    refillTimer = new QTimer(this);
+    refillTimer->setInterval(REFILL_INTERVAL_MS);
+    connect(refillTimer, &QTimer::timeout, this, &RateLimiter::onRefillTimer);
+}
+
+RateLimiter::~RateLimiter()
+{
+    setUpstream(nullptr);
+}
+
+void RateLimiter::setRate(qint64 bytesPerSecond)
+{
+    this->bytesPerSecond = qMax<qint64>(0, bytesPerSecond);
+    tokens = 0;
+    refillClock.invalidate();
+}
+
+qint64 RateLimiter::rate() const
+{
+    return bytesPerSecond;
+}
+
+void RateLimiter::setActiveWindow(const QTime &start, const QTime &end)
+{
+    windowStart = start;
+    windowEnd = end;
+}
+
+void RateLimiter::setUpstream(RateLimiter *limiter)
+{
+    if (upstream == limiter) {
+        return;
+    }
+    if (upstream) {
+        upstream->disconnect(this);
+        upstream->detach(upstreamConsumer);
+        upstreamConsumer = -1;
+    }
+
+    upstream = limiter;
+    if (upstream) {
+        // 上级补充令牌后，本级的使用者重新申请
+        upstreamConsumer = upstream->attach();
+        connect(upstream, &RateLimiter::tokensAvailable, this, &RateLimiter::tokensAvailable);
+        connect(upstream, &QObject::destroyed, this, &RateLimiter::onUpstreamDestroyed);
+    }
+}
+
+void RateLimiter::onUpstreamDestroyed()
+{
+    upstream = nullptr;
+    upstreamConsumer = -1;
+}
+
+bool RateLimiter::inActiveWindow() const
+{
+    if (upstream) {
+        return upstream->inActiveWindow();
+    }
+    if (!windowStart.isValid() || !windowEnd.isValid() || windowStart == windowEnd) {
+        return true;
+    }
+
+    QTime now = QTime::currentTime();
+    if (windowStart < windowEnd) {
+        return now >= windowStart && now < windowEnd;
+    }
+    // 跨越午夜的时段，例如 22:00 - 06:00
+    return now >= windowStart || now < windowEnd;
+}
+
+bool RateLimiter::limitsHere() const
+{
+    return bytesPerSecond > 0 && inActiveWindow();
+}
+
+bool RateLimiter::isLimiting() const
+{
+    return limitsHere() || (upstream && upstream->isLimiting());
+}
+
+int RateLimiter::attach()
+{
+    return nextConsumerId++;
+}
+
+void RateLimiter::detach(int consumerId)
+{
+    waiters.removeAll(consumerId);
+    if (waiters.isEmpty()) {
+        refillTimer->stop();
+    }
+}
+
+void RateLimiter::refill()
+{
+    if (!refillClock.isValid()) {
+        refillClock.start();
+        tokens = 0;
+        return;
+    }
+
+    qint64 elapsedMs = refillClock.restart();
+    qint64 burst = qMax(bytesPerSecond / BURST_DIVISOR, MIN_BURST_BYTES);
+    tokens = qMin(burst, tokens + bytesPerSecond * elapsedMs / 1000);
+}
+
+void RateLimiter::enqueueWaiter(int consumerId)
+{
+    if (!waiters.contains(consumerId)) {
+        waiters.append(consumerId);
+    }
+    if (!refillTimer->isActive()) {
+        refillTimer->start();
+    }
+}
+
+qint64 RateLimiter::acquire(int consumerId, qint64 maxBytes)
+{
+    if (maxBytes <= 0) {
+        return 0;
+    }
+
+    qint64 allowed = maxBytes;
+    bool limited = limitsHere();
+    if (limited) {
+        refill();
+        // 队列中有其他使用者在等待时先让它们发送
+        if (tokens <= 0 || (!waiters.isEmpty() && waiters.first() != consumerId)) {
+            enqueueWaiter(consumerId);
+            return 0;
+        }
+        allowed = qMin(allowed, tokens);
+    }
+
+    if (upstream) {
+        allowed = upstream->acquire(upstreamConsumer, allowed);
+        if (allowed <= 0) {
+            // 等待上级的 tokensAvailable
+            return 0;
+        }
+    }
+
+    if (limited) {
+        tokens -= allowed;
+        waiters.removeAll(consumerId);
+    }
+    return allowed;
+}
+
+void RateLimiter::release(qint64 bytes)
+{
+    if (bytes <= 0) {
+        return;
+    }
+    if (limitsHere()) {
+        tokens += bytes;
+    }
+    if (upstream) {
+        upstream->release(bytes);
+    }
+}
+
+void RateLimiter::onRefillTimer()
+{
+    if (waiters.isEmpty()) {
+        refillTimer->stop();
+        return;
+    }
+
+    if (!limitsHere()) {
+        // 限速时段结束或速率改为不限，所有等待者立即继续
+        waiters.clear();
+        refillTimer->stop();
+        emit tokensAvailable();
+        return;
+    }
+
+    refill();
+
+    // 按队列顺序唤醒：队首取得令牌后出队，未再申请的使用者也移出队列，避免阻塞后面的通道
+    while (tokens > 0 && !waiters.isEmpty()) {
+        int head = waiters.first();
+        emit tokensAvailable();
+        if (!waiters.isEmpty() && waiters.first() == head) {
+            waiters.removeFirst();
+        }
+    }
+
+    if (waiters.isEmpty()) {
+        refillTimer->stop();
+    }
+}
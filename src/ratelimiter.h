@@ -0,0 +1,80 @@
+/**
+ * @File Name: ratelimiter.h
+ * @brief  上传限速头文件，令牌桶限制发送速率，多个上传通道按先来先服务轮流取得令牌
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QObject>
+#include <QList>
+#include <QTime>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * 令牌桶：按设定速率持续补充令牌，桶容量约为0.2秒的数据量，发送前用 acquire() 取得允许发送的字节数。
+ *
+ * 使用方式与 SharedChunkSource 相同：使用者先 attach() 得到编号，发送前 acquire()，结束时 detach()。
+ * - 令牌不足时使用者进入等待队列并得到0，补充令牌后按队列顺序发出 tokensAvailable()，
+ *   每次只有队首能取得令牌，已取得令牌的使用者再次申请时排到队尾，多个通道因此平分带宽
+ * - 设置了上级限速器时（每台设备一个限速器，上级为全局限速器），两级令牌都足够才能发送
+ * - 只在限速时段内生效；起止时间相同表示全天限速。有上级时沿用上级的时段
+ * 速率为0表示不限速，acquire() 直接返回申请的字节数。
+ */
+class RateLimiter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RateLimiter(QObject *parent = nullptr);
+    ~RateLimiter();
+
+    void setRate(qint64 bytesPerSecond);
+    qint64 rate() const;
+    void setActiveWindow(const QTime &start, const QTime &end);
+    void setUpstream(RateLimiter *limiter);
+
+    // 当前是否需要限速（本级或上级速率非0且处于限速时段）
+    bool isLimiting() const;
+
+    int attach();
+    void detach(int consumerId);
+
+    // 返回本次允许发送的字节数（不超过 maxBytes），返回0时等待 tokensAvailable()
+    qint64 acquire(int consumerId, qint64 maxBytes);
+
+    // 取得令牌后实际发送的数据更少（例如压缩后变小）时退回多余的令牌
+    void release(qint64 bytes);
+
+signals:
+    void tokensAvailable();
+
+private slots:
+    void onRefillTimer();
+    void onUpstreamDestroyed();
+
+private:
+    bool inActiveWindow() const;
+    bool limitsHere() const;
+    void refill();
+    void enqueueWaiter(int consumerId);
+
+    qint64 bytesPerSecond;
+    QTime windowStart;
+    QTime windowEnd;
+    RateLimiter *upstream;
+    int upstreamConsumer;
+
+    qint64 tokens;
+    QElapsedTimer refillClock;
+    QTimer *refillTimer;
+    QList<int> waiters;
+    int nextConsumerId;
+};
+
+#endif // RATELIMITER_H
@@ -0,0 +1,134 @@
+/**
+ * @File Name: retrypolicy.cpp
+ * @brief  重试策略实现，按 ssh 错误输出分类失败原因，计算带抖动的指数退避间隔
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "retrypolicy.h"
+#include <QRandomGenerator>
+
+const int RetryPolicy::DEFAULT_MAX_ATTEMPTS;
+
+// 退避间隔的基础值和上限
+static const qint64 BASE_DELAY_MS = 2000;
+static const qint64 MAX_DELAY_MS = 120 * 1000;
+
+// ssh 自身出错（连接、认证）时的退出码
+static const int SSH_ERROR_EXIT_CODE = 255;
+
+// ssh 报告认证失败的关键字，其余255退出都是连接问题（超时、被拒绝、被重置、无法解析主机名等）
+static const char *const AUTH_PATTERNS[] = {
+    "permission denied",
+    "authentication failed",
+    "too many authentication failures",
+    "host key verification failed",
+    "no supported authentication methods"
+};
+
+RetryPolicy::RetryPolicy()
+    : maxRetries(DEFAULT_MAX_ATTEMPTS), retryRemote(false), retries(0)
+{
+}
+
+void RetryPolicy::setMaxAttempts(int attempts)
+{
+    maxRetries = qMax(0, attempts);
+}
+
+int RetryPolicy::maxAttempts() const
+{
+    return maxRetries;
+}
+
+void RetryPolicy::setRetryRemoteFailures(bool enabled)
+{
+    retryRemote = enabled;
+}
+
+void RetryPolicy::reset()
+{
+    retries = 0;
+}
+
+int RetryPolicy::attempt() const
+{
+    return retries;
+}
+
+bool RetryPolicy::shouldRetry(ErrorClass errorClass)
+{
+    if (retries >= maxRetries) {
+        return false;
+    }
+
+    switch (errorClass) {
+    case ErrorNetwork:
+        break;
+    case ErrorRemote:
+        if (!retryRemote) {
+            return false;
+        }
+        break;
+    case ErrorNone:
+    case ErrorAuth:
+    case ErrorLocal:
+        return false;
+    }
+
+    ++retries;
+    return true;
+}
+
+int RetryPolicy::nextDelayMs() const
+{
+    // 第1次重试的上限为基础间隔，之后每次翻倍
+    int shift = qBound(0, retries - 1, 16);
+    qint64 ceiling = qMin(MAX_DELAY_MS, BASE_DELAY_MS << shift);
+    return static_cast<int>(QRandomGenerator::global()->bounded(ceiling + 1));
+}
+
+RetryPolicy::ErrorClass RetryPolicy::classify(int exitCode, QProcess::ExitStatus exitStatus, const QString &errorText,
+                                              QProcess::ProcessError processError)
+{
+    // 找不到 ssh 程序或没有权限执行时，每次重试都会同样失败
+    if (processError == QProcess::FailedToStart) {
+        return ErrorLocal;
+    }
+
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        return ErrorNone;
+    }
+
+    // 进程被本地终止（用户取消、硬件错误检测、命令超时）时不重试
+    if (exitStatus == QProcess::CrashExit || exitCode != SSH_ERROR_EXIT_CODE) {
+        return ErrorRemote;
+    }
+
+    QString text = errorText.toLower();
+    for (const char *pattern : AUTH_PATTERNS) {
+        if (text.contains(QLatin1String(pattern))) {
+            return ErrorAuth;
+        }
+    }
+    return ErrorNetwork;
+}
+
+QString RetryPolicy::className(ErrorClass errorClass)
+{
+    switch (errorClass) {
+    case ErrorNone:
+        return "成功";
+    case ErrorAuth:
+        return "认证失败";
+    case ErrorNetwork:
+        return "网络中断";
+    case ErrorRemote:
+        return "远程命令失败";
+    case ErrorLocal:
+        return "本地错误";
+    }
+    return QString();
+}
@@ -0,0 +1,65 @@
+/**
+ * @File Name: retrypolicy.h
+ * @brief  重试策略头文件，对远程步骤的失败分类（认证/网络/远程/本地），按带抖动的指数退避决定是否以及何时重试
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QString>
+#include <QProcess>
+
+/**
+ * 一个步骤（上传、校验、升级命令）的重试状态：
+ * - classify() 根据 ssh 的退出码和错误输出判断失败类别：ssh 自身出错时退出码为255，
+ *   其中认证失败单独归类，其余视为网络中断；远程命令自己的非0退出码和本地终止的进程都不是网络问题；
+ *   ssh 程序无法启动（FailedToStart）属于本地错误
+ * - 认证失败和本地错误重试也不会成功，直接失败；网络中断总是可以重试；
+ *   远程命令失败只有步骤声明可重复执行时才重试
+ * - 第 n 次重试前等待 [0, min(上限, 基础间隔 × 2^n)] 之间的随机时间（full jitter），
+ *   多台设备同时断线后不会在同一时刻一起重连
+ * 每个步骤开始时 reset()，成功后不需要处理。
+ */
+class RetryPolicy
+{
+public:
+    enum ErrorClass {
+        ErrorNone,
+        ErrorAuth,      // 认证失败：密钥、密码或主机指纹问题
+        ErrorNetwork,   // 网络失败：连接超时、被拒绝、被重置，ssh 退出码255
+        ErrorRemote,    // 远程命令返回非0
+        ErrorLocal      // 本地错误：本地文件读取失败、ssh 程序无法启动
+    };
+
+    RetryPolicy();
+
+    void setMaxAttempts(int attempts);
+    int maxAttempts() const;
+    void setRetryRemoteFailures(bool enabled);
+
+    void reset();
+    int attempt() const;
+
+    // 该类别的失败是否还能重试；能重试时计入一次尝试
+    bool shouldRetry(ErrorClass errorClass);
+
+    // 本次重试前的等待时间，调用 shouldRetry() 返回 true 之后使用
+    int nextDelayMs() const;
+
+    static ErrorClass classify(int exitCode, QProcess::ExitStatus exitStatus, const QString &errorText,
+                               QProcess::ProcessError processError = QProcess::UnknownError);
+    static QString className(ErrorClass errorClass);
+
+    static const int DEFAULT_MAX_ATTEMPTS = 5;
+
+private:
+    int maxRetries;
+    bool retryRemote;
+    int retries;
+};
+
+#endif // RETRYPOLICY_H
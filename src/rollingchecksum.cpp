@@ -0,0 +1,124 @@
+/**
+ * @File Name: rollingchecksum.cpp
+ * @brief  可滚动的块弱校验实现，CRC32 查表计算，移出字节表由"追加n个零字节"的线性变换求幂得到
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "rollingchecksum.h"
+
+// cksum 使用的 CRC32 多项式（高位在前）
+static const quint32 CKSUM_POLYNOMIAL = 0x04C11DB7;
+
+static const quint32 *crcTable()
+{
+    static quint32 table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 crc = i << 24;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x80000000u) ? (crc << 1) ^ CKSUM_POLYNOMIAL : (crc << 1);
+            }
+            table[i] = crc;
+        }
+        ready = true;
+    }
+    return table;
+}
+
+static inline quint32 crcByte(const quint32 *table, quint32 crc, uchar byte)
+{
+    return (crc << 8) ^ table[(crc >> 24) ^ byte];
+}
+
+// GF(2) 上的 32x32 矩阵，matrix[i] 为第 i 位为1的输入对应的输出
+static quint32 matrixApply(const quint32 *matrix, quint32 vector)
+{
+    quint32 result = 0;
+    for (int i = 0; vector; ++i, vector >>= 1) {
+        if (vector & 1) {
+            result ^= matrix[i];
+        }
+    }
+    return result;
+}
+
+static void matrixMultiply(quint32 *result, const quint32 *left, const quint32 *right)
+{
+    // result = left * right（先作用 right）
+    quint32 product[32];
+    for (int i = 0; i < 32; ++i) {
+        product[i] = matrixApply(left, right[i]);
+    }
+    for (int i = 0; i < 32; ++i) {
+        result[i] = product[i];
+    }
+}
+
+RollingChecksum::RollingChecksum(qint64 windowSize)
+    : window(0)
+{
+    reset(windowSize);
+}
+
+void RollingChecksum::reset(qint64 windowSize)
+{
+    const quint32 *table = crcTable();
+    window = windowSize;
+
+    // 单个零字节对CRC的作用是线性变换 Z，移出字节 b 在窗口右移后的贡献为 Z^window(table[b])
+    quint32 power[32];
+    quint32 result[32];
+    for (int i = 0; i < 32; ++i) {
+        power[i] = crcByte(table, quint32(1) << i, 0);
+        result[i] = quint32(1) << i;
+    }
+
+    for (qint64 n = qMax<qint64>(windowSize, 0); n > 0; n >>= 1) {
+        if (n & 1) {
+            matrixMultiply(result, power, result);
+        }
+        matrixMultiply(power, power, power);
+    }
+
+    for (int b = 0; b < 256; ++b) {
+        outTable[b] = matrixApply(result, table[b]);
+    }
+}
+
+qint64 RollingChecksum::windowSize() const
+{
+    return window;
+}
+
+quint32 RollingChecksum::roll(quint32 crc, uchar out, uchar in) const
+{
+    return crcByte(crcTable(), crc, in) ^ outTable[out];
+}
+
+quint32 RollingChecksum::update(quint32 crc, const char *data, qint64 length)
+{
+    const quint32 *table = crcTable();
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    for (qint64 i = 0; i < length; ++i) {
+        crc = crcByte(table, crc, bytes[i]);
+    }
+    return crc;
+}
+
+quint32 RollingChecksum::finish(quint32 crc, qint64 length)
+{
+    const quint32 *table = crcTable();
+    for (; length > 0; length >>= 8) {
+        crc = crcByte(table, crc, static_cast<uchar>(length & 0xFF));
+    }
+    return ~crc;
+}
+
+quint32 RollingChecksum::cksum(const QByteArray &data)
+{
+    return finish(update(0, data.constData(), data.size()), data.size());
+}
@@ -0,0 +1,46 @@
+/**
+ * @File Name: rollingchecksum.h
+ * @brief  可滚动的块弱校验头文件，与 POSIX cksum 的 CRC32 结果一致，用于增量上传时按任意字节偏移查找相同块
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef ROLLINGCHECKSUM_H
+#define ROLLINGCHECKSUM_H
+
+#include <QtGlobal>
+#include <QByteArray>
+
+/**
+ * cksum 使用的 CRC32（多项式 0x04C11DB7，高位在前，初值0）对数据是线性的，
+ * 因此固定长度窗口右移一个字节时，可以加入新字节并用预先算好的表消去移出字节的贡献，
+ * 每个字节只需常数次查表。设备上用 cksum 计算旧文件各块的弱校验，本地在新文件上逐字节滑动窗口比对。
+ *
+ * update() 得到的是不含长度的原始CRC，finish() 按 cksum 的规则追加长度并取反，结果与设备输出一致。
+ */
+class RollingChecksum
+{
+public:
+    explicit RollingChecksum(qint64 windowSize = 0);
+
+    // 设置窗口长度并重建移出字节表（窗口长度变化时调用）
+    void reset(qint64 windowSize);
+    qint64 windowSize() const;
+
+    // 窗口 [b0 .. bn-1] 右移一个字节，变为 [b1 .. bn]
+    quint32 roll(quint32 crc, uchar out, uchar in) const;
+
+    static quint32 update(quint32 crc, const char *data, qint64 length);
+    static quint32 finish(quint32 crc, qint64 length);
+
+    // 与 "cksum < 文件" 输出的第一列相同
+    static quint32 cksum(const QByteArray &data);
+
+private:
+    qint64 window;
+    quint32 outTable[256];
+};
+
+#endif // ROLLINGCHECKSUM_H
@@ -126,11 +126,108 @@ void SettingsDialog::setupConnectionSettings()
     timeoutSpinBox->setValue(30);
     timeoutSpinBox->setSuffix(" 秒");
     
+    stallTimeoutLabel = new QLabel("无进度超时:", remoteGroup);
+    stallTimeoutSpinBox = new QSpinBox(remoteGroup);
+    stallTimeoutSpinBox->setObjectName("stallTimeoutSpinBox");
+    stallTimeoutSpinBox->setRange(15, 600);
+    stallTimeoutSpinBox->setValue(60);
+    stallTimeoutSpinBox->setSuffix(" 秒");
+    stallTimeoutSpinBox->setToolTip("上传连续这么长时间没有任何进度才判定为超时；总时长按文件大小和实测速度估算，不再固定为5分钟");
+    
+    retryAttemptsLabel = new QLabel("失败重试次数:", remoteGroup);
+    retryAttemptsSpinBox = new QSpinBox(remoteGroup);
+    retryAttemptsSpinBox->setObjectName("retryAttemptsSpinBox");
+    retryAttemptsSpinBox->setRange(0, 20);
+    retryAttemptsSpinBox->setValue(5);
+    retryAttemptsSpinBox->setSuffix(" 次");
+    retryAttemptsSpinBox->setSpecialValueText("不重试");
+    retryAttemptsSpinBox->setToolTip("网络中断时自动重试上传、校验和升级命令，间隔从2秒起逐次加倍并随机错开；认证失败不重试");
+    
+    // 上传限速：0 表示不限速，只在限速时段内生效
+    uploadRateLimitLabel = new QLabel("上传总限速:", remoteGroup);
+    uploadRateLimitSpinBox = new QSpinBox(remoteGroup);
+    uploadRateLimitSpinBox->setObjectName("uploadRateLimitSpinBox");
+    uploadRateLimitSpinBox->setRange(0, 1000000);
+    uploadRateLimitSpinBox->setSingleStep(128);
+    uploadRateLimitSpinBox->setValue(0);
+    uploadRateLimitSpinBox->setSuffix(" KB/s");
+    uploadRateLimitSpinBox->setSpecialValueText("不限速");
+    uploadRateLimitSpinBox->setToolTip("所有上传（包括批量上传的全部设备）合计的最大发送速率");
+    
+    deviceRateLimitLabel = new QLabel("每台设备限速:", remoteGroup);
+    deviceRateLimitSpinBox = new QSpinBox(remoteGroup);
+    deviceRateLimitSpinBox->setObjectName("deviceRateLimitSpinBox");
+    deviceRateLimitSpinBox->setRange(0, 1000000);
+    deviceRateLimitSpinBox->setSingleStep(128);
+    deviceRateLimitSpinBox->setValue(0);
+    deviceRateLimitSpinBox->setSuffix(" KB/s");
+    deviceRateLimitSpinBox->setSpecialValueText("不限速");
+    deviceRateLimitSpinBox->setToolTip("单台设备的最大发送速率，避免上传挤占设备图像数据的带宽");
+    
+    rateLimitWindowLabel = new QLabel("限速时段:", remoteGroup);
+    rateLimitStartEdit = new QTimeEdit(QTime(8, 0), remoteGroup);
+    rateLimitStartEdit->setObjectName("rateLimitStartEdit");
+    rateLimitStartEdit->setDisplayFormat("HH:mm");
+    rateLimitEndEdit = new QTimeEdit(QTime(20, 0), remoteGroup);
+    rateLimitEndEdit->setObjectName("rateLimitEndEdit");
+    rateLimitEndEdit->setDisplayFormat("HH:mm");
+    rateLimitEndEdit->setToolTip("时段外（例如维护窗口）不限速；起止时间相同表示全天限速");
+    
+    QHBoxLayout *rateLimitWindowLayout = new QHBoxLayout();
+    rateLimitWindowLayout->addWidget(rateLimitStartEdit);
+    rateLimitWindowLayout->addWidget(new QLabel("至", remoteGroup));
+    rateLimitWindowLayout->addWidget(rateLimitEndEdit);
+    rateLimitWindowLayout->addStretch();
+    
+    deltaUploadCheckBox = new QCheckBox("增量上传（远程已有旧版本时只发送变化的数据块）", remoteGroup);
+    deltaUploadCheckBox->setObjectName("deltaUploadCheckBox");
+    deltaUploadCheckBox->setChecked(true);
+    deltaUploadCheckBox->setToolTip("适用于小幅修改的升级包，新旧文件差异过大时自动改为完整上传");
+    
+    compressUploadCheckBox = new QCheckBox("传输压缩（按链路速度自动选择压缩级别，已压缩的数据直接发送）", remoteGroup);
+    compressUploadCheckBox->setObjectName("compressUploadCheckBox");
+    compressUploadCheckBox->setChecked(false);
+    compressUploadCheckBox->setToolTip("适用于慢速链路上传 .bit 等未压缩文件，需要远程设备提供 gzip");
+    
+    uploadStreamsLabel = new QLabel("并行传输通道:", remoteGroup);
+    uploadStreamsSpinBox = new QSpinBox(remoteGroup);
+    uploadStreamsSpinBox->setObjectName("uploadStreamsSpinBox");
+    uploadStreamsSpinBox->setRange(1, 8);
+    uploadStreamsSpinBox->setValue(1);
+    uploadStreamsSpinBox->setSuffix(" 路");
+    uploadStreamsSpinBox->setToolTip("高延迟链路上单个通道跑不满带宽时调大，文件分段同时发送，远程拼接后校验MD5");
+    
+    verifyDigestLabel = new QLabel("校验算法:", remoteGroup);
+    verifyDigestComboBox = new QComboBox(remoteGroup);
+    verifyDigestComboBox->setObjectName("verifyDigestComboBox");
+    verifyDigestComboBox->addItem("自动协商", "auto");
+    verifyDigestComboBox->addItem("XXH64（最快）", "xxh64");
+    verifyDigestComboBox->addItem("SHA-256（抗碰撞）", "sha256");
+    verifyDigestComboBox->addItem("MD5（兼容老设备）", "md5");
+    verifyDigestComboBox->setToolTip("上传后校验文件完整性使用的摘要算法；自动协商时设备上有 xxhsum 则用 XXH64，否则用 MD5，"
+                                     "指定的算法在设备上不可用时退回 MD5");
+    
     remoteLayout->addWidget(remoteDirLabel, 0, 0);
     remoteLayout->addWidget(remoteDirLineEdit, 0, 1);
     remoteLayout->addWidget(testRemoteDirButton, 0, 2);
     remoteLayout->addWidget(timeoutLabel, 1, 0);
     remoteLayout->addWidget(timeoutSpinBox, 1, 1);
+    remoteLayout->addWidget(stallTimeoutLabel, 2, 0);
+    remoteLayout->addWidget(stallTimeoutSpinBox, 2, 1);
+    remoteLayout->addWidget(retryAttemptsLabel, 3, 0);
+    remoteLayout->addWidget(retryAttemptsSpinBox, 3, 1);
+    remoteLayout->addWidget(uploadRateLimitLabel, 4, 0);
+    remoteLayout->addWidget(uploadRateLimitSpinBox, 4, 1);
+    remoteLayout->addWidget(deviceRateLimitLabel, 5, 0);
+    remoteLayout->addWidget(deviceRateLimitSpinBox, 5, 1);
+    remoteLayout->addWidget(rateLimitWindowLabel, 6, 0);
+    remoteLayout->addLayout(rateLimitWindowLayout, 6, 1);
+    remoteLayout->addWidget(deltaUploadCheckBox, 7, 0, 1, 3);
+    remoteLayout->addWidget(compressUploadCheckBox, 8, 0, 1, 3);
+    remoteLayout->addWidget(uploadStreamsLabel, 9, 0);
+    remoteLayout->addWidget(uploadStreamsSpinBox, 9, 1);
+    remoteLayout->addWidget(verifyDigestLabel, 10, 0);
+    remoteLayout->addWidget(verifyDigestComboBox, 10, 1);
     
     remoteLayout->setColumnStretch(1, 1);
     
@@ -152,6 +249,16 @@ void SettingsDialog::setupConnectionSettings()
     selectQtExtractPathButton->setObjectName("selectQtExtractPathButton");
     selectQtExtractPathButton->setMinimumWidth(80);
     
+    streamQtUpgradeCheckBox = new QCheckBox("Qt软件流式升级（升级包边传输边解压，不在设备上保存压缩包）", upgradePathGroup);
+    streamQtUpgradeCheckBox->setObjectName("streamQtUpgradeCheckBox");
+    streamQtUpgradeCheckBox->setChecked(false);
+    streamQtUpgradeCheckBox->setToolTip("启用后'升级qt软件'直接发送当前选择的升级包，无需先上传；两端MD5不一致时报告失败");
+    
+    extractFileListCheckBox = new QCheckBox("保存解压文件列表（写入设备上升级包旁的 .files 文件）", upgradePathGroup);
+    extractFileListCheckBox->setObjectName("extractFileListCheckBox");
+    extractFileListCheckBox->setChecked(false);
+    extractFileListCheckBox->setToolTip("解压时默认只显示进度，不逐个输出文件名；需要核对解压了哪些文件时启用");
+    
     // 7ev固件升级解压路径
     sevEvExtractPathLabel = new QLabel("7ev固件解压路径:", upgradePathGroup);
     sevEvExtractPathLineEdit = new QLineEdit(upgradePathGroup);
@@ -169,6 +276,8 @@ void SettingsDialog::setupConnectionSettings()
     upgradePathLayout->addWidget(sevEvExtractPathLabel, 1, 0);
     upgradePathLayout->addWidget(sevEvExtractPathLineEdit, 1, 1);
     upgradePathLayout->addWidget(select7evExtractPathButton, 1, 2);
+    upgradePathLayout->addWidget(streamQtUpgradeCheckBox, 2, 0, 1, 3);
+    upgradePathLayout->addWidget(extractFileListCheckBox, 3, 0, 1, 3);
     
     upgradePathLayout->setColumnStretch(1, 1);
     
@@ -370,10 +479,22 @@ void SettingsDialog::loadDefaults()
     // 连接设置默认值
     remoteDirLineEdit->setText("/media/sata/ue_data/");
     timeoutSpinBox->setValue(30);
+    stallTimeoutSpinBox->setValue(60);
+    retryAttemptsSpinBox->setValue(5);
+    uploadRateLimitSpinBox->setValue(0);
+    deviceRateLimitSpinBox->setValue(0);
+    rateLimitStartEdit->setTime(QTime(8, 0));
+    rateLimitEndEdit->setTime(QTime(20, 0));
+    deltaUploadCheckBox->setChecked(true);
+    compressUploadCheckBox->setChecked(false);
+    uploadStreamsSpinBox->setValue(1);
+    verifyDigestComboBox->setCurrentIndex(0);
     
     // 升级路径默认值
     qtExtractPathLineEdit->setText("/mnt/qtfs");
     sevEvExtractPathLineEdit->setText("/mnt/mmcblk0p1");
+    streamQtUpgradeCheckBox->setChecked(false);
+    extractFileListCheckBox->setChecked(false);
     
     // 应用设置默认值
     autoSaveCheckBox->setChecked(true);
@@ -551,6 +672,36 @@ int SettingsDialog::getConnectionTimeout() const
     return timeoutSpinBox->value();
 }
 
+int SettingsDialog::getStallTimeout() const
+{
+    return stallTimeoutSpinBox->value();
+}
+
+int SettingsDialog::getRetryAttempts() const
+{
+    return retryAttemptsSpinBox->value();
+}
+
+int SettingsDialog::getUploadRateLimit() const
+{
+    return uploadRateLimitSpinBox->value();
+}
+
+int SettingsDialog::getDeviceRateLimit() const
+{
+    return deviceRateLimitSpinBox->value();
+}
+
+QTime SettingsDialog::getRateLimitStart() const
+{
+    return rateLimitStartEdit->time();
+}
+
+QTime SettingsDialog::getRateLimitEnd() const
+{
+    return rateLimitEndEdit->time();
+}
+
 bool SettingsDialog::getAutoSaveSettings() const
 {
     return autoSaveCheckBox->isChecked();
@@ -596,6 +747,36 @@ QString SettingsDialog::get7evExtractPath() const
     return sevEvExtractPathLineEdit->text().trimmed();
 }
 
+bool SettingsDialog::getDeltaUploadEnabled() const
+{
+    return deltaUploadCheckBox->isChecked();
+}
+
+bool SettingsDialog::getCompressUploadEnabled() const
+{
+    return compressUploadCheckBox->isChecked();
+}
+
+int SettingsDialog::getUploadStreams() const
+{
+    return uploadStreamsSpinBox->value();
+}
+
+QString SettingsDialog::getVerifyDigest() const
+{
+    return verifyDigestComboBox->currentData().toString();
+}
+
+bool SettingsDialog::getStreamQtUpgradeEnabled() const
+{
+    return streamQtUpgradeCheckBox->isChecked();
+}
+
+bool SettingsDialog::getExtractFileListEnabled() const
+{
+    return extractFileListCheckBox->isChecked();
+}
+
 // Setter functions
 void SettingsDialog::setRemoteDirectory(const QString &path)
 {
@@ -607,6 +788,32 @@ void SettingsDialog::setConnectionTimeout(int timeout)
     timeoutSpinBox->setValue(timeout);
 }
 
+void SettingsDialog::setStallTimeout(int seconds)
+{
+    stallTimeoutSpinBox->setValue(seconds);
+}
+
+void SettingsDialog::setRetryAttempts(int attempts)
+{
+    retryAttemptsSpinBox->setValue(attempts);
+}
+
+void SettingsDialog::setUploadRateLimit(int kilobytesPerSecond)
+{
+    uploadRateLimitSpinBox->setValue(kilobytesPerSecond);
+}
+
+void SettingsDialog::setDeviceRateLimit(int kilobytesPerSecond)
+{
+    deviceRateLimitSpinBox->setValue(kilobytesPerSecond);
+}
+
+void SettingsDialog::setRateLimitWindow(const QTime &start, const QTime &end)
+{
+    rateLimitStartEdit->setTime(start);
+    rateLimitEndEdit->setTime(end);
+}
+
 void SettingsDialog::setAutoSaveSettings(bool autoSave)
 {
     autoSaveCheckBox->setChecked(autoSave);
@@ -650,4 +857,35 @@ void SettingsDialog::setQtExtractPath(const QString &path)
 void SettingsDialog::set7evExtractPath(const QString &path)
 {
     sevEvExtractPathLineEdit->setText(path);
+}
+
+void SettingsDialog::setDeltaUploadEnabled(bool enabled)
+{
+    deltaUploadCheckBox->setChecked(enabled);
+}
+
+void SettingsDialog::setCompressUploadEnabled(bool enabled)
+{
+    compressUploadCheckBox->setChecked(enabled);
+}
+
+void SettingsDialog::setUploadStreams(int streams)
+{
+    uploadStreamsSpinBox->setValue(streams);
+}
+
+void SettingsDialog::setVerifyDigest(const QString &name)
+{
+    int index = verifyDigestComboBox->findData(name.trimmed().toLower());
+    verifyDigestComboBox->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+void SettingsDialog::setStreamQtUpgradeEnabled(bool enabled)
+{
+    streamQtUpgradeCheckBox->setChecked(enabled);
+}
+
+void SettingsDialog::setExtractFileListEnabled(bool enabled)
+{
+    extractFileListCheckBox->setChecked(enabled);
 } 
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QSpinBox>
+#include <QTimeEdit>
 #include <QPushButton>
 #include <QTabWidget>
 #include <QCheckBox>
@@ -27,6 +28,12 @@ public:
     // 获取设置值
     QString getRemoteDirectory() const;
     int getConnectionTimeout() const;
+    int getStallTimeout() const;
+    int getRetryAttempts() const;
+    int getUploadRateLimit() const;
+    int getDeviceRateLimit() const;
+    QTime getRateLimitStart() const;
+    QTime getRateLimitEnd() const;
     bool getAutoSaveSettings() const;
     bool getShowLogByDefault() const;
     QString getDefaultLocalPath() const;
@@ -36,10 +43,21 @@ public:
     int getMaxLogLines() const;
     QString getQtExtractPath() const;
     QString get7evExtractPath() const;
+    bool getDeltaUploadEnabled() const;
+    bool getCompressUploadEnabled() const;
+    int getUploadStreams() const;
+    QString getVerifyDigest() const;
+    bool getStreamQtUpgradeEnabled() const;
+    bool getExtractFileListEnabled() const;
     
     // 设置值
     void setRemoteDirectory(const QString &path);
     void setConnectionTimeout(int timeout);
+    void setStallTimeout(int seconds);
+    void setRetryAttempts(int attempts);
+    void setUploadRateLimit(int kilobytesPerSecond);
+    void setDeviceRateLimit(int kilobytesPerSecond);
+    void setRateLimitWindow(const QTime &start, const QTime &end);
     void setAutoSaveSettings(bool autoSave);
     void setShowLogByDefault(bool showLog);
     void setDefaultLocalPath(const QString &path);
@@ -49,6 +67,12 @@ public:
     void setMaxLogLines(int maxLines);
     void setQtExtractPath(const QString &path);
     void set7evExtractPath(const QString &path);
+    void setDeltaUploadEnabled(bool enabled);
+    void setCompressUploadEnabled(bool enabled);
+    void setUploadStreams(int streams);
+    void setVerifyDigest(const QString &name);
+    void setStreamQtUpgradeEnabled(bool enabled);
+    void setExtractFileListEnabled(bool enabled);
 
 private slots:
     void onAccept();
@@ -83,6 +107,23 @@ private:
     QPushButton *testRemoteDirButton;
     QLabel *timeoutLabel;
     QSpinBox *timeoutSpinBox;
+    QLabel *stallTimeoutLabel;
+    QSpinBox *stallTimeoutSpinBox;
+    QLabel *retryAttemptsLabel;
+    QSpinBox *retryAttemptsSpinBox;
+    QLabel *uploadRateLimitLabel;
+    QSpinBox *uploadRateLimitSpinBox;
+    QLabel *deviceRateLimitLabel;
+    QSpinBox *deviceRateLimitSpinBox;
+    QLabel *rateLimitWindowLabel;
+    QTimeEdit *rateLimitStartEdit;
+    QTimeEdit *rateLimitEndEdit;
+    QCheckBox *deltaUploadCheckBox;
+    QCheckBox *compressUploadCheckBox;
+    QLabel *uploadStreamsLabel;
+    QSpinBox *uploadStreamsSpinBox;
+    QLabel *verifyDigestLabel;
+    QComboBox *verifyDigestComboBox;
     
     // 升级路径设置组
     QGroupBox *upgradePathGroup;
@@ -90,6 +131,8 @@ private:
     QLabel *qtExtractPathLabel;
     QLineEdit *qtExtractPathLineEdit;
     QPushButton *selectQtExtractPathButton;
+    QCheckBox *streamQtUpgradeCheckBox;
+    QCheckBox *extractFileListCheckBox;
     QLabel *sevEvExtractPathLabel;
     QLineEdit *sevEvExtractPathLineEdit;
     QPushButton *select7evExtractPathButton;
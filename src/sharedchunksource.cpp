@@ -0,0 +1,440 @@
+/**
+ * @File Name: sharedchunksource.cpp
+ * @brief  共享分块数据源实现，按读取通道缓存有界窗口内的数据片，多个设备连接按各自进度取用
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "sharedchunksource.h"
+#include <QTimer>
+
+const qint64 SharedChunkSource::DEFAULT_WINDOW_SIZE;
+
+// 窗口中每个数据片的大小，与上传通道每次写入SSH的数据量一致
+static const qint64 SLICE_SIZE = 256 * 1024;
+
+// 单次 read() 调用中读取头最多前进的数据片数，避免一次调用长时间阻塞事件循环
+static const int MAX_SLICES_PER_CALL = 16;
+
+SharedChunkSource::SharedChunkSource(const QString &filePath, QObject *parent)
+    : QObject(parent), filePath(filePath), totalBytes(0), windowSize(DEFAULT_WINDOW_SIZE), opened(false),
+      nextLaneId(1), nextConsumerId(1), md5Hash(QCryptographicHash::Md5), notifyPending(false), drainPending(false)
+{
+}
+
+SharedChunkSource::~SharedChunkSource()
+{
+    close();
+}
+
+bool SharedChunkSource::open(QString *errorMessage)
+{
+    close();
+
+    QFile probe(filePath);
+    if (!probe.open(QIODevice::ReadOnly)) {
+        if (errorMessage) {
+            *errorMessage = QString("无法打开本地文件: %1").arg(probe.errorString());
+        }
+        return false;
+    }
+    totalBytes = probe.size();
+    probe.close();
+
+    md5Hash.reset();
+    md5Hex.clear();
+    opened = true;
+    return true;
+}
+
+void SharedChunkSource::close()
+{
+    QList<int> laneIds = lanes.keys();
+    for (int i = 0; i < laneIds.size(); ++i) {
+        removeLane(laneIds[i]);
+    }
+    consumers.clear();
+    opened = false;
+}
+
+qint64 SharedChunkSource::size() const
+{
+    return totalBytes;
+}
+
+void SharedChunkSource::setWindowSize(qint64 bytes)
+{
+    // 窗口至少容纳两个数据片，保证快慢使用者之间可以错开
+    windowSize = qMax(bytes, SLICE_SIZE * 2);
+}
+
+int SharedChunkSource::laneCount() const
+{
+    return lanes.size();
+}
+
+bool SharedChunkSource::isMd5Ready() const
+{
+    return !md5Hex.isEmpty();
+}
+
+QString SharedChunkSource::fileMd5() const
+{
+    return md5Hex;
+}
+
+void SharedChunkSource::computeMd5()
+{
+    if (!opened || !md5Hex.isEmpty()) {
+        return;
+    }
+
+    // 已有通道在计算时等它完成，否则单独从头读一遍（例如所有设备都是续传）
+    for (QMap<int, Lane>::const_iterator it = lanes.constBegin(); it != lanes.constEnd(); ++it) {
+        if (it.value().hashing) {
+            return;
+        }
+    }
+    if (createLane(0) >= 0) {
+        scheduleDrain();
+    }
+}
+
+int SharedChunkSource::attach(qint64 startOffset)
+{
+    if (!opened) {
+        return -1;
+    }
+
+    startOffset = qBound(static_cast<qint64>(0), startOffset, totalBytes);
+
+    // 起始位置仍在某个通道保留的数据内时加入该通道，否则新建通道
+    int laneId = -1;
+    for (QMap<int, Lane>::const_iterator it = lanes.constBegin(); it != lanes.constEnd(); ++it) {
+        const Lane &lane = it.value();
+        if (startOffset >= lane.base && startOffset <= lane.head) {
+            laneId = it.key();
+            break;
+        }
+    }
+    if (laneId < 0) {
+        laneId = createLane(startOffset);
+        if (laneId < 0) {
+            return -1;
+        }
+    }
+
+    Consumer consumer;
+    consumer.lane = laneId;
+    consumer.cursor = startOffset;
+    consumer.fallback = false;
+
+    if (lanes[laneId].head > startOffset) {
+        emit logMessage(QString("[共享读取] 从偏移 %1 开始的上传使用已缓存的数据").arg(startOffset));
+    }
+
+    int consumerId = nextConsumerId++;
+    consumers.insert(consumerId, consumer);
+    return consumerId;
+}
+
+void SharedChunkSource::detach(int consumerId)
+{
+    if (!consumers.contains(consumerId)) {
+        return;
+    }
+
+    int laneId = consumers.value(consumerId).lane;
+    consumers.remove(consumerId);
+    trimLane(laneId);
+    scheduleNotify();
+}
+
+QByteArray SharedChunkSource::read(int consumerId, qint64 offset, qint64 maxBytes, ReadStatus *status)
+{
+    *status = ReadFallback;
+
+    if (!consumers.contains(consumerId)) {
+        return QByteArray();
+    }
+
+    Consumer &consumer = consumers[consumerId];
+    if (consumer.fallback || !lanes.contains(consumer.lane)) {
+        return QByteArray();
+    }
+
+    int laneId = consumer.lane;
+    consumer.cursor = offset;
+
+    if (offset >= totalBytes) {
+        *status = ReadOk;
+        return QByteArray();
+    }
+
+    if (offset < lanes[laneId].base) {
+        // 请求的数据已滑出窗口，只能由使用者自行读盘
+        consumer.fallback = true;
+        trimLane(laneId);
+        return QByteArray();
+    }
+
+    if (offset >= lanes[laneId].head) {
+        int sliceCount = readHeadSlices(laneId, MAX_SLICES_PER_CALL);
+        if (sliceCount < 0) {
+            // 读盘失败时交给使用者自行读取，由它报告具体错误
+            consumers[consumerId].fallback = true;
+            trimLane(laneId);
+            return QByteArray();
+        }
+
+        if (sliceCount == 0 && offset >= lanes[laneId].head) {
+            // 窗口已满：最慢的使用者改为自行读盘，腾出窗口
+            detachSlowest(laneId);
+            if (!lanes.contains(laneId)) {
+                return QByteArray();
+            }
+            readHeadSlices(laneId, 1);
+        }
+
+        if (!lanes.contains(laneId) || offset >= lanes[laneId].head) {
+            *status = consumers.value(consumerId).fallback ? ReadFallback : ReadWait;
+            if (*status == ReadWait) {
+                scheduleNotify();
+            }
+            return QByteArray();
+        }
+
+        // 读取头前进了，等待中的其他使用者也可以继续
+        scheduleNotify();
+    }
+
+    const Lane &lane = lanes[laneId];
+    qint64 relative = offset - lane.base;
+    int index = static_cast<int>(relative / SLICE_SIZE);
+    int within = static_cast<int>(relative % SLICE_SIZE);
+    const QByteArray &slice = lane.slices.at(index);
+
+    QByteArray data = (within == 0 && slice.size() <= maxBytes) ? slice : slice.mid(within, static_cast<int>(maxBytes));
+    consumers[consumerId].cursor = offset + data.size();
+
+    // 窗口已满时，慢的使用者前进后快的使用者可能又能读入新数据
+    if (lane.head - lane.base >= windowSize && lane.head < totalBytes) {
+        scheduleNotify();
+    }
+
+    *status = ReadOk;
+    return data;
+}
+
+void SharedChunkSource::notifyConsumers()
+{
+    notifyPending = false;
+    emit dataAvailable();
+}
+
+void SharedChunkSource::drainLanes()
+{
+    drainPending = false;
+
+    // 只剩没有使用者的计算MD5通道：继续顺序读完文件
+    QList<int> laneIds = lanes.keys();
+    bool more = false;
+    for (int i = 0; i < laneIds.size(); ++i) {
+        int laneId = laneIds[i];
+        if (minimumCursor(laneId) >= 0 || !lanes[laneId].hashing) {
+            continue;
+        }
+        if (readHeadSlices(laneId, MAX_SLICES_PER_CALL) < 0) {
+            // 以空MD5通知等待方计算失败
+            emit logMessage("[共享读取] 读取本地文件失败，无法计算文件MD5");
+            removeLane(laneId);
+            emit md5Ready(QString());
+            continue;
+        }
+        if (!lanes.contains(laneId)) {
+            continue;
+        }
+        if (lanes[laneId].head >= totalBytes) {
+            trimLane(laneId);
+        } else {
+            more = true;
+        }
+    }
+
+    if (more) {
+        scheduleDrain();
+    }
+}
+
+int SharedChunkSource::createLane(qint64 startOffset)
+{
+    Lane lane;
+    lane.file = new QFile(filePath);
+    if (!lane.file->open(QIODevice::ReadOnly)) {
+        emit logMessage(QString("[共享读取] 无法打开本地文件: %1").arg(lane.file->errorString()));
+        delete lane.file;
+        return -1;
+    }
+
+    // 窗口按数据片对齐，起点之前的部分在第一次读取时被跳过
+    lane.base = startOffset - startOffset % SLICE_SIZE;
+    lane.head = lane.base;
+    lane.file->seek(lane.base);
+
+    // 从文件开头开始、且MD5尚未得到的通道负责计算整个文件的MD5（同一时间只有一个）
+    lane.hashing = false;
+    if (lane.base == 0 && md5Hex.isEmpty()) {
+        bool hashingLaneExists = false;
+        for (QMap<int, Lane>::const_iterator it = lanes.constBegin(); it != lanes.constEnd(); ++it) {
+            hashingLaneExists = hashingLaneExists || it.value().hashing;
+        }
+        if (!hashingLaneExists) {
+            lane.hashing = true;
+            md5Hash.reset();
+        }
+    }
+
+    int laneId = nextLaneId++;
+    lanes.insert(laneId, lane);
+    return laneId;
+}
+
+void SharedChunkSource::removeLane(int laneId)
+{
+    if (!lanes.contains(laneId)) {
+        return;
+    }
+
+    Lane lane = lanes.take(laneId);
+    lane.file->close();
+    delete lane.file;
+
+    QMap<int, Consumer>::iterator it = consumers.begin();
+    for (; it != consumers.end(); ++it) {
+        if (it.value().lane == laneId) {
+            it.value().fallback = true;
+        }
+    }
+}
+
+int SharedChunkSource::readHeadSlices(int laneId, int maxSlices)
+{
+    Lane &lane = lanes[laneId];
+    int sliceCount = 0;
+
+    while (sliceCount < maxSlices && lane.head < totalBytes) {
+        if (lane.head - lane.base >= windowSize) {
+            dropConsumed(laneId);
+            if (lane.head - lane.base >= windowSize) {
+                break;
+            }
+        }
+
+        QByteArray data = lane.file->read(qMin(SLICE_SIZE, totalBytes - lane.head));
+        if (data.isEmpty()) {
+            return -1;
+        }
+
+        if (lane.hashing) {
+            md5Hash.addData(data);
+        }
+        lane.slices.append(data);
+        lane.head += data.size();
+        sliceCount++;
+    }
+
+    if (lane.hashing && lane.head >= totalBytes) {
+        lane.hashing = false;
+        md5Hex = QString(md5Hash.result().toHex());
+        emit md5Ready(md5Hex);
+    }
+    return sliceCount;
+}
+
+qint64 SharedChunkSource::minimumCursor(int laneId) const
+{
+    qint64 minimum = -1;
+    for (QMap<int, Consumer>::const_iterator it = consumers.constBegin(); it != consumers.constEnd(); ++it) {
+        const Consumer &consumer = it.value();
+        if (consumer.lane != laneId || consumer.fallback) {
+            continue;
+        }
+        if (minimum < 0 || consumer.cursor < minimum) {
+            minimum = consumer.cursor;
+        }
+    }
+    return minimum;
+}
+
+void SharedChunkSource::trimLane(int laneId)
+{
+    if (!lanes.contains(laneId) || minimumCursor(laneId) >= 0) {
+        return;
+    }
+
+    // 通道已没有共享使用者：计算MD5的通道在后台读完；仍保留文件开头的通道留给之后从头开始的使用者，
+    // 其余通道直接释放
+    const Lane &lane = lanes[laneId];
+    if (lane.hashing && lane.head < totalBytes) {
+        scheduleDrain();
+    } else if (lane.base != 0) {
+        removeLane(laneId);
+    }
+}
+
+void SharedChunkSource::dropConsumed(int laneId)
+{
+    // 丢弃所有使用者都已取走的数据片；没有使用者时全部丢弃
+    Lane &lane = lanes[laneId];
+    qint64 minimum = minimumCursor(laneId);
+    if (minimum < 0) {
+        minimum = lane.head;
+    }
+
+    while (!lane.slices.isEmpty() && lane.base + lane.slices.first().size() <= minimum) {
+        lane.base += lane.slices.first().size();
+        lane.slices.removeFirst();
+    }
+}
+
+void SharedChunkSource::detachSlowest(int laneId)
+{
+    qint64 minimum = minimumCursor(laneId);
+    if (minimum < 0) {
+        return;
+    }
+
+    QMap<int, Consumer>::iterator it = consumers.begin();
+    for (; it != consumers.end(); ++it) {
+        Consumer &consumer = it.value();
+        if (consumer.lane == laneId && !consumer.fallback && consumer.cursor == minimum) {
+            consumer.fallback = true;
+        }
+    }
+
+    emit logMessage(QString("[共享读取] 有设备落后超过 %1 MB，改为单独读取本地文件").arg(windowSize / (1024 * 1024)));
+    trimLane(laneId);
+    if (lanes.contains(laneId)) {
+        dropConsumed(laneId);
+    }
+}
+
+void SharedChunkSource::scheduleNotify()
+{
+    if (notifyPending) {
+        return;
+    }
+    notifyPending = true;
+    QTimer::singleShot(0, this, &SharedChunkSource::notifyConsumers);
+}
+
+void SharedChunkSource::scheduleDrain()
+{
+    if (drainPending) {
+        return;
+    }
+    drainPending = true;
+    QTimer::singleShot(0, this, &SharedChunkSource::drainLanes);
+}
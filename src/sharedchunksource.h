@@ -0,0 +1,116 @@
+/**
+ * @File Name: sharedchunksource.h
+ * @brief  共享分块数据源头文件，批量上传时本地文件只读取一次，同一份缓冲分发给所有设备连接
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef SHAREDCHUNKSOURCE_H
+#define SHAREDCHUNKSOURCE_H
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QList>
+#include <QMap>
+#include <QByteArray>
+#include <QCryptographicHash>
+
+/**
+ * 数据按读取通道组织，每个通道有一个顺序读取头和一个有界窗口（最多缓存 windowSize 字节）：
+ * - 已读入的数据片在窗口装满之前一直保留，窗口满时才丢弃所有使用者都已取走的部分，
+ *   因此窗口中除了正在使用的数据，还保留一段已被取走的尾部
+ * - 使用者（一台设备的上传通道）的起始位置仍在某个通道保留的数据内时加入该通道，否则新建通道
+ * - 快的使用者追上读取头、且丢弃已取走的数据后窗口仍是满的，最慢的使用者被切换为独立读盘（ReadFallback），
+ *   因此慢设备最多让快设备等待一个窗口的数据量
+ * - 从文件开头开始的通道同时计算整个文件的MD5；该通道的使用者全部离开后继续读完剩余部分以得到MD5，
+ *   读盘失败时 md5Ready 携带空字符串
+ * - 使用者全部离开后，仍保留文件开头数据的通道不释放，供之后从头开始的使用者加入
+ *
+ * 实际保证：同时启动的设备共享一个通道；文件不超过一个窗口时，整个批量上传过程中文件只读取一次，
+ * 排队后启动的设备也从缓存取数据。文件超过窗口时，后启动的设备只有在起始位置仍在保留范围内时才能加入，
+ * 否则新建通道重新读盘。
+ */
+class SharedChunkSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ReadStatus {
+        ReadOk,
+        ReadWait,
+        ReadFallback
+    };
+
+    explicit SharedChunkSource(const QString &filePath, QObject *parent = nullptr);
+    ~SharedChunkSource();
+
+    bool open(QString *errorMessage);
+    void close();
+    qint64 size() const;
+    void setWindowSize(qint64 bytes);
+
+    int attach(qint64 startOffset);
+    void detach(int consumerId);
+    QByteArray read(int consumerId, qint64 offset, qint64 maxBytes, ReadStatus *status);
+    int laneCount() const;
+
+    bool isMd5Ready() const;
+    QString fileMd5() const;
+    void computeMd5();
+
+    static const qint64 DEFAULT_WINDOW_SIZE = 64 * 1024 * 1024;
+
+signals:
+    void dataAvailable();
+    void md5Ready(const QString &md5);
+    void logMessage(const QString &message);
+
+private slots:
+    void notifyConsumers();
+    void drainLanes();
+
+private:
+    struct Lane {
+        QFile *file;
+        QList<QByteArray> slices;   // slices[i] 对应文件偏移 base + i * SLICE_SIZE
+        qint64 base;
+        qint64 head;
+        bool hashing;
+    };
+
+    struct Consumer {
+        int lane;
+        qint64 cursor;
+        bool fallback;
+    };
+
+    int createLane(qint64 startOffset);
+    void removeLane(int laneId);
+    int readHeadSlices(int laneId, int maxSlices);
+    qint64 minimumCursor(int laneId) const;
+    void trimLane(int laneId);
+    void dropConsumed(int laneId);
+    void detachSlowest(int laneId);
+    void scheduleNotify();
+    void scheduleDrain();
+
+    QString filePath;
+    qint64 totalBytes;
+    qint64 windowSize;
+    bool opened;
+
+    QMap<int, Lane> lanes;
+    int nextLaneId;
+    QMap<int, Consumer> consumers;
+    int nextConsumerId;
+
+    QCryptographicHash md5Hash;
+    QString md5Hex;
+    bool notifyPending;
+    bool drainPending;
+};
+
+#endif // SHAREDCHUNKSOURCE_H
@@ -0,0 +1,55 @@
+/**
+ * @File Name: sshprocess.cpp
+ * @brief  上传用 ssh 进程实现
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "sshprocess.h"
+
+// 每次写入SSH通道的数据片大小，以及允许积压在通道缓冲区中的最大数据量
+static const qint64 WRITE_SLICE_SIZE = 256 * 1024;
+static const qint64 MAX_PENDING_BYTES = 1024 * 1024;
+
+SshProcess::SshProcess(const QProcessEnvironment &environment, QObject *parent)
+    : QProcess(parent)
+{
+    setProcessEnvironment(environment);
+    connect(this, &QProcess::started, this, &SshProcess::readyWrite);
+    connect(this, &QProcess::bytesWritten, this, &SshProcess::readyWrite);
+    connect(this, &QProcess::errorOccurred, this, &SshProcess::onErrorOccurred);
+}
+
+void SshProcess::startSsh(const QStringList &arguments)
+{
+    start("ssh", arguments);
+}
+
+bool SshProcess::canWrite() const
+{
+    return state() == QProcess::Running && bytesToWrite() < MAX_PENDING_BYTES;
+}
+
+qint64 SshProcess::nextSlice(qint64 remaining) const
+{
+    if (remaining <= 0 || !canWrite()) {
+        return 0;
+    }
+    return qMin(WRITE_SLICE_SIZE, remaining);
+}
+
+void SshProcess::closeWriteChannelWhenDrained()
+{
+    if (bytesToWrite() == 0) {
+        closeWriteChannel();
+    }
+}
+
+void SshProcess::onErrorOccurred(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        emit failedToStart(QString("无法启动ssh程序: %1").arg(errorString()));
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @File Name: sshprocess.h
+ * @brief  上传用 ssh 进程头文件，统一处理 ssh 无法启动的情况，并控制经标准输入发送数据时的分片和积压
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef SSHPROCESS_H
+#define SSHPROCESS_H
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+/**
+ * 分块上传、并行上传、流式解压和多文件上传共用的 ssh 进程：
+ * - ssh 程序无法启动（FailedToStart）时 QProcess 不会发出 finished，这里改为发出 failedToStart，
+ *   调用方按本地错误结束，重试也不会成功
+ * - 经标准输入发送数据时，进程启动和每次数据被通道取走后发出 readyWrite。调用方循环调用 nextSlice()
+ *   取得本次可以读取的字节数，返回0时等下一次通知；通道中积压的数据不超过1MB，文件不会整个读入内存
+ * - 数据全部写入后调用 closeWriteChannelWhenDrained()，积压的数据发完时关闭写通道，远程命令收到 EOF
+ */
+class SshProcess : public QProcess
+{
+    Q_OBJECT
+
+public:
+    explicit SshProcess(const QProcessEnvironment &environment, QObject *parent = nullptr);
+
+    // 以给定参数（连接选项、目标和远程命令）启动 ssh
+    void startSsh(const QStringList &arguments);
+
+    // 通道中积压的数据未满时为 true
+    bool canWrite() const;
+    // 本次可以写入的数据量，不超过 remaining；进程未运行或积压已满时为0
+    qint64 nextSlice(qint64 remaining) const;
+    void closeWriteChannelWhenDrained();
+
+signals:
+    void readyWrite();
+    void failedToStart(const QString &errorMessage);
+
+private slots:
+    void onErrorOccurred(QProcess::ProcessError error);
+};
+
+#endif // SSHPROCESS_H
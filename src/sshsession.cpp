@@ -0,0 +1,772 @@
+/**
+ * @File Name: sshsession.cpp
+ * @brief  SSH会话管理实现，常驻 ssh + sh 进程按结束标记切分每条命令的输出，空闲超时后自动断开
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "sshsession.h"
+#include "sshutils.h"
+#include <QDir>
+#include <QUuid>
+#include <QProcessEnvironment>
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QRegExp>
+#include <cstdio>
+
+const int SshSessionManager::DEFAULT_IDLE_TIMEOUT;
+
+// 结束标记前缀，后跟会话随机串和命令序号，避免与命令输出混淆
+static const char *END_MARKER_PREFIX = "@@SSH_SESSION_END_";
+
+// 会话启动时定义的远程函数：k 信号 进程号，先记下子进程再结束父进程，递归结束整个进程树
+static const char *KILL_TREE_FUNCTION =
+    "k() { set -- \"$1\" \"$2\" $(for f in /proc/[0-9]*/stat; do read -r c _ _ pp _ < \"$f\" 2>/dev/null "
+    "&& [ \"$pp\" = \"$2\" ] && echo \"$c\"; done); kill -\"$1\" \"$2\" 2>/dev/null; g=$1; shift 2; "
+    "for c in \"$@\"; do k \"$g\" \"$c\"; done; }\n";
+
+// 终止命令后等待其结束的时间，超时后改用 KILL 信号
+static const int KILL_GRACE_MS = 5000;
+
+// 应答模式下从这两个环境变量取得主程序的本地套接字名和令牌，密码只经套接字传递
+static const char *ASKPASS_SERVER_VARIABLE = "UPDATE_TOOL_ASKPASS_SERVER";
+static const char *ASKPASS_TOKEN_VARIABLE = "UPDATE_TOOL_ASKPASS_TOKEN";
+
+// 应答进程连接主程序和等待回复的超时
+static const int ASKPASS_TIMEOUT_MS = 10000;
+
+SshCommand::SshCommand(QObject *parent)
+    : QObject(parent), session(nullptr), id(0), processState(QProcess::NotRunning),
+      processError(QProcess::UnknownError)
+{
+}
+
+SshCommand::~SshCommand()
+{
+    if (session) {
+        session->abandon(this);
+    }
+}
+
+void SshCommand::start(SshSession *session, const QString &command)
+{
+    if (processState != QProcess::NotRunning || !session) {
+        return;
+    }
+
+    this->session = session;
+    commandText = command;
+    outputBuffer.clear();
+    errorBuffer.clear();
+    processState = QProcess::Starting;
+    processError = QProcess::UnknownError;
+    session->enqueue(this);
+}
+
+QString SshCommand::command() const
+{
+    return commandText;
+}
+
+QProcess::ProcessState SshCommand::state() const
+{
+    return processState;
+}
+
+QByteArray SshCommand::readAllStandardOutput()
+{
+    QByteArray data = outputBuffer;
+    outputBuffer.clear();
+    return data;
+}
+
+QByteArray SshCommand::readAllStandardError()
+{
+    QByteArray data = errorBuffer;
+    errorBuffer.clear();
+    return data;
+}
+
+QProcess::ProcessError SshCommand::error() const
+{
+    return processError;
+}
+
+void SshCommand::kill()
+{
+    if (processState == QProcess::NotRunning) {
+        return;
+    }
+
+    // 与 QProcess::kill() 后等待结束的效果一致：立即以异常退出结束，设备上的命令由会话在后台结束
+    if (session) {
+        session->abandon(this);
+        session = nullptr;
+    }
+    processState = QProcess::NotRunning;
+    emit finished(-1, QProcess::CrashExit);
+}
+
+void SshCommand::appendOutput(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    outputBuffer += data;
+    emit readyReadStandardOutput();
+}
+
+void SshCommand::appendError(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+    errorBuffer += data;
+    emit readyReadStandardError();
+}
+
+void SshCommand::markStarted()
+{
+    processState = QProcess::Running;
+    emit started();
+}
+
+void SshCommand::markError(QProcess::ProcessError error)
+{
+    processError = error;
+    emit errorOccurred(error);
+}
+
+void SshCommand::markFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    session = nullptr;
+    processState = QProcess::NotRunning;
+    emit finished(exitCode, exitStatus);
+}
+
+SshSession::SshSession(const QString &host, int port, const QString &username, const QStringList &options,
+                       QObject *parent)
+    : QObject(parent), host(host), port(port), username(username), options(options), process(nullptr),
+      current(nullptr), activeId(0), activePid(-1), killPending(false), nextCommandId(1), outputDone(false),
+      errorDone(false), currentExitCode(0)
+{
+    idleTimer = new QTimer(this);
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(SshSessionManager::DEFAULT_IDLE_TIMEOUT * 1000);
+    connect(idleTimer, &QTimer::timeout, this, &SshSession::onIdleTimeout);
+
+    killTimer = new QTimer(this);
+    killTimer->setSingleShot(true);
+    killTimer->setInterval(KILL_GRACE_MS);
+    connect(killTimer, &QTimer::timeout, this, &SshSession::onKillTimeout);
+}
+
+SshSession::~SshSession()
+{
+    // 尚未完成的命令与会话脱离，持有者删除它们时不再回调
+    if (current) {
+        current->session = nullptr;
+    }
+    for (int i = 0; i < queue.size(); ++i) {
+        queue[i]->session = nullptr;
+    }
+    stopProcess();
+}
+
+void SshSession::enqueue(SshCommand *command)
+{
+    command->id = nextCommandId++;
+    queue.append(command);
+    dispatch();
+}
+
+void SshSession::setIdleTimeout(int seconds)
+{
+    idleTimer->setInterval(qMax(1, seconds) * 1000);
+}
+
+bool SshSession::isConnected() const
+{
+    return process && process->state() != QProcess::NotRunning;
+}
+
+void SshSession::close()
+{
+    if (activeId || !queue.isEmpty()) {
+        return;
+    }
+    idleTimer->stop();
+    stopProcess();
+}
+
+void SshSession::dispatch()
+{
+    if (activeId || queue.isEmpty()) {
+        return;
+    }
+
+    idleTimer->stop();
+    current = queue.takeFirst();
+    activeId = current->id;
+    activePid = -1;
+    killPending = false;
+    outputPending.clear();
+    errorPending.clear();
+    outputDone = false;
+    errorDone = false;
+    currentExitCode = 0;
+
+    if (!process) {
+        startProcess();
+        if (!process) {
+            return;     // ssh 无法启动，当前命令已在 onProcessError 中结束
+        }
+    }
+
+    // sh -c 隔离每条命令（语法错误或 exit 不会结束常驻的 sh）；整组在后台运行，常驻的 sh 随即可以
+    // 接收终止指令。先在标准错误写出进程号，结束后在两个输出流各写一行结束标记
+    QByteArray marker = endMarker(activeId);
+    QByteArray framed = QByteArray("{ sh -c ") + SshUtils::shellQuote(current->command()).toUtf8()
+                        + " </dev/null & p=$!; "
+                        + "printf '\\n%s %d\\n' '" + marker + "_PID' \"$p\" >&2; "
+                        + "wait $p; r=$?; "
+                        + "printf '\\n%s %d\\n' '" + marker + "' \"$r\"; "
+                        + "printf '\\n%s\\n' '" + marker + "' >&2; } &\n";
+    process->write(framed);
+    current->markStarted();
+}
+
+void SshSession::startProcess()
+{
+    token = QUuid::createUuid().toRfc4122().toHex().left(16);
+
+    process = new QProcess(this);
+    SshSessionManager *manager = qobject_cast<SshSessionManager*>(parent());
+    process->setProcessEnvironment(manager ? manager->sshEnvironment() : QProcessEnvironment::systemEnvironment());
+    connect(process, &QProcess::readyReadStandardOutput, this, &SshSession::onReadyReadOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &SshSession::onReadyReadError);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &SshSession::onProcessFinished);
+    connect(process, &QProcess::errorOccurred, this, &SshSession::onProcessError);
+
+    // 保活探测及时发现断开的链路，下一条命令时重新连接
+    QStringList arguments = SshUtils::commonArguments();
+    arguments << options;
+    if (manager) {
+        arguments << manager->controlArguments();
+    }
+    arguments << "-p" << QString::number(port)
+              << QString("%1@%2").arg(username).arg(host)
+              << "sh";
+
+    emit logMessage(QString("[SSH会话] 建立到 %1@%2:%3 的连接").arg(username).arg(host).arg(port));
+    process->start("ssh", arguments);
+    if (process) {
+        process->write(KILL_TREE_FUNCTION);
+    }
+}
+
+void SshSession::stopProcess()
+{
+    if (!process) {
+        return;
+    }
+
+    process->disconnect(this);
+    if (process->state() != QProcess::NotRunning) {
+        process->closeWriteChannel();
+        if (!process->waitForFinished(1000)) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+    }
+    process->deleteLater();
+    process = nullptr;
+}
+
+void SshSession::abandon(SshCommand *command)
+{
+    if (queue.removeAll(command) > 0) {
+        return;
+    }
+    if (command != current) {
+        return;
+    }
+
+    // 只结束这一条命令：连接保持，剩余输出在结束标记到达前丢弃，之后继续执行排队的命令
+    current = nullptr;
+    if (activePid > 0) {
+        killRemote("TERM");
+    } else {
+        killPending = true;     // 进程号尚未收到，收到后再结束
+    }
+}
+
+void SshSession::killRemote(const char *signal)
+{
+    if (!process || activePid <= 0) {
+        return;
+    }
+    process->write(QString("k %1 %2\n").arg(signal).arg(activePid).toUtf8());
+    if (QByteArray(signal) == "TERM") {
+        killTimer->start();
+    }
+}
+
+void SshSession::onKillTimeout()
+{
+    // 命令没有响应 TERM，强制结束
+    if (activeId && !current) {
+        killRemote("KILL");
+    }
+}
+
+void SshSession::extractPid()
+{
+    QByteArray marker = QByteArray("\n") + endMarker(activeId) + "_PID ";
+    int markerIndex = errorPending.indexOf(marker);
+    if (markerIndex < 0) {
+        return;
+    }
+    int lineEnd = errorPending.indexOf('\n', markerIndex + marker.size());
+    if (lineEnd < 0) {
+        return;
+    }
+
+    activePid = errorPending.mid(markerIndex + marker.size(), lineEnd - markerIndex - marker.size()).trimmed().toLongLong();
+    errorPending.remove(markerIndex, lineEnd - markerIndex);
+    if (killPending) {
+        killPending = false;
+        killRemote("TERM");
+    }
+}
+
+void SshSession::onReadyReadOutput()
+{
+    outputPending += process->readAllStandardOutput();
+    if (!activeId || outputDone) {
+        outputPending.clear();
+        return;
+    }
+
+    QByteArray marker = QByteArray("\n") + endMarker(activeId) + " ";
+    int markerIndex = outputPending.indexOf(marker);
+    if (markerIndex >= 0) {
+        int lineEnd = outputPending.indexOf('\n', markerIndex + marker.size());
+        if (current) {
+            current->appendOutput(outputPending.left(markerIndex));
+        }
+        outputPending.remove(0, markerIndex);
+        if (lineEnd < 0) {
+            return;     // 退出码所在行还没收全
+        }
+        if (!activeId) {
+            return;
+        }
+        currentExitCode = outputPending.mid(marker.size(), lineEnd - markerIndex - marker.size()).trimmed().toInt();
+        outputPending.clear();
+        outputDone = true;
+        if (errorDone) {
+            finishCurrent(currentExitCode, QProcess::NormalExit);
+        }
+        return;
+    }
+
+    // 结束标记以换行开头，最后一个换行之前的内容可以安全地交给命令
+    int lastNewline = outputPending.lastIndexOf('\n');
+    if (lastNewline > 0) {
+        if (current) {
+            current->appendOutput(outputPending.left(lastNewline));
+        }
+        outputPending.remove(0, lastNewline);
+    }
+}
+
+void SshSession::onReadyReadError()
+{
+    errorPending += process->readAllStandardError();
+    if (!activeId || errorDone) {
+        errorPending.clear();
+        return;
+    }
+
+    if (activePid < 0) {
+        extractPid();
+    }
+
+    QByteArray marker = QByteArray("\n") + endMarker(activeId) + "\n";
+    int markerIndex = errorPending.indexOf(marker);
+    if (markerIndex >= 0) {
+        if (current) {
+            current->appendError(errorPending.left(markerIndex));
+        }
+        errorPending.clear();
+        if (!activeId) {
+            return;
+        }
+        errorDone = true;
+        if (outputDone) {
+            finishCurrent(currentExitCode, QProcess::NormalExit);
+        }
+        return;
+    }
+
+    // 进程号所在行没有收全时保留，避免把它交给命令
+    int keepFrom = errorPending.lastIndexOf('\n');
+    if (activePid < 0) {
+        int pidIndex = errorPending.indexOf(QByteArray("\n") + endMarker(activeId) + "_PID");
+        if (pidIndex >= 0) {
+            keepFrom = pidIndex;
+        }
+    }
+    if (keepFrom > 0) {
+        if (current) {
+            current->appendError(errorPending.left(keepFrom));
+        }
+        errorPending.remove(0, keepFrom);
+    }
+}
+
+void SshSession::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitStatus);
+
+    QProcess *finishedProcess = process;
+    process = nullptr;
+
+    if (activeId) {
+        // 连接断开（认证失败、网络中断等）：把剩余输出交给当前命令，以 ssh 的退出码结束
+        if (current) {
+            current->appendOutput(outputPending + finishedProcess->readAllStandardOutput());
+        }
+        if (current) {
+            current->appendError(errorPending + finishedProcess->readAllStandardError());
+        }
+        if (current) {
+            emit logMessage(QString("[SSH会话] 到 %1 的连接已断开 (退出码: %2)").arg(host).arg(exitCode));
+        }
+        if (activeId) {
+            finishCurrent(exitCode == 0 ? 255 : exitCode, QProcess::NormalExit);
+        }
+    }
+
+    finishedProcess->deleteLater();
+    dispatch();
+}
+
+void SshSession::onProcessError(QProcess::ProcessError error)
+{
+    if (error != QProcess::FailedToStart) {
+        return;     // 其他错误随后都会收到 finished
+    }
+
+    // ssh 程序无法启动时不会收到 finished，直接让当前命令失败
+    QProcess *failedProcess = process;
+    process = nullptr;
+    failedProcess->disconnect(this);
+    failedProcess->deleteLater();
+
+    if (current) {
+        current->appendError(QString("无法启动ssh程序: %1").arg(failedProcess->errorString()).toUtf8());
+    }
+    if (current) {
+        current->markError(QProcess::FailedToStart);
+    }
+    if (activeId) {
+        finishCurrent(255, QProcess::NormalExit);
+    }
+}
+
+void SshSession::onIdleTimeout()
+{
+    if (activeId || !queue.isEmpty() || !process) {
+        return;
+    }
+    emit logMessage(QString("[SSH会话] 到 %1 的连接空闲超时，已关闭").arg(host));
+
+    // 关闭输入后远程 sh 自行退出，进程结束后再释放，不阻塞界面
+    QProcess *idleProcess = process;
+    process = nullptr;
+    idleProcess->disconnect(this);
+    connect(idleProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            idleProcess, &QObject::deleteLater);
+    idleProcess->closeWriteChannel();
+}
+
+void SshSession::finishCurrent(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    SshCommand *command = current;
+    current = nullptr;
+    activeId = 0;
+    activePid = -1;
+    killPending = false;
+    killTimer->stop();
+    outputPending.clear();
+    errorPending.clear();
+
+    // 已被终止的命令在 kill() 时已经发出过 finished
+    if (command) {
+        command->markFinished(exitCode, exitStatus);
+    }
+
+    if (queue.isEmpty()) {
+        if (process) {
+            idleTimer->start();
+        }
+    } else {
+        QTimer::singleShot(0, this, &SshSession::dispatch);
+    }
+}
+
+QByteArray SshSession::endMarker(int commandId) const
+{
+    return QByteArray(END_MARKER_PREFIX) + token + "_" + QByteArray::number(commandId);
+}
+
+SshSessionManager::SshSessionManager(QObject *parent)
+    : QObject(parent), idleSeconds(DEFAULT_IDLE_TIMEOUT), askPassServer(nullptr), askPassAnswers(0)
+{
+}
+
+SshSessionManager::~SshSessionManager()
+{
+    closeAll();
+}
+
+SshSession *SshSessionManager::session(const QString &host, int port, const QString &username,
+                                       const QStringList &options)
+{
+    // 认证参数不同（例如切换了认证方式）时使用新的会话
+    QString key = QString("%1@%2:%3 %4").arg(username).arg(host).arg(port).arg(options.join(' '));
+    if (!sessions.contains(key)) {
+        SshSession *newSession = new SshSession(host, port, username, options, this);
+        newSession->setIdleTimeout(idleSeconds);
+        connect(newSession, &SshSession::logMessage, this, &SshSessionManager::logMessage);
+        sessions.insert(key, newSession);
+    }
+    return sessions.value(key);
+}
+
+void SshSessionManager::setIdleTimeout(int seconds)
+{
+    idleSeconds = qMax(1, seconds);
+    for (QMap<QString, SshSession*>::iterator it = sessions.begin(); it != sessions.end(); ++it) {
+        it.value()->setIdleTimeout(idleSeconds);
+    }
+}
+
+int SshSessionManager::idleTimeout() const
+{
+    return idleSeconds;
+}
+
+void SshSessionManager::closeAll()
+{
+    for (QMap<QString, SshSession*>::iterator it = sessions.begin(); it != sessions.end(); ++it) {
+        delete it.value();
+    }
+    sessions.clear();
+}
+
+QStringList SshSessionManager::controlArguments() const
+{
+    QStringList arguments;
+#ifndef Q_OS_WIN
+    // Windows 版 OpenSSH 不支持 ControlMaster，那里只复用常驻会话
+    arguments << "-o" << "ControlMaster=auto"
+              << "-o" << QString("ControlPath=%1/ssh-cm-%C").arg(QDir::tempPath())
+              << "-o" << QString("ControlPersist=%1").arg(idleSeconds);
+#endif
+    return arguments;
+}
+
+void SshSessionManager::setPassword(const QString &password)
+{
+    if (password == this->password) {
+        return;
+    }
+    // 会话令牌应答时取当前密码，已建立的连接和 ControlMaster 主连接保持不变
+    this->password = password;
+}
+
+bool SshSessionManager::hasPassword() const
+{
+    return !password.isEmpty();
+}
+
+QStringList SshSessionManager::batchArguments() const
+{
+    QStringList arguments;
+    if (password.isEmpty()) {
+        arguments << "-o" << "BatchMode=yes";
+    } else {
+        // BatchMode=yes 会同时禁用 SSH_ASKPASS
+        arguments << "-o" << "BatchMode=no"
+                  << "-o" << "NumberOfPasswordPrompts=1";
+    }
+    return arguments;
+}
+
+QProcessEnvironment SshSessionManager::sshEnvironment()
+{
+    if (password.isEmpty()) {
+        return askPassEnvironment(QString());
+    }
+    if (sessionToken.isEmpty()) {
+        sessionToken = QUuid::createUuid().toString();
+    }
+    return askPassEnvironment(sessionToken);
+}
+
+QProcessEnvironment SshSessionManager::oneShotEnvironment(const QString &password)
+{
+    if (password.isEmpty()) {
+        return askPassEnvironment(QString());
+    }
+    QString token = QUuid::createUuid().toString();
+    oneShotPasswords.insert(token, password);
+    return askPassEnvironment(token);
+}
+
+int SshSessionManager::askPassAnswerCount() const
+{
+    return askPassAnswers;
+}
+
+bool SshSessionManager::isPasswordPrompt(const QString &prompt)
+{
+    QString text = prompt.trimmed().toLower();
+    if (text.contains("passphrase") || text.contains("new password") || text.contains("(yes/no")) {
+        return false;
+    }
+    return QRegExp("^.*password[^:]*:$").exactMatch(text);
+}
+
+QProcessEnvironment SshSessionManager::askPassEnvironment(const QString &token)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.remove(ASKPASS_SERVER_VARIABLE);
+    environment.remove(ASKPASS_TOKEN_VARIABLE);
+    if (token.isEmpty()) {
+        return environment;
+    }
+
+    if (!askPassServer) {
+        askPassServer = new QLocalServer(this);
+        askPassServer->setSocketOptions(QLocalServer::UserAccessOption);   // 只允许当前用户连接
+        connect(askPassServer, &QLocalServer::newConnection, this, &SshSessionManager::onAskPassConnection);
+        QString name = QString("update_tool_askpass_%1_%2").arg(QCoreApplication::applicationPid())
+                           .arg(QUuid::createUuid().toString().mid(1, 8));
+        if (!askPassServer->listen(name)) {
+            emit logMessage(QString("[错误] 无法启动密码应答服务：%1").arg(askPassServer->errorString()));
+        }
+    }
+
+    environment.insert("SSH_ASKPASS", QDir::toNativeSeparators(QCoreApplication::applicationFilePath()));
+    environment.insert("SSH_ASKPASS_REQUIRE", "force");   // 有控制终端时也使用 SSH_ASKPASS（OpenSSH 8.4+）
+    if (!environment.contains("DISPLAY")) {
+        // 较旧的 OpenSSH 只在设置了 DISPLAY 时调用 SSH_ASKPASS；已有的 DISPLAY 保持不变
+        environment.insert("DISPLAY", ":0");
+    }
+    environment.insert(ASKPASS_SERVER_VARIABLE, askPassServer->fullServerName());
+    environment.insert(ASKPASS_TOKEN_VARIABLE, token);
+    return environment;
+}
+
+void SshSessionManager::onAskPassConnection()
+{
+    while (askPassServer->hasPendingConnections()) {
+        QLocalSocket *socket = askPassServer->nextPendingConnection();
+        askPassRequests.insert(socket, QByteArray());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+            answerAskPassRequest(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            askPassRequests.remove(socket);
+            socket->deleteLater();
+        });
+        answerAskPassRequest(socket);
+    }
+}
+
+void SshSessionManager::answerAskPassRequest(QLocalSocket *socket)
+{
+    if (!askPassRequests.contains(socket)) {
+        return;
+    }
+
+    // 请求为两行：令牌、提示文本
+    QByteArray &request = askPassRequests[socket];
+    request += socket->readAll();
+    if (request.count('\n') < 2) {
+        if (request.size() > 4096) {
+            askPassRequests.remove(socket);
+            socket->disconnectFromServer();
+        }
+        return;
+    }
+
+    QList<QByteArray> lines = request.split('\n');
+    QString token = QString::fromUtf8(lines.value(0));
+    QString prompt = QString::fromUtf8(lines.value(1));
+    askPassRequests.remove(socket);
+
+    QString answer;
+    if (!token.isEmpty() && isPasswordPrompt(prompt)) {
+        if (token == sessionToken) {
+            answer = password;
+        } else if (oneShotPasswords.contains(token)) {
+            answer = oneShotPasswords.take(token);
+        }
+    }
+
+    if (answer.isEmpty()) {
+        emit logMessage(QString("[SSH] 已拒绝非密码提示或无效令牌的认证请求：%1").arg(prompt.trimmed()));
+    } else {
+        ++askPassAnswers;
+        socket->write(answer.toUtf8() + '\n');
+        socket->flush();
+    }
+    socket->disconnectFromServer();
+}
+
+int SshSessionManager::answerAskPass(int argc, char *argv[])
+{
+    QByteArray server = qgetenv(ASKPASS_SERVER_VARIABLE);
+    QByteArray token = qgetenv(ASKPASS_TOKEN_VARIABLE);
+    if (argc < 2 || server.isEmpty() || token.isEmpty()) {
+        return -1;
+    }
+
+    QCoreApplication application(argc, argv);
+    QLocalSocket socket;
+    socket.connectToServer(QString::fromLocal8Bit(server));
+    if (!socket.waitForConnected(ASKPASS_TIMEOUT_MS)) {
+        return 1;
+    }
+
+    // ssh 以提示文本为参数调用，提示中的换行折叠为空格后随令牌发给主程序
+    QByteArray prompt = QString::fromLocal8Bit(argv[1]).simplified().toUtf8();
+    socket.write(token + '\n' + prompt + '\n');
+    socket.waitForBytesWritten(ASKPASS_TIMEOUT_MS);
+
+    QByteArray reply;
+    while (!reply.contains('\n') && socket.state() == QLocalSocket::ConnectedState
+           && socket.waitForReadyRead(ASKPASS_TIMEOUT_MS)) {
+        reply += socket.readAll();
+    }
+    reply += socket.readAll();
+    if (!reply.contains('\n')) {
+        return 1;
+    }
+
+    // 标准输出的第一行作为密码
+    reply.truncate(reply.indexOf('\n') + 1);
+    std::fwrite(reply.constData(), 1, static_cast<size_t>(reply.size()), stdout);
+    std::fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @File Name: sshsession.h
+ * @brief  SSH会话管理头文件，每个目标设备保持一条已认证的SSH连接，远程命令复用该连接执行
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef SSHSESSION_H
+#define SSHSESSION_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QHash>
+#include <QTimer>
+#include <QProcessEnvironment>
+
+class SshSession;
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * 在会话上执行的一条远程命令，接口与 QProcess 的常用部分保持一致，便于替换原有的单次 ssh 进程：
+ * finished / readyReadStandardOutput / readyReadStandardError / errorOccurred 信号，readAllStandardOutput 等方法。
+ * kill() 立即以 CrashExit 发出 finished，并结束设备上这一条命令的进程树，连接和排队的命令不受影响；
+ * 不需要回调时先 disconnect 再 kill。ssh 程序无法启动时先发出 errorOccurred(FailedToStart)，再发出 finished。
+ */
+class SshCommand : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SshCommand(QObject *parent = nullptr);
+    ~SshCommand();
+
+    // 在指定会话上排队执行远程命令
+    void start(SshSession *session, const QString &command);
+
+    QString command() const;
+    QProcess::ProcessState state() const;
+    QByteArray readAllStandardOutput();
+    QByteArray readAllStandardError();
+    QProcess::ProcessError error() const;
+    void kill();
+
+signals:
+    void started();
+    void errorOccurred(QProcess::ProcessError error);
+    void readyReadStandardOutput();
+    void readyReadStandardError();
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    friend class SshSession;
+
+    void appendOutput(const QByteArray &data);
+    void appendError(const QByteArray &data);
+    void markStarted();
+    void markFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void markError(QProcess::ProcessError error);
+
+    SshSession *session;
+    int id;
+    QString commandText;
+    QProcess::ProcessState processState;
+    QProcess::ProcessError processError;
+    QByteArray outputBuffer;
+    QByteArray errorBuffer;
+};
+
+/**
+ * 一个目标设备上的常驻 SSH 会话：
+ * - 连接建立一次（握手、密钥交换和认证只做一次），远程运行一个 sh 读取后续命令
+ * - 每条命令以 sh -c 在后台执行，先在标准错误写出命令的进程号，结束后在标准输出和标准错误各写一行
+ *   带随机标记的结束行，据此切分输出和取得退出码；常驻的 sh 在命令执行期间仍可接收终止指令
+ * - 命令按提交顺序依次执行；连接空闲超过 idleTimeout 秒后自动关闭，下一条命令到来时重新建立
+ * - 终止命令时按进程号结束设备上该命令的进程树，丢弃其剩余输出后继续执行排队的命令
+ * - 连接意外断开时当前命令以退出码 255 结束，排队的命令在新连接上继续执行
+ *
+ * 复用范围：经 SshCommand 执行的命令（连接测试、校验、升级流程、自定义命令、密钥安装）都走常驻会话。
+ * 支持 ControlMaster 的平台上会话同时作为主连接，上传等需要独立数据通道的 ssh 进程也复用它；
+ * Windows 版 OpenSSH 不支持 ControlMaster，上传、多路上传、增量上传和流式解压仍是独立的 ssh 进程，
+ * 每次各自完成握手和认证。
+ */
+class SshSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    SshSession(const QString &host, int port, const QString &username, const QStringList &options,
+               QObject *parent = nullptr);
+    ~SshSession();
+
+    void setIdleTimeout(int seconds);
+    bool isConnected() const;
+    void close();
+
+signals:
+    void logMessage(const QString &message);
+
+private slots:
+    void onReadyReadOutput();
+    void onReadyReadError();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessError(QProcess::ProcessError error);
+    void onIdleTimeout();
+
+private:
+    friend class SshCommand;
+
+    void enqueue(SshCommand *command);
+    void dispatch();
+    void startProcess();
+    void stopProcess();
+    void abandon(SshCommand *command);
+    void killRemote(const char *signal);
+    void onKillTimeout();
+    void finishCurrent(int exitCode, QProcess::ExitStatus exitStatus);
+    void extractPid();
+    QByteArray endMarker(int commandId) const;
+
+    QString host;
+    int port;
+    QString username;
+    QStringList options;
+
+    QProcess *process;
+    QByteArray token;
+    QList<SshCommand*> queue;
+    SshCommand *current;        // 被终止后为空，此时仍等待 activeId 的结束标记
+    int activeId;
+    qint64 activePid;
+    bool killPending;
+    int nextCommandId;
+    QByteArray outputPending;
+    QByteArray errorPending;
+    bool outputDone;
+    bool errorDone;
+    int currentExitCode;
+    QTimer *idleTimer;
+    QTimer *killTimer;
+};
+
+/**
+ * 按 用户@主机:端口 管理 SshSession，所有远程操作通过 session() 取得同一条连接。
+ * 密码认证不再经过 python 脚本或批处理：ssh 进程的 SSH_ASKPASS 指向程序自身，
+ * 程序以应答模式启动（见 answerAskPass）时通过本地套接字向主程序要密码，密码本身不进入任何环境变量。
+ * 主程序只对持有有效令牌、且提示为密码提示的请求应答，主机密钥确认、私钥口令等其他提示一律拒绝，
+ * 这时 ssh 按认证失败处理。
+ */
+class SshSessionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SshSessionManager(QObject *parent = nullptr);
+    ~SshSessionManager();
+
+    SshSession *session(const QString &host, int port, const QString &username, const QStringList &options);
+
+    void setIdleTimeout(int seconds);
+    int idleTimeout() const;
+    void closeAll();
+
+    // 支持 ControlMaster 的平台上返回复用主连接的 ssh 参数，其他平台返回空列表
+    QStringList controlArguments() const;
+
+    // 设置后新建立的连接通过 SSH_ASKPASS 使用新密码认证；已建立的连接不受影响，继续使用
+    void setPassword(const QString &password);
+    bool hasPassword() const;
+
+    // 没有密码时为非交互模式；有密码时允许 ssh 调用 SSH_ASKPASS，且只尝试一次避免错误密码反复重试
+    QStringList batchArguments() const;
+
+    // 本程序启动 ssh / scp 进程使用的环境变量，有密码时包含 SSH_ASKPASS 和会话令牌，应答时取当前密码
+    QProcessEnvironment sshEnvironment();
+    // 用户命令使用的环境变量：令牌只对给定密码应答一次，之后失效
+    QProcessEnvironment oneShotEnvironment(const QString &password);
+
+    // 已应答的密码提示次数，用于判断一次连接实际是否经过了密码认证
+    int askPassAnswerCount() const;
+
+    // 提示文本是否为密码提示（如 "user@host's password: "），私钥口令和 yes/no 确认不算
+    static bool isPasswordPrompt(const QString &prompt);
+
+    // 在 main() 中最先调用：程序被 ssh 作为 SSH_ASKPASS 启动时向主程序取得密码并输出，
+    // 返回进程退出码（0 已输出密码，1 被拒绝或主程序不可达）；不是应答模式时返回 -1
+    static int answerAskPass(int argc, char *argv[]);
+
+    static const int DEFAULT_IDLE_TIMEOUT = 300;
+
+signals:
+    void logMessage(const QString &message);
+
+private slots:
+    void onAskPassConnection();
+
+private:
+    QProcessEnvironment askPassEnvironment(const QString &token);
+    void answerAskPassRequest(QLocalSocket *socket);
+
+    QMap<QString, SshSession*> sessions;
+    int idleSeconds;
+    QString password;
+
+    QLocalServer *askPassServer;
+    QString sessionToken;                       // 本程序的 ssh 进程共用，应答时取当前密码
+    QHash<QString, QString> oneShotPasswords;   // 令牌 -> 密码，应答一次后删除
+    QHash<QLocalSocket*, QByteArray> askPassRequests;
+    int askPassAnswers;
+};
+
+#endif // SSHSESSION_H
@@ -0,0 +1,29 @@
+/**
+ * @File Name: sshutils.cpp
+ * @brief  ssh 命令公用函数实现
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "sshutils.h"
+
+QString SshUtils::shellQuote(const QString &text)
+{
+    // 使用单引号包裹，内部单引号转义为 '\''
+    QString escaped = text;
+    escaped.replace("'", "'\\''");
+    return QString("'%1'").arg(escaped);
+}
+
+QStringList SshUtils::commonArguments()
+{
+    QStringList arguments;
+    arguments << "-o" << "ConnectTimeout=30"
+              << "-o" << "StrictHostKeyChecking=no"
+              << "-o" << "UserKnownHostsFile=/dev/null"
+              << "-o" << "ServerAliveInterval=15"
+              << "-o" << "ServerAliveCountMax=4";
+    return arguments;
+}
@@ -0,0 +1,30 @@
+/**
+ * @File Name: sshutils.h
+ * @brief  ssh 命令公用函数头文件，远程 shell 参数的引用和本程序所有 ssh 进程共用的连接选项
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef SSHUTILS_H
+#define SSHUTILS_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * 拼接远程命令和启动 ssh 进程时各模块共用的函数，不依赖任何上传或会话类，
+ * 上传引擎、会话管理和升级流水线都只包含这个头文件。
+ */
+class SshUtils
+{
+public:
+    // 按远程 shell 的规则引用一个参数
+    static QString shellQuote(const QString &text);
+
+    // 本程序所有 ssh 进程共用的连接选项：连接超时、不检查主机密钥、保活探测及时发现断开的链路
+    static QStringList commonArguments();
+};
+
+#endif // SSHUTILS_H
@@ -0,0 +1,160 @@
+/**
+ * @File Name: streamcompressor.cpp
+ * @brief  传输压缩实现，qCompress 的 deflate 数据封装为gzip成员，按压缩耗时占比自适应选择级别
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "streamcompressor.h"
+#include <QtGlobal>
+
+const int StreamCompressor::DEFAULT_LEVEL;
+const int StreamCompressor::MAX_LEVEL;
+
+// 级别调整的统计窗口
+static const qint64 ADJUST_WINDOW_MS = 2000;
+
+// 压缩耗时占比高于 / 低于该值时降低 / 提高级别
+static const double BUSY_HIGH = 0.6;
+static const double BUSY_LOW = 0.25;
+
+// 压缩后大小超过原始大小的该比例时视为不可压缩
+static const double INCOMPRESSIBLE_RATIO = 0.95;
+
+// 判定为不可压缩后直接存储的数据片数，之后重新试探
+static const int STORED_SLICES = 16;
+
+StreamCompressor::StreamCompressor()
+{
+    reset();
+}
+
+void StreamCompressor::reset(int initialLevel)
+{
+    currentLevel = qBound(0, initialLevel, MAX_LEVEL);
+    storedSlicesLeft = 0;
+    totalIn = 0;
+    totalOut = 0;
+    windowBusyNs = 0;
+    windowTimer.invalidate();
+}
+
+QByteArray StreamCompressor::compress(const QByteArray &data)
+{
+    if (!windowTimer.isValid()) {
+        windowTimer.start();
+    }
+
+    QElapsedTimer busyTimer;
+    busyTimer.start();
+
+    QByteArray member;
+    if (storedSlicesLeft > 0) {
+        member = gzipMember(data, 0);
+        storedSlicesLeft--;
+    } else {
+        member = gzipMember(data, currentLevel);
+        if (currentLevel > 0 && member.size() > data.size() * INCOMPRESSIBLE_RATIO) {
+            storedSlicesLeft = STORED_SLICES;
+        }
+    }
+
+    windowBusyNs += busyTimer.nsecsElapsed();
+    totalIn += data.size();
+    totalOut += member.size();
+
+    if (windowTimer.elapsed() >= ADJUST_WINDOW_MS) {
+        adjustLevel();
+    }
+    return member;
+}
+
+void StreamCompressor::adjustLevel()
+{
+    double busy = static_cast<double>(windowBusyNs) / (windowTimer.nsecsElapsed() + 1);
+
+    if (busy > BUSY_HIGH && currentLevel > 0) {
+        currentLevel--;
+    } else if (busy < BUSY_LOW && currentLevel < MAX_LEVEL && storedSlicesLeft == 0) {
+        currentLevel++;
+    }
+
+    windowBusyNs = 0;
+    windowTimer.restart();
+}
+
+int StreamCompressor::level() const
+{
+    return currentLevel;
+}
+
+qint64 StreamCompressor::inputBytes() const
+{
+    return totalIn;
+}
+
+qint64 StreamCompressor::outputBytes() const
+{
+    return totalOut;
+}
+
+double StreamCompressor::ratio() const
+{
+    return totalIn > 0 ? static_cast<double>(totalOut) / totalIn : 1.0;
+}
+
+QByteArray StreamCompressor::gzipMember(const QByteArray &data, int level)
+{
+    // qCompress 输出：4字节大端长度 + zlib头(2字节) + deflate数据 + adler32(4字节)；
+    // 输入为空时 qCompress 只返回4个零字节，没有deflate数据，改用只含结束符的固定哈夫曼块
+    QByteArray deflateData;
+    if (data.isEmpty()) {
+        deflateData = QByteArray("\x03\x00", 2);
+    } else {
+        QByteArray zlibData = qCompress(data, level);
+        deflateData = zlibData.mid(6, zlibData.size() - 10);
+    }
+
+    static const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff' };
+
+    QByteArray member;
+    member.reserve(deflateData.size() + 18);
+    member.append(header, sizeof(header));
+    member.append(deflateData);
+
+    // 尾部：CRC32 和原始长度，均为小端
+    quint32 crc = crc32(data);
+    quint32 size = static_cast<quint32>(data.size());
+    for (int i = 0; i < 4; ++i) {
+        member.append(static_cast<char>((crc >> (8 * i)) & 0xff));
+    }
+    for (int i = 0; i < 4; ++i) {
+        member.append(static_cast<char>((size >> (8 * i)) & 0xff));
+    }
+    return member;
+}
+
+quint32 StreamCompressor::crc32(const QByteArray &data)
+{
+    static quint32 table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    quint32 crc = 0xFFFFFFFFu;
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+    for (int i = 0; i < data.size(); ++i) {
+        crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
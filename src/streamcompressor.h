@@ -0,0 +1,57 @@
+/**
+ * @File Name: streamcompressor.h
+ * @brief  传输压缩头文件，把上传数据逐片编码为gzip成员，并根据链路与CPU的繁忙程度自动调整压缩级别
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef STREAMCOMPRESSOR_H
+#define STREAMCOMPRESSOR_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+
+/**
+ * 每片数据编码为一个独立的gzip成员，成员首尾相接仍是合法的gzip流，远程用 gzip -dc 解压。
+ * 压缩数据由 qCompress 生成（去掉长度前缀、zlib头和adler校验），再补上gzip头、CRC32和原始长度。
+ *
+ * 级别选择：统计一个时间窗口内压缩耗时占墙钟时间的比例
+ * - 比例高说明CPU跟不上链路，降低级别（最低为0，即只存储不压缩）
+ * - 比例低说明链路是瓶颈，数据在通道中排队，提高级别换取更高的有效吞吐量
+ * 压缩后几乎不变小的数据（例如已经是gzip的文件）视为不可压缩，之后一段数据直接以级别0存储，再重新试探。
+ */
+class StreamCompressor
+{
+public:
+    StreamCompressor();
+
+    void reset(int initialLevel = DEFAULT_LEVEL);
+
+    // 把一片原始数据编码为一个gzip成员
+    QByteArray compress(const QByteArray &data);
+
+    int level() const;
+    qint64 inputBytes() const;
+    qint64 outputBytes() const;
+    double ratio() const;
+
+    static QByteArray gzipMember(const QByteArray &data, int level);
+    static quint32 crc32(const QByteArray &data);
+
+    static const int DEFAULT_LEVEL = 1;
+    static const int MAX_LEVEL = 9;
+
+private:
+    void adjustLevel();
+
+    int currentLevel;
+    int storedSlicesLeft;       // 判定为不可压缩后，剩余直接存储的数据片数
+    qint64 totalIn;
+    qint64 totalOut;
+    QElapsedTimer windowTimer;
+    qint64 windowBusyNs;        // 当前窗口内压缩耗时
+};
+
+#endif // STREAMCOMPRESSOR_H
@@ -0,0 +1,374 @@
+/**
+ * @File Name: streamextractor.cpp
+ * @brief  流式解压升级实现，本地升级包经SSH通道写入远程 tee | tar -xz，两端在传输过程中分别计算MD5，本地比对后再替换解压结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "streamextractor.h"
+#include "ratelimiter.h"
+#include "sshprocess.h"
+#include "sshsession.h"
+#include "sshutils.h"
+#include <QFileInfo>
+#include <QDateTime>
+
+// 远程输出收到数据MD5的行前缀
+static const char *REMOTE_MD5_MARKER = "@@STREAM_MD5";
+
+// 解压路径下临时目录名称的前缀，开始传输时清除中断的升级留下的同名目录
+static const char *STAGING_PREFIX = ".stream_extract_";
+
+StreamExtractor::StreamExtractor(QObject *parent)
+    : QObject(parent), port(22), sshEnvironment(QProcessEnvironment::systemEnvironment()), session(nullptr),
+      process(nullptr), finalizeCommand(nullptr), committing(false),
+      totalBytes(0), writtenOffset(0), cancelRequested(false), md5Hash(QCryptographicHash::Md5),
+      deviceLimiter(nullptr), limiterConsumer(-1), errorClass(RetryPolicy::ErrorNone)
+{
+    deviceLimiter = new RateLimiter(this);
+    connect(deviceLimiter, &RateLimiter::tokensAvailable, this, &StreamExtractor::feed);
+}
+
+StreamExtractor::~StreamExtractor()
+{
+    cleanupProcess();
+}
+
+void StreamExtractor::setLocalFile(const QString &filePath)
+{
+    localFilePath = filePath;
+}
+
+void StreamExtractor::setRemoteTarget(const QString &host, int port, const QString &username)
+{
+    this->host = host;
+    this->port = port;
+    this->username = username;
+}
+
+void StreamExtractor::setExtractPath(const QString &path)
+{
+    extractPath = path;
+}
+
+void StreamExtractor::setSshOptions(const QStringList &options)
+{
+    sshOptions = options;
+}
+
+void StreamExtractor::setSshEnvironment(const QProcessEnvironment &environment)
+{
+    sshEnvironment = environment;
+}
+
+void StreamExtractor::setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond)
+{
+    deviceLimiter->setUpstream(sharedLimiter);
+    deviceLimiter->setRate(deviceBytesPerSecond);
+}
+
+void StreamExtractor::setSession(SshSession *session)
+{
+    this->session = session;
+}
+
+bool StreamExtractor::isRunning() const
+{
+    return process != nullptr || finalizeCommand != nullptr;
+}
+
+QString StreamExtractor::localMd5() const
+{
+    return localMd5Hex;
+}
+
+QString StreamExtractor::remoteMd5() const
+{
+    return remoteMd5Hex;
+}
+
+RetryPolicy::ErrorClass StreamExtractor::lastErrorClass() const
+{
+    return errorClass;
+}
+
+void StreamExtractor::start()
+{
+    if (isRunning()) {
+        return;
+    }
+
+    cancelRequested = false;
+    writtenOffset = 0;
+    md5Hash.reset();
+    localMd5Hex.clear();
+    remoteMd5Hex.clear();
+    stagingName = STAGING_PREFIX + QString::number(QDateTime::currentMSecsSinceEpoch());
+    errorClass = RetryPolicy::ErrorNone;
+
+    if (extractPath.trimmed().isEmpty()) {
+        errorClass = RetryPolicy::ErrorLocal;
+        emit finished(false, "未设置解压路径");
+        return;
+    }
+    if (!session) {
+        errorClass = RetryPolicy::ErrorLocal;
+        emit finished(false, "未设置SSH会话");
+        return;
+    }
+
+    sourceFile.setFileName(localFilePath);
+    if (!sourceFile.open(QIODevice::ReadOnly)) {
+        errorClass = RetryPolicy::ErrorLocal;
+        emit finished(false, QString("无法打开本地文件: %1").arg(sourceFile.errorString()));
+        return;
+    }
+    totalBytes = sourceFile.size();
+
+    limiterConsumer = deviceLimiter->attach();
+    process = new SshProcess(sshEnvironment, this);
+    connect(process, &SshProcess::readyWrite, this, &StreamExtractor::onWritable);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &StreamExtractor::onProcessFinished);
+    connect(process, &SshProcess::failedToStart, this, [this](const QString &errorMessage) {
+        finishWithError(errorMessage, RetryPolicy::ErrorLocal);
+    });
+
+    QStringList arguments = SshUtils::commonArguments();
+    arguments << sshOptions;
+    arguments << "-p" << QString::number(port)
+              << QString("%1@%2").arg(username).arg(host)
+              << buildRemoteCommand();
+
+    emit logMessage(QString("[流式升级] %1 (%2 字节) 直接解压到 %3@%4:%5")
+                   .arg(QFileInfo(localFilePath).fileName()).arg(totalBytes)
+                   .arg(username).arg(host).arg(extractPath));
+    emit progressChanged(0, totalBytes);
+
+    process->startSsh(arguments);
+}
+
+void StreamExtractor::cancel()
+{
+    if (!isRunning()) {
+        return;
+    }
+    if (finalizeCommand) {
+        // 替换到一半中断会留下新旧混合的文件，等这条命令结束
+        emit logMessage("[流式升级] 正在处理解压结果，完成后结束");
+        return;
+    }
+    cancelRequested = true;
+    process->kill();
+}
+
+QString StreamExtractor::buildRemoteCommand() const
+{
+    // 标准输入只有升级包数据，读到 EOF 为止；数据之后不再附带任何内容，不依赖 head -c 按长度截取
+    // （busybox 的 head -c 会按块多读，截取之后的内容会被吞掉）
+    // tar 遇到压缩包结尾后可能不再读取，随后用 cat 读尽剩余数据，tee 才能把完整数据流送入 md5sum
+    // 管道的退出码是 tar 的，解压工具失败时把退出码写入 $r，与解压脚本 unpack 的做法相同
+    // 临时目录放在解压路径下，保证与目标在同一文件系统，mv 不复制数据；解压成功时保留，由 finalize() 处理
+    QStringList lines;
+    lines << QString("d=%1; f=/tmp/.stream_extract_$$; r=\"$f.rc\"").arg(SshUtils::shellQuote(extractPath))
+          << "mkdir -p \"$d\" && d=$(cd \"$d\" && pwd) || exit 1"
+          << QString("rm -rf \"$d\"/%1*; s=\"$d/%2\"; mkdir \"$s\" || exit 1").arg(STAGING_PREFIX).arg(stagingName)
+          << "rm -f \"$f\" \"$f.md5\" \"$r\"; mkfifo \"$f\" || { rm -rf \"$s\"; exit 1; }"
+          << "md5sum < \"$f\" > \"$f.md5\" &"
+          << "if command -v pigz >/dev/null 2>&1; then dz='pigz -dc'; else dz='gzip -dc'; fi"
+          << "tee \"$f\" | { { $dz || echo $? > \"$r\"; } | tar -xf - -C \"$s\"; rc=$?; cat > /dev/null; exit $rc; }"
+          << "rc=$?"
+          << "[ $rc -eq 0 ] && [ -s \"$r\" ] && rc=$(cat \"$r\")"
+          << "wait"
+          << QString("echo \"%1 $(cut -d' ' -f1 \"$f.md5\")\"").arg(REMOTE_MD5_MARKER)
+          << "rm -f \"$f\" \"$f.md5\" \"$r\""
+          << "[ $rc -eq 0 ] || rm -rf \"$s\""
+          << "exit $rc";
+    return lines.join("\n");
+}
+
+QString StreamExtractor::buildFinalizeCommand(bool commit) const
+{
+    QStringList lines;
+    lines << QString("d=%1; d=$(cd \"$d\" && pwd) || exit 1; s=\"$d/%2\"")
+             .arg(SshUtils::shellQuote(extractPath)).arg(stagingName);
+    if (!commit) {
+        lines << "rm -rf \"$s\"";
+        return lines.join("\n");
+    }
+
+    lines << "[ -d \"$s\" ] || { echo \"解压临时目录 $s 不存在\" >&2; exit 1; }"
+          << "( cd \"$s\" && find . -type d | while IFS= read -r p; do mkdir -p \"$d/$p\" || exit 1; done &&"
+          << "  find . ! -type d | while IFS= read -r p; do mv -f \"$p\" \"$d/$p\" || exit 1; done ); rc=$?"
+          << "[ $rc -eq 0 ] && sync"
+          << "rm -rf \"$s\""
+          << "exit $rc";
+    return lines.join("\n");
+}
+
+void StreamExtractor::onWritable()
+{
+    if (!process) {
+        return;
+    }
+
+    emit progressChanged(qBound(qint64(0), writtenOffset - process->bytesToWrite(), totalBytes), totalBytes);
+    feed();
+}
+
+void StreamExtractor::feed()
+{
+    if (!process) {
+        return;
+    }
+
+    // 保持通道缓冲区中只有少量待发送数据，避免整个升级包读入内存
+    qint64 sliceBytes;
+    while ((sliceBytes = process->nextSlice(totalBytes - writtenOffset)) > 0) {
+        sliceBytes = deviceLimiter->acquire(limiterConsumer, sliceBytes);
+        if (sliceBytes <= 0) {
+            return;
+        }
+
+        QByteArray data = sourceFile.read(sliceBytes);
+        if (data.isEmpty()) {
+            emit logMessage(QString("[错误] 读取本地文件失败: %1").arg(sourceFile.errorString()));
+            process->kill();
+            return;
+        }
+
+        // 同一份读缓冲既发送又计入MD5，文件只读取一次
+        md5Hash.addData(data);
+        process->write(data);
+        writtenOffset += data.size();
+    }
+
+    if (writtenOffset >= totalBytes && localMd5Hex.isEmpty()) {
+        localMd5Hex = QString(md5Hash.result().toHex());
+    }
+
+    if (writtenOffset >= totalBytes) {
+        // 所有数据交给SSH后关闭写通道
+        process->closeWriteChannelWhenDrained();
+    }
+}
+
+void StreamExtractor::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    sourceFile.close();
+
+    if (cancelRequested) {
+        finishWithError("流式升级已取消");
+        return;
+    }
+
+    QString output = QString::fromUtf8(process->readAllStandardOutput());
+    QString error = QString::fromUtf8(process->readAllStandardError()).trimmed();
+
+    QString markerPrefix = QString(REMOTE_MD5_MARKER) + " ";
+    const QStringList lines = output.split('\n');
+    for (const QString &line : lines) {
+        if (line.startsWith(markerPrefix)) {
+            remoteMd5Hex = line.mid(markerPrefix.length()).trimmed().toLower();
+        }
+    }
+
+    if (writtenOffset < totalBytes) {
+        finishWithError(error.isEmpty()
+                        ? QString("SSH通道在传输完成前退出 (已发送 %1/%2 字节，退出码: %3)")
+                          .arg(writtenOffset).arg(totalBytes).arg(exitCode)
+                        : error,
+                        RetryPolicy::classify(exitCode, exitStatus, error));
+        return;
+    }
+
+    emit logMessage(QString("[流式升级] 本地MD5: %1").arg(localMd5Hex));
+    emit logMessage(QString("[流式升级] 远程收到数据MD5: %1").arg(remoteMd5Hex.isEmpty() ? "未返回" : remoteMd5Hex));
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        // 解压失败时远程脚本已删除临时目录
+        finishWithError(error.isEmpty() ? QString("远程解压失败 (退出码: %1)").arg(exitCode) : error,
+                        RetryPolicy::classify(exitCode, exitStatus, error));
+        return;
+    }
+
+    // 解压结果暂存在临时目录，由本地比对MD5后决定替换还是丢弃，目标路径在此之前保持原样
+    if (remoteMd5Hex.isEmpty()) {
+        finalize(false, "远程未返回收到数据的MD5，无法确认解压结果");
+        return;
+    }
+    if (remoteMd5Hex != localMd5Hex) {
+        finalize(false, "远程收到的数据MD5与本地不一致，已丢弃解压结果，目标路径未改动，请重新升级");
+        return;
+    }
+
+    emit logMessage("[流式升级] MD5一致，替换解压路径中的文件");
+    finalize(true, QString());
+}
+
+void StreamExtractor::finalize(bool commit, const QString &rollbackReason)
+{
+    cleanupProcess();
+    committing = commit;
+    this->rollbackReason = rollbackReason;
+
+    finalizeCommand = new SshCommand(this);
+    connect(finalizeCommand, &SshCommand::finished, this, &StreamExtractor::onFinalizeFinished);
+    finalizeCommand->start(session, buildFinalizeCommand(commit));
+}
+
+void StreamExtractor::onFinalizeFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    QString error = QString::fromUtf8(finalizeCommand->readAllStandardError()).trimmed();
+    QProcess::ProcessError processError = finalizeCommand->error();
+    finalizeCommand->deleteLater();
+    finalizeCommand = nullptr;
+
+    if (!committing) {
+        if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+            // 临时目录残留不影响目标路径，下次升级开始时清除
+            emit logMessage(QString("[流式升级] 删除解压临时目录失败: %1").arg(error.isEmpty() ? QString::number(exitCode) : error));
+        }
+        finishWithError(rollbackReason, RetryPolicy::ErrorRemote);
+        return;
+    }
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        RetryPolicy::ErrorClass errorClass = RetryPolicy::classify(exitCode, exitStatus, error, processError);
+        finishWithError(error.isEmpty() ? QString("替换解压结果失败 (退出码: %1)").arg(exitCode) : error,
+                        errorClass == RetryPolicy::ErrorNone ? RetryPolicy::ErrorRemote : errorClass);
+        return;
+    }
+
+    emit progressChanged(totalBytes, totalBytes);
+    emit finished(true, QString());
+}
+
+void StreamExtractor::finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass)
+{
+    this->errorClass = errorClass;
+    if (sourceFile.isOpen()) {
+        sourceFile.close();
+    }
+    cleanupProcess();
+    emit finished(false, errorMessage);
+}
+
+void StreamExtractor::cleanupProcess()
+{
+    if (limiterConsumer >= 0) {
+        deviceLimiter->detach(limiterConsumer);
+        limiterConsumer = -1;
+    }
+    if (process) {
+        process->disconnect(this);
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished(1000);
+        }
+        process->deleteLater();
+        process = nullptr;
+    }
+}
@@ -0,0 +1,114 @@
+/**
+ * @File Name: streamextractor.h
+ * @brief  流式解压升级头文件，本地升级包经SSH通道直接送入远程 tar 解压，设备上不保存压缩包
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef STREAMEXTRACTOR_H
+#define STREAMEXTRACTOR_H
+
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QCryptographicHash>
+#include "retrypolicy.h"
+
+class RateLimiter;
+class SshProcess;
+class SshSession;
+class SshCommand;
+
+/**
+ * 升级流程：
+ * 1. 远程创建一个 fifo，后台 md5sum 读取 fifo 计算收到数据的MD5
+ * 2. 本地按片读取升级包写入SSH通道，同一份读缓冲同时计入本地MD5，发完后关闭写通道；标准输入中只有升级包数据
+ * 3. 远程 tee 把数据同时送入 fifo 和 tar -xz，解压到解压路径下的临时目录；tar 结束后读尽剩余数据，
+ *    保证远程MD5覆盖完整数据流；解压工具和 tar 任一失败时删除临时目录并按失败处理
+ * 4. 远程输出收到数据的MD5，由本地与发送时计算的MD5比较，再在常驻会话上执行一条单独的命令：
+ *    一致时把临时目录中的文件逐个 mv 到解压路径（同一文件系统内只改目录项）并执行 sync，
+ *    不一致时删除临时目录，解压路径中原有的文件保持不变
+ *
+ * 与先上传再解压相比，升级包不落盘：设备存储只写入解压后的文件一次，也省去了单独的解压阶段。
+ * 替换前新旧文件同时存在，设备上需要留有解压后文件大小的空闲空间。
+ * 发送速率与普通上传一样受全局和设备级限速约束。
+ */
+class StreamExtractor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StreamExtractor(QObject *parent = nullptr);
+    ~StreamExtractor();
+
+    void setLocalFile(const QString &filePath);
+    void setRemoteTarget(const QString &host, int port, const QString &username);
+    void setExtractPath(const QString &path);
+    void setSshOptions(const QStringList &options);
+    void setSshEnvironment(const QProcessEnvironment &environment);
+    void setRateLimit(RateLimiter *sharedLimiter, qint64 deviceBytesPerSecond);
+    // 传输结束后替换或丢弃解压结果的命令在该会话上执行
+    void setSession(SshSession *session);
+
+    bool isRunning() const;
+    QString localMd5() const;
+    QString remoteMd5() const;
+
+    // 最近一次失败的类别；失败时解压路径未被改动，重新 start() 从头发送
+    RetryPolicy::ErrorClass lastErrorClass() const;
+
+    void start();
+    void cancel();
+
+signals:
+    void logMessage(const QString &message);
+    void progressChanged(qint64 bytesSent, qint64 totalBytes);
+    void finished(bool success, const QString &errorMessage);
+
+private slots:
+    void onWritable();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onFinalizeFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    void feed();
+    QString buildRemoteCommand() const;
+    QString buildFinalizeCommand(bool commit) const;
+    void finalize(bool commit, const QString &rollbackReason);
+    void finishWithError(const QString &errorMessage, RetryPolicy::ErrorClass errorClass = RetryPolicy::ErrorLocal);
+    void cleanupProcess();
+
+    // 参数
+    QString localFilePath;
+    QString host;
+    int port;
+    QString username;
+    QString extractPath;
+    QStringList sshOptions;
+    QProcessEnvironment sshEnvironment;
+    SshSession *session;
+
+    // 运行状态
+    SshProcess *process;
+    SshCommand *finalizeCommand;
+    QString stagingName;        // 解压路径下临时目录的名称
+    bool committing;
+    QString rollbackReason;
+    QFile sourceFile;
+    qint64 totalBytes;
+    qint64 writtenOffset;
+    bool cancelRequested;
+    QCryptographicHash md5Hash;
+    QString localMd5Hex;
+    QString remoteMd5Hex;
+    RateLimiter *deviceLimiter;
+    int limiterConsumer;
+    RetryPolicy::ErrorClass errorClass;
+};
+
+#endif // STREAMEXTRACTOR_H
@@ -0,0 +1,163 @@
+/**
+ * @File Name: test_batchuploader.cpp
+ * @brief  测试多文件上传的 ustar 头部生成和所选文件、目录的展开
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include "batchuploader.h"
+
+static BatchUploader::Entry makeEntry(const QString &relativePath, qint64 size, bool executable)
+{
+    BatchUploader::Entry entry;
+    entry.relativePath = relativePath;
+    entry.size = size;
+    entry.executable = executable;
+    entry.sent = false;
+    entry.verified = false;
+    return entry;
+}
+
+// 取头部中以 NUL 结尾的字段
+static QByteArray field(const QByteArray &header, int offset, int width)
+{
+    QByteArray value = header.mid(offset, width);
+    int end = value.indexOf('\0');
+    return end < 0 ? value : value.left(end);
+}
+
+static bool writeFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+class TestBatchUploader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void ustarFields();
+    void ustarChecksum();
+    void ustarLongPath();
+    void collectExpandsDirectories();
+    void collectMissingPath();
+    void collectEmptySelection();
+};
+
+void TestBatchUploader::ustarFields()
+{
+    QByteArray header = BatchUploader::ustarHeader(makeEntry("pkg/app.bin", 1000, false), 1700000000);
+    QCOMPARE(header.size(), 512);
+    QCOMPARE(field(header, 0, 100), QByteArray("pkg/app.bin"));
+    QCOMPARE(field(header, 100, 8), QByteArray("0000644"));
+    QCOMPARE(field(header, 124, 12), QByteArray::number(1000, 8).rightJustified(11, '0'));
+    QCOMPARE(field(header, 136, 12), QByteArray::number(1700000000, 8).rightJustified(11, '0'));
+    QCOMPARE(header.at(156), '0');
+    QCOMPARE(header.mid(257, 6), QByteArray("ustar\0", 6));
+    QCOMPARE(header.mid(263, 2), QByteArray("00"));
+    QCOMPARE(field(header, 345, 155), QByteArray());
+
+    QByteArray executable = BatchUploader::ustarHeader(makeEntry("run.sh", 0, true), -5);
+    QCOMPARE(field(executable, 100, 8), QByteArray("0000755"));
+    QCOMPARE(field(executable, 124, 12), QByteArray("00000000000"));
+    // 修改时间为负数时写0
+    QCOMPARE(field(executable, 136, 12), QByteArray("00000000000"));
+}
+
+void TestBatchUploader::ustarChecksum()
+{
+    QByteArray header = BatchUploader::ustarHeader(makeEntry("目录/文件.txt", 123456, false), 1700000000);
+
+    // 校验和字段写成6位八进制加 NUL 和空格，按该字段为8个空格计算
+    QCOMPARE(header.at(154), '\0');
+    QCOMPARE(header.at(155), ' ');
+    bool ok = false;
+    unsigned int stored = header.mid(148, 6).toUInt(&ok, 8);
+    QVERIFY(ok);
+
+    QByteArray blank = header;
+    blank.replace(148, 8, QByteArray(8, ' '));
+    unsigned int expected = 0;
+    for (int i = 0; i < blank.size(); ++i) {
+        expected += static_cast<unsigned char>(blank.at(i));
+    }
+    QCOMPARE(stored, expected);
+}
+
+void TestBatchUploader::ustarLongPath()
+{
+    // 超过100字节的路径在 / 处拆成 prefix 和 name
+    QString dir = QString(120, 'd');
+    QByteArray header = BatchUploader::ustarHeader(makeEntry(dir + "/file.bin", 1, false), 0);
+    QCOMPARE(field(header, 0, 100), QByteArray("file.bin"));
+    QCOMPARE(field(header, 345, 155), dir.toUtf8());
+}
+
+void TestBatchUploader::collectExpandsDirectories()
+{
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    QDir root(temp.path());
+    QVERIFY(root.mkpath("pkg/sub"));
+    QVERIFY(writeFile(root.filePath("pkg/b.txt"), "bb"));
+    QVERIFY(writeFile(root.filePath("pkg/sub/a.txt"), "a"));
+    QVERIFY(writeFile(root.filePath("top.bin"), "1234"));
+
+    // 重复选择同一个文件只保留一次
+    QString error;
+    QList<BatchUploader::Entry> entries = BatchUploader::collectEntries(
+        QStringList() << root.filePath("top.bin") << root.filePath("pkg") << root.filePath("top.bin"), &error);
+    QVERIFY(error.isEmpty());
+    QCOMPARE(entries.size(), 3);
+
+    // 目录保留自身名称作为第一级，结果按相对路径排序
+    QCOMPARE(entries[0].relativePath, QString("pkg/b.txt"));
+    QCOMPARE(entries[1].relativePath, QString("pkg/sub/a.txt"));
+    QCOMPARE(entries[2].relativePath, QString("top.bin"));
+    QCOMPARE(entries[0].size, qint64(2));
+    QCOMPARE(entries[2].size, qint64(4));
+    QCOMPARE(entries[2].localPath, QFileInfo(root.filePath("top.bin")).absoluteFilePath());
+    for (const BatchUploader::Entry &entry : entries) {
+        QVERIFY(!entry.sent);
+        QVERIFY(!entry.verified);
+    }
+}
+
+void TestBatchUploader::collectMissingPath()
+{
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    QDir root(temp.path());
+    QVERIFY(writeFile(root.filePath("a.txt"), "a"));
+
+    QString error;
+    QList<BatchUploader::Entry> entries = BatchUploader::collectEntries(
+        QStringList() << root.filePath("a.txt") << root.filePath("missing.txt"), &error);
+    QVERIFY(entries.isEmpty());
+    QVERIFY(error.contains("missing.txt"));
+}
+
+void TestBatchUploader::collectEmptySelection()
+{
+    // 空目录不上传，没有任何文件时报错
+    QTemporaryDir temp;
+    QVERIFY(temp.isValid());
+    QDir root(temp.path());
+    QVERIFY(root.mkpath("empty"));
+
+    QString error;
+    QVERIFY(BatchUploader::collectEntries(QStringList() << root.filePath("empty"), &error).isEmpty());
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestBatchUploader)
+
+#include "test_batchuploader.moc"
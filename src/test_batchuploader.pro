@@ -0,0 +1,50 @@
+QT += core testlib
+QT -= gui
+
+TARGET = test_batchuploader
+TEMPLATE = app
+
+SOURCES += test_batchuploader.cpp \
+           batchuploader.cpp \
+           digestmanifest.cpp \
+           filedigest.cpp \
+           chunkeduploader.cpp \
+           deltauploader.cpp \
+           rollingchecksum.cpp \
+           multistreamuploader.cpp \
+           streamcompressor.cpp \
+           ratelimiter.cpp \
+           sharedchunksource.cpp \
+           retrypolicy.cpp \
+           sshprocess.cpp \
+           sshutils.cpp
+
+HEADERS += batchuploader.h \
+           digestmanifest.h \
+           filedigest.h \
+           chunkeduploader.h \
+           deltauploader.h \
+           rollingchecksum.h \
+           multistreamuploader.h \
+           streamcompressor.h \
+           ratelimiter.h \
+           sharedchunksource.h \
+           retrypolicy.h \
+           sshprocess.h \
+           sshutils.h
+
+# 输出目录（输出到上级目录的bin文件夹）
+DESTDIR = $$PWD/../bin
+OBJECTS_DIR = $$PWD/../build/obj/test_batchuploader
+MOC_DIR = $$PWD/../build/moc/test_batchuploader
+RCC_DIR = $$PWD/../build/rcc/test_batchuploader
+UI_DIR = $$PWD/../build/ui/test_batchuploader
+
+# 创建必要的目录
+!exists($$DESTDIR): system(mkdir $$shell_path($$DESTDIR))
+!exists($$OBJECTS_DIR): system(mkdir $$shell_path($$OBJECTS_DIR))
+!exists($$MOC_DIR): system(mkdir $$shell_path($$MOC_DIR))
+!exists($$RCC_DIR): system(mkdir $$shell_path($$RCC_DIR))
+
+CONFIG += console testcase
+CONFIG += c++11
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+ * @File Name: test_chunkeduploader.cpp
+ * @brief  测试分块上传的远程探测输出解析和"远程已有相同文件"判断
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "chunkeduploader.h"
+
+static const char *FILE_MD5 = "0123456789abcdef0123456789abcdef";
+
+class TestChunkedUploader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseFullProbe();
+    void parseEmptyProbe();
+    void parseProbeWithoutManifest();
+    void remoteIdentical_data();
+    void remoteIdentical();
+};
+
+// 与 ChunkedUploader::start() 中探测命令的输出顺序一致
+static QString probeOutput(const QString &manifest, qint64 partSize, qint64 finalSize,
+                           const QString &md5Line, const QString &ranges, bool gzip)
+{
+    QString output = manifest;
+    output += QString("@@PART_SIZE\n%1\n").arg(partSize);
+    output += QString("@@FINAL\n%1\n").arg(finalSize);
+    if (!md5Line.isEmpty()) {
+        output += md5Line + "\n";
+    }
+    output += "@@RANGES\n" + ranges;
+    if (gzip) {
+        output += "@@GZIP\n";
+    }
+    return output;
+}
+
+void TestChunkedUploader::parseFullProbe()
+{
+    QString output = probeOutput("pkg.tar.gz:1048576:1700000000000:4194304\n", 8388608, 1048576,
+                                 "0123456789ABCDEF0123456789ABCDEF  /opt/update/pkg.tar.gz",
+                                 "4-8 16777216\n8-16 0\n", true);
+
+    ChunkedUploader::ProbeResult probe = ChunkedUploader::parseProbeOutput(output);
+    QVERIFY(probe.hasPart);
+    QCOMPARE(probe.identity, QString("pkg.tar.gz:1048576:1700000000000:4194304"));
+    QCOMPARE(probe.partSize, qint64(8388608));
+    QVERIFY(probe.hasFinal);
+    QCOMPARE(probe.finalSize, qint64(1048576));
+    QCOMPARE(probe.finalMd5, QString(FILE_MD5));
+    QVERIFY(probe.rangesSection.contains("4-8 16777216"));
+    QVERIFY(probe.rangesSection.contains("8-16 0"));
+    QVERIFY(!probe.rangesSection.contains("@@GZIP"));
+    QVERIFY(probe.hasGzip);
+}
+
+void TestChunkedUploader::parseEmptyProbe()
+{
+    ChunkedUploader::ProbeResult probe = ChunkedUploader::parseProbeOutput(QString());
+    QVERIFY(!probe.hasPart);
+    QVERIFY(!probe.hasFinal);
+    QVERIFY(!probe.hasGzip);
+    QCOMPARE(probe.partSize, qint64(0));
+    QCOMPARE(probe.finalSize, qint64(0));
+    QVERIFY(probe.finalMd5.isEmpty());
+    QVERIFY(probe.rangesSection.isEmpty());
+}
+
+void TestChunkedUploader::parseProbeWithoutManifest()
+{
+    // 首次上传：没有清单和 .part，目标文件也不存在
+    ChunkedUploader::ProbeResult probe = ChunkedUploader::parseProbeOutput(probeOutput(QString(), 0, 0, QString(), QString(), false));
+    QVERIFY(probe.hasPart);
+    QVERIFY(probe.identity.isEmpty());
+    QCOMPARE(probe.partSize, qint64(0));
+    QVERIFY(probe.hasFinal);
+    QCOMPARE(probe.finalSize, qint64(0));
+    QVERIFY(probe.finalMd5.isEmpty());
+    QVERIFY(!probe.hasGzip);
+}
+
+void TestChunkedUploader::remoteIdentical_data()
+{
+    QTest::addColumn<qint64>("remoteSize");
+    QTest::addColumn<QString>("md5Line");
+    QTest::addColumn<QString>("expectedMd5");
+    QTest::addColumn<bool>("identical");
+
+    QString md5Line = QString("%1  /opt/update/pkg.tar.gz").arg(FILE_MD5);
+    QTest::newRow("相同") << qint64(1000) << md5Line << QString(FILE_MD5) << true;
+    QTest::newRow("本地MD5为大写") << qint64(1000) << md5Line << QString(FILE_MD5).toUpper() << true;
+    QTest::newRow("大小不同") << qint64(999) << md5Line << QString(FILE_MD5) << false;
+    QTest::newRow("MD5不同") << qint64(1000) << QString("ffffffffffffffffffffffffffffffff  /opt/update/pkg.tar.gz")
+                            << QString(FILE_MD5) << false;
+    QTest::newRow("远程未计算MD5") << qint64(1000) << QString() << QString(FILE_MD5) << false;
+    QTest::newRow("本地MD5未知") << qint64(1000) << md5Line << QString() << false;
+}
+
+void TestChunkedUploader::remoteIdentical()
+{
+    QFETCH(qint64, remoteSize);
+    QFETCH(QString, md5Line);
+    QFETCH(QString, expectedMd5);
+    QFETCH(bool, identical);
+
+    ChunkedUploader::ProbeResult probe =
+        ChunkedUploader::parseProbeOutput(probeOutput(QString(), 0, remoteSize, md5Line, QString(), false));
+    QCOMPARE(ChunkedUploader::isRemoteIdentical(probe, 1000, expectedMd5), identical);
+}
+
+QTEST_GUILESS_MAIN(TestChunkedUploader)
+
+#include "test_chunkeduploader.moc"
@@ -0,0 +1,88 @@
+/**
+ * @File Name: test_deltauploader.cpp
+ * @brief  测试增量上传重建脚本：复用段从旧文件拷贝，发送段从差异数据文件按对齐位置拷贝，不读取标准输入
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "deltauploader.h"
+
+static const qint64 BLOCK = 64 * 1024;
+static const qint64 ALIGN = DeltaUploader::LITERAL_ALIGNMENT;
+
+class TestDeltaUploader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void storedLength_data();
+    void storedLength();
+    void scriptCopiesEachRange();
+    void scriptDoesNotReadStdin();
+};
+
+static DeltaUploader::Range range(bool fromBase, qint64 srcOffset, qint64 dstOffset, qint64 length)
+{
+    DeltaUploader::Range result = { fromBase, srcOffset, dstOffset, length };
+    return result;
+}
+
+void TestDeltaUploader::storedLength_data()
+{
+    QTest::addColumn<qint64>("length");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("one byte") << qint64(1) << ALIGN;
+    QTest::newRow("aligned") << ALIGN << ALIGN;
+    QTest::newRow("one over") << ALIGN + 1 << 2 * ALIGN;
+}
+
+void TestDeltaUploader::storedLength()
+{
+    QFETCH(qint64, length);
+    QFETCH(qint64, expected);
+
+    QCOMPARE(DeltaUploader::storedLength(length), expected);
+}
+
+void TestDeltaUploader::scriptCopiesEachRange()
+{
+    // 新文件：100 字节新数据 + 旧文件第2块 + 2 个对齐单位的新数据 + 旧文件最后的不完整块
+    QVector<DeltaUploader::Range> ranges;
+    ranges << range(false, 0, 0, 100)
+           << range(true, 2 * BLOCK, 100, BLOCK)
+           << range(false, 100 + BLOCK, 100 + BLOCK, 2 * ALIGN)
+           << range(true, 5 * BLOCK, 100 + BLOCK + 2 * ALIGN, 300);
+    qint64 total = 100 + BLOCK + 2 * ALIGN + 300;
+
+    QStringList lines = DeltaUploader::buildScript("/opt/app.bin", ranges, BLOCK, total).split('\n');
+    QCOMPARE(lines.first(), QString("set -e"));
+    QVERIFY(lines.contains("dd if='/opt/app.bin.delta.lit' bs=4096 skip=0 count=1 2>/dev/null | head -c 100"));
+    QVERIFY(lines.contains("dd if='/opt/app.bin' bs=65536 skip=2 count=1 2>/dev/null"));
+    // 第一段发送数据补齐后占1个对齐单位，第二段从第1个对齐单位开始，长度已对齐，不需要截取
+    QVERIFY(lines.contains("dd if='/opt/app.bin.delta.lit' bs=4096 skip=1 count=2 2>/dev/null"));
+    QVERIFY(lines.contains("dd if='/opt/app.bin' bs=65536 skip=5 count=1 2>/dev/null"));
+    QVERIFY(lines.contains(QString("[ $(wc -c < '/opt/app.bin.delta.new') -eq %1 ]").arg(total)));
+    QCOMPARE(lines.last(), QString("mv -f '/opt/app.bin.delta.new' '/opt/app.bin'"));
+}
+
+void TestDeltaUploader::scriptDoesNotReadStdin()
+{
+    QVector<DeltaUploader::Range> ranges;
+    ranges << range(false, 0, 0, 10) << range(true, 0, 10, BLOCK) << range(false, 10 + BLOCK, 10 + BLOCK, 5);
+
+    const QStringList lines = DeltaUploader::buildScript("/opt/app.bin", ranges, BLOCK, 15 + BLOCK).split('\n');
+    for (const QString &line : lines) {
+        // head -c 只允许截取同一行 dd 的输出
+        if (line.contains("head -c")) {
+            QVERIFY(line.startsWith("dd if="));
+        }
+        QVERIFY(!line.startsWith("cat") && !line.startsWith("read"));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestDeltaUploader)
+#include "test_deltauploader.moc"
@@ -0,0 +1,113 @@
+/**
+ * @File Name: test_digestmanifest.cpp
+ * @brief  测试远程摘要清单的结果解析和远程命令生成
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "digestmanifest.h"
+
+static const char *MD5_A = "d41d8cd98f00b204e9800998ecf8427e";
+static const char *MD5_B = "9e107d9d372bb6826bd81d3542a419d6";
+
+class TestDigestManifest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseAllStatuses();
+    void parseIncomplete();
+    void parseIgnoresNoise();
+    void parseResetsPreviousResult();
+    void remoteCommand();
+};
+
+void TestDigestManifest::parseAllStatuses()
+{
+    DigestManifest manifest;
+    manifest.addFile("bin/app", MD5_A);
+    manifest.addFile("lib/lib with space.so", QString(MD5_B).toUpper());
+    manifest.addFile("etc/missing.conf", MD5_A);
+
+    QByteArray output = QByteArray("@@DIGEST 0 ") + MD5_A + "\n"
+                        + "@@DIGEST 1 " + QByteArray(MD5_A).toUpper() + "\n"
+                        + "@@DIGEST 2 -\n";
+    QVERIFY(manifest.parseOutput(output));
+
+    const QList<DigestManifest::Item> &items = manifest.items();
+    QCOMPARE(items[0].status, DigestManifest::StatusMatched);
+    QCOMPARE(items[1].status, DigestManifest::StatusMismatched);
+    QCOMPARE(items[1].actual, QString(MD5_A));
+    QCOMPARE(items[2].status, DigestManifest::StatusMissing);
+    QVERIFY(items[2].actual.isEmpty());
+
+    QCOMPARE(manifest.count(DigestManifest::StatusMatched), 1);
+    QVERIFY(!manifest.allMatched());
+    QCOMPARE(manifest.failedItems().size(), 2);
+}
+
+void TestDigestManifest::parseIncomplete()
+{
+    // 远程在中途断开：未返回的条目保持 Pending
+    DigestManifest manifest;
+    manifest.addFile("a", MD5_A);
+    manifest.addFile("b", MD5_B);
+    QVERIFY(!manifest.parseOutput(QByteArray("@@DIGEST 0 ") + MD5_A + "\n"));
+    QCOMPARE(manifest.items()[0].status, DigestManifest::StatusMatched);
+    QCOMPARE(manifest.items()[1].status, DigestManifest::StatusPending);
+    QVERIFY(!manifest.allMatched());
+}
+
+void TestDigestManifest::parseIgnoresNoise()
+{
+    DigestManifest manifest;
+    manifest.addFile("a", MD5_A);
+
+    // 登录横幅、越界序号、字段数不对和 CRLF 行尾都不影响结果
+    QByteArray output = QByteArray("Welcome to device\r\n")
+                        + "@@DIGEST 5 " + MD5_B + "\n"
+                        + "@@DIGEST -1 " + MD5_B + "\n"
+                        + "@@DIGEST x " + MD5_B + "\n"
+                        + "@@DIGEST 0 " + MD5_B + " extra\n"
+                        + "@@DIGEST 0 " + MD5_A + "\r\n";
+    QVERIFY(manifest.parseOutput(output));
+    QVERIFY(manifest.allMatched());
+}
+
+void TestDigestManifest::parseResetsPreviousResult()
+{
+    DigestManifest manifest;
+    manifest.addFile("a", MD5_A);
+    QVERIFY(manifest.parseOutput(QByteArray("@@DIGEST 0 ") + MD5_A + "\n"));
+    QVERIFY(manifest.allMatched());
+
+    // 再次解析（例如重试后）不沿用上一次的结果
+    QVERIFY(!manifest.parseOutput(QByteArray()));
+    QCOMPARE(manifest.items()[0].status, DigestManifest::StatusPending);
+    QVERIFY(manifest.items()[0].actual.isEmpty());
+}
+
+void TestDigestManifest::remoteCommand()
+{
+    DigestManifest manifest;
+    manifest.setBaseDirectory("/opt/update dir");
+    manifest.setAlgorithm(FileDigest::Xxh64);
+    manifest.addFile("a.bin", QString());
+    manifest.addFile("b.bin", QString());
+
+    QString command = manifest.remoteCommand();
+    QVERIFY(command.startsWith("cd '/opt/update dir' || exit 1\n"));
+    QVERIFY(command.contains(FileDigest::remoteCommand(FileDigest::Xxh64)));
+    QVERIFY(command.contains("a.bin\nb.bin\n"));
+    QCOMPARE(manifest.pathList(), QByteArray("a.bin\nb.bin\n"));
+
+    // 标准输入方式不内嵌清单
+    QVERIFY(!manifest.streamingCommand().contains("a.bin"));
+}
+
+QTEST_GUILESS_MAIN(TestDigestManifest)
+
+#include "test_digestmanifest.moc"
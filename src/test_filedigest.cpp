@@ -0,0 +1,187 @@
+/**
+ * @File Name: test_filedigest.cpp
+ * @brief  测试文件摘要：XXH64 已知结果、分段输入与一次输入结果一致、MD5/SHA-256 结果，以及与设备协商摘要算法
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "filedigest.h"
+
+// 与 filedigest.cpp 中协商输出的标记一致
+static const char *TOOL_MARKER = "@@DIGEST_TOOL";
+
+// 内容随偏移变化，跨越多个32字节条带和不对齐的尾部
+static QByteArray patternData(int size)
+{
+    QByteArray data;
+    data.resize(size);
+    for (int i = 0; i < size; ++i) {
+        data[i] = static_cast<char>((i * 7 + i / 251) & 0xff);
+    }
+    return data;
+}
+
+static QByteArray probeOutput(const QStringList &tools)
+{
+    QByteArray output;
+    for (const QString &tool : tools) {
+        output += QByteArray(TOOL_MARKER) + " " + tool.toLatin1() + "\n";
+    }
+    return output;
+}
+
+static QString digestOf(FileDigest::Algorithm algorithm, const QByteArray &data)
+{
+    FileDigest digest(algorithm);
+    digest.addData(data);
+    return digest.resultHex();
+}
+
+class TestFileDigest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void xxh64KnownAnswers_data();
+    void xxh64KnownAnswers();
+    void xxh64SplitFeeding_data();
+    void xxh64SplitFeeding();
+    void resetStartsOver();
+    void cryptoAlgorithms();
+    void algorithmNames();
+    void negotiate_data();
+    void negotiate();
+};
+
+void TestFileDigest::xxh64KnownAnswers_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QString>("expected");
+
+    // 结果与 xxhsum -H1 的输出一致（种子为0）
+    QTest::newRow("空") << QByteArray() << QString("ef46db3751d8e999");
+    QTest::newRow("a") << QByteArray("a") << QString("d24ec4f1a98c6e5b");
+    QTest::newRow("abc") << QByteArray("abc") << QString("44bc2cf5ad770999");
+    QTest::newRow("39字节") << QByteArray("Nobody inspects the spammish repetition") << QString("fbcea83c8a378bf1");
+    QTest::newRow("1000个a") << QByteArray(1000, 'a') << QString("56e43b712eda4223");
+    QTest::newRow("100000字节") << patternData(100000) << QString("4316421af31ed0c2");
+}
+
+void TestFileDigest::xxh64KnownAnswers()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QString, expected);
+
+    QCOMPARE(digestOf(FileDigest::Xxh64, data), expected);
+}
+
+void TestFileDigest::xxh64SplitFeeding_data()
+{
+    QTest::addColumn<int>("pieceSize");
+
+    // 小于、等于、跨越32字节条带的分段
+    QTest::newRow("1") << 1;
+    QTest::newRow("7") << 7;
+    QTest::newRow("31") << 31;
+    QTest::newRow("32") << 32;
+    QTest::newRow("33") << 33;
+    QTest::newRow("4099") << 4099;
+}
+
+void TestFileDigest::xxh64SplitFeeding()
+{
+    QFETCH(int, pieceSize);
+
+    QByteArray data = patternData(100000);
+    FileDigest digest(FileDigest::Xxh64);
+    for (int offset = 0; offset < data.size(); offset += pieceSize) {
+        int length = qMin(pieceSize, data.size() - offset);
+        digest.addData(data.constData() + offset, length);
+    }
+    QCOMPARE(digest.resultHex(), QString("4316421af31ed0c2"));
+}
+
+void TestFileDigest::resetStartsOver()
+{
+    for (FileDigest::Algorithm algorithm : {FileDigest::Md5, FileDigest::Sha256, FileDigest::Xxh64}) {
+        FileDigest digest(algorithm);
+        digest.addData(QByteArray("stale data"));
+        digest.reset();
+        digest.addData(QByteArray("abc"));
+        QCOMPARE(digest.resultHex(), digestOf(algorithm, QByteArray("abc")));
+    }
+}
+
+void TestFileDigest::cryptoAlgorithms()
+{
+    QByteArray data = patternData(70000);
+    FileDigest md5(FileDigest::Md5);
+    FileDigest sha256(FileDigest::Sha256);
+    for (int offset = 0; offset < data.size(); offset += 4099) {
+        int length = qMin(4099, data.size() - offset);
+        md5.addData(data.constData() + offset, length);
+        sha256.addData(data.constData() + offset, length);
+    }
+    QCOMPARE(md5.resultHex(), QString(QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex()));
+    QCOMPARE(sha256.resultHex(), QString(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex()));
+}
+
+void TestFileDigest::algorithmNames()
+{
+    for (FileDigest::Algorithm algorithm : {FileDigest::Md5, FileDigest::Sha256, FileDigest::Xxh64}) {
+        FileDigest::Algorithm parsed = FileDigest::Md5;
+        QVERIFY(FileDigest::fromName(FileDigest::algorithmName(algorithm), &parsed));
+        QCOMPARE(parsed, algorithm);
+        QCOMPARE(FileDigest(algorithm).algorithm(), algorithm);
+    }
+
+    FileDigest::Algorithm parsed = FileDigest::Md5;
+    QVERIFY(FileDigest::fromName(" XXH64 ", &parsed));
+    QCOMPARE(parsed, FileDigest::Xxh64);
+    QVERIFY(!FileDigest::fromName("auto", &parsed));
+    QVERIFY(!FileDigest::fromName("crc32", &parsed));
+}
+
+void TestFileDigest::negotiate_data()
+{
+    QTest::addColumn<QString>("preference");
+    QTest::addColumn<QByteArray>("probe");
+    QTest::addColumn<int>("expected");
+    QTest::addColumn<bool>("hasNote");
+
+    QByteArray all = probeOutput(QStringList() << "xxhsum" << "sha256sum" << "md5sum");
+    QByteArray common = probeOutput(QStringList() << "sha256sum" << "md5sum");
+
+    QTest::newRow("自动-有xxhsum") << QString("auto") << all << int(FileDigest::Xxh64) << false;
+    // 没有 xxhsum 时保持 MD5，不自动换成更慢的 SHA-256
+    QTest::newRow("自动-无xxhsum") << QString("auto") << common << int(FileDigest::Md5) << false;
+    QTest::newRow("自动-无工具") << QString("auto") << QByteArray() << int(FileDigest::Md5) << true;
+    QTest::newRow("指定sha256") << QString("sha256") << common << int(FileDigest::Sha256) << false;
+    QTest::newRow("指定sha256-不可用") << QString("sha256") << probeOutput(QStringList() << "md5sum")
+                                      << int(FileDigest::Md5) << true;
+    QTest::newRow("指定xxh64-不可用") << QString("xxh64") << common << int(FileDigest::Md5) << true;
+    QTest::newRow("指定md5") << QString("md5") << all << int(FileDigest::Md5) << false;
+    // 登录提示等无关输出和 CRLF 换行不影响解析
+    QTest::newRow("夹杂其他输出") << QString("auto")
+                            << QByteArray("Welcome\r\n") + QByteArray(TOOL_MARKER) + " xxhsum\r\n"
+                            << int(FileDigest::Xxh64) << false;
+}
+
+void TestFileDigest::negotiate()
+{
+    QFETCH(QString, preference);
+    QFETCH(QByteArray, probe);
+    QFETCH(int, expected);
+    QFETCH(bool, hasNote);
+
+    QString note;
+    QCOMPARE(int(FileDigest::negotiate(preference, probe, &note)), expected);
+    QCOMPARE(!note.isEmpty(), hasNote);
+}
+
+QTEST_GUILESS_MAIN(TestFileDigest)
+
+#include "test_filedigest.moc"
@@ -0,0 +1,26 @@
+QT += core testlib
+QT -= gui
+
+TARGET = test_filedigest
+TEMPLATE = app
+
+SOURCES += test_filedigest.cpp \
+           filedigest.cpp
+
+HEADERS += filedigest.h
+
+# 输出目录（输出到上级目录的bin文件夹）
+DESTDIR = $$PWD/../bin
+OBJECTS_DIR = $$PWD/../build/obj/test_filedigest
+MOC_DIR = $$PWD/../build/moc/test_filedigest
+RCC_DIR = $$PWD/../build/rcc/test_filedigest
+UI_DIR = $$PWD/../build/ui/test_filedigest
+
+# 创建必要的目录
+!exists($$DESTDIR): system(mkdir $$shell_path($$DESTDIR))
+!exists($$OBJECTS_DIR): system(mkdir $$shell_path($$OBJECTS_DIR))
+!exists($$MOC_DIR): system(mkdir $$shell_path($$MOC_DIR))
+!exists($$RCC_DIR): system(mkdir $$shell_path($$RCC_DIR))
+
+CONFIG += console testcase
+CONFIG += c++11
\ No newline at end of file
@@ -0,0 +1,139 @@
+/**
+ * @File Name: test_multistreamuploader.cpp
+ * @brief  测试并行上传的分段划分、分段文件命名和远程残留分段的解析
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "multistreamuploader.h"
+
+static const qint64 CHUNK = 4 * 1024 * 1024;
+
+class TestMultiStreamUploader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitFromStart();
+    void splitResumed();
+    void splitLimitedByChunks();
+    void suffix();
+    void parseRoundTrip();
+    void parsePartialRange();
+    void parseRejects_data();
+    void parseRejects();
+};
+
+void TestMultiStreamUploader::splitFromStart()
+{
+    // 11 块（最后一块不满）分给 4 路：3、3、3、2
+    qint64 total = 10 * CHUNK + 100;
+    QList<MultiStreamUploader::Range> ranges = MultiStreamUploader::splitRanges(0, total, CHUNK, 4);
+    QCOMPARE(ranges.size(), 4);
+    QCOMPARE(ranges[0].begin, qint64(0));
+    QCOMPARE(ranges[0].end, 3 * CHUNK);
+    QCOMPARE(ranges[1].begin, 3 * CHUNK);
+    QCOMPARE(ranges[1].end, 6 * CHUNK);
+    QCOMPARE(ranges[2].end, 9 * CHUNK);
+    QCOMPARE(ranges[3].begin, 9 * CHUNK);
+    QCOMPARE(ranges[3].end, total);
+    for (const MultiStreamUploader::Range &range : ranges) {
+        QCOMPARE(range.landed, qint64(0));
+    }
+}
+
+void TestMultiStreamUploader::splitResumed()
+{
+    // 第0段从文件开头算起，已落盘的部分计入 landed
+    QList<MultiStreamUploader::Range> ranges = MultiStreamUploader::splitRanges(2 * CHUNK, 10 * CHUNK, CHUNK, 3);
+    QCOMPARE(ranges.size(), 3);
+    QCOMPARE(ranges[0].begin, qint64(0));
+    QCOMPARE(ranges[0].end, 5 * CHUNK);
+    QCOMPARE(ranges[0].landed, 2 * CHUNK);
+    QCOMPARE(ranges[1].begin, 5 * CHUNK);
+    QCOMPARE(ranges[1].end, 8 * CHUNK);
+    QCOMPARE(ranges[2].end, 10 * CHUNK);
+}
+
+void TestMultiStreamUploader::splitLimitedByChunks()
+{
+    // 分块数少于请求的路数时每路至少一块
+    QList<MultiStreamUploader::Range> ranges = MultiStreamUploader::splitRanges(0, 2 * CHUNK, CHUNK, 8);
+    QCOMPARE(ranges.size(), 2);
+    QCOMPARE(ranges[1].begin, CHUNK);
+    QCOMPARE(ranges[1].end, 2 * CHUNK);
+}
+
+void TestMultiStreamUploader::suffix()
+{
+    MultiStreamUploader::Range range;
+    range.begin = 3 * CHUNK;
+    range.end = 6 * CHUNK;
+    range.landed = 0;
+    QCOMPARE(MultiStreamUploader::rangeSuffix(range, CHUNK), QString(".r3-6"));
+
+    // 最后一段不满一块时按向上取整的分块号命名
+    range.begin = 9 * CHUNK;
+    range.end = 10 * CHUNK + 100;
+    QCOMPARE(MultiStreamUploader::rangeSuffix(range, CHUNK), QString(".r9-11"));
+}
+
+void TestMultiStreamUploader::parseRoundTrip()
+{
+    qint64 total = 10 * CHUNK + 100;
+    QList<MultiStreamUploader::Range> ranges = MultiStreamUploader::splitRanges(0, total, CHUNK, 4);
+
+    // 模拟探测输出：第1段及以后的分段都已写完
+    QString section;
+    for (int i = 1; i < ranges.size(); ++i) {
+        section += QString("%1 %2\n").arg(MultiStreamUploader::rangeSuffix(ranges[i], CHUNK).mid(2))
+                                     .arg(ranges[i].end - ranges[i].begin);
+    }
+
+    QList<MultiStreamUploader::Range> parsed = MultiStreamUploader::parseRemoteRanges(section, total, CHUNK);
+    QCOMPARE(parsed.size(), ranges.size() - 1);
+    for (int i = 0; i < parsed.size(); ++i) {
+        QCOMPARE(parsed[i].begin, ranges[i + 1].begin);
+        QCOMPARE(parsed[i].end, ranges[i + 1].end);
+        QCOMPARE(parsed[i].landed, ranges[i + 1].end - ranges[i + 1].begin);
+    }
+}
+
+void TestMultiStreamUploader::parsePartialRange()
+{
+    // 输出顺序不影响结果；未写完的段按分块向下取整
+    QString section = QString("6-10 %1\n3-6 %2\n").arg(CHUNK + CHUNK / 2).arg(3 * CHUNK);
+    QList<MultiStreamUploader::Range> parsed = MultiStreamUploader::parseRemoteRanges(section, 10 * CHUNK, CHUNK);
+    QCOMPARE(parsed.size(), 2);
+    QCOMPARE(parsed[0].begin, 3 * CHUNK);
+    QCOMPARE(parsed[0].landed, 3 * CHUNK);
+    QCOMPARE(parsed[1].begin, 6 * CHUNK);
+    QCOMPARE(parsed[1].landed, CHUNK);
+}
+
+void TestMultiStreamUploader::parseRejects_data()
+{
+    QTest::addColumn<QString>("section");
+
+    QTest::newRow("空") << QString();
+    QTest::newRow("不相接") << QString("3-5 0\n6-10 0\n");
+    QTest::newRow("未到文件末尾") << QString("3-6 0\n6-9 0\n");
+    QTest::newRow("包含第0段") << QString("0-3 0\n3-10 0\n");
+    QTest::newRow("结束不大于起始") << QString("6-6 0\n");
+    QTest::newRow("缺少大小") << QString("3-10\n");
+    QTest::newRow("非数字") << QString("3-x 0\n");
+    QTest::newRow("通配符未展开") << QString("* 0\n");
+}
+
+void TestMultiStreamUploader::parseRejects()
+{
+    QFETCH(QString, section);
+    QVERIFY(MultiStreamUploader::parseRemoteRanges(section, 10 * CHUNK, CHUNK).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestMultiStreamUploader)
+
+#include "test_multistreamuploader.moc"
@@ -0,0 +1,44 @@
+QT += core testlib
+QT -= gui
+
+TARGET = test_multistreamuploader
+TEMPLATE = app
+
+SOURCES += test_multistreamuploader.cpp \
+           multistreamuploader.cpp \
+           chunkeduploader.cpp \
+           deltauploader.cpp \
+           rollingchecksum.cpp \
+           streamcompressor.cpp \
+           ratelimiter.cpp \
+           sharedchunksource.cpp \
+           retrypolicy.cpp \
+           sshprocess.cpp \
+           sshutils.cpp
+
+HEADERS += multistreamuploader.h \
+           chunkeduploader.h \
+           deltauploader.h \
+           rollingchecksum.h \
+           streamcompressor.h \
+           ratelimiter.h \
+           sharedchunksource.h \
+           retrypolicy.h \
+           sshprocess.h \
+           sshutils.h
+
+# 输出目录（输出到上级目录的bin文件夹）
+DESTDIR = $$PWD/../bin
+OBJECTS_DIR = $$PWD/../build/obj/test_multistreamuploader
+MOC_DIR = $$PWD/../build/moc/test_multistreamuploader
+RCC_DIR = $$PWD/../build/rcc/test_multistreamuploader
+UI_DIR = $$PWD/../build/ui/test_multistreamuploader
+
+# 创建必要的目录
+!exists($$DESTDIR): system(mkdir $$shell_path($$DESTDIR))
+!exists($$OBJECTS_DIR): system(mkdir $$shell_path($$OBJECTS_DIR))
+!exists($$MOC_DIR): system(mkdir $$shell_path($$MOC_DIR))
+!exists($$RCC_DIR): system(mkdir $$shell_path($$RCC_DIR))
+
+CONFIG += console testcase
+CONFIG += c++11
\ No newline at end of file
@@ -0,0 +1,147 @@
+/**
+ * @File Name: test_ratelimiter.cpp
+ * @brief  测试上传限速令牌桶的令牌补充、桶容量、退回令牌、排队顺序、上级限速和限速时段
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "ratelimiter.h"
+
+static const qint64 RATE = 1024 * 1024;
+// 桶容量为0.2秒的数据量，见 ratelimiter.cpp
+static const qint64 BURST = RATE / 5;
+
+class TestRateLimiter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void unlimited();
+    void refillAfterWait();
+    void burstCap();
+    void releaseReturnsTokens();
+    void queueOrder();
+    void upstreamLimits();
+    void activeWindow();
+};
+
+void TestRateLimiter::unlimited()
+{
+    RateLimiter limiter;
+    QVERIFY(!limiter.isLimiting());
+    int consumer = limiter.attach();
+    QCOMPARE(limiter.acquire(consumer, 123456), qint64(123456));
+    QCOMPARE(limiter.acquire(consumer, 0), qint64(0));
+}
+
+void TestRateLimiter::refillAfterWait()
+{
+    RateLimiter limiter;
+    limiter.setRate(RATE);
+    QVERIFY(limiter.isLimiting());
+    int consumer = limiter.attach();
+
+    // 第一次申请时才开始计时，桶是空的
+    QCOMPARE(limiter.acquire(consumer, RATE), qint64(0));
+
+    QTest::qSleep(100);
+    qint64 allowed = limiter.acquire(consumer, RATE);
+    QVERIFY(allowed > 0);
+    QVERIFY(allowed <= BURST);
+
+    // 刚取走全部令牌，立即再次申请只能得到这段极短时间内补充的令牌
+    QVERIFY(limiter.acquire(consumer, RATE) < allowed);
+}
+
+void TestRateLimiter::burstCap()
+{
+    RateLimiter limiter;
+    limiter.setRate(RATE);
+    int consumer = limiter.attach();
+    QCOMPARE(limiter.acquire(consumer, RATE), qint64(0));
+
+    // 等待时间远超0.2秒，令牌也不超过桶容量
+    QTest::qSleep(500);
+    QCOMPARE(limiter.acquire(consumer, RATE), BURST);
+}
+
+void TestRateLimiter::releaseReturnsTokens()
+{
+    RateLimiter limiter;
+    limiter.setRate(RATE);
+    int consumer = limiter.attach();
+    QCOMPARE(limiter.acquire(consumer, RATE), qint64(0));
+    QTest::qSleep(300);
+    QCOMPARE(limiter.acquire(consumer, RATE), BURST);
+
+    // 压缩后实际发送的更少，退回的令牌可以立即再用
+    limiter.release(4096);
+    QCOMPARE(limiter.acquire(consumer, 4096), qint64(4096));
+}
+
+void TestRateLimiter::queueOrder()
+{
+    RateLimiter limiter;
+    limiter.setRate(RATE);
+    int first = limiter.attach();
+    int second = limiter.attach();
+
+    QCOMPARE(limiter.acquire(first, 1000), qint64(0));
+    QCOMPARE(limiter.acquire(second, 1000), qint64(0));
+    QTest::qSleep(60);
+
+    // 有令牌时也先让排在前面的使用者发送
+    QCOMPARE(limiter.acquire(second, 1000), qint64(0));
+    QCOMPARE(limiter.acquire(first, 1000), qint64(1000));
+    QCOMPARE(limiter.acquire(second, 1000), qint64(1000));
+    limiter.detach(first);
+    limiter.detach(second);
+}
+
+void TestRateLimiter::upstreamLimits()
+{
+    RateLimiter global;
+    global.setRate(RATE);
+    RateLimiter device;
+    device.setUpstream(&global);
+    QVERIFY(device.isLimiting());
+
+    // 设备本身不限速时由全局限速器决定
+    int consumer = device.attach();
+    QCOMPARE(device.acquire(consumer, RATE), qint64(0));
+    QTest::qSleep(300);
+    QCOMPARE(device.acquire(consumer, RATE), BURST);
+
+    // 两级都限速时取较小的一级
+    device.setRate(RATE / 4);
+    QCOMPARE(device.acquire(consumer, RATE), qint64(0));
+    QTest::qSleep(300);
+    qint64 allowed = device.acquire(consumer, RATE);
+    QCOMPARE(allowed, qMax(RATE / 4 / 5, qint64(16 * 1024)));
+}
+
+void TestRateLimiter::activeWindow()
+{
+    RateLimiter limiter;
+    limiter.setRate(RATE);
+    QTime now = QTime::currentTime();
+
+    limiter.setActiveWindow(now.addSecs(3600), now.addSecs(7200));
+    QVERIFY(!limiter.isLimiting());
+    int consumer = limiter.attach();
+    QCOMPARE(limiter.acquire(consumer, RATE), RATE);
+
+    limiter.setActiveWindow(now.addSecs(-3600), now.addSecs(3600));
+    QVERIFY(limiter.isLimiting());
+
+    // 起止时间相同表示全天限速
+    limiter.setActiveWindow(now, now);
+    QVERIFY(limiter.isLimiting());
+}
+
+QTEST_GUILESS_MAIN(TestRateLimiter)
+
+#include "test_ratelimiter.moc"
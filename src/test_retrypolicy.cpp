@@ -0,0 +1,134 @@
+/**
+ * @File Name: test_retrypolicy.cpp
+ * @brief  测试重试策略的失败分类、各类别是否重试、重试次数上限和退避间隔
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "retrypolicy.h"
+
+class TestRetryPolicy : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void classify_data();
+    void classify();
+    void retryByClass();
+    void remoteRetryOptIn();
+    void attemptLimit();
+    void delayBounds();
+};
+
+void TestRetryPolicy::classify_data()
+{
+    QTest::addColumn<int>("exitCode");
+    // 枚举按 int 保存，数据表不依赖元类型注册
+    QTest::addColumn<int>("exitStatus");
+    QTest::addColumn<QString>("errorText");
+    QTest::addColumn<int>("processError");
+    QTest::addColumn<int>("expected");
+
+    QTest::newRow("成功") << 0 << int(QProcess::NormalExit) << QString() << int(QProcess::UnknownError) << int(RetryPolicy::ErrorNone);
+    QTest::newRow("连接超时") << 255 << int(QProcess::NormalExit)
+        << QString("ssh: connect to host 192.168.1.10 port 22: Connection timed out")
+        << int(QProcess::UnknownError) << int(RetryPolicy::ErrorNetwork);
+    QTest::newRow("连接被重置") << 255 << int(QProcess::NormalExit)
+        << QString("Connection reset by peer") << int(QProcess::UnknownError) << int(RetryPolicy::ErrorNetwork);
+    QTest::newRow("无错误输出") << 255 << int(QProcess::NormalExit) << QString() << int(QProcess::UnknownError) << int(RetryPolicy::ErrorNetwork);
+    QTest::newRow("密码错误") << 255 << int(QProcess::NormalExit)
+        << QString("root@192.168.1.10: Permission denied (publickey,password).")
+        << int(QProcess::UnknownError) << int(RetryPolicy::ErrorAuth);
+    QTest::newRow("主机密钥") << 255 << int(QProcess::NormalExit)
+        << QString("Host key verification failed.") << int(QProcess::UnknownError) << int(RetryPolicy::ErrorAuth);
+    QTest::newRow("远程命令失败") << 1 << int(QProcess::NormalExit)
+        << QString("tar: invalid magic") << int(QProcess::UnknownError) << int(RetryPolicy::ErrorRemote);
+    QTest::newRow("本地终止") << 255 << int(QProcess::CrashExit) << QString() << int(QProcess::Crashed) << int(RetryPolicy::ErrorRemote);
+    QTest::newRow("ssh无法启动") << 255 << int(QProcess::NormalExit)
+        << QString("无法启动ssh程序") << int(QProcess::FailedToStart) << int(RetryPolicy::ErrorLocal);
+    QTest::newRow("ssh无法启动且无退出码") << 0 << int(QProcess::NormalExit) << QString()
+        << int(QProcess::FailedToStart) << int(RetryPolicy::ErrorLocal);
+}
+
+void TestRetryPolicy::classify()
+{
+    QFETCH(int, exitCode);
+    QFETCH(int, exitStatus);
+    QFETCH(QString, errorText);
+    QFETCH(int, processError);
+    QFETCH(int, expected);
+
+    RetryPolicy::ErrorClass errorClass = RetryPolicy::classify(exitCode, static_cast<QProcess::ExitStatus>(exitStatus), errorText,
+                                                               static_cast<QProcess::ProcessError>(processError));
+    QCOMPARE(int(errorClass), expected);
+}
+
+void TestRetryPolicy::retryByClass()
+{
+    RetryPolicy policy;
+    policy.setMaxAttempts(5);
+
+    // 只有网络中断默认重试
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorNone));
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorAuth));
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorLocal));
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorRemote));
+    QCOMPARE(policy.attempt(), 0);
+
+    QVERIFY(policy.shouldRetry(RetryPolicy::ErrorNetwork));
+    QCOMPARE(policy.attempt(), 1);
+}
+
+void TestRetryPolicy::remoteRetryOptIn()
+{
+    RetryPolicy policy;
+    policy.setMaxAttempts(5);
+    policy.setRetryRemoteFailures(true);
+    QVERIFY(policy.shouldRetry(RetryPolicy::ErrorRemote));
+
+    // 认证失败和本地错误无论如何都不重试
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorAuth));
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorLocal));
+}
+
+void TestRetryPolicy::attemptLimit()
+{
+    RetryPolicy policy;
+    policy.setMaxAttempts(2);
+    QVERIFY(policy.shouldRetry(RetryPolicy::ErrorNetwork));
+    QVERIFY(policy.shouldRetry(RetryPolicy::ErrorNetwork));
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorNetwork));
+    QCOMPARE(policy.attempt(), 2);
+
+    policy.reset();
+    QCOMPARE(policy.attempt(), 0);
+    QVERIFY(policy.shouldRetry(RetryPolicy::ErrorNetwork));
+
+    policy.setMaxAttempts(0);
+    policy.reset();
+    QVERIFY(!policy.shouldRetry(RetryPolicy::ErrorNetwork));
+}
+
+void TestRetryPolicy::delayBounds()
+{
+    // 第1次重试不超过2秒，之后每次上限翻倍，最长2分钟
+    RetryPolicy policy;
+    policy.setMaxAttempts(20);
+    qint64 ceiling = 2000;
+    for (int i = 0; i < 12; ++i) {
+        QVERIFY(policy.shouldRetry(RetryPolicy::ErrorNetwork));
+        for (int sample = 0; sample < 50; ++sample) {
+            int delay = policy.nextDelayMs();
+            QVERIFY(delay >= 0);
+            QVERIFY(delay <= ceiling);
+        }
+        ceiling = qMin<qint64>(ceiling * 2, 120 * 1000);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestRetryPolicy)
+
+#include "test_retrypolicy.moc"
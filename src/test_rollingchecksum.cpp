@@ -0,0 +1,93 @@
+/**
+ * @File Name: test_rollingchecksum.cpp
+ * @brief  测试可滚动弱校验与 cksum 输出一致、滚动结果与重新计算一致，以及按任意偏移找到相同块
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "rollingchecksum.h"
+
+class TestRollingChecksum : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesCksum_data();
+    void matchesCksum();
+    void rollEqualsRecompute();
+    void findsShiftedBlock();
+};
+
+// 固定种子的伪随机数据，避免测试结果依赖运行环境
+static QByteArray sampleData(int size)
+{
+    QByteArray data(size, '\0');
+    quint32 state = 12345;
+    for (int i = 0; i < size; ++i) {
+        state = state * 1103515245u + 12345u;
+        data[i] = static_cast<char>(state >> 16);
+    }
+    return data;
+}
+
+void TestRollingChecksum::matchesCksum_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<quint32>("expected");
+
+    // 期望值为 "printf '...' | cksum" 的第一列
+    QTest::newRow("empty") << QByteArray() << quint32(4294967295u);
+    QTest::newRow("check") << QByteArray("123456789") << quint32(930766865u);
+}
+
+void TestRollingChecksum::matchesCksum()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(quint32, expected);
+
+    QCOMPARE(RollingChecksum::cksum(data), expected);
+}
+
+void TestRollingChecksum::rollEqualsRecompute()
+{
+    const int window = 64;
+    QByteArray data = sampleData(1000);
+    RollingChecksum rolling(window);
+    QCOMPARE(rolling.windowSize(), qint64(window));
+
+    quint32 crc = RollingChecksum::update(0, data.constData(), window);
+    for (int offset = 0; offset + window < data.size(); ++offset) {
+        crc = rolling.roll(crc, static_cast<uchar>(data[offset]), static_cast<uchar>(data[offset + window]));
+        quint32 expected = RollingChecksum::update(0, data.constData() + offset + 1, window);
+        QCOMPARE(crc, expected);
+    }
+}
+
+void TestRollingChecksum::findsShiftedBlock()
+{
+    // 旧文件的一块在新文件中前移了37字节，逐字节滑动窗口应在该偏移处命中
+    const int window = 256;
+    QByteArray block = sampleData(window);
+    QByteArray data = QByteArray(37, 'x') + block + QByteArray(100, 'y');
+    quint32 target = RollingChecksum::cksum(block);
+
+    RollingChecksum rolling(window);
+    quint32 crc = RollingChecksum::update(0, data.constData(), window);
+    int found = -1;
+    for (int offset = 0; offset + window <= data.size(); ++offset) {
+        if (RollingChecksum::finish(crc, window) == target) {
+            found = offset;
+            break;
+        }
+        if (offset + window < data.size()) {
+            crc = rolling.roll(crc, static_cast<uchar>(data[offset]), static_cast<uchar>(data[offset + window]));
+        }
+    }
+    QCOMPARE(found, 37);
+}
+
+QTEST_GUILESS_MAIN(TestRollingChecksum)
+#include "test_rollingchecksum.moc"
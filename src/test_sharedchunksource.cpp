@@ -0,0 +1,173 @@
+/**
+ * @File Name: test_sharedchunksource.cpp
+ * @brief  测试共享分块数据源的通道共享、窗口裁剪、慢使用者切换为独立读盘和整文件MD5
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include <QTemporaryFile>
+#include <QCryptographicHash>
+#include "sharedchunksource.h"
+
+// 与 sharedchunksource.cpp 中的数据片大小一致
+static const qint64 SLICE = 256 * 1024;
+
+class TestSharedChunkSource : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void consumersShareLane();
+    void slowConsumerFallsBack();
+    void laneReleasedWhenConsumersLeave();
+    void headLaneKeptForLaterConsumers();
+    void trimmedDataStartsNewLane();
+    void md5OfWholeFile();
+
+private:
+    QByteArray readAll(SharedChunkSource &source, int consumerId, qint64 from, qint64 to);
+
+    QTemporaryFile *file;
+    QByteArray content;
+};
+
+void TestSharedChunkSource::init()
+{
+    // 4 MB，内容随偏移变化，错位读取能被发现
+    content.resize(static_cast<int>(16 * SLICE));
+    for (int i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>((i * 7 + i / 251) & 0xff);
+    }
+
+    file = new QTemporaryFile();
+    QVERIFY(file->open());
+    QCOMPARE(file->write(content), static_cast<qint64>(content.size()));
+    file->flush();
+}
+
+void TestSharedChunkSource::cleanup()
+{
+    delete file;
+    file = nullptr;
+}
+
+QByteArray TestSharedChunkSource::readAll(SharedChunkSource &source, int consumerId, qint64 from, qint64 to)
+{
+    QByteArray data;
+    qint64 offset = from;
+    while (offset < to) {
+        SharedChunkSource::ReadStatus status;
+        QByteArray piece = source.read(consumerId, offset, SLICE, &status);
+        if (status != SharedChunkSource::ReadOk || piece.isEmpty()) {
+            break;
+        }
+        data += piece;
+        offset += piece.size();
+    }
+    return data;
+}
+
+void TestSharedChunkSource::consumersShareLane()
+{
+    SharedChunkSource source(file->fileName());
+    QVERIFY(source.open(nullptr));
+    QCOMPARE(source.size(), static_cast<qint64>(content.size()));
+
+    int first = source.attach(0);
+    QVERIFY(first > 0);
+    QCOMPARE(readAll(source, first, 0, SLICE), content.left(static_cast<int>(SLICE)));
+
+    // 起点仍在保留的数据内，加入同一通道并从缓存取得数据
+    int second = source.attach(0);
+    QVERIFY(second > 0);
+    QCOMPARE(source.laneCount(), 1);
+    QCOMPARE(readAll(source, second, 0, 2 * SLICE), content.left(static_cast<int>(2 * SLICE)));
+    QCOMPARE(readAll(source, first, SLICE, 2 * SLICE), content.mid(static_cast<int>(SLICE), static_cast<int>(SLICE)));
+}
+
+void TestSharedChunkSource::slowConsumerFallsBack()
+{
+    SharedChunkSource source(file->fileName());
+    source.setWindowSize(2 * SLICE);
+    QVERIFY(source.open(nullptr));
+
+    int fast = source.attach(0);
+    int slow = source.attach(0);
+
+    // 快的使用者读满窗口后继续读：慢的使用者还停在开头，被切换为独立读盘
+    QCOMPARE(readAll(source, fast, 0, 4 * SLICE), content.left(static_cast<int>(4 * SLICE)));
+
+    SharedChunkSource::ReadStatus status;
+    QVERIFY(source.read(slow, 0, SLICE, &status).isEmpty());
+    QCOMPARE(status, SharedChunkSource::ReadFallback);
+
+    // 快的使用者不受影响
+    QCOMPARE(readAll(source, fast, 4 * SLICE, 5 * SLICE), content.mid(static_cast<int>(4 * SLICE), static_cast<int>(SLICE)));
+}
+
+void TestSharedChunkSource::laneReleasedWhenConsumersLeave()
+{
+    SharedChunkSource source(file->fileName());
+    QVERIFY(source.open(nullptr));
+
+    // 不从文件开头开始的通道在使用者全部离开后释放
+    int resumed = source.attach(3 * SLICE);
+    QCOMPARE(readAll(source, resumed, 3 * SLICE, 4 * SLICE), content.mid(static_cast<int>(3 * SLICE), static_cast<int>(SLICE)));
+    QCOMPARE(source.laneCount(), 1);
+
+    source.detach(resumed);
+    QCOMPARE(source.laneCount(), 0);
+}
+
+void TestSharedChunkSource::headLaneKeptForLaterConsumers()
+{
+    SharedChunkSource source(file->fileName());
+    QVERIFY(source.open(nullptr));
+
+    int first = source.attach(0);
+    QCOMPARE(readAll(source, first, 0, SLICE), content.left(static_cast<int>(SLICE)));
+    source.detach(first);
+
+    // 保留文件开头数据的通道留给之后从头开始的使用者
+    QCOMPARE(source.laneCount(), 1);
+    int later = source.attach(0);
+    QCOMPARE(source.laneCount(), 1);
+    QCOMPARE(readAll(source, later, 0, 2 * SLICE), content.left(static_cast<int>(2 * SLICE)));
+}
+
+void TestSharedChunkSource::trimmedDataStartsNewLane()
+{
+    SharedChunkSource source(file->fileName());
+    source.setWindowSize(2 * SLICE);
+    QVERIFY(source.open(nullptr));
+
+    // 唯一的使用者读过窗口后，开头的数据被丢弃
+    int first = source.attach(0);
+    QCOMPARE(readAll(source, first, 0, 6 * SLICE), content.left(static_cast<int>(6 * SLICE)));
+
+    // 从已丢弃位置开始的使用者只能新建通道，数据仍然正确
+    int late = source.attach(0);
+    QVERIFY(late > 0);
+    QCOMPARE(source.laneCount(), 2);
+    QCOMPARE(readAll(source, late, 0, SLICE), content.left(static_cast<int>(SLICE)));
+}
+
+void TestSharedChunkSource::md5OfWholeFile()
+{
+    SharedChunkSource source(file->fileName());
+    QVERIFY(source.open(nullptr));
+
+    int consumer = source.attach(0);
+    QCOMPARE(readAll(source, consumer, 0, content.size()), content);
+    QVERIFY(source.isMd5Ready());
+    QCOMPARE(source.fileMd5(), QString(QCryptographicHash::hash(content, QCryptographicHash::Md5).toHex()));
+}
+
+QTEST_GUILESS_MAIN(TestSharedChunkSource)
+
+#include "test_sharedchunksource.moc"
@@ -0,0 +1,97 @@
+/**
+ * @File Name: test_sshsession.cpp
+ * @brief  测试SSH会话管理中的密码提示识别、认证相关的ssh参数和远程 shell 参数的引用
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "sshsession.h"
+#include "sshutils.h"
+
+class TestSshSession : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void passwordPrompt_data();
+    void passwordPrompt();
+    void batchArguments();
+    void commonArguments();
+    void shellQuote_data();
+    void shellQuote();
+};
+
+void TestSshSession::passwordPrompt_data()
+{
+    QTest::addColumn<QString>("prompt");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("openssh") << QString("root@192.168.1.10's password: ") << true;
+    QTest::newRow("无用户名") << QString("Password:") << true;
+    QTest::newRow("keyboard-interactive") << QString("(root@device) Password for root@device: ") << true;
+    QTest::newRow("私钥口令") << QString("Enter passphrase for key '/home/u/.ssh/id_rsa': ") << false;
+    QTest::newRow("主机密钥确认") << QString("Are you sure you want to continue connecting (yes/no/[fingerprint])? ") << false;
+    QTest::newRow("修改密码") << QString("New password: ") << false;
+    QTest::newRow("非提示") << QString("Permission denied, please try again.") << false;
+    QTest::newRow("空") << QString() << false;
+}
+
+void TestSshSession::passwordPrompt()
+{
+    QFETCH(QString, prompt);
+    QFETCH(bool, expected);
+    QCOMPARE(SshSessionManager::isPasswordPrompt(prompt), expected);
+}
+
+void TestSshSession::batchArguments()
+{
+    SshSessionManager manager;
+    QVERIFY(!manager.hasPassword());
+    QVERIFY(manager.batchArguments().contains("BatchMode=yes"));
+
+    // 有密码时必须允许 SSH_ASKPASS，且只尝试一次
+    manager.setPassword("secret");
+    QVERIFY(manager.hasPassword());
+    QStringList arguments = manager.batchArguments();
+    QVERIFY(arguments.contains("BatchMode=no"));
+    QVERIFY(arguments.contains("NumberOfPasswordPrompts=1"));
+    QVERIFY(!arguments.join(' ').contains("secret"));
+}
+
+void TestSshSession::commonArguments()
+{
+    QStringList arguments = SshUtils::commonArguments();
+    QVERIFY(arguments.contains("ConnectTimeout=30"));
+    QVERIFY(arguments.contains("ServerAliveInterval=15"));
+
+    // 每个选项都以 -o 开头，可以直接拼接在其他参数之前
+    QCOMPARE(arguments.size() % 2, 0);
+    for (int i = 0; i < arguments.size(); i += 2) {
+        QCOMPARE(arguments.at(i), QString("-o"));
+    }
+}
+
+void TestSshSession::shellQuote_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("普通路径") << QString("/tmp/a b") << QString("'/tmp/a b'");
+    QTest::newRow("空") << QString() << QString("''");
+    QTest::newRow("单引号") << QString("it's") << QString("'it'\\''s'");
+    QTest::newRow("变量和命令替换") << QString("$(rm -rf /) `id` $HOME") << QString("'$(rm -rf /) `id` $HOME'");
+}
+
+void TestSshSession::shellQuote()
+{
+    QFETCH(QString, text);
+    QFETCH(QString, expected);
+    QCOMPARE(SshUtils::shellQuote(text), expected);
+}
+
+QTEST_GUILESS_MAIN(TestSshSession)
+
+#include "test_sshsession.moc"
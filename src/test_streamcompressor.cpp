@@ -0,0 +1,112 @@
+/**
+ * @File Name: test_streamcompressor.cpp
+ * @brief  测试gzip成员编码：解压后与原始数据一致，尾部CRC32和原始长度正确，空输入也能编码为合法成员
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "streamcompressor.h"
+
+class TestStreamCompressor : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void crc32KnownValue();
+    void memberRoundTrip_data();
+    void memberRoundTrip();
+    void emptyMember();
+};
+
+static quint32 readLittleEndian(const QByteArray &data, int offset)
+{
+    quint32 value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<uchar>(data.at(offset + i));
+    }
+    return value;
+}
+
+static QByteArray bigEndian(quint32 value)
+{
+    QByteArray bytes;
+    for (int i = 3; i >= 0; --i) {
+        bytes.append(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+    return bytes;
+}
+
+static quint32 adler32(const QByteArray &data)
+{
+    quint32 a = 1;
+    quint32 b = 0;
+    for (int i = 0; i < data.size(); ++i) {
+        a = (a + static_cast<uchar>(data.at(i))) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+// 取出成员中的deflate数据，按 qUncompress 的格式补上长度前缀、zlib头和adler32后解压
+static QByteArray decodeMember(const QByteArray &member, quint32 originalSize, const QByteArray &original)
+{
+    QByteArray deflateData = member.mid(10, member.size() - 18);
+    QByteArray zlibData = bigEndian(originalSize) + QByteArray("\x78\x9c", 2) + deflateData + bigEndian(adler32(original));
+    return qUncompress(zlibData);
+}
+
+void TestStreamCompressor::crc32KnownValue()
+{
+    QCOMPARE(StreamCompressor::crc32(QByteArray("123456789")), quint32(0xCBF43926));
+}
+
+void TestStreamCompressor::memberRoundTrip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<int>("level");
+
+    QByteArray text = QByteArray("upgrade package slice ").repeated(2000);
+    QByteArray binary;
+    for (int i = 0; i < 70000; ++i) {
+        binary.append(static_cast<char>((i * 7919) >> 3));
+    }
+
+    QTest::newRow("stored") << text << 0;
+    QTest::newRow("fast") << text << StreamCompressor::DEFAULT_LEVEL;
+    QTest::newRow("best") << binary << StreamCompressor::MAX_LEVEL;
+    QTest::newRow("one byte") << QByteArray("x") << StreamCompressor::DEFAULT_LEVEL;
+}
+
+void TestStreamCompressor::memberRoundTrip()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(int, level);
+
+    QByteArray member = StreamCompressor::gzipMember(data, level);
+    QVERIFY(member.size() >= 18);
+    QCOMPARE(static_cast<uchar>(member.at(0)), uchar(0x1f));
+    QCOMPARE(static_cast<uchar>(member.at(1)), uchar(0x8b));
+    QCOMPARE(static_cast<uchar>(member.at(2)), uchar(8));
+
+    // 尾部：CRC32 和原始长度（小端）
+    QCOMPARE(readLittleEndian(member, member.size() - 8), StreamCompressor::crc32(data));
+    QCOMPARE(readLittleEndian(member, member.size() - 4), static_cast<quint32>(data.size()));
+
+    QCOMPARE(decodeMember(member, static_cast<quint32>(data.size()), data), data);
+}
+
+void TestStreamCompressor::emptyMember()
+{
+    QByteArray member = StreamCompressor::gzipMember(QByteArray(), StreamCompressor::DEFAULT_LEVEL);
+    QCOMPARE(member.size(), 20);
+    QCOMPARE(member.mid(10, 2), QByteArray("\x03\x00", 2));
+    QCOMPARE(readLittleEndian(member, 12), quint32(0));
+    QCOMPARE(readLittleEndian(member, 16), quint32(0));
+    QVERIFY(decodeMember(member, 0, QByteArray()).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestStreamCompressor)
+#include "test_streamcompressor.moc"
@@ -0,0 +1,26 @@
+QT += core testlib
+QT -= gui
+
+TARGET = test_streamcompressor
+TEMPLATE = app
+
+SOURCES += test_streamcompressor.cpp \
+           streamcompressor.cpp
+
+HEADERS += streamcompressor.h
+
+# 输出目录（输出到上级目录的bin文件夹）
+DESTDIR = $$PWD/../bin
+OBJECTS_DIR = $$PWD/../build/obj/test_streamcompressor
+MOC_DIR = $$PWD/../build/moc/test_streamcompressor
+RCC_DIR = $$PWD/../build/rcc/test_streamcompressor
+UI_DIR = $$PWD/../build/ui/test_streamcompressor
+
+# 创建必要的目录
+!exists($$DESTDIR): system(mkdir $$shell_path($$DESTDIR))
+!exists($$OBJECTS_DIR): system(mkdir $$shell_path($$OBJECTS_DIR))
+!exists($$MOC_DIR): system(mkdir $$shell_path($$MOC_DIR))
+!exists($$RCC_DIR): system(mkdir $$shell_path($$RCC_DIR))
+
+CONFIG += console testcase
+CONFIG += c++11
\ No newline at end of file
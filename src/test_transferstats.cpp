@@ -0,0 +1,188 @@
+/**
+ * @File Name: test_transferstats.cpp
+ * @brief  测试传输统计的续传起点处理、剩余时间估算、吞吐量历史和数值格式化
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "transferstats.h"
+
+class TestTransferStats : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void formatBytes_data();
+    void formatBytes();
+    void formatDuration_data();
+    void formatDuration();
+    void resumeOffsetNotCounted();
+    void progressNeverGoesBack();
+    void inactiveIgnoresUpdates();
+    void etaWithoutRate();
+    void etaWhenDone();
+    void samplesAndReport();
+    void reportMergesLongHistory();
+};
+
+void TestTransferStats::formatBytes_data()
+{
+    QTest::addColumn<qint64>("bytes");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("0") << qint64(0) << QString("0 B");
+    QTest::newRow("1023") << qint64(1023) << QString("1023 B");
+    QTest::newRow("1K") << qint64(1024) << QString("1.0 KB");
+    QTest::newRow("1.5M") << qint64(1536 * 1024) << QString("1.5 MB");
+    QTest::newRow("2G") << qint64(2) * 1024 * 1024 * 1024 << QString("2.00 GB");
+}
+
+void TestTransferStats::formatBytes()
+{
+    QFETCH(qint64, bytes);
+    QFETCH(QString, expected);
+
+    QCOMPARE(TransferStats::formatBytes(bytes), expected);
+    QCOMPARE(TransferStats::formatRate(static_cast<double>(bytes)), expected + "/s");
+}
+
+void TestTransferStats::formatDuration_data()
+{
+    QTest::addColumn<qint64>("seconds");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("负数") << qint64(-5) << QString("00:00");
+    QTest::newRow("秒") << qint64(7) << QString("00:07");
+    QTest::newRow("分") << qint64(605) << QString("10:05");
+    QTest::newRow("时") << qint64(3 * 3600 + 2 * 60 + 1) << QString("3:02:01");
+}
+
+void TestTransferStats::formatDuration()
+{
+    QFETCH(qint64, seconds);
+    QFETCH(QString, expected);
+
+    QCOMPARE(TransferStats::formatDuration(seconds), expected);
+}
+
+void TestTransferStats::resumeOffsetNotCounted()
+{
+    TransferStats stats;
+    stats.start(1000);
+
+    // 第一次进度是续传起点，只有之后的200字节属于本次传输
+    stats.update(400, 1000);
+    stats.update(600, 1000);
+    QTest::qSleep(50);
+    stats.stop();
+
+    QCOMPARE(stats.bytesSent(), qint64(600));
+    QCOMPARE(stats.percent(), 60);
+    QVERIFY(stats.elapsedMs() >= 50);
+    QVERIFY(stats.averageBytesPerSecond() > 0.0);
+    QVERIFY(stats.averageBytesPerSecond() <= 200 * 1000.0 / 50);
+
+    QStringList report = stats.historyReport();
+    QVERIFY(!report.isEmpty());
+    QVERIFY(report.first().contains("本次传输 200 B"));
+}
+
+void TestTransferStats::progressNeverGoesBack()
+{
+    TransferStats stats;
+    stats.start(1000);
+    stats.update(300, 1000);
+    stats.update(200, 1000);
+    QCOMPARE(stats.bytesSent(), qint64(300));
+
+    // 总量为0时保留原来的总量
+    stats.update(350, 0);
+    QCOMPARE(stats.totalBytes(), qint64(1000));
+    QCOMPARE(stats.bytesSent(), qint64(350));
+}
+
+void TestTransferStats::inactiveIgnoresUpdates()
+{
+    TransferStats stats;
+    QVERIFY(!stats.isActive());
+    stats.update(500, 1000);
+    stats.sample();
+    QCOMPARE(stats.bytesSent(), qint64(0));
+    QVERIFY(stats.history().isEmpty());
+
+    stats.start(1000);
+    QVERIFY(stats.isActive());
+    stats.stop();
+    QVERIFY(!stats.isActive());
+}
+
+void TestTransferStats::etaWithoutRate()
+{
+    // 还没有任何进度，无法估算
+    TransferStats stats;
+    stats.start(1000);
+    QCOMPARE(stats.etaSeconds(), qint64(-1));
+    QVERIFY(stats.summaryText().contains("--:--"));
+}
+
+void TestTransferStats::etaWhenDone()
+{
+    TransferStats stats;
+    stats.start(1000);
+    stats.update(0, 1000);
+    stats.update(1000, 1000);
+    QCOMPARE(stats.etaSeconds(), qint64(0));
+    QCOMPARE(stats.percent(), 100);
+}
+
+void TestTransferStats::samplesAndReport()
+{
+    TransferStats stats;
+    stats.start(4000);
+    stats.update(0, 4000);
+    for (int i = 1; i <= 3; ++i) {
+        QTest::qSleep(20);
+        stats.update(i * 1000, 4000);
+        stats.sample();
+    }
+
+    const QVector<TransferStats::Sample> &history = stats.history();
+    QCOMPARE(history.size(), 3);
+    for (int i = 0; i < history.size(); ++i) {
+        QCOMPARE(history[i].bytesSent, qint64((i + 1) * 1000));
+        QVERIFY(history[i].bytesPerSecond > 0.0);
+        if (i > 0) {
+            QVERIFY(history[i].elapsedMs > history[i - 1].elapsedMs);
+        }
+    }
+    QVERIFY(stats.instantBytesPerSecond() > 0.0);
+    QVERIFY(stats.etaSeconds() >= 0);
+
+    // 汇总一行，加每个采样一行
+    QCOMPARE(stats.historyReport().size(), 1 + 3);
+}
+
+void TestTransferStats::reportMergesLongHistory()
+{
+    TransferStats stats;
+    stats.start(1000000);
+    stats.update(0, 1000000);
+    for (int i = 1; i <= 130; ++i) {
+        stats.update(i * 1000, 1000000);
+        QTest::qSleep(2);
+        stats.sample();
+    }
+    QVERIFY(stats.history().size() > 60);
+
+    // 最多60行历史，超出时按组合并
+    QStringList report = stats.historyReport();
+    QVERIFY(report.size() <= 1 + 60);
+    QVERIFY(report.size() > 1);
+}
+
+QTEST_GUILESS_MAIN(TestTransferStats)
+
+#include "test_transferstats.moc"
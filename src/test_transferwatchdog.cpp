@@ -0,0 +1,124 @@
+/**
+ * @File Name: test_transferwatchdog.cpp
+ * @brief  测试传输看门狗的期限估算、停滞判断，以及准备阶段不计入停滞
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include "transferwatchdog.h"
+
+// 测试中使用的最短停滞窗口
+static const int STALL_SECONDS = 5;
+
+class TestTransferWatchdog : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stallTimeoutClamped();
+    void prepareBudget();
+    void finishBudget();
+    void activeState();
+    void stallExpires();
+    void progressKeepsAlive();
+    void preparingGapIsNotStall();
+};
+
+void TestTransferWatchdog::stallTimeoutClamped()
+{
+    TransferWatchdog watchdog;
+    QCOMPARE(watchdog.stallTimeout(), TransferWatchdog::DEFAULT_STALL_TIMEOUT);
+    watchdog.setStallTimeout(1);
+    QCOMPARE(watchdog.stallTimeout(), 5);
+    watchdog.setStallTimeout(90);
+    QCOMPARE(watchdog.stallTimeout(), 90);
+}
+
+void TestTransferWatchdog::prepareBudget()
+{
+    // 至少2分钟；停滞窗口较长时为其3倍
+    QCOMPARE(TransferWatchdog::prepareBudgetMs(0, 10), qint64(120 * 1000));
+    QCOMPARE(TransferWatchdog::prepareBudgetMs(0, 60), qint64(180 * 1000));
+
+    // 另加远程按 8 MB/s 读一遍文件的时间
+    qint64 size = qint64(1024) * 1024 * 1024;
+    QCOMPARE(TransferWatchdog::prepareBudgetMs(size, 60), qint64(180 * 1000 + 128 * 1000));
+}
+
+void TestTransferWatchdog::finishBudget()
+{
+    QCOMPARE(TransferWatchdog::finishBudgetMs(0, 60), qint64(60 * 1000));
+    QCOMPARE(TransferWatchdog::finishBudgetMs(qint64(80) * 1024 * 1024, 30), qint64(30 * 1000 + 10 * 1000));
+}
+
+void TestTransferWatchdog::activeState()
+{
+    TransferWatchdog watchdog;
+    QVERIFY(!watchdog.isActive());
+
+    // 未启动时的进度和准备通知被忽略
+    watchdog.update(100, 1000);
+    watchdog.beginPreparing();
+    QVERIFY(!watchdog.isActive());
+
+    watchdog.start(1000);
+    QVERIFY(watchdog.isActive());
+    watchdog.stop();
+    QVERIFY(!watchdog.isActive());
+}
+
+void TestTransferWatchdog::stallExpires()
+{
+    TransferWatchdog watchdog;
+    watchdog.setStallTimeout(STALL_SECONDS);
+    QSignalSpy spy(&watchdog, &TransferWatchdog::expired);
+
+    watchdog.start(1000);
+    watchdog.update(100, 1000);
+    QVERIFY(spy.wait((STALL_SECONDS + 3) * 1000));
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(spy.first().first().toString().contains(QString::number(STALL_SECONDS)));
+    QVERIFY(!watchdog.isActive());
+}
+
+void TestTransferWatchdog::progressKeepsAlive()
+{
+    TransferWatchdog watchdog;
+    watchdog.setStallTimeout(STALL_SECONDS);
+    QSignalSpy spy(&watchdog, &TransferWatchdog::expired);
+
+    // 进度很慢但一直在增长，超过停滞窗口也不终止
+    watchdog.start(1000000);
+    for (int i = 0; i < STALL_SECONDS + 2; ++i) {
+        watchdog.update(i * 10, 1000000);
+        QTest::qWait(1000);
+    }
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(watchdog.isActive());
+}
+
+void TestTransferWatchdog::preparingGapIsNotStall()
+{
+    TransferWatchdog watchdog;
+    watchdog.setStallTimeout(STALL_SECONDS);
+    QSignalSpy spy(&watchdog, &TransferWatchdog::expired);
+
+    // 传输一段后进入新的准备阶段（如下一个文件开始探测），这段时间按准备阶段的期限计算
+    watchdog.start(1000);
+    watchdog.update(500, 1000);
+    watchdog.beginPreparing();
+    QTest::qWait((STALL_SECONDS + 2) * 1000);
+    QCOMPARE(spy.count(), 0);
+
+    // 恢复进度后重新按停滞窗口判断
+    watchdog.update(600, 1000);
+    QVERIFY(spy.wait((STALL_SECONDS + 3) * 1000));
+}
+
+QTEST_GUILESS_MAIN(TestTransferWatchdog)
+
+#include "test_transferwatchdog.moc"
@@ -0,0 +1,28 @@
+QT += core testlib
+QT -= gui
+
+TARGET = test_transferwatchdog
+TEMPLATE = app
+
+SOURCES += test_transferwatchdog.cpp \
+           transferwatchdog.cpp \
+           transferstats.cpp
+
+HEADERS += transferwatchdog.h \
+           transferstats.h
+
+# 输出目录（输出到上级目录的bin文件夹）
+DESTDIR = $$PWD/../bin
+OBJECTS_DIR = $$PWD/../build/obj/test_transferwatchdog
+MOC_DIR = $$PWD/../build/moc/test_transferwatchdog
+RCC_DIR = $$PWD/../build/rcc/test_transferwatchdog
+UI_DIR = $$PWD/../build/ui/test_transferwatchdog
+
+# 创建必要的目录
+!exists($$DESTDIR): system(mkdir $$shell_path($$DESTDIR))
+!exists($$OBJECTS_DIR): system(mkdir $$shell_path($$OBJECTS_DIR))
+!exists($$MOC_DIR): system(mkdir $$shell_path($$MOC_DIR))
+!exists($$RCC_DIR): system(mkdir $$shell_path($$RCC_DIR))
+
+CONFIG += console testcase
+CONFIG += c++11
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @File Name: test_upgradepipeline.cpp
+ * @brief  测试升级流水线的步骤标记行和解压进度行解析
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "upgradepipeline.h"
+
+class TestUpgradePipeline : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void markerBegin_data();
+    void markerBegin();
+    void markerSkip();
+    void markerEnd_data();
+    void markerEnd();
+    void markerRejects_data();
+    void markerRejects();
+    void progress_data();
+    void progress();
+    void scriptEmitsMarkers();
+};
+
+void TestUpgradePipeline::markerBegin_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<double>("deviceTime");
+    QTest::addColumn<qint64>("bytes");
+
+    // 与 script() 中 "echo \"@@STEP <序号> begin $(upt)[ $(stat ...)]\"" 的输出对应
+    QTest::newRow("带数据量") << QByteArray("2 begin 12345.67 1048576") << 2 << 12345.67 << qint64(1048576);
+    QTest::newRow("无数据文件") << QByteArray("0 begin 88.10") << 0 << 88.10 << qint64(-1);
+    QTest::newRow("stat失败") << QByteArray("1 begin 88.10 ") << 1 << 88.10 << qint64(-1);
+    QTest::newRow("设备无uptime") << QByteArray("3 begin ") << 3 << -1.0 << qint64(-1);
+    QTest::newRow("无uptime有数据量") << QByteArray("3 begin  4096") << 3 << -1.0 << qint64(4096);
+}
+
+void TestUpgradePipeline::markerBegin()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(int, index);
+    QFETCH(double, deviceTime);
+    QFETCH(qint64, bytes);
+
+    UpgradePipeline::Marker marker;
+    QVERIFY(UpgradePipeline::parseMarker(line, &marker));
+    QCOMPARE(marker.index, index);
+    QCOMPARE(marker.event, QByteArray("begin"));
+    QCOMPARE(marker.deviceTime, deviceTime);
+    QCOMPARE(marker.bytes, bytes);
+}
+
+void TestUpgradePipeline::markerSkip()
+{
+    UpgradePipeline::Marker marker;
+    QVERIFY(UpgradePipeline::parseMarker("4 skip", &marker));
+    QCOMPARE(marker.index, 4);
+    QCOMPARE(marker.event, QByteArray("skip"));
+    QCOMPARE(marker.exitCode, 0);
+    QCOMPARE(marker.deviceTime, -1.0);
+}
+
+void TestUpgradePipeline::markerEnd_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<int>("exitCode");
+    QTest::addColumn<double>("deviceTime");
+
+    QTest::newRow("成功") << QByteArray("1 end 0 12350.02") << 0 << 12350.02;
+    QTest::newRow("失败") << QByteArray("1 end 2 12350.02") << 2 << 12350.02;
+    QTest::newRow("设备无uptime") << QByteArray("1 end 127 ") << 127 << -1.0;
+}
+
+void TestUpgradePipeline::markerEnd()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(int, exitCode);
+    QFETCH(double, deviceTime);
+
+    UpgradePipeline::Marker marker;
+    QVERIFY(UpgradePipeline::parseMarker(line, &marker));
+    QCOMPARE(marker.index, 1);
+    QCOMPARE(marker.event, QByteArray("end"));
+    QCOMPARE(marker.exitCode, exitCode);
+    QCOMPARE(marker.deviceTime, deviceTime);
+    QCOMPARE(marker.bytes, qint64(-1));
+}
+
+void TestUpgradePipeline::markerRejects_data()
+{
+    QTest::addColumn<QByteArray>("line");
+
+    QTest::newRow("空") << QByteArray();
+    QTest::newRow("序号不是数字") << QByteArray("x begin 1.0");
+    QTest::newRow("负序号") << QByteArray("-1 end 0 1.0");
+    QTest::newRow("未知事件") << QByteArray("0 pause 1.0");
+    QTest::newRow("缺少事件") << QByteArray("0");
+}
+
+void TestUpgradePipeline::markerRejects()
+{
+    QFETCH(QByteArray, line);
+
+    UpgradePipeline::Marker marker;
+    QVERIFY(!UpgradePipeline::parseMarker(line, &marker));
+}
+
+void TestUpgradePipeline::progress_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<qint64>("done");
+    QTest::addColumn<qint64>("total");
+
+    QTest::newRow("进行中") << QByteArray("524288 1048576") << true << qint64(524288) << qint64(1048576);
+    QTest::newRow("多余空白") << QByteArray("  524288   1048576 ") << true << qint64(524288) << qint64(1048576);
+    // 解压结束时读取位置可能因预读超过文件大小
+    QTest::newRow("超过总量") << QByteArray("1200000 1048576") << true << qint64(1048576) << qint64(1048576);
+    QTest::newRow("读不到fdinfo") << QByteArray(" 1048576") << false << qint64(0) << qint64(0);
+    QTest::newRow("总量为0") << QByteArray("0 0") << false << qint64(0) << qint64(0);
+    QTest::newRow("非数字") << QByteArray("abc 1048576") << false << qint64(0) << qint64(0);
+    QTest::newRow("字段过多") << QByteArray("1 2 3") << false << qint64(0) << qint64(0);
+}
+
+void TestUpgradePipeline::progress()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(bool, valid);
+    QFETCH(qint64, done);
+    QFETCH(qint64, total);
+
+    qint64 parsedDone = 0;
+    qint64 parsedTotal = 0;
+    QCOMPARE(UpgradePipeline::parseProgress(line, &parsedDone, &parsedTotal), valid);
+    QCOMPARE(parsedDone, done);
+    QCOMPARE(parsedTotal, total);
+}
+
+void TestUpgradePipeline::scriptEmitsMarkers()
+{
+    // 生成的脚本中的标记行能被解析
+    UpgradePipeline pipeline;
+    pipeline.reset("测试");
+    pipeline.addStep(UpgradePipeline::StepCheck, "检查", "true");
+    int extract = pipeline.addStep(UpgradePipeline::StepExtract, "解压", "true");
+    pipeline.setDataFile(extract, "/tmp/pkg.tar.gz");
+    pipeline.setSkipCondition(extract, "false");
+
+    QString script = pipeline.script();
+    QVERIFY(script.contains("echo \"@@STEP 0 begin $(upt)\""));
+    QVERIFY(script.contains("echo \"@@STEP 0 end $rc $(upt)\""));
+    QVERIFY(script.contains("echo '@@STEP 1 skip'"));
+    QVERIFY(script.contains("echo \"@@STEP 1 begin $(upt) $(stat -c %s"));
+}
+
+QTEST_GUILESS_MAIN(TestUpgradePipeline)
+
+#include "test_upgradepipeline.moc"
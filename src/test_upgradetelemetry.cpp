@@ -0,0 +1,157 @@
+/**
+ * @File Name: test_upgradetelemetry.cpp
+ * @brief  测试升级耗时记录的步骤标识、按步骤汇总，以及 JSON 序列化往返
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include <QtTest>
+#include "upgradetelemetry.h"
+
+class TestUpgradeTelemetry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void stepKeyCountsSameType();
+    void aggregateGroupsByKey();
+    void aggregateSkipsUnfinishedSteps();
+    void jsonRoundTrip();
+    void jsonRejectsOtherVersion();
+};
+
+static UpgradeTelemetry::StepRecord makeStep(int type, const QString &title, int status,
+                                             qint64 clientMs, qint64 deviceMs, qint64 bytes)
+{
+    UpgradeTelemetry::StepRecord step;
+    step.type = type;
+    step.title = title;
+    step.status = status;
+    step.exitCode = status == UpgradePipeline::StatusFailed ? 1 : 0;
+    step.offsetMs = 0;
+    step.clientMs = clientMs;
+    step.deviceMs = deviceMs;
+    step.bytes = bytes;
+    return step;
+}
+
+static UpgradeTelemetry::RunRecord makeRun(const QString &upgrade)
+{
+    UpgradeTelemetry::RunRecord run;
+    run.startedAt = QDateTime(QDate(2025, 3, 1), QTime(10, 30, 0), Qt::UTC);
+    run.upgrade = upgrade;
+    run.device = "root@192.168.1.10:22";
+    run.packageFile = "app.tar.gz";
+    run.packageDigest = "0123456789abcdef";
+    run.packageDigestName = "XXH64";
+    run.success = true;
+    run.totalMs = 0;
+    return run;
+}
+
+void TestUpgradeTelemetry::stepKeyCountsSameType()
+{
+    UpgradeTelemetry::RunRecord run = makeRun("Qt");
+    run.steps << makeStep(UpgradePipeline::StepCheck, "检查", UpgradePipeline::StatusSucceeded, 10, -1, -1)
+              << makeStep(UpgradePipeline::StepRun, "执行 a.sh", UpgradePipeline::StatusSucceeded, 10, -1, -1)
+              << makeStep(UpgradePipeline::StepSync, "同步", UpgradePipeline::StatusSucceeded, 10, -1, -1)
+              << makeStep(UpgradePipeline::StepRun, "执行 b.sh", UpgradePipeline::StatusSucceeded, 10, -1, -1);
+
+    QCOMPARE(UpgradeTelemetry::stepKey(run, 0), QString("%1#0").arg(int(UpgradePipeline::StepCheck)));
+    QCOMPARE(UpgradeTelemetry::stepKey(run, 1), QString("%1#0").arg(int(UpgradePipeline::StepRun)));
+    QCOMPARE(UpgradeTelemetry::stepKey(run, 2), QString("%1#0").arg(int(UpgradePipeline::StepSync)));
+    QCOMPARE(UpgradeTelemetry::stepKey(run, 3), QString("%1#1").arg(int(UpgradePipeline::StepRun)));
+}
+
+void TestUpgradeTelemetry::aggregateGroupsByKey()
+{
+    // 两次升级的解压路径不同，标题变化后仍归为同一步骤；设备耗时可用时优先使用
+    UpgradeTelemetry::RunRecord first = makeRun("Qt");
+    first.steps << makeStep(UpgradePipeline::StepExtract, "解压到 /opt/a", UpgradePipeline::StatusSucceeded, 1200, 1000, 4000)
+                << makeStep(UpgradePipeline::StepSync, "同步", UpgradePipeline::StatusSucceeded, 300, -1, -1);
+    UpgradeTelemetry::RunRecord second = makeRun("Qt");
+    second.steps << makeStep(UpgradePipeline::StepExtract, "解压到 /opt/b", UpgradePipeline::StatusFailed, 3500, 3000, 8000)
+                 << makeStep(UpgradePipeline::StepSync, "同步", UpgradePipeline::StatusSucceeded, 500, -1, -1);
+    UpgradeTelemetry::RunRecord other = makeRun("7EV");
+    other.steps << makeStep(UpgradePipeline::StepSync, "同步", UpgradePipeline::StatusSucceeded, 700, -1, -1);
+
+    QList<UpgradeTelemetry::StepStats> stats =
+        UpgradeTelemetry::aggregate(QList<UpgradeTelemetry::RunRecord>() << first << second << other);
+    QCOMPARE(stats.size(), 3);
+
+    const UpgradeTelemetry::StepStats &extract = stats.at(0);
+    QCOMPARE(extract.upgrade, QString("Qt"));
+    QCOMPARE(extract.type, int(UpgradePipeline::StepExtract));
+    QCOMPARE(extract.title, QString("解压到 /opt/b"));
+    QCOMPARE(extract.count, 2);
+    QCOMPARE(extract.totalMs, qint64(4000));
+    QCOMPARE(extract.maxMs, qint64(3000));
+    QCOMPARE(extract.totalBytes, qint64(12000));
+    QCOMPARE(extract.bytesMs, qint64(4000));
+
+    const UpgradeTelemetry::StepStats &sync = stats.at(1);
+    QCOMPARE(sync.upgrade, QString("Qt"));
+    QCOMPARE(sync.count, 2);
+    QCOMPARE(sync.totalMs, qint64(800));
+    QCOMPARE(sync.totalBytes, qint64(0));
+
+    QCOMPARE(stats.at(2).upgrade, QString("7EV"));
+    QCOMPARE(stats.at(2).count, 1);
+}
+
+void TestUpgradeTelemetry::aggregateSkipsUnfinishedSteps()
+{
+    UpgradeTelemetry::RunRecord run = makeRun("Qt");
+    run.steps << makeStep(UpgradePipeline::StepCheck, "检查", UpgradePipeline::StatusSkipped, 0, -1, -1)
+              << makeStep(UpgradePipeline::StepRun, "执行", UpgradePipeline::StatusPending, 0, -1, -1);
+
+    QVERIFY(UpgradeTelemetry::aggregate(QList<UpgradeTelemetry::RunRecord>() << run).isEmpty());
+}
+
+void TestUpgradeTelemetry::jsonRoundTrip()
+{
+    UpgradeTelemetry::RunRecord run = makeRun("Qt");
+    run.success = false;
+    run.failureReason = "执行 a.sh 失败";
+    run.totalMs = 98765;
+    run.steps << makeStep(UpgradePipeline::StepExtract, "解压", UpgradePipeline::StatusSucceeded, 1500, 1200, 5000000000LL)
+              << makeStep(UpgradePipeline::StepRun, "执行 a.sh", UpgradePipeline::StatusFailed, 800, -1, -1);
+    run.steps[1].offsetMs = 1600;
+
+    UpgradeTelemetry::RunRecord parsed;
+    QVERIFY(UpgradeTelemetry::fromJson(UpgradeTelemetry::toJson(run), parsed));
+    QCOMPARE(parsed.startedAt, run.startedAt);
+    QCOMPARE(parsed.upgrade, run.upgrade);
+    QCOMPARE(parsed.device, run.device);
+    QCOMPARE(parsed.packageFile, run.packageFile);
+    QCOMPARE(parsed.packageDigest, run.packageDigest);
+    QCOMPARE(parsed.packageDigestName, run.packageDigestName);
+    QCOMPARE(parsed.success, false);
+    QCOMPARE(parsed.failureReason, run.failureReason);
+    QCOMPARE(parsed.totalMs, run.totalMs);
+    QCOMPARE(parsed.steps.size(), 2);
+    for (int i = 0; i < run.steps.size(); ++i) {
+        QCOMPARE(parsed.steps[i].type, run.steps[i].type);
+        QCOMPARE(parsed.steps[i].title, run.steps[i].title);
+        QCOMPARE(parsed.steps[i].status, run.steps[i].status);
+        QCOMPARE(parsed.steps[i].exitCode, run.steps[i].exitCode);
+        QCOMPARE(parsed.steps[i].offsetMs, run.steps[i].offsetMs);
+        QCOMPARE(parsed.steps[i].clientMs, run.steps[i].clientMs);
+        QCOMPARE(parsed.steps[i].deviceMs, run.steps[i].deviceMs);
+        QCOMPARE(parsed.steps[i].bytes, run.steps[i].bytes);
+    }
+}
+
+void TestUpgradeTelemetry::jsonRejectsOtherVersion()
+{
+    QJsonObject obj = UpgradeTelemetry::toJson(makeRun("Qt"));
+    obj["version"] = 2;
+
+    UpgradeTelemetry::RunRecord parsed;
+    QVERIFY(!UpgradeTelemetry::fromJson(obj, parsed));
+}
+
+QTEST_GUILESS_MAIN(TestUpgradeTelemetry)
+#include "test_upgradetelemetry.moc"
@@ -0,0 +1,256 @@
+/**
+ * @File Name: transferstats.cpp
+ * @brief  传输统计实现，采样吞吐量历史并估算剩余时间
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "transferstats.h"
+
+// 瞬时吞吐量的平滑系数，越大越贴近最新采样
+static const double RATE_SMOOTHING = 0.5;
+
+// 写入日志的吞吐量历史最多保留的行数，超出时按时间段合并
+static const int MAX_REPORT_LINES = 60;
+
+TransferStats::TransferStats()
+    : active(false), total(0), baseBytes(0), baseKnown(false), sent(0),
+      lastSampleMs(0), lastSampleBytes(0), instantRate(0.0), finalElapsedMs(0)
+{
+}
+
+void TransferStats::start(qint64 totalBytes)
+{
+    total = totalBytes;
+    baseBytes = 0;
+    baseKnown = false;
+    sent = 0;
+    lastSampleMs = 0;
+    lastSampleBytes = 0;
+    instantRate = 0.0;
+    finalElapsedMs = 0;
+    samples.clear();
+    timer.start();
+    active = true;
+}
+
+void TransferStats::update(qint64 bytesSent, qint64 totalBytes)
+{
+    if (!active) {
+        return;
+    }
+
+    if (totalBytes > 0) {
+        total = totalBytes;
+    }
+
+    // 第一次进度即续传起点，之后的增量才是本次实际传输的数据
+    if (!baseKnown) {
+        baseBytes = bytesSent;
+        baseKnown = true;
+        lastSampleBytes = bytesSent;
+        lastSampleMs = timer.elapsed();
+    }
+
+    sent = qMax(sent, bytesSent);
+}
+
+void TransferStats::sample()
+{
+    if (!active || !baseKnown) {
+        return;
+    }
+
+    qint64 now = timer.elapsed();
+    qint64 intervalMs = now - lastSampleMs;
+    if (intervalMs <= 0) {
+        return;
+    }
+
+    double rate = (sent - lastSampleBytes) * 1000.0 / intervalMs;
+    if (samples.isEmpty()) {
+        instantRate = rate;
+    } else {
+        instantRate = RATE_SMOOTHING * rate + (1.0 - RATE_SMOOTHING) * instantRate;
+    }
+
+    Sample entry;
+    entry.elapsedMs = now;
+    entry.bytesSent = sent;
+    entry.bytesPerSecond = rate;
+    samples.append(entry);
+
+    lastSampleMs = now;
+    lastSampleBytes = sent;
+}
+
+void TransferStats::stop()
+{
+    if (!active) {
+        return;
+    }
+
+    // 补一条最终采样，保证历史记录覆盖到传输结束
+    sample();
+    finalElapsedMs = timer.elapsed();
+    active = false;
+}
+
+bool TransferStats::isActive() const
+{
+    return active;
+}
+
+qint64 TransferStats::bytesSent() const
+{
+    return sent;
+}
+
+qint64 TransferStats::totalBytes() const
+{
+    return total;
+}
+
+qint64 TransferStats::elapsedMs() const
+{
+    return active ? timer.elapsed() : finalElapsedMs;
+}
+
+int TransferStats::percent() const
+{
+    if (total <= 0) {
+        return 0;
+    }
+    return static_cast<int>(sent * 100 / total);
+}
+
+double TransferStats::instantBytesPerSecond() const
+{
+    return instantRate;
+}
+
+double TransferStats::averageBytesPerSecond() const
+{
+    qint64 elapsed = elapsedMs();
+    if (!baseKnown || elapsed <= 0) {
+        return 0.0;
+    }
+    return (sent - baseBytes) * 1000.0 / elapsed;
+}
+
+qint64 TransferStats::etaSeconds() const
+{
+    qint64 remaining = total - sent;
+    if (remaining <= 0) {
+        return 0;
+    }
+
+    // 优先使用平滑后的瞬时速率，刚开始还没有采样时退回平均速率
+    double rate = instantRate > 0.0 ? instantRate : averageBytesPerSecond();
+    if (rate <= 0.0) {
+        return -1;
+    }
+    return static_cast<qint64>(remaining / rate + 0.5);
+}
+
+const QVector<TransferStats::Sample> &TransferStats::history() const
+{
+    return samples;
+}
+
+QString TransferStats::summaryText() const
+{
+    QString eta;
+    qint64 etaSec = etaSeconds();
+    if (etaSec < 0) {
+        eta = "--:--";
+    } else {
+        eta = formatDuration(etaSec);
+    }
+
+    return QString("%1% (%2/%3)  当前 %4  平均 %5  剩余 %6")
+        .arg(percent())
+        .arg(formatBytes(sent))
+        .arg(formatBytes(total))
+        .arg(formatRate(instantRate))
+        .arg(formatRate(averageBytesPerSecond()))
+        .arg(eta);
+}
+
+QStringList TransferStats::historyReport() const
+{
+    QStringList lines;
+    if (samples.isEmpty()) {
+        return lines;
+    }
+
+    double minRate = samples.first().bytesPerSecond;
+    double maxRate = minRate;
+    for (int i = 0; i < samples.size(); ++i) {
+        minRate = qMin(minRate, samples[i].bytesPerSecond);
+        maxRate = qMax(maxRate, samples[i].bytesPerSecond);
+    }
+
+    lines << QString("[吞吐量] 本次传输 %1，耗时 %2，平均 %3，最低 %4，最高 %5")
+             .arg(formatBytes(sent - baseBytes))
+             .arg(formatDuration(elapsedMs() / 1000))
+             .arg(formatRate(averageBytesPerSecond()))
+             .arg(formatRate(minRate))
+             .arg(formatRate(maxRate));
+
+    // 采样过多时按组合并，每行为该时间段内的平均速率
+    int group = (samples.size() + MAX_REPORT_LINES - 1) / MAX_REPORT_LINES;
+    qint64 prevMs = 0;
+    qint64 prevBytes = baseBytes;
+    for (int i = 0; i < samples.size(); i += group) {
+        const Sample &entry = samples[qMin(i + group, samples.size()) - 1];
+        qint64 spanMs = entry.elapsedMs - prevMs;
+        double rate = spanMs > 0 ? (entry.bytesSent - prevBytes) * 1000.0 / spanMs : 0.0;
+        lines << QString("[吞吐量] %1  %2  %3")
+                 .arg(formatDuration(entry.elapsedMs / 1000))
+                 .arg(formatBytes(entry.bytesSent), 10)
+                 .arg(formatRate(rate), 12);
+        prevMs = entry.elapsedMs;
+        prevBytes = entry.bytesSent;
+    }
+
+    return lines;
+}
+
+QString TransferStats::formatBytes(qint64 bytes)
+{
+    if (bytes < 1024) {
+        return QString("%1 B").arg(bytes);
+    } else if (bytes < 1024 * 1024) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    } else if (bytes < 1024LL * 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    return QString("%1 GB").arg(bytes / (1024.0 * 1024.0 * 1024.0), 0, 'f', 2);
+}
+
+QString TransferStats::formatRate(double bytesPerSecond)
+{
+    return formatBytes(static_cast<qint64>(bytesPerSecond)) + "/s";
+}
+
+QString TransferStats::formatDuration(qint64 seconds)
+{
+    if (seconds < 0) {
+        seconds = 0;
+    }
+    qint64 hours = seconds / 3600;
+    qint64 minutes = (seconds % 3600) / 60;
+    qint64 secs = seconds % 60;
+    if (hours > 0) {
+        return QString("%1:%2:%3")
+            .arg(hours)
+            .arg(minutes, 2, 10, QChar('0'))
+            .arg(secs, 2, 10, QChar('0'));
+    }
+    return QString("%1:%2")
+        .arg(minutes, 2, 10, QChar('0'))
+        .arg(secs, 2, 10, QChar('0'));
+}
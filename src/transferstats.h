@@ -0,0 +1,71 @@
+/**
+ * @File Name: transferstats.h
+ * @brief  传输统计头文件，根据已发送字节数计算瞬时/平均吞吐量和剩余时间，并保存采样历史
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef TRANSFERSTATS_H
+#define TRANSFERSTATS_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
+
+/**
+ * 一次上传的吞吐量统计：
+ * - update() 随传输进度随时调用，只记录最新的已发送字节数
+ * - sample() 由定时器周期调用，生成一条采样并刷新瞬时吞吐量
+ * 续传时起始偏移量不计入本次传输的吞吐量。
+ */
+class TransferStats
+{
+public:
+    struct Sample {
+        qint64 elapsedMs;       // 距本次传输开始的毫秒数
+        qint64 bytesSent;       // 累计已发送字节数（包含续传起点）
+        double bytesPerSecond;  // 该采样区间内的瞬时吞吐量
+    };
+
+    TransferStats();
+
+    void start(qint64 totalBytes);
+    void update(qint64 bytesSent, qint64 totalBytes);
+    void sample();
+    void stop();
+
+    bool isActive() const;
+    qint64 bytesSent() const;
+    qint64 totalBytes() const;
+    qint64 elapsedMs() const;
+    int percent() const;
+    double instantBytesPerSecond() const;
+    double averageBytesPerSecond() const;
+    qint64 etaSeconds() const;
+    const QVector<Sample> &history() const;
+
+    QString summaryText() const;
+    QStringList historyReport() const;
+
+    static QString formatBytes(qint64 bytes);
+    static QString formatRate(double bytesPerSecond);
+    static QString formatDuration(qint64 seconds);
+
+private:
+    QElapsedTimer timer;
+    bool active;
+    qint64 total;
+    qint64 baseBytes;       // 首次收到进度时的字节数（续传起点）
+    bool baseKnown;
+    qint64 sent;
+    qint64 lastSampleMs;
+    qint64 lastSampleBytes;
+    double instantRate;
+    qint64 finalElapsedMs;
+    QVector<Sample> samples;
+};
+
+#endif // TRANSFERSTATS_H
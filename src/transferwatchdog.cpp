@@ -0,0 +1,177 @@
+/**
+ * @File Name: transferwatchdog.cpp
+ * @brief  传输看门狗实现，每秒检查一次进度停滞和截止时间，超限时发出 expired
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "transferwatchdog.h"
+#include "transferstats.h"
+
+const int TransferWatchdog::DEFAULT_STALL_TIMEOUT;
+
+// 检查间隔
+static const int CHECK_INTERVAL_MS = 1000;
+
+// 准备阶段的期限至少为停滞窗口的倍数，且不少于该值
+static const int PREPARE_STALL_FACTOR = 3;
+static const qint64 MIN_PREPARE_MS = 120 * 1000;
+
+// 估算截止时间前至少观察的传输时间
+static const qint64 WARMUP_MS = 15 * 1000;
+
+// 远程读取 / 拼接 / 解压文件的保守速度，用于估算准备和收尾阶段的期限
+static const qint64 REMOTE_PROCESS_BYTES_PER_SECOND = 8 * 1024 * 1024;
+
+static qint64 remoteProcessingMs(qint64 totalBytes)
+{
+    return totalBytes * 1000 / REMOTE_PROCESS_BYTES_PER_SECOND;
+}
+
+TransferWatchdog::TransferWatchdog(QObject *parent)
+    : QObject(parent), stallSeconds(DEFAULT_STALL_TIMEOUT), checkTimer(nullptr), phase(PhaseIdle),
+      total(0), sent(0), firstProgressBytes(0), firstProgressMs(0), lastProgressMs(0),
+      phaseDeadlineMs(0), estimateLogged(false)
+{
+    checkTimer = new QTimer(this);
+    checkTimer->setInterval(CHECK_INTERVAL_MS);
+    connect(checkTimer, &QTimer::timeout, this, &TransferWatchdog::onCheck);
+}
+
+void TransferWatchdog::setStallTimeout(int seconds)
+{
+    stallSeconds = qMax(5, seconds);
+}
+
+int TransferWatchdog::stallTimeout() const
+{
+    return stallSeconds;
+}
+
+void TransferWatchdog::start(qint64 totalBytes)
+{
+    total = totalBytes;
+    sent = 0;
+    firstProgressBytes = 0;
+    firstProgressMs = 0;
+    lastProgressMs = 0;
+    estimateLogged = false;
+    phase = PhasePreparing;
+    clock.start();
+
+    phaseDeadlineMs = prepareBudgetMs(total, stallSeconds);
+    checkTimer->start();
+}
+
+void TransferWatchdog::beginPreparing()
+{
+    if (phase == PhaseIdle || phase == PhasePreparing) {
+        return;
+    }
+
+    // 已发送的字节数保留，下一次进度到来时重新进入传输阶段
+    phase = PhasePreparing;
+    phaseDeadlineMs = clock.elapsed() + prepareBudgetMs(total, stallSeconds);
+}
+
+void TransferWatchdog::update(qint64 bytesSent, qint64 totalBytes)
+{
+    if (phase == PhaseIdle) {
+        return;
+    }
+    if (totalBytes > 0) {
+        total = totalBytes;
+    }
+
+    qint64 now = clock.elapsed();
+    if (phase == PhasePreparing || bytesSent < sent) {
+        // 第一次进度即续传起点；进度回退（例如增量上传改为完整上传）时重新计算
+        phase = PhaseTransferring;
+        estimateLogged = false;
+        firstProgressBytes = bytesSent;
+        firstProgressMs = now;
+        lastProgressMs = now;
+        sent = bytesSent;
+    } else if (bytesSent > sent) {
+        sent = bytesSent;
+        lastProgressMs = now;
+    }
+
+    if (phase == PhaseTransferring && total > 0 && sent >= total) {
+        // 数据已全部发出，剩下远程收尾
+        phase = PhaseFinishing;
+        phaseDeadlineMs = now + finishBudgetMs(total, stallSeconds);
+    }
+}
+
+void TransferWatchdog::stop()
+{
+    phase = PhaseIdle;
+    checkTimer->stop();
+}
+
+bool TransferWatchdog::isActive() const
+{
+    return phase != PhaseIdle;
+}
+
+qint64 TransferWatchdog::prepareBudgetMs(qint64 totalBytes, int stallTimeoutSeconds)
+{
+    return qMax(MIN_PREPARE_MS, stallTimeoutSeconds * 1000LL * PREPARE_STALL_FACTOR) + remoteProcessingMs(totalBytes);
+}
+
+qint64 TransferWatchdog::finishBudgetMs(qint64 totalBytes, int stallTimeoutSeconds)
+{
+    return stallTimeoutSeconds * 1000LL + remoteProcessingMs(totalBytes);
+}
+
+void TransferWatchdog::onCheck()
+{
+    qint64 now = clock.elapsed();
+
+    switch (phase) {
+    case PhaseIdle:
+        checkTimer->stop();
+        return;
+
+    case PhasePreparing:
+        if (now > phaseDeadlineMs) {
+            expire(QString("连接服务器后 %1 内未开始传输数据")
+                   .arg(TransferStats::formatDuration(now / 1000)));
+        }
+        return;
+
+    case PhaseTransferring:
+        if (now - lastProgressMs > stallSeconds * 1000LL) {
+            expire(QString("已连续 %1 秒没有任何传输进度").arg(stallSeconds));
+            return;
+        }
+
+        if (!estimateLogged && now - firstProgressMs >= WARMUP_MS && sent > firstProgressBytes) {
+            // 只提示，不据此终止：链路变慢但仍有进度时继续传输
+            estimateLogged = true;
+            double rate = (sent - firstProgressBytes) * 1000.0 / (now - firstProgressMs);
+            qint64 remainingMs = static_cast<qint64>((total - sent) * 1000.0 / rate);
+            emit logMessage(QString("[看门狗] 平均吞吐量 %1，预计剩余 %2；连续 %3 秒没有进度才会终止")
+                           .arg(TransferStats::formatRate(rate))
+                           .arg(TransferStats::formatDuration(remainingMs / 1000))
+                           .arg(stallSeconds));
+        }
+        return;
+
+    case PhaseFinishing:
+        if (now > phaseDeadlineMs) {
+            expire(QString("数据已全部发送，但远程在预计的 %1 内没有完成处理")
+                   .arg(TransferStats::formatDuration(finishBudgetMs(total, stallSeconds) / 1000)));
+        }
+        return;
+    }
+}
+
+void TransferWatchdog::expire(const QString &reason)
+{
+    stop();
+    emit expired(reason);
+}
@@ -0,0 +1,80 @@
+/**
+ * @File Name: transferwatchdog.h
+ * @brief  传输看门狗头文件，按进度停滞时间和由文件大小、实测吞吐量估算的截止时间判断上传是否需要终止
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef TRANSFERWATCHDOG_H
+#define TRANSFERWATCHDOG_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/**
+ * 取代固定的5分钟超时，分三个阶段判断：
+ * 1. 准备：尚未收到进度（连接、探测远程分块、增量签名），期限为停滞窗口的若干倍，
+ *    另按文件大小加上远程读一遍文件所需的时间（探测和增量签名会在远程计算MD5）
+ * 2. 传输：只有已发送字节数连续超过停滞窗口没有增长才终止，链路再慢只要仍有进度就不会被终止；
+ *    传输满预热时间后按平均吞吐量估算剩余时间，仅用于提示
+ * 3. 收尾：数据已全部发出，等待远程拼接、校验或解压，期限按文件大小和远程处理速度估算
+ * 传输中途进入新的准备阶段（批量上传的下一个文件开始探测、增量上传计算签名和差异）时调用 beginPreparing()，
+ * 这段没有进度的时间按准备阶段的期限计算，不算作停滞。
+ */
+class TransferWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TransferWatchdog(QObject *parent = nullptr);
+
+    void setStallTimeout(int seconds);
+    int stallTimeout() const;
+
+    void start(qint64 totalBytes);
+    void update(qint64 bytesSent, qint64 totalBytes);
+    void beginPreparing();
+    void stop();
+    bool isActive() const;
+
+    // 准备阶段的期限，以及数据全部发出后等待远程收尾的期限（毫秒）
+    static qint64 prepareBudgetMs(qint64 totalBytes, int stallTimeoutSeconds);
+    static qint64 finishBudgetMs(qint64 totalBytes, int stallTimeoutSeconds);
+
+    static const int DEFAULT_STALL_TIMEOUT = 60;
+
+signals:
+    void expired(const QString &reason);
+    void logMessage(const QString &message);
+
+private slots:
+    void onCheck();
+
+private:
+    enum Phase {
+        PhaseIdle,
+        PhasePreparing,
+        PhaseTransferring,
+        PhaseFinishing
+    };
+
+    void expire(const QString &reason);
+
+    int stallSeconds;
+    QTimer *checkTimer;
+    QElapsedTimer clock;
+    Phase phase;
+    qint64 total;
+    qint64 sent;
+    qint64 firstProgressBytes;
+    qint64 firstProgressMs;
+    qint64 lastProgressMs;
+    qint64 phaseDeadlineMs;     // 准备和收尾阶段的期限
+    bool estimateLogged;        // 已按预热期间的吞吐量提示过预计剩余时间
+};
+
+#endif // TRANSFERWATCHDOG_H
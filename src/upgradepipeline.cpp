@@ -0,0 +1,605 @@
+/**
+ * @File Name: upgradepipeline.cpp
+ * @brief  升级流水线实现，生成带步骤标记的远程脚本，按标记行解析每个步骤的执行结果
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "upgradepipeline.h"
+#include "sshsession.h"
+#include "sshutils.h"
+#include <QTimer>
+
+// 远程输出步骤状态的行前缀
+static const char *STEP_MARKER = "@@STEP";
+
+// 解压进度行前缀
+static const char *PROGRESS_MARKER = "@@PROGRESS";
+
+// 按文件头选择解压工具：zstd 格式用 zstd；gzip 格式优先用 pigz（解压、读写和校验分别在不同线程中进行），
+// 设备上没有时用 gzip。压缩包在 shell 中以描述符5打开，解压工具共用同一个文件位置，
+// 每秒从 /proc/<shell>/fdinfo/5 读取已读取的字节数作为进度；tar 不加 -v，文件名不经过SSH通道。
+// 管道中解压工具出错时 tar 未必报错，解压工具的退出码经临时文件带出
+static const char *UNPACK_FUNCTIONS =
+    "pick_dz() {\n"
+    "  case $(head -c 4 \"$1\" 2>/dev/null | od -An -tx1 2>/dev/null | tr -d ' \\n') in\n"
+    "    28b52ffd) dz='zstd -dc' ;;\n"
+    "    *) if command -v pigz >/dev/null 2>&1; then dz='pigz -dc'; else dz='gzip -dc'; fi ;;\n"
+    "  esac\n"
+    "  command -v ${dz%% *} >/dev/null 2>&1 || { echo \"设备上没有 ${dz%% *}，无法解压 $1\" >&2; return 127; }\n"
+    "}\n"
+    "unpack() {\n"
+    "  f=$1; shift\n"
+    "  pick_dz \"$f\" || return\n"
+    "  echo \"解压工具: ${dz%% *}，CPU核数: $(grep -c ^processor /proc/cpuinfo 2>/dev/null)\"\n"
+    "  r=/tmp/.unpack_rc_$$; rm -f \"$r\"\n"
+    "  v=; l=/dev/null; [ -n \"$unpack_list\" ] && { v=v; l=\"$f.files\"; }\n"
+    "  read -r me _ < /proc/self/stat\n"
+    "  total=$(stat -c %s \"$f\")\n"
+    "  exec 5< \"$f\"\n"
+    "  { $dz <&5 || echo $? > \"$r\"; } | tar -x${v}f - \"$@\" > \"$l\" &\n"
+    "  p=$!\n"
+    "  while kill -0 $p 2>/dev/null; do\n"
+    "    echo \"@@PROGRESS $(sed -n 's/^pos:[[:space:]]*//p' /proc/$me/fdinfo/5 2>/dev/null) $total\"\n"
+    "    sleep 1\n"
+    "  done\n"
+    "  wait $p; rc=$?\n"
+    "  exec 5<&-\n"
+    "  [ $rc -eq 0 ] && [ -s \"$r\" ] && rc=$(cat \"$r\"); rm -f \"$r\"\n"
+    "  [ $rc -eq 0 ] || return $rc\n"
+    "  echo \"@@PROGRESS $total $total\"\n"
+    "  [ -z \"$unpack_list\" ] || echo \"文件列表: $l（$(wc -l < \"$l\") 个文件）\"\n"
+    "}";
+
+UpgradePipeline::UpgradePipeline(QObject *parent)
+    : QObject(parent), timeoutSeconds(0), fileListEnabled(false), command(nullptr), timeoutTimer(nullptr), runElapsedMs(0),
+      currentIndex(-1), failedIndex(-1), sshStartFailed(false), errorClass(RetryPolicy::ErrorNone)
+{
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, &UpgradePipeline::onTimeout);
+}
+
+UpgradePipeline::~UpgradePipeline()
+{
+    cleanupCommand();
+}
+
+void UpgradePipeline::reset(const QString &name)
+{
+    pipelineName = name;
+    stepList.clear();
+    stepResults.clear();
+    abortPatterns.clear();
+    timeoutSeconds = 0;
+    failedIndex = -1;
+    reason.clear();
+}
+
+QString UpgradePipeline::name() const
+{
+    return pipelineName;
+}
+
+int UpgradePipeline::addStep(StepType type, const QString &title, const QString &command, const QString &failureHint)
+{
+    Step step;
+    step.type = type;
+    step.title = title;
+    step.command = command;
+    step.failureHint = failureHint;
+    step.repeatable = true;
+    stepList.append(step);
+    return stepList.size() - 1;
+}
+
+void UpgradePipeline::setSkipCondition(int index, const QString &condition)
+{
+    stepList[index].skipCondition = condition;
+}
+
+void UpgradePipeline::setUndoCommand(int index, const QString &command)
+{
+    stepList[index].undoCommand = command;
+}
+
+void UpgradePipeline::setRepeatable(int index, bool repeatable)
+{
+    stepList[index].repeatable = repeatable;
+}
+
+void UpgradePipeline::setDataFile(int index, const QString &remotePath)
+{
+    stepList[index].dataFile = remotePath;
+}
+
+void UpgradePipeline::setTimeout(int seconds)
+{
+    timeoutSeconds = seconds;
+}
+
+void UpgradePipeline::setFileListEnabled(bool enabled)
+{
+    fileListEnabled = enabled;
+}
+
+void UpgradePipeline::setAbortPatterns(const QStringList &patterns)
+{
+    abortPatterns = patterns;
+}
+
+const QList<UpgradePipeline::Step> &UpgradePipeline::steps() const
+{
+    return stepList;
+}
+
+const QList<UpgradePipeline::StepResult> &UpgradePipeline::results() const
+{
+    return stepResults;
+}
+
+QString UpgradePipeline::script() const
+{
+    // 设备开机以来的秒数（精确到0.01秒），用于在设备上计算每个步骤的耗时
+    QStringList lines;
+    lines << "upt() { cut -d' ' -f1 /proc/uptime 2>/dev/null; }"
+          << UNPACK_FUNCTIONS;
+    if (fileListEnabled) {
+        lines << "unpack_list=1";
+    }
+    for (int i = 0; i < stepList.size(); ++i) {
+        const Step &step = stepList.at(i);
+
+        // 失败时撤销此前已完成的步骤，脚本以1退出，与 ssh 自身出错的255区分
+        QString undo;
+        for (int j = i - 1; j >= 0; --j) {
+            if (!stepList.at(j).undoCommand.isEmpty()) {
+                undo += QString("[ -n \"$undo_%1\" ] && ( %2 ) >/dev/null; ").arg(j).arg(stepList.at(j).undoCommand);
+            }
+        }
+
+        QStringList body;
+        body << QString("( %1 ); rc=$?").arg(step.command)
+             << QString("echo \"%1 %2 end $rc $(upt)\"").arg(STEP_MARKER).arg(i)
+             << QString("[ $rc -eq 0 ] || { %1exit 1; }").arg(undo);
+        if (!step.undoCommand.isEmpty()) {
+            body << QString("undo_%1=1").arg(i);
+        }
+
+        QString size;
+        if (!step.dataFile.isEmpty()) {
+            size = QString(" $(stat -c %s %1 2>/dev/null)").arg(SshUtils::shellQuote(step.dataFile));
+        }
+        lines << QString("echo \"%1 %2 begin $(upt)%3\"").arg(STEP_MARKER).arg(i).arg(size);
+        if (step.skipCondition.isEmpty()) {
+            lines << body;
+        } else {
+            lines << QString("if ( %1 ) >/dev/null 2>&1; then echo '%2 %3 skip'; else").arg(step.skipCondition).arg(STEP_MARKER).arg(i)
+                  << body
+                  << "fi";
+        }
+    }
+    return lines.join("\n");
+}
+
+bool UpgradePipeline::isRunning() const
+{
+    return command != nullptr;
+}
+
+QDateTime UpgradePipeline::startedAt() const
+{
+    return runStartedAt;
+}
+
+qint64 UpgradePipeline::totalElapsedMs() const
+{
+    return command ? runTimer.elapsed() : runElapsedMs;
+}
+
+int UpgradePipeline::failedStep() const
+{
+    return failedIndex;
+}
+
+QString UpgradePipeline::failureReason() const
+{
+    return reason;
+}
+
+bool UpgradePipeline::unrepeatableStepStarted() const
+{
+    for (int i = 0; i < stepList.size() && i < stepResults.size(); ++i) {
+        StepStatus status = stepResults.at(i).status;
+        if (!stepList.at(i).repeatable && status != StatusPending && status != StatusSkipped) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UpgradePipeline::startFailed() const
+{
+    return sshStartFailed;
+}
+
+RetryPolicy::ErrorClass UpgradePipeline::lastErrorClass() const
+{
+    return errorClass;
+}
+
+QStringList UpgradePipeline::summary() const
+{
+    QStringList lines;
+    for (int i = 0; i < stepList.size() && i < stepResults.size(); ++i) {
+        const StepResult &result = stepResults.at(i);
+        QString line = QString("%1. [%2] %3 - %4").arg(i + 1).arg(typeName(stepList.at(i).type))
+                       .arg(stepList.at(i).title).arg(statusName(result.status));
+        if (result.status == StatusSucceeded || result.status == StatusFailed) {
+            line += QString("，耗时 %1 秒").arg(result.elapsedMs / 1000.0, 0, 'f', 1);
+            if (result.deviceElapsedMs >= 0) {
+                line += QString("（设备 %1 秒）").arg(result.deviceElapsedMs / 1000.0, 0, 'f', 1);
+            }
+        }
+        if (result.status == StatusFailed) {
+            line += QString("，退出码 %1").arg(result.exitCode);
+        }
+        lines << line;
+    }
+    return lines;
+}
+
+QString UpgradePipeline::typeName(StepType type)
+{
+    switch (type) {
+    case StepCheck:
+        return "检查";
+    case StepMount:
+        return "挂载";
+    case StepExtract:
+        return "解压";
+    case StepRun:
+        return "执行";
+    case StepSync:
+        return "同步";
+    case StepUnmount:
+        return "卸载";
+    }
+    return QString();
+}
+
+QString UpgradePipeline::statusName(StepStatus status)
+{
+    switch (status) {
+    case StatusPending:
+        return "未执行";
+    case StatusRunning:
+        return "执行中";
+    case StatusSucceeded:
+        return "成功";
+    case StatusSkipped:
+        return "已满足，跳过";
+    case StatusFailed:
+        return "失败";
+    }
+    return QString();
+}
+
+QString UpgradePipeline::extractCommand(const QString &archive, const QString &targetDir, const QString &tarOptions)
+{
+    QString command = QString("unpack %1").arg(SshUtils::shellQuote(archive));
+    if (!targetDir.isEmpty()) {
+        command += QString(" -C %1").arg(SshUtils::shellQuote(targetDir));
+    }
+    if (!tarOptions.isEmpty()) {
+        command += ' ' + tarOptions;
+    }
+    return command;
+}
+
+QString UpgradePipeline::testArchiveCommand(const QString &archive)
+{
+    QString quoted = SshUtils::shellQuote(archive);
+    return QString("pick_dz %1 && $dz %1 > /dev/null").arg(quoted);
+}
+
+void UpgradePipeline::start(SshSession *session)
+{
+    cleanupCommand();
+
+    stepResults.clear();
+    deviceBeginTimes.clear();
+    for (int i = 0; i < stepList.size(); ++i) {
+        StepResult result;
+        result.status = StatusPending;
+        result.exitCode = -1;
+        result.startOffsetMs = 0;
+        result.elapsedMs = 0;
+        result.deviceElapsedMs = -1;
+        result.bytes = -1;
+        stepResults.append(result);
+        deviceBeginTimes.append(-1);
+    }
+    outputBuffer.clear();
+    pendingOutput.clear();
+    errorOutput.clear();
+    currentIndex = -1;
+    failedIndex = -1;
+    reason.clear();
+    sshStartFailed = false;
+    errorClass = RetryPolicy::ErrorNone;
+
+    command = new SshCommand(this);
+    connect(command, &SshCommand::readyReadStandardOutput, this, &UpgradePipeline::onReadyReadOutput);
+    connect(command, &SshCommand::readyReadStandardError, this, &UpgradePipeline::onReadyReadError);
+    connect(command, &SshCommand::finished, this, &UpgradePipeline::onCommandFinished);
+    connect(command, &SshCommand::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            sshStartFailed = true;
+            reason = "无法启动SSH进程";
+        }
+    });
+
+    runStartedAt = QDateTime::currentDateTime();
+    runTimer.start();
+    runElapsedMs = 0;
+    command->start(session, script());
+    if (timeoutSeconds > 0) {
+        timeoutTimer->start(timeoutSeconds * 1000);
+    }
+}
+
+void UpgradePipeline::cancel()
+{
+    if (!command) {
+        return;
+    }
+    abort("用户取消");
+}
+
+void UpgradePipeline::onReadyReadOutput()
+{
+    outputBuffer += command->readAllStandardOutput();
+    handleOutputLines(false);
+}
+
+void UpgradePipeline::onReadyReadError()
+{
+    QString text = QString::fromUtf8(command->readAllStandardError());
+    if (text.isEmpty()) {
+        return;
+    }
+
+    errorOutput += text;
+    if (currentIndex >= 0 && stepResults.at(currentIndex).status == StatusRunning) {
+        stepResults[currentIndex].errorOutput += text;
+    }
+    emit errorReceived(currentIndex, text);
+
+    for (const QString &pattern : abortPatterns) {
+        if (text.contains(pattern)) {
+            abort(QString("检测到严重错误: %1").arg(text.trimmed()));
+            return;
+        }
+    }
+}
+
+void UpgradePipeline::onCommandFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    timeoutTimer->stop();
+    runElapsedMs = runTimer.elapsed();
+
+    outputBuffer += command->readAllStandardOutput();
+    handleOutputLines(true);
+    errorOutput += QString::fromUtf8(command->readAllStandardError());
+
+    // 正在执行的步骤没有结束标记：连接中断或被本地终止
+    if (currentIndex >= 0 && stepResults.at(currentIndex).status == StatusRunning) {
+        StepResult &result = stepResults[currentIndex];
+        result.status = StatusFailed;
+        result.exitCode = exitCode;
+        result.elapsedMs = stepTimer.elapsed();
+        failedIndex = currentIndex;
+        emit stepFinished(currentIndex);
+    }
+
+    bool allDone = true;
+    for (const StepResult &result : stepResults) {
+        if (result.status != StatusSucceeded && result.status != StatusSkipped) {
+            allDone = false;
+        }
+    }
+    bool success = exitStatus == QProcess::NormalExit && exitCode == 0 && allDone;
+
+    if (!success) {
+        errorClass = RetryPolicy::classify(exitCode, exitStatus, errorOutput,
+                                           sshStartFailed ? QProcess::FailedToStart : QProcess::UnknownError);
+        if (errorClass == RetryPolicy::ErrorNone) {
+            errorClass = RetryPolicy::ErrorRemote;
+        }
+
+        if (reason.isEmpty()) {
+            QString stepTitle = failedIndex >= 0 ? QString("「%1」").arg(stepList.at(failedIndex).title) : QString();
+            if (errorClass == RetryPolicy::ErrorNetwork || errorClass == RetryPolicy::ErrorAuth) {
+                reason = QString("%1执行时%2").arg(stepTitle).arg(RetryPolicy::className(errorClass));
+            } else if (failedIndex >= 0) {
+                reason = QString("步骤%1失败，退出码 %2").arg(stepTitle).arg(stepResults.at(failedIndex).exitCode);
+            } else {
+                reason = QString("远程脚本提前结束 (退出码: %1)").arg(exitCode);
+            }
+        }
+    }
+
+    cleanupCommand();
+    emit finished(success);
+}
+
+void UpgradePipeline::onTimeout()
+{
+    if (command) {
+        abort(QString("执行超时（超过 %1 秒）").arg(timeoutSeconds));
+    }
+}
+
+void UpgradePipeline::handleOutputLines(bool flushAll)
+{
+    QByteArray markerPrefix = QByteArray(STEP_MARKER) + " ";
+    QByteArray progressPrefix = QByteArray(PROGRESS_MARKER) + " ";
+    int newline;
+    while ((newline = outputBuffer.indexOf('\n')) >= 0) {
+        QByteArray line = outputBuffer.left(newline);
+        outputBuffer.remove(0, newline + 1);
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        if (line.startsWith(markerPrefix)) {
+            flushPendingOutput();
+            handleMarker(line.mid(markerPrefix.size()));
+        } else if (line.startsWith(progressPrefix)) {
+            handleProgress(line.mid(progressPrefix.size()));
+        } else {
+            pendingOutput << QString::fromUtf8(line);
+        }
+    }
+
+    if (flushAll && !outputBuffer.isEmpty()) {
+        pendingOutput << QString::fromUtf8(outputBuffer);
+        outputBuffer.clear();
+    }
+    flushPendingOutput();
+}
+
+void UpgradePipeline::handleMarker(const QByteArray &line)
+{
+    Marker marker;
+    if (!parseMarker(line, &marker) || marker.index >= stepResults.size()) {
+        return;
+    }
+
+    int index = marker.index;
+    StepResult &result = stepResults[index];
+    if (marker.event == "begin") {
+        currentIndex = index;
+        result.status = StatusRunning;
+        result.startOffsetMs = runTimer.elapsed();
+        deviceBeginTimes[index] = marker.deviceTime;
+        result.bytes = marker.bytes;
+        stepTimer.start();
+        emit stepStarted(index);
+    } else if (marker.event == "skip") {
+        result.status = StatusSkipped;
+        result.exitCode = 0;
+        emit stepFinished(index);
+    } else {
+        result.exitCode = marker.exitCode;
+        result.elapsedMs = stepTimer.elapsed();
+        if (marker.deviceTime >= 0 && deviceBeginTimes.at(index) >= 0 && marker.deviceTime >= deviceBeginTimes.at(index)) {
+            result.deviceElapsedMs = qRound64((marker.deviceTime - deviceBeginTimes.at(index)) * 1000.0);
+        }
+        result.status = result.exitCode == 0 ? StatusSucceeded : StatusFailed;
+        if (result.status == StatusFailed) {
+            failedIndex = index;
+        }
+        emit stepFinished(index);
+    }
+}
+
+void UpgradePipeline::handleProgress(const QByteArray &line)
+{
+    qint64 done = 0;
+    qint64 total = 0;
+    if (currentIndex >= 0 && parseProgress(line, &done, &total)) {
+        emit progressChanged(currentIndex, done, total);
+    }
+}
+
+bool UpgradePipeline::parseMarker(const QByteArray &line, Marker *marker)
+{
+    // "<序号> begin <设备时间> [数据量]" / "<序号> skip" / "<序号> end <退出码> <设备时间>"
+    QList<QByteArray> fields = line.split(' ');
+    bool ok = false;
+    marker->index = fields.value(0).toInt(&ok);
+    marker->event = fields.value(1);
+    marker->exitCode = 0;
+    marker->deviceTime = -1;
+    marker->bytes = -1;
+    if (!ok || marker->index < 0) {
+        return false;
+    }
+
+    if (marker->event == "begin") {
+        double deviceTime = fields.value(2).toDouble(&ok);
+        if (ok) {
+            marker->deviceTime = deviceTime;
+        }
+        qint64 bytes = fields.value(3).toLongLong(&ok);
+        if (ok) {
+            marker->bytes = bytes;
+        }
+        return true;
+    }
+    if (marker->event == "skip") {
+        return true;
+    }
+    if (marker->event == "end") {
+        marker->exitCode = fields.value(2).toInt();
+        double deviceTime = fields.value(3).toDouble(&ok);
+        if (ok) {
+            marker->deviceTime = deviceTime;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool UpgradePipeline::parseProgress(const QByteArray &line, qint64 *done, qint64 *total)
+{
+    // "<已读取字节> <总字节>"，设备读不到 fdinfo 时已读取字节为空
+    QList<QByteArray> fields = line.simplified().split(' ');
+    if (fields.size() != 2) {
+        return false;
+    }
+    bool doneOk = false;
+    bool totalOk = false;
+    qint64 doneBytes = fields.at(0).toLongLong(&doneOk);
+    qint64 totalBytes = fields.at(1).toLongLong(&totalOk);
+    if (!doneOk || !totalOk || totalBytes <= 0) {
+        return false;
+    }
+    *done = qMin(doneBytes, totalBytes);
+    *total = totalBytes;
+    return true;
+}
+
+void UpgradePipeline::flushPendingOutput()
+{
+    if (pendingOutput.isEmpty()) {
+        return;
+    }
+    QString text = pendingOutput.join("\n");
+    pendingOutput.clear();
+    emit outputReceived(currentIndex, text);
+}
+
+void UpgradePipeline::abort(const QString &abortReason)
+{
+    reason = abortReason;
+    if (command) {
+        // SshCommand::kill() 同步发出 finished，由 onCommandFinished 记录结果
+        command->kill();
+    }
+}
+
+void UpgradePipeline::cleanupCommand()
+{
+    timeoutTimer->stop();
+    if (command) {
+        command->disconnect(this);
+        command->kill();
+        command->deleteLater();
+        command = nullptr;
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @File Name: upgradepipeline.h
+ * @brief  升级流水线头文件，把升级描述为一组有类型的步骤（检查、挂载、解压、执行、同步、卸载），
+ *         在一条SSH会话中依次执行，记录每个步骤的退出码、耗时和输出
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef UPGRADEPIPELINE_H
+#define UPGRADEPIPELINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include "retrypolicy.h"
+
+class QTimer;
+class SshCommand;
+class SshSession;
+
+/**
+ * 执行方式：
+ * - 所有步骤生成一个远程脚本，作为一条命令在常驻会话上执行；每个步骤在子 shell 中运行，
+ *   前后输出 "@@STEP <序号> begin" 和 "@@STEP <序号> end <退出码>"，满足跳过条件时输出 "@@STEP <序号> skip"
+ * - 某个步骤失败后不再执行后续步骤，已完成步骤登记的撤销命令（如卸载已挂载的分区）按相反顺序执行
+ * - 标准输出按标记行归入对应步骤；标准错误没有标记，按到达时正在执行的步骤归类
+ * - 标记行同时带上设备的 /proc/uptime，每个步骤同时有设备上测得的耗时和本地按标记到达时间测得的耗时
+ *   （后者包含网络延迟）；设置了 setDataFile() 的步骤在开始时报告该远程文件的大小
+ * - 解压步骤使用 extractCommand()：按文件头选择 zstd，gzip 格式在设备有 pigz 时用 pigz 多线程解压，否则用 gzip；
+ *   解压时不逐个输出文件名，每秒输出一行 "@@PROGRESS <已读取字节> <压缩包大小>"，解析后以 progressChanged() 通知；
+ *   setFileListEnabled() 打开时文件列表写到设备上压缩包旁的 <压缩包>.files
+ * 失败时 failedStep() 给出失败的步骤和退出码，无需再从合并的输出中猜测原因。
+ * 标准错误中出现 setAbortPatterns() 指定的内容（硬件I/O错误等）时立即终止；超过 setTimeout() 时同样终止。
+ */
+class UpgradePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum StepType {
+        StepCheck,
+        StepMount,
+        StepExtract,
+        StepRun,
+        StepSync,
+        StepUnmount
+    };
+
+    enum StepStatus {
+        StatusPending,
+        StatusRunning,
+        StatusSucceeded,
+        StatusSkipped,
+        StatusFailed
+    };
+
+    struct Step {
+        StepType type;
+        QString title;          // 中文名称，用于日志和结果对话框
+        QString command;
+        QString skipCondition;  // 远程条件成立（退出码为0）时跳过本步骤
+        QString undoCommand;    // 后续步骤失败时撤销本步骤的命令
+        QString failureHint;    // 本步骤失败时给出的处理建议
+        QString dataFile;       // 本步骤处理的远程文件（如升级包），其大小记入结果
+        bool repeatable;        // 连接中断后能否重新执行（烧写类步骤不能）
+    };
+
+    // 步骤标记行去掉 "@@STEP " 前缀后的内容
+    struct Marker {
+        int index;
+        QByteArray event;       // begin / skip / end
+        int exitCode;           // end 时的退出码
+        double deviceTime;      // 设备的 /proc/uptime，设备不支持时为 -1
+        qint64 bytes;           // begin 时报告的数据量，未报告时为 -1
+    };
+
+    struct StepResult {
+        StepStatus status;
+        int exitCode;
+        qint64 startOffsetMs;   // 相对流水线开始的时间
+        qint64 elapsedMs;       // 本地测得的耗时
+        qint64 deviceElapsedMs; // 设备上测得的耗时，设备不支持时为 -1
+        qint64 bytes;           // 处理的数据量，未知时为 -1
+        QString errorOutput;
+    };
+
+    explicit UpgradePipeline(QObject *parent = nullptr);
+    ~UpgradePipeline();
+
+    // 清空步骤，开始描述一个新的流水线
+    void reset(const QString &name);
+    QString name() const;
+
+    int addStep(StepType type, const QString &title, const QString &command, const QString &failureHint = QString());
+    void setSkipCondition(int index, const QString &condition);
+    void setUndoCommand(int index, const QString &command);
+    void setRepeatable(int index, bool repeatable);
+    void setDataFile(int index, const QString &remotePath);
+
+    void setTimeout(int seconds);
+    void setFileListEnabled(bool enabled);
+    void setAbortPatterns(const QStringList &patterns);
+
+    const QList<Step> &steps() const;
+    const QList<StepResult> &results() const;
+    QString script() const;
+
+    bool isRunning() const;
+    QDateTime startedAt() const;
+    qint64 totalElapsedMs() const;
+    int failedStep() const;
+    QString failureReason() const;
+
+    // 不可重复执行的步骤已经开始后，连接中断也不应自动重新执行
+    bool unrepeatableStepStarted() const;
+
+    // ssh 程序无法启动（没有执行任何步骤）
+    bool startFailed() const;
+
+    // 最近一次失败的类别，步骤自身失败归为远程命令失败
+    RetryPolicy::ErrorClass lastErrorClass() const;
+
+    // 每个步骤一行：序号、类型、名称、结果、耗时
+    QStringList summary() const;
+
+    static QString typeName(StepType type);
+    static QString statusName(StepStatus status);
+
+    // 解压升级包到目标目录（为空时解压到当前目录），tarOptions 附加在 tar 参数之后
+    static QString extractCommand(const QString &archive, const QString &targetDir,
+                                  const QString &tarOptions = QString());
+    // 完整解压一遍但不写出文件，用于检查压缩包是否完整
+    static QString testArchiveCommand(const QString &archive);
+
+    // 解析步骤标记行和 "@@PROGRESS " 之后的进度行，格式不对时返回 false；进度的已读取字节不超过总字节
+    static bool parseMarker(const QByteArray &line, Marker *marker);
+    static bool parseProgress(const QByteArray &line, qint64 *done, qint64 *total);
+
+    void start(SshSession *session);
+    void cancel();
+
+signals:
+    void stepStarted(int index);
+    void stepFinished(int index);
+    void outputReceived(int index, const QString &text);
+    void errorReceived(int index, const QString &text);
+    void progressChanged(int index, qint64 done, qint64 total);
+    void finished(bool success);
+
+private slots:
+    void onReadyReadOutput();
+    void onReadyReadError();
+    void onCommandFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onTimeout();
+
+private:
+    void handleOutputLines(bool flushAll);
+    void handleMarker(const QByteArray &line);
+    void handleProgress(const QByteArray &line);
+    void flushPendingOutput();
+    void abort(const QString &abortReason);
+    void cleanupCommand();
+
+    QString pipelineName;
+    QList<Step> stepList;
+    QList<StepResult> stepResults;
+    QStringList abortPatterns;
+    int timeoutSeconds;
+    bool fileListEnabled;
+
+    SshCommand *command;
+    QTimer *timeoutTimer;
+    QElapsedTimer stepTimer;
+    QElapsedTimer runTimer;
+    QDateTime runStartedAt;
+    qint64 runElapsedMs;
+    QList<double> deviceBeginTimes;
+    QByteArray outputBuffer;
+    QStringList pendingOutput;
+    QString errorOutput;
+    int currentIndex;
+    int failedIndex;
+    QString reason;
+    bool sshStartFailed;
+    RetryPolicy::ErrorClass errorClass;
+};
+
+#endif // UPGRADEPIPELINE_H
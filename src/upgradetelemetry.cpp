@@ -0,0 +1,234 @@
+/**
+ * @File Name: upgradetelemetry.cpp
+ * @brief  升级耗时记录实现，按行读写 JSON 记录并按步骤汇总耗时
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "upgradetelemetry.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QByteArray>
+#include <QStringList>
+#include <QMap>
+
+// 记录文件超过该大小时只保留最近的 MAX_KEPT_RUNS 条记录
+static const qint64 MAX_FILE_SIZE = 8 * 1024 * 1024;
+static const int MAX_KEPT_RUNS = 2000;
+
+UpgradeTelemetry::UpgradeTelemetry(const QString &filePath)
+    : telemetryFilePath(filePath)
+{
+}
+
+UpgradeTelemetry::RunRecord UpgradeTelemetry::fromPipeline(const UpgradePipeline &pipeline, bool success)
+{
+    RunRecord record;
+    record.startedAt = pipeline.startedAt();
+    record.upgrade = pipeline.name();
+    record.success = success;
+    record.failureReason = pipeline.failureReason();
+    record.totalMs = pipeline.totalElapsedMs();
+
+    const QList<UpgradePipeline::Step> &steps = pipeline.steps();
+    const QList<UpgradePipeline::StepResult> &results = pipeline.results();
+    for (int i = 0; i < steps.size() && i < results.size(); ++i) {
+        StepRecord step;
+        step.type = steps.at(i).type;
+        step.title = steps.at(i).title;
+        step.status = results.at(i).status;
+        step.exitCode = results.at(i).exitCode;
+        step.offsetMs = results.at(i).startOffsetMs;
+        step.clientMs = results.at(i).elapsedMs;
+        step.deviceMs = results.at(i).deviceElapsedMs;
+        step.bytes = results.at(i).bytes;
+        record.steps.append(step);
+    }
+    return record;
+}
+
+qint64 UpgradeTelemetry::stepDuration(const StepRecord &step)
+{
+    return step.deviceMs >= 0 ? step.deviceMs : step.clientMs;
+}
+
+QString UpgradeTelemetry::stepKey(const RunRecord &run, int index)
+{
+    int type = run.steps.at(index).type;
+    int occurrence = 0;
+    for (int i = 0; i < index; ++i) {
+        if (run.steps.at(i).type == type) {
+            occurrence++;
+        }
+    }
+    return QString("%1#%2").arg(type).arg(occurrence);
+}
+
+bool UpgradeTelemetry::append(const RunRecord &record)
+{
+    QFile file(telemetryFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+    QByteArray line = QJsonDocument(toJson(record)).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    bool ok = file.write(line) == line.size();
+    file.close();
+
+    if (QFileInfo(telemetryFilePath).size() > MAX_FILE_SIZE) {
+        trim();
+    }
+    return ok;
+}
+
+QList<UpgradeTelemetry::RunRecord> UpgradeTelemetry::load(int maxRuns) const
+{
+    QList<RunRecord> runs;
+    QFile file(telemetryFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return runs;
+    }
+
+    // 无法解析的行（如写入中途断电留下的半行）直接跳过
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        RunRecord record;
+        if (fromJson(QJsonDocument::fromJson(line).object(), record)) {
+            runs.append(record);
+            if (maxRuns > 0 && runs.size() > maxRuns) {
+                runs.removeFirst();
+            }
+        }
+    }
+    return runs;
+}
+
+void UpgradeTelemetry::trim()
+{
+    QList<RunRecord> runs = load(MAX_KEPT_RUNS);
+
+    QFile file(telemetryFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return;
+    }
+    for (const RunRecord &record : runs) {
+        file.write(QJsonDocument(toJson(record)).toJson(QJsonDocument::Compact));
+        file.write("\n");
+    }
+    file.close();
+}
+
+QList<UpgradeTelemetry::StepStats> UpgradeTelemetry::aggregate(const QList<RunRecord> &runs)
+{
+    // 按升级类型和步骤标识分组，保持步骤首次出现的顺序；标题含路径等设置，不作为分组依据
+    QList<StepStats> stats;
+    QMap<QString, int> indexes;
+    for (const RunRecord &run : runs) {
+        for (int i = 0; i < run.steps.size(); ++i) {
+            const StepRecord &step = run.steps.at(i);
+            if (step.status != UpgradePipeline::StatusSucceeded && step.status != UpgradePipeline::StatusFailed) {
+                continue;
+            }
+
+            QString stepId = stepKey(run, i);
+            QString key = run.upgrade + QChar('\n') + stepId;
+            if (!indexes.contains(key)) {
+                StepStats entry;
+                entry.upgrade = run.upgrade;
+                entry.type = step.type;
+                entry.key = stepId;
+                entry.count = 0;
+                entry.totalMs = 0;
+                entry.maxMs = 0;
+                entry.totalBytes = 0;
+                entry.bytesMs = 0;
+                indexes.insert(key, stats.size());
+                stats.append(entry);
+            }
+
+            StepStats &entry = stats[indexes.value(key)];
+            entry.title = step.title;
+            qint64 duration = stepDuration(step);
+            entry.count++;
+            entry.totalMs += duration;
+            entry.maxMs = qMax(entry.maxMs, duration);
+            if (step.bytes > 0) {
+                entry.totalBytes += step.bytes;
+                entry.bytesMs += duration;
+            }
+        }
+    }
+    return stats;
+}
+
+QJsonObject UpgradeTelemetry::toJson(const RunRecord &record)
+{
+    QJsonArray steps;
+    for (const StepRecord &step : record.steps) {
+        QJsonObject obj;
+        obj["type"] = step.type;
+        obj["title"] = step.title;
+        obj["status"] = step.status;
+        obj["exitCode"] = step.exitCode;
+        obj["offset"] = static_cast<double>(step.offsetMs);
+        obj["client"] = static_cast<double>(step.clientMs);
+        obj["device"] = static_cast<double>(step.deviceMs);
+        obj["bytes"] = static_cast<double>(step.bytes);
+        steps.append(obj);
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["startedAt"] = record.startedAt.toString(Qt::ISODate);
+    root["upgrade"] = record.upgrade;
+    root["device"] = record.device;
+    root["package"] = record.packageFile;
+    root["digest"] = record.packageDigest;
+    root["digestName"] = record.packageDigestName;
+    root["success"] = record.success;
+    root["reason"] = record.failureReason;
+    root["total"] = static_cast<double>(record.totalMs);
+    root["steps"] = steps;
+    return root;
+}
+
+bool UpgradeTelemetry::fromJson(const QJsonObject &obj, RunRecord &record)
+{
+    if (obj.value("version").toInt() != 1) {
+        return false;
+    }
+
+    record.startedAt = QDateTime::fromString(obj.value("startedAt").toString(), Qt::ISODate);
+    record.upgrade = obj.value("upgrade").toString();
+    record.device = obj.value("device").toString();
+    record.packageFile = obj.value("package").toString();
+    record.packageDigest = obj.value("digest").toString();
+    record.packageDigestName = obj.value("digestName").toString();
+    record.success = obj.value("success").toBool();
+    record.failureReason = obj.value("reason").toString();
+    record.totalMs = static_cast<qint64>(obj.value("total").toDouble());
+    record.steps.clear();
+
+    QJsonArray steps = obj.value("steps").toArray();
+    for (int i = 0; i < steps.size(); ++i) {
+        QJsonObject stepObj = steps.at(i).toObject();
+        StepRecord step;
+        step.type = stepObj.value("type").toInt();
+        step.title = stepObj.value("title").toString();
+        step.status = stepObj.value("status").toInt();
+        step.exitCode = stepObj.value("exitCode").toInt();
+        step.offsetMs = static_cast<qint64>(stepObj.value("offset").toDouble());
+        step.clientMs = static_cast<qint64>(stepObj.value("client").toDouble());
+        step.deviceMs = static_cast<qint64>(stepObj.value("device").toDouble(-1));
+        step.bytes = static_cast<qint64>(stepObj.value("bytes").toDouble(-1));
+        record.steps.append(step);
+    }
+    return record.startedAt.isValid();
+}
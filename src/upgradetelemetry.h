@@ -0,0 +1,92 @@
+/**
+ * @File Name: upgradetelemetry.h
+ * @brief  升级耗时记录头文件，每次升级保存一条结构化记录（设备、升级包摘要、各步骤耗时和数据量），
+ *         用于在多次升级之间比较各步骤的耗时
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef UPGRADETELEMETRY_H
+#define UPGRADETELEMETRY_H
+
+#include <QString>
+#include <QList>
+#include <QDateTime>
+#include <QJsonObject>
+#include "upgradepipeline.h"
+
+/**
+ * 耗时记录文件：每行一条 JSON 格式的升级记录，只追加不改写，文件过大时保留最近的记录。
+ * - 步骤耗时同时保存本地测得的值和设备上测得的值，设备耗时不可用时为 -1
+ * - aggregate() 按升级类型和步骤汇总次数、平均/最长耗时和平均速率，用于找出拖慢升级的步骤；
+ *   步骤按类型及其在本次升级中同类步骤的序号识别，标题中的路径等设置变化后仍归为同一步骤
+ */
+class UpgradeTelemetry
+{
+public:
+    struct StepRecord {
+        int type;
+        QString title;
+        int status;
+        int exitCode;
+        qint64 offsetMs;
+        qint64 clientMs;
+        qint64 deviceMs;
+        qint64 bytes;
+    };
+
+    struct RunRecord {
+        QDateTime startedAt;
+        QString upgrade;
+        QString device;
+        QString packageFile;
+        QString packageDigest;
+        QString packageDigestName;      // 摘要算法名称，如 "MD5"、"XXH64"
+        bool success;
+        QString failureReason;
+        qint64 totalMs;
+        QList<StepRecord> steps;
+    };
+
+    struct StepStats {
+        QString upgrade;
+        int type;
+        QString key;            // 步骤类型和同类步骤序号，见 stepKey()
+        QString title;          // 最近一次执行时的步骤标题
+        int count;
+        qint64 totalMs;
+        qint64 maxMs;
+        qint64 totalBytes;      // 有数据量的执行次数累计的数据量
+        qint64 bytesMs;         // 上述执行次数累计的耗时，用于计算平均速率
+    };
+
+    explicit UpgradeTelemetry(const QString &filePath);
+
+    // 由执行完毕的流水线生成记录，设备和升级包信息由调用方填写
+    static RunRecord fromPipeline(const UpgradePipeline &pipeline, bool success);
+
+    // 步骤的有效耗时：优先使用设备上测得的值
+    static qint64 stepDuration(const StepRecord &step);
+
+    // 步骤在多次升级之间的标识："类型#序号"，序号为该步骤之前同类步骤的个数
+    static QString stepKey(const RunRecord &run, int index);
+
+    bool append(const RunRecord &record);
+
+    // 按时间顺序返回最近的 maxRuns 条记录
+    QList<RunRecord> load(int maxRuns) const;
+
+    static QList<StepStats> aggregate(const QList<RunRecord> &runs);
+
+    static QJsonObject toJson(const RunRecord &record);
+    static bool fromJson(const QJsonObject &obj, RunRecord &record);
+
+private:
+    void trim();
+
+    QString telemetryFilePath;
+};
+
+#endif // UPGRADETELEMETRY_H
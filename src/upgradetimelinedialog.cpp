@@ -0,0 +1,329 @@
+/**
+ * @File Name: upgradetimelinedialog.cpp
+ * @brief  升级耗时记录对话框实现，读取耗时记录文件，绘制步骤时间轴并汇总各步骤耗时
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#include "upgradetimelinedialog.h"
+#include "transferstats.h"
+#include <QHeaderView>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QFontMetrics>
+#include <QColor>
+
+// 最多读取的历史记录条数
+static const int MAX_LOADED_RUNS = 1000;
+
+// 时间轴布局
+static const int ROW_HEIGHT = 26;
+static const int AXIS_HEIGHT = 24;
+static const int LABEL_WIDTH = 170;
+static const int AXIS_TICKS = 5;
+
+static QString formatSeconds(qint64 ms)
+{
+    return QString("%1 秒").arg(ms / 1000.0, 0, 'f', 1);
+}
+
+static QColor statusColor(int status)
+{
+    switch (status) {
+    case UpgradePipeline::StatusSucceeded:
+        return QColor("#4caf50");
+    case UpgradePipeline::StatusFailed:
+        return QColor("#e53935");
+    case UpgradePipeline::StatusRunning:
+        return QColor("#fb8c00");     // 执行中被中断
+    case UpgradePipeline::StatusSkipped:
+        return QColor("#bdbdbd");
+    default:
+        return QColor("#eeeeee");
+    }
+}
+
+UpgradeTimelineView::UpgradeTimelineView(QWidget *parent)
+    : QWidget(parent), hasRun(false)
+{
+    setMinimumHeight(AXIS_HEIGHT + ROW_HEIGHT * 3);
+}
+
+void UpgradeTimelineView::setRun(const UpgradeTelemetry::RunRecord &record)
+{
+    run = record;
+    hasRun = true;
+    setMinimumHeight(AXIS_HEIGHT + ROW_HEIGHT * qMax(3, run.steps.size()) + 8);
+    updateGeometry();
+    update();
+}
+
+void UpgradeTimelineView::clear()
+{
+    hasRun = false;
+    update();
+}
+
+QSize UpgradeTimelineView::sizeHint() const
+{
+    return QSize(760, minimumHeight());
+}
+
+void UpgradeTimelineView::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    if (!hasRun) {
+        painter.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        painter.drawText(rect(), Qt::AlignCenter, "选择一条升级记录查看各步骤耗时");
+        return;
+    }
+
+    // 横轴长度取整个升级耗时和最后结束的步骤中较大者
+    qint64 spanMs = run.totalMs;
+    for (const UpgradeTelemetry::StepRecord &step : run.steps) {
+        spanMs = qMax(spanMs, step.offsetMs + step.clientMs);
+    }
+    spanMs = qMax<qint64>(spanMs, 1000);
+
+    const int barLeft = LABEL_WIDTH;
+    const int barWidth = qMax(50, width() - LABEL_WIDTH - 10);
+    QFontMetrics metrics(font());
+
+    // 时间刻度
+    painter.setPen(palette().color(QPalette::Mid));
+    for (int i = 0; i <= AXIS_TICKS; ++i) {
+        int x = barLeft + barWidth * i / AXIS_TICKS;
+        painter.drawLine(x, AXIS_HEIGHT - 4, x, height());
+        QString text = formatSeconds(spanMs * i / AXIS_TICKS);
+        int textX = qMin(x - metrics.width(text) / 2, width() - metrics.width(text) - 2);
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(qMax(barLeft, textX), AXIS_HEIGHT - 8, text);
+        painter.setPen(palette().color(QPalette::Mid));
+    }
+
+    for (int i = 0; i < run.steps.size(); ++i) {
+        const UpgradeTelemetry::StepRecord &step = run.steps.at(i);
+        int top = AXIS_HEIGHT + i * ROW_HEIGHT;
+
+        painter.setPen(palette().color(QPalette::Text));
+        QString label = QString("%1. [%2] %3").arg(i + 1)
+                        .arg(UpgradePipeline::typeName(static_cast<UpgradePipeline::StepType>(step.type)))
+                        .arg(step.title);
+        painter.drawText(QRect(4, top, LABEL_WIDTH - 8, ROW_HEIGHT), Qt::AlignVCenter | Qt::AlignLeft,
+                         metrics.elidedText(label, Qt::ElideRight, LABEL_WIDTH - 8));
+
+        if (step.status == UpgradePipeline::StatusPending) {
+            continue;
+        }
+
+        int x = barLeft + static_cast<int>(barWidth * step.offsetMs / spanMs);
+        int w = qMax(2, static_cast<int>(barWidth * step.clientMs / spanMs));
+        QRect bar(x, top + 5, w, ROW_HEIGHT - 10);
+        painter.fillRect(bar, statusColor(step.status));
+
+        // 耗时说明放在横条右侧，空间不够时放在左侧
+        QString text;
+        if (step.status == UpgradePipeline::StatusSkipped) {
+            text = UpgradePipeline::statusName(UpgradePipeline::StatusSkipped);
+        } else {
+            text = formatSeconds(step.clientMs);
+            if (step.deviceMs >= 0) {
+                text += QString("（设备 %1）").arg(formatSeconds(step.deviceMs));
+            }
+            if (step.bytes >= 0) {
+                text += QString("  %1").arg(TransferStats::formatBytes(step.bytes));
+            }
+            if (step.status == UpgradePipeline::StatusFailed) {
+                text += QString("  退出码 %1").arg(step.exitCode);
+            }
+        }
+        int textWidth = metrics.width(text);
+        int textX = bar.right() + 6;
+        if (textX + textWidth > width() && bar.left() - 6 - textWidth >= barLeft) {
+            textX = bar.left() - 6 - textWidth;
+        }
+        painter.setPen(palette().color(QPalette::Text));
+        painter.drawText(QRect(textX, top, textWidth + 2, ROW_HEIGHT), Qt::AlignVCenter | Qt::AlignLeft, text);
+    }
+}
+
+UpgradeTimelineDialog::UpgradeTimelineDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("升级耗时记录");
+    setModal(true);
+    resize(900, 620);
+
+    setupUI();
+}
+
+UpgradeTimelineDialog::~UpgradeTimelineDialog()
+{
+}
+
+void UpgradeTimelineDialog::setupUI()
+{
+    mainLayout = new QVBoxLayout(this);
+    mainLayout->setSpacing(10);
+    mainLayout->setContentsMargins(15, 15, 15, 15);
+
+    tabWidget = new QTabWidget(this);
+
+    // 单次升级：记录列表和所选记录的时间轴
+    QWidget *runPage = new QWidget(this);
+    QVBoxLayout *runLayout = new QVBoxLayout(runPage);
+
+    runTable = new QTableWidget(0, RunColumnCount, runPage);
+    runTable->setHorizontalHeaderLabels(QStringList() << "时间" << "升级" << "设备" << "结果" << "总耗时");
+    runTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    runTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    runTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    runTable->verticalHeader()->setVisible(false);
+    runTable->horizontalHeader()->setSectionResizeMode(RunColumnDevice, QHeaderView::Stretch);
+    runTable->setColumnWidth(RunColumnTime, 150);
+    runTable->setColumnWidth(RunColumnUpgrade, 110);
+    runTable->setColumnWidth(RunColumnResult, 70);
+    runTable->setColumnWidth(RunColumnTotal, 90);
+    runLayout->addWidget(runTable, 1);
+
+    runDetailLabel = new QLabel(runPage);
+    runDetailLabel->setWordWrap(true);
+    runDetailLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    runLayout->addWidget(runDetailLabel);
+
+    timelineView = new UpgradeTimelineView(runPage);
+    runLayout->addWidget(timelineView);
+    tabWidget->addTab(runPage, "单次升级");
+
+    // 步骤统计：所有记录按升级类型和步骤汇总
+    statsTable = new QTableWidget(0, StatsColumnColumns, this);
+    statsTable->setHorizontalHeaderLabels(QStringList() << "升级" << "步骤" << "次数"
+                                          << "平均耗时" << "最长耗时" << "平均速率");
+    statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    statsTable->verticalHeader()->setVisible(false);
+    statsTable->horizontalHeader()->setSectionResizeMode(StatsColumnStep, QHeaderView::Stretch);
+    statsTable->setColumnWidth(StatsColumnUpgrade, 110);
+    statsTable->setToolTip("耗时优先使用设备上测得的值，速率按记录了数据量的步骤计算");
+    tabWidget->addTab(statsTable, "步骤统计");
+
+    mainLayout->addWidget(tabWidget, 1);
+
+    summaryLabel = new QLabel(this);
+    mainLayout->addWidget(summaryLabel);
+
+    // 底部按钮
+    buttonLayout = new QHBoxLayout();
+    reloadButton = new QPushButton("刷新", this);
+    closeButton = new QPushButton("关闭", this);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(reloadButton);
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(runTable, &QTableWidget::itemSelectionChanged, this, &UpgradeTimelineDialog::onRunSelected);
+    connect(reloadButton, &QPushButton::clicked, this, &UpgradeTimelineDialog::onReload);
+    connect(closeButton, &QPushButton::clicked, this, &UpgradeTimelineDialog::reject);
+}
+
+void UpgradeTimelineDialog::setTelemetryFile(const QString &filePath)
+{
+    telemetryFilePath = filePath;
+    onReload();
+}
+
+void UpgradeTimelineDialog::onReload()
+{
+    runs = UpgradeTelemetry(telemetryFilePath).load(MAX_LOADED_RUNS);
+    fillRunTable();
+    fillStatsTable();
+
+    int failed = 0;
+    for (const UpgradeTelemetry::RunRecord &run : runs) {
+        if (!run.success) {
+            failed++;
+        }
+    }
+    summaryLabel->setText(QString("共 %1 条升级记录，失败 %2 条").arg(runs.size()).arg(failed));
+
+    if (runTable->rowCount() > 0) {
+        runTable->selectRow(0);
+    } else {
+        runDetailLabel->clear();
+        timelineView->clear();
+    }
+}
+
+void UpgradeTimelineDialog::fillRunTable()
+{
+    // 最新的记录在最上面
+    runTable->setRowCount(0);
+    for (int i = runs.size() - 1; i >= 0; --i) {
+        const UpgradeTelemetry::RunRecord &run = runs.at(i);
+        int row = runTable->rowCount();
+        runTable->insertRow(row);
+
+        QTableWidgetItem *timeItem = new QTableWidgetItem(run.startedAt.toString("yyyy-MM-dd hh:mm:ss"));
+        timeItem->setData(Qt::UserRole, i);
+        runTable->setItem(row, RunColumnTime, timeItem);
+        runTable->setItem(row, RunColumnUpgrade, new QTableWidgetItem(run.upgrade));
+        runTable->setItem(row, RunColumnDevice, new QTableWidgetItem(run.device));
+
+        QTableWidgetItem *resultItem = new QTableWidgetItem(run.success ? "成功" : "失败");
+        resultItem->setForeground(run.success ? QColor("#2e7d32") : QColor("#c62828"));
+        runTable->setItem(row, RunColumnResult, resultItem);
+        runTable->setItem(row, RunColumnTotal, new QTableWidgetItem(formatSeconds(run.totalMs)));
+    }
+}
+
+void UpgradeTimelineDialog::fillStatsTable()
+{
+    QList<UpgradeTelemetry::StepStats> stats = UpgradeTelemetry::aggregate(runs);
+
+    statsTable->setRowCount(0);
+    for (const UpgradeTelemetry::StepStats &entry : stats) {
+        int row = statsTable->rowCount();
+        statsTable->insertRow(row);
+        statsTable->setItem(row, StatsColumnUpgrade, new QTableWidgetItem(entry.upgrade));
+        statsTable->setItem(row, StatsColumnStep, new QTableWidgetItem(entry.title));
+        statsTable->setItem(row, StatsColumnCount, new QTableWidgetItem(QString::number(entry.count)));
+        statsTable->setItem(row, StatsColumnAverage, new QTableWidgetItem(formatSeconds(entry.totalMs / entry.count)));
+        statsTable->setItem(row, StatsColumnMax, new QTableWidgetItem(formatSeconds(entry.maxMs)));
+
+        QString rate = "-";
+        if (entry.totalBytes > 0 && entry.bytesMs > 0) {
+            rate = TransferStats::formatRate(entry.totalBytes * 1000.0 / entry.bytesMs);
+        }
+        statsTable->setItem(row, StatsColumnRate, new QTableWidgetItem(rate));
+    }
+}
+
+void UpgradeTimelineDialog::onRunSelected()
+{
+    QList<QTableWidgetItem*> selected = runTable->selectedItems();
+    if (selected.isEmpty()) {
+        return;
+    }
+
+    QTableWidgetItem *timeItem = runTable->item(selected.first()->row(), RunColumnTime);
+    int index = timeItem ? timeItem->data(Qt::UserRole).toInt() : -1;
+    if (index < 0 || index >= runs.size()) {
+        return;
+    }
+
+    const UpgradeTelemetry::RunRecord &run = runs.at(index);
+    QStringList details;
+    details << QString("升级包: %1").arg(run.packageFile.isEmpty() ? "-" : run.packageFile)
+            << QString("%1: %2").arg(run.packageDigestName.isEmpty() ? "摘要" : run.packageDigestName)
+                                .arg(run.packageDigest.isEmpty() ? "-" : run.packageDigest);
+    if (!run.success && !run.failureReason.isEmpty()) {
+        details << QString("失败原因: %1").arg(run.failureReason);
+    }
+    runDetailLabel->setText(details.join("\n"));
+    timelineView->setRun(run);
+}
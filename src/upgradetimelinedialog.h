@@ -0,0 +1,101 @@
+/**
+ * @File Name: upgradetimelinedialog.h
+ * @brief  升级耗时记录对话框头文件，列出历史升级记录，以时间轴显示单次升级各步骤的耗时，并按步骤汇总统计
+ * @Author : chency email:121888719@qq.com
+ * @Version : 1.0
+ * @Creat Date : 2025
+ *
+ */
+
+#ifndef UPGRADETIMELINEDIALOG_H
+#define UPGRADETIMELINEDIALOG_H
+
+#include <QDialog>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTabWidget>
+#include <QList>
+#include "upgradetelemetry.h"
+
+/**
+ * 单次升级的时间轴：每个步骤一行，横条的位置和长度对应步骤开始时间和耗时，颜色表示结果
+ */
+class UpgradeTimelineView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit UpgradeTimelineView(QWidget *parent = nullptr);
+
+    void setRun(const UpgradeTelemetry::RunRecord &record);
+    void clear();
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    UpgradeTelemetry::RunRecord run;
+    bool hasRun;
+};
+
+class UpgradeTimelineDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit UpgradeTimelineDialog(QWidget *parent = nullptr);
+    ~UpgradeTimelineDialog();
+
+    void setTelemetryFile(const QString &filePath);
+
+private slots:
+    void onRunSelected();
+    void onReload();
+
+private:
+    void setupUI();
+    void fillRunTable();
+    void fillStatsTable();
+
+    enum RunColumn {
+        RunColumnTime,
+        RunColumnUpgrade,
+        RunColumnDevice,
+        RunColumnResult,
+        RunColumnTotal,
+        RunColumnCount
+    };
+
+    enum StatsColumn {
+        StatsColumnUpgrade,
+        StatsColumnStep,
+        StatsColumnCount,
+        StatsColumnAverage,
+        StatsColumnMax,
+        StatsColumnRate,
+        StatsColumnColumns
+    };
+
+    // UI组件
+    QVBoxLayout *mainLayout;
+    QTabWidget *tabWidget;
+    QTableWidget *runTable;
+    QLabel *runDetailLabel;
+    UpgradeTimelineView *timelineView;
+    QTableWidget *statsTable;
+    QLabel *summaryLabel;
+    QHBoxLayout *buttonLayout;
+    QPushButton *reloadButton;
+    QPushButton *closeButton;
+
+    QString telemetryFilePath;
+    QList<UpgradeTelemetry::RunRecord> runs;
+};
+
+#endif // UPGRADETIMELINEDIALOG_H